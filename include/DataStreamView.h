@@ -0,0 +1,162 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#ifndef _DATA_STREAM_VIEW_H_
+#define _DATA_STREAM_VIEW_H_
+
+#include "dll_export.h"
+#include "nif_basic_types.h"
+#include "nif_math.h"
+#include "gen/enums.h"
+#include <vector>
+
+namespace Niflib {
+
+using namespace std;
+
+/*!
+ * Retrieves the size in bytes of one component of a certain format.
+ * \param[in] format The component format.
+ * \return The size in bytes.
+ */
+NIFLIB_API unsigned int GetComponentFormatSize( ComponentFormat format );
+
+/*!
+ * Retrieves the number of values that one component of a certain format
+ * decodes to, such as 3 for F_FLOAT32_3 or F_NORMINT_11_11_10.
+ * \param[in] format The component format.
+ * \return The number of values.
+ */
+NIFLIB_API unsigned int GetComponentFormatValueCount( ComponentFormat format );
+
+/*!
+ * A typed view of one component of a NiDataStream, such as the positions in
+ * an interleaved vertex stream.  The view points into the bytes of the stream
+ * instead of copying them, and decodes the stored format on access.  Half
+ * floats become floats, normalized integers become floats in [0, 1] or
+ * [-1, 1], and packed 10 and 11 bit formats are split into their values.
+ *
+ * A view is only valid as long as its stream exists and its data is not
+ * changed.  The stream bytes are read in little endian order, as written by
+ * the PC versions of Gamebryo.
+ */
+class DataStreamView {
+public:
+	/*! Creates an empty view. */
+	NIFLIB_API DataStreamView();
+
+	/*!
+	 * Creates a view of raw bytes.  Normally created by NiDataStream::GetComponentView.
+	 * \param[in] base The first byte of the component in the first element.
+	 * \param[in] stride The distance in bytes between two elements.
+	 * \param[in] count The number of elements.
+	 * \param[in] format The format of the component.
+	 */
+	NIFLIB_API DataStreamView( const byte * base, unsigned int stride, unsigned int count, ComponentFormat format );
+
+	/*!
+	 * Retrieves the number of elements in the view, such as the number of vertices.
+	 * \return The number of elements.
+	 */
+	NIFLIB_API unsigned int Size() const;
+
+	/*!
+	 * Retrieves the format of the viewed component.
+	 * \return The component format.
+	 */
+	NIFLIB_API ComponentFormat GetFormat() const;
+
+	/*!
+	 * Retrieves the distance in bytes between two elements.
+	 * \return The stride.
+	 */
+	NIFLIB_API unsigned int GetStride() const;
+
+	/*!
+	 * Retrieves the number of values in each element, such as 3 for a position.
+	 * \return The number of values.
+	 */
+	NIFLIB_API unsigned int GetValueCount() const;
+
+	/*!
+	 * Retrieves the raw bytes of an element.
+	 * \param[in] i The index of the element.
+	 * \return A pointer to the first byte of the component in the element.
+	 */
+	NIFLIB_API const byte * GetElement( unsigned int i ) const;
+
+	/*!
+	 * Decodes one value of an element to a float.
+	 * \param[in] i The index of the element.
+	 * \param[in] value The index of the value within the element.
+	 * \return The decoded value.
+	 */
+	NIFLIB_API float GetFloat( unsigned int i, unsigned int value = 0 ) const;
+
+	/*!
+	 * Reads one value of an element as an unsigned integer, as used by the
+	 * INDEX and BLENDINDICES semantics.  Float and normalized formats are
+	 * decoded and truncated.
+	 * \param[in] i The index of the element.
+	 * \param[in] value The index of the value within the element.
+	 * \return The value.
+	 */
+	NIFLIB_API unsigned int GetUInt( unsigned int i, unsigned int value = 0 ) const;
+
+	/*!
+	 * Decodes an element to a vector.  Missing values are zero.
+	 * \param[in] i The index of the element.
+	 * \return The decoded vector.
+	 */
+	NIFLIB_API Vector3 GetVector3( unsigned int i ) const;
+
+	/*!
+	 * Decodes an element to a texture coordinate.  Missing values are zero.
+	 * \param[in] i The index of the element.
+	 * \return The decoded texture coordinate.
+	 */
+	NIFLIB_API TexCoord GetTexCoord( unsigned int i ) const;
+
+	/*!
+	 * Decodes an element to a color.  Missing color values are zero and a
+	 * missing alpha is one.
+	 * \param[in] i The index of the element.
+	 * \return The decoded color.
+	 */
+	NIFLIB_API Color4 GetColor4( unsigned int i ) const;
+
+	/*!
+	 * Decodes every element to floats.  The format is looked at once, and each
+	 * format has its own loop over the elements.
+	 * \param[out] values Receives GetValueCount() floats per element.
+	 */
+	NIFLIB_API void DecodeFloats( vector<float> & values ) const;
+
+	/*!
+	 * Reads every element as unsigned integers.
+	 * \param[out] values Receives GetValueCount() integers per element.
+	 * \sa DataStreamView::GetUInt
+	 */
+	NIFLIB_API void DecodeUInts( vector<unsigned int> & values ) const;
+
+	/*!
+	 * Decodes every element to a vector.
+	 * \param[out] values Receives one vector per element.
+	 */
+	NIFLIB_API void DecodeVector3s( vector<Vector3> & values ) const;
+
+	/*!
+	 * Decodes every element to a texture coordinate.
+	 * \param[out] values Receives one texture coordinate per element.
+	 */
+	NIFLIB_API void DecodeTexCoords( vector<TexCoord> & values ) const;
+
+private:
+	const byte * base;
+	unsigned int stride;
+	unsigned int count;
+	ComponentFormat format;
+};
+
+}
+#endif
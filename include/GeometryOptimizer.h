@@ -0,0 +1,67 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#ifndef _GEOMETRY_OPTIMIZER_H_
+#define _GEOMETRY_OPTIMIZER_H_
+
+#include "dll_export.h"
+#include "obj/NiTriBasedGeom.h"
+#include "obj/NiNode.h"
+
+namespace Niflib {
+
+/*! What OptimizeGeometry removed from the geometry it was given. */
+struct GeometryOptimizeResult {
+	/*! Vertices that were merged into an equal vertex. */
+	unsigned int weldedVertices;
+	/*! Vertices that no face used. */
+	unsigned int unusedVertices;
+	/*! Triangles that had the same vertex twice. */
+	unsigned int degenerateTriangles;
+	/*! Texture coordinate sets that repeated an earlier set. */
+	unsigned int duplicateUVSets;
+	/*! How many bytes smaller the geometry, skin and morph data are when written. */
+	unsigned int bytesSaved;
+
+	/*! Constructor.  Everything starts at zero. */
+	NIFLIB_API GeometryOptimizeResult();
+	/*! Adds the counts of another result to this one. */
+	NIFLIB_API GeometryOptimizeResult & operator+=( const GeometryOptimizeResult & rh );
+};
+
+/*!
+ * Removes redundant data from the geometry of a shape.  Vertices within
+ * tolerance of each other whose normals, colors, texture coordinates,
+ * tangents, skin weights and morph targets also match within
+ * attribute_tolerance are welded, vertices that no face uses are removed,
+ * and then triangles that use the same vertex twice are removed.  Strips
+ * are only reindexed, since they rely on such triangles.  Texture coordinate
+ * sets that repeat an earlier set are removed, unless the shape's
+ * NiTexturingProperty uses them or a set after them.
+ *
+ * The triangles or strips, the NiSkinData weights, the NiSkinPartition
+ * vertex maps and faces, the NiMorphData targets of NiGeomMorpherControllers
+ * and Oblivion style tangent space extra data of the shape are kept
+ * consistent.  Other shapes that share the data are not updated, so use
+ * OptimizeSceneGeometry for a whole scene.  Data with additional geometry
+ * data is left alone.
+ * \param[in] shape The shape to optimize.  Its data must be a NiTriShapeData or NiTriStripsData.
+ * \param[in] tolerance How far apart vertices may be to be welded.  Zero welds only vertices at the same position.
+ * \param[in] attribute_tolerance How much each component of the other attributes may differ for vertices to be welded.
+ * \return What was removed.
+ */
+NIFLIB_API GeometryOptimizeResult OptimizeGeometry( NiTriBasedGeom * shape, float tolerance = 0.0f, float attribute_tolerance = 1e-5f );
+
+/*!
+ * Calls OptimizeGeometry for every NiTriShape and NiTriStrips below a node.
+ * Data shared by several shapes is optimized once, and only if none of them
+ * has a skin or morph controller, since those would need to agree.
+ * \param[in] root The root of the scene.
+ * \param[in] tolerance How far apart vertices may be to be welded.
+ * \param[in] attribute_tolerance How much each component of the other attributes may differ for vertices to be welded.
+ * \return The sum of what was removed from every shape.
+ */
+NIFLIB_API GeometryOptimizeResult OptimizeSceneGeometry( NiNode * root, float tolerance = 0.0f, float attribute_tolerance = 1e-5f );
+
+}
+#endif
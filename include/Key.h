@@ -7,7 +7,9 @@ All rights reserved.  Please see niflib.h for license. */
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <algorithm>
 #include <math.h>
+#include <stdexcept>
 #include "gen/enums.h"
 
 namespace Niflib {
@@ -115,6 +117,270 @@ vector< Key<T> > ExtractKeySlice( const vector< Key<T> > & keys, float slice_sta
 	return out;
 }
 
+/*!
+ * A function to find the key segment that contains a certain time.  Keys must be
+ * sorted by time.  A binary search is used unless the hint already points at the
+ * right segment or the one after it, which makes sampling at increasing times
+ * cheap.
+ * \param[in] keys The keys to search.
+ * \param[in] time The time to look up.
+ * \param[in,out] hint If not NULL, the result of the previous lookup in the same
+ * keys.  Receives the new result.
+ * \return The index of the last key whose time is not after the given time, or
+ * zero if the time is before the first key.
+ */
+template <class T>
+unsigned int FindKeyIndex( const vector< Key<T> > & keys, float time, unsigned int * hint = NULL ) {
+	const unsigned int n = (unsigned int)(keys.size());
+	if ( hint != NULL && *hint + 1 < n && keys[*hint].time <= time ) {
+		if ( time < keys[*hint + 1].time ) {
+			return *hint;
+		}
+		if ( *hint + 2 >= n || time < keys[*hint + 2].time ) {
+			return ++(*hint);
+		}
+	}
+
+	//First key that starts after the time
+	unsigned int lo = 0, hi = n;
+	while ( lo < hi ) {
+		unsigned int mid = ( lo + hi ) / 2;
+		if ( keys[mid].time <= time ) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	unsigned int index = ( lo > 0 ) ? lo - 1 : 0;
+	if ( hint != NULL ) {
+		*hint = index;
+	}
+	return index;
+}
+
+/*!
+ * Calculates the incoming and outgoing tangents of a key for tension, bias,
+ * continuity interpolation, scaled for the length of the segment before and
+ * after the key.
+ */
+template <class T>
+void CalcTBCTangents( const vector< Key<T> > & keys, unsigned int i, T & in_tangent, T & out_tangent ) {
+	const Key<T> & k = keys[i];
+	const unsigned int last = (unsigned int)(keys.size()) - 1;
+	const T prev = ( i > 0 ) ? k.data - keys[i - 1].data : keys[min( i + 1, last )].data - k.data;
+	const T next = ( i < last ) ? keys[i + 1].data - k.data : prev;
+	const float t = 1.0f - k.tension;
+	const float c = k.continuity;
+	const float b = k.bias;
+	in_tangent = prev * ( 0.5f * t * ( 1.0f - c ) * ( 1.0f + b ) ) + next * ( 0.5f * t * ( 1.0f + c ) * ( 1.0f - b ) );
+	out_tangent = prev * ( 0.5f * t * ( 1.0f + c ) * ( 1.0f + b ) ) + next * ( 0.5f * t * ( 1.0f - c ) * ( 1.0f - b ) );
+
+	//Adjust for uneven key spacing
+	if ( i > 0 && i < last ) {
+		const float dt_prev = k.time - keys[i - 1].time;
+		const float dt_next = keys[i + 1].time - k.time;
+		if ( dt_prev + dt_next > 0.0f ) {
+			in_tangent = in_tangent * ( 2.0f * dt_prev / ( dt_prev + dt_next ) );
+			out_tangent = out_tangent * ( 2.0f * dt_next / ( dt_prev + dt_next ) );
+		}
+	}
+}
+
+/*!
+ * A function to evaluate a key track at a certain time.  Works for any key data
+ * that can be added, subtracted, and multiplied by a float, such as float and
+ * Vector3.  Times outside the keys are clamped to the first or last key.
+ * \param[in] keys The keys to evaluate, sorted by time.
+ * \param[in] type The interpolation to use between the keys.  QUADRATIC_KEY uses
+ * the stored tangents as a Hermite curve, TBC_KEY calculates tangents from the
+ * tension, bias, and continuity of each key, CONST_KEY holds each key until the
+ * next one, and anything else interpolates linearly.
+ * \param[in] time The time to evaluate the keys at.
+ * \param[in,out] hint If not NULL, the key segment found by a previous call on
+ * the same keys.  See FindKeyIndex.
+ * \return The interpolated value.
+ */
+template <class T>
+T InterpolateKeys( const vector< Key<T> > & keys, KeyType type, float time, unsigned int * hint = NULL ) {
+	if ( keys.empty() ) {
+		throw runtime_error("Cannot evaluate a key track that has no keys.");
+	}
+	const unsigned int i = FindKeyIndex( keys, time, hint );
+	const Key<T> & k0 = keys[i];
+	if ( time <= k0.time || i + 1 == keys.size() || type == CONST_KEY ) {
+		return k0.data;
+	}
+	const Key<T> & k1 = keys[i + 1];
+	const float u = ( time - k0.time ) / ( k1.time - k0.time );
+
+	T m0, m1;
+	switch ( type ) {
+		case QUADRATIC_KEY:
+			m0 = k0.forward_tangent;
+			m1 = k1.backward_tangent;
+			break;
+		case TBC_KEY:
+			{
+				T unused;
+				CalcTBCTangents( keys, i, unused, m0 );
+				CalcTBCTangents( keys, i + 1, m1, unused );
+			}
+			break;
+		default:
+			return k0.data + ( k1.data - k0.data ) * u;
+	}
+
+	//Cubic Hermite basis
+	const float u2 = u * u;
+	const float u3 = u2 * u;
+	return k0.data * ( 2.0f * u3 - 3.0f * u2 + 1.0f )
+		+ k1.data * ( -2.0f * u3 + 3.0f * u2 )
+		+ m0 * ( u3 - 2.0f * u2 + u )
+		+ m1 * ( u3 - u2 );
+}
+
+/*!
+ * Builds the track made of the kept keys of a reduced track.  Quadratic key
+ * tangents are rescaled to the length of the merged segments.  Used by ReduceKeys.
+ */
+template <class T>
+void BuildReducedKeys( const vector< Key<T> > & keys, KeyType type, const vector<bool> & keep, vector< Key<T> > & reduced, vector<unsigned int> & kept ) {
+	reduced.clear();
+	kept.clear();
+	for ( unsigned int i = 0; i < keys.size(); ++i ) {
+		if ( keep[i] ) {
+			kept.push_back( i );
+			reduced.push_back( keys[i] );
+		}
+	}
+	if ( type == QUADRATIC_KEY ) {
+		for ( unsigned int j = 0; j + 1 < kept.size(); ++j ) {
+			const unsigned int a = kept[j], b = kept[j + 1];
+			const float span = keys[b].time - keys[a].time;
+			if ( b > a + 1 && keys[a + 1].time > keys[a].time && keys[b].time > keys[b - 1].time ) {
+				reduced[j].forward_tangent = keys[a].forward_tangent * ( span / ( keys[a + 1].time - keys[a].time ) );
+				reduced[j + 1].backward_tangent = keys[b].backward_tangent * ( span / ( keys[b].time - keys[b - 1].time ) );
+			}
+		}
+	}
+}
+
+/*!
+ * A function to remove keys that are not needed to reproduce a key track within a
+ * tolerance.  The reduced track is checked against the original curve at every
+ * original key and halfway between keys.  Starting from the first and last key,
+ * each segment of the reduced track whose error is too large gets back the
+ * original key closest to its worst sample, until the whole track is within the
+ * tolerance.  Then each kept key is removed again if the track stays within the
+ * tolerance without it.  A track that stays within the tolerance of its first key
+ * is reduced to that single key.
+ * \param[in] keys The keys to reduce, sorted by time.
+ * \param[in] type The interpolation used between the keys.  Quadratic key tangents
+ * are rescaled to the length of the merged segments.
+ * \param[in] tolerance The largest allowed distance between the original and the reduced track.
+ * \param[in] distance A function that measures the distance between two key values.
+ * \param[in] interpolate The function that evaluates the keys.  The default is InterpolateKeys.
+ * \return The reduced keys, a subset of the original ones.
+ */
+template <class T>
+vector< Key<T> > ReduceKeys( const vector< Key<T> > & keys, KeyType type, float tolerance, float (*distance)( const T &, const T & ), T (*interpolate)( const vector< Key<T> > &, KeyType, float, unsigned int * ) = &InterpolateKeys<T> ) {
+	const unsigned int n = (unsigned int)(keys.size());
+	if ( n <= 1 ) {
+		return keys;
+	}
+
+	//Reference samples of the original curve, and the key each one is closest to
+	vector<float> times;
+	vector<T> values;
+	vector<unsigned int> nearest;
+	unsigned int hint = 0;
+	bool constant = true;
+	for ( unsigned int i = 0; i < n; ++i ) {
+		times.push_back( keys[i].time );
+		values.push_back( keys[i].data );
+		nearest.push_back( i );
+		if ( i + 1 < n && type != CONST_KEY ) {
+			times.push_back( 0.5f * ( keys[i].time + keys[i + 1].time ) );
+			values.push_back( interpolate( keys, type, times.back(), &hint ) );
+			nearest.push_back( i + 1 );
+		}
+	}
+	for ( unsigned int s = 0; s < values.size() && constant; ++s ) {
+		constant = distance( values[s], keys[0].data ) <= tolerance;
+	}
+	if ( constant ) {
+		return vector< Key<T> >( 1, keys[0] );
+	}
+
+	vector<bool> keep( n, false );
+	keep[0] = keep[n - 1] = true;
+	vector< Key<T> > reduced;
+	vector<unsigned int> kept;
+	while ( true ) {
+		BuildReducedKeys( keys, type, keep, reduced, kept );
+		if ( kept.size() == n ) {
+			break;
+		}
+
+		//Find the worst sample of each reduced segment
+		vector<float> worst( kept.size(), tolerance );
+		vector<unsigned int> worst_key( kept.size(), n );
+		unsigned int eval_hint = 0, seg_hint = 0;
+		for ( unsigned int s = 0; s < times.size(); ++s ) {
+			float err = distance( interpolate( reduced, type, times[s], &eval_hint ), values[s] );
+			unsigned int seg = FindKeyIndex( reduced, times[s], &seg_hint );
+			if ( err > worst[seg] ) {
+				//The closest original key that is not kept yet
+				unsigned int lo = nearest[s], hi = nearest[s];
+				while ( keep[lo] && keep[hi] && ( lo > 0 || hi + 1 < n ) ) {
+					lo = ( lo > 0 ) ? lo - 1 : lo;
+					hi = ( hi + 1 < n ) ? hi + 1 : hi;
+				}
+				worst[seg] = err;
+				worst_key[seg] = keep[hi] ? lo : hi;
+			}
+		}
+
+		bool added = false;
+		for ( unsigned int j = 0; j < kept.size(); ++j ) {
+			if ( worst_key[j] < n && !keep[worst_key[j]] ) {
+				keep[worst_key[j]] = true;
+				added = true;
+			}
+		}
+		if ( !added ) {
+			break;
+		}
+	}
+
+	//Remove keys that the refinement added but that turn out not to be needed.
+	//Removing a key only changes the curve up to two kept keys away.
+	vector< Key<T> > trial;
+	vector<unsigned int> trial_kept;
+	for ( unsigned int i = 1; i + 1 < n; ++i ) {
+		if ( !keep[i] ) {
+			continue;
+		}
+		keep[i] = false;
+		BuildReducedKeys( keys, type, keep, trial, trial_kept );
+		unsigned int j = FindKeyIndex( trial, keys[i].time );
+		const float lo = trial[ ( j > 0 ) ? j - 1 : 0 ].time;
+		const float hi = trial[ std::min( j + 2, (unsigned int)(trial.size()) - 1 ) ].time;
+		bool ok = true;
+		unsigned int eval_hint = 0;
+		for ( unsigned int s = 0; s < times.size() && ok; ++s ) {
+			if ( times[s] >= lo && times[s] <= hi ) {
+				ok = distance( interpolate( trial, type, times[s], &eval_hint ), values[s] ) <= tolerance;
+			}
+		}
+		if ( ok ) {
+			reduced.swap( trial );
+		} else {
+			keep[i] = true;
+		}
+	}
+	return reduced;
+}
 
 } //end namespace Niflib
 
@@ -0,0 +1,79 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#ifndef _MESH_CONVERTER_H_
+#define _MESH_CONVERTER_H_
+
+#include "Ref.h"
+#include "obj/NiMesh.h"
+#include "obj/NiTriShape.h"
+#include "obj/NiTriBasedGeom.h"
+#include "obj/NiNode.h"
+
+namespace Niflib {
+
+/*! How ConvertToMesh lays out the vertex data of the new mesh. */
+enum MeshStreamLayout {
+	MESH_INTERLEAVED = 0, /*!< One vertex stream holds every vertex semantic, so the data of each vertex is contiguous. */
+	MESH_SEPARATE = 1 /*!< Each vertex semantic gets its own stream. */
+};
+
+/*!
+ * Converts a NiTriShape or NiTriStrips to a NiMesh, as used by Gamebryo
+ * 20.5 and later.  The vertices, normals, colors and UV sets become vertex
+ * streams, and the triangles become an INDEX stream.  A skin becomes a
+ * NiSkinningMeshModifier.  If the skin has a partition, each partition
+ * becomes a submesh with its own region in every stream: its vertices, its
+ * triangles, its BLENDWEIGHT and BLENDINDICES, and its bone map as a
+ * BONE_PALETTE stream.  The mesh shares the properties of the geometry,
+ * with the Bethesda properties added to them, and its material is the
+ * shader of the geometry.  The extra data, controllers and collision object
+ * are moved from the geometry to the mesh.
+ *
+ * Writing the mesh has a limitation.  Gamebryo files keep the usage and
+ * access of each NiDataStream in its block type name, such as
+ * "NiDataStream\x01" followed by the two values.  Niflib writes them as
+ * fields of the object under the plain "NiDataStream" type instead, so files
+ * with converted meshes can be read back by Niflib but not by other tools.
+ * \param[in] geom The geometry to convert.  Only the objects that are moved are taken from it.
+ * \param[in] layout Whether to interleave the vertex semantics in one stream.
+ * \return The new mesh, with the name, flags and local transform of the geometry.
+ */
+NIFLIB_API Ref<NiMesh> ConvertToMesh( NiTriBasedGeom * geom, MeshStreamLayout layout = MESH_INTERLEAVED );
+
+/*!
+ * Converts a triangle NiMesh to a NiTriShape.  The submeshes are merged
+ * into one shape, with each submesh's indices offset to the start of its
+ * vertex region.  The skin is not restored, since binding it needs the shape
+ * to be in the scene; ConvertSceneToTriShapes does that.  The shape shares
+ * the properties of the mesh and its shader is the active material.  The
+ * extra data, controllers and collision object are moved from the mesh to
+ * the shape.
+ * \param[in] mesh The mesh to convert.  Only the objects that are moved are taken from it.
+ * \return The new shape, with the name, flags and local transform of the mesh.
+ */
+NIFLIB_API Ref<NiTriShape> ConvertToTriShape( NiMesh * mesh );
+
+/*!
+ * Replaces every NiTriShape and NiTriStrips below a node with a NiMesh made
+ * by ConvertToMesh, at the same position among the children of its parent.
+ * See ConvertToMesh for a limitation when the meshes are written.
+ * \param[in] root The root of the scene to convert.
+ * \param[in] layout Whether to interleave the vertex semantics in one stream.
+ * \return The number of converted shapes.
+ */
+NIFLIB_API unsigned int ConvertSceneToMeshes( NiNode * root, MeshStreamLayout layout = MESH_INTERLEAVED );
+
+/*!
+ * Replaces every NiMesh below a node with a NiTriShape made by
+ * ConvertToTriShape, at the same position among the children of its parent,
+ * and binds the skin of skinned meshes to the same bones,
+ * with the weights of the BLENDWEIGHT and BLENDINDICES streams.  The bind
+ * pose is taken from the current pose of the bones.
+ * \param[in] root The root of the scene to convert.
+ * \return The number of converted meshes.
+ */
+NIFLIB_API unsigned int ConvertSceneToTriShapes( NiNode * root );
+
+}
+#endif
@@ -0,0 +1,84 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#ifndef _MESH_SIMPLIFIER_H_
+#define _MESH_SIMPLIFIER_H_
+
+#include "Ref.h"
+#include "nif_math.h"
+#include "obj/NiTriBasedGeomData.h"
+#include "obj/NiTriBasedGeom.h"
+#include "obj/NiSkinData.h"
+#include "obj/NiLODNode.h"
+#include "obj/BSLODTriShape.h"
+#include "obj/NiNode.h"
+
+namespace Niflib {
+
+/*!
+ * Reduces the triangles of a mesh with quadric error metrics.  Edges are
+ * collapsed in order of the error they add, where each collapse moves the
+ * vertices at one position onto those at a neighboring position.  No new
+ * vertices are made, so the result indexes the same vertices as the data,
+ * some of which are no longer used.
+ *
+ * Besides the distance to the original surface, the cost of a collapse
+ * includes how much the normals, vertex colors, texture coordinates and skin
+ * weights of the merged vertices differ.  Vertices that share a position but
+ * not their other attributes, such as along a texture seam, are collapsed
+ * together onto matching vertices so that the seam does not open, and open
+ * borders are kept in place.
+ * \param[in] data The mesh to simplify.  It is not changed.
+ * \param[in] target_triangles The number of triangles to reduce the mesh to.  Fewer collapses are made if no more are possible.
+ * \param[in] skin The skin weights of the mesh to take into account, or NULL for none.
+ * \param[in] attribute_weight How much the attributes count against the distance to the surface.  Zero simplifies by shape alone.
+ * \param[out] error If not NULL, receives the largest distance by which a collapse moved the surface.
+ * \return The triangles of the simplified mesh.
+ */
+NIFLIB_API vector<Triangle> SimplifyTriangles( NiTriBasedGeomData * data, unsigned int target_triangles, NiSkinData * skin = NULL, float attribute_weight = 1.0f, float * error = NULL );
+
+/*!
+ * Builds levels of detail for a shape.  A NiLODNode takes the place of the
+ * shape in its parent, with the shape as the first level and a NiTriShape
+ * for each of the ratios, simplified with SimplifyTriangles.  Each level is
+ * used until it is far enough away that the error of the next level spans
+ * less than screen_error of the view, so the ranges follow the geometry.
+ *
+ * The new shapes have the properties, transform and skin bones of the
+ * original.  Skinned levels keep all vertices and get a copy of the
+ * NiSkinData of the original, with their own partition if the original has
+ * one; the others only keep the vertices they use.
+ * \param[in] shape The shape to build levels of detail for.  It must have data.
+ * \param[in] ratios The fraction of the triangles to keep in each level after the first, from the nearest to the farthest.
+ * \param[in] screen_error The error to tolerate, as a fraction of the distance to the viewer.
+ * \param[in] attribute_weight How much the attributes count when simplifying, as in SimplifyTriangles.
+ * \return The new NiLODNode.
+ */
+NIFLIB_API Ref<NiLODNode> GenerateLODs( NiTriBasedGeom * shape, const vector<float> & ratios, float screen_error = 0.001f, float attribute_weight = 1.0f );
+
+/*!
+ * Calls GenerateLODs for every NiTriShape and NiTriStrips below a node that
+ * is not already a level of a NiLODNode.
+ * \param[in] root The root of the scene.
+ * \param[in] ratios The fraction of the triangles to keep in each level after the first.
+ * \param[in] screen_error The error to tolerate, as a fraction of the distance to the viewer.
+ * \param[in] attribute_weight How much the attributes count when simplifying, as in SimplifyTriangles.
+ * \return The number of shapes that got levels of detail.
+ */
+NIFLIB_API unsigned int GenerateSceneLODs( NiNode * root, const vector<float> & ratios, float screen_error = 0.001f, float attribute_weight = 1.0f );
+
+/*!
+ * Fills the levels of a BSLODTriShape.  Its triangles become three
+ * consecutive groups: the full mesh, then the mesh simplified to each of the
+ * two ratios, and the level sizes are set to the triangle counts of the
+ * groups.  If the level sizes already cover all of the triangles, only the
+ * first group is used as the full mesh.
+ * \param[in] shape The shape to fill.  Its data must be a NiTriShapeData.
+ * \param[in] level1_ratio The fraction of the triangles to keep in the second level.
+ * \param[in] level2_ratio The fraction of the triangles to keep in the third level.
+ * \param[in] attribute_weight How much the attributes count when simplifying, as in SimplifyTriangles.
+ */
+NIFLIB_API void GenerateLODTriShapeLevels( BSLODTriShape * shape, float level1_ratio = 0.5f, float level2_ratio = 0.25f, float attribute_weight = 1.0f );
+
+}
+#endif
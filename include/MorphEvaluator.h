@@ -0,0 +1,112 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#ifndef _MORPH_EVALUATOR_H_
+#define _MORPH_EVALUATOR_H_
+
+#include "Ref.h"
+#include "nif_math.h"
+#include "obj/NiMorphData.h"
+#include "obj/NiGeomMorpherController.h"
+#include <vector>
+
+namespace Niflib {
+
+using namespace std;
+
+/*!
+ * Computes blended morph geometry, the base mesh plus the weighted sum of
+ * the morph target offsets, from a NiMorphData object.  The offsets are
+ * copied once, when the evaluator is created, into a sparse form that only
+ * holds the vertices each morph target actually moves, so the cost of a
+ * blend depends on the number of moved vertices rather than on the size
+ * of the mesh times the number of morph targets.
+ *
+ * As in the NIF files, morph target 0 is the base mesh.  It always has full
+ * weight, and its entry in a weight array is ignored.
+ */
+class MorphEvaluator {
+public:
+	/*!
+	 * Creates an evaluator for morph data.
+	 * \param[in] data The morph data.  It is read once, so a new evaluator
+	 * must be made after it changes.
+	 * \param[in] tolerance Offsets whose length is at most this are dropped
+	 * from the sparse morph targets.
+	 */
+	NIFLIB_API MorphEvaluator( NiMorphData * data, float tolerance = 0.0f );
+
+	/*!
+	 * Creates an evaluator for the morph data of a controller.  The weights
+	 * at a given time are then taken from the controller's interpolators.
+	 * \param[in] controller The geometry morpher controller.
+	 * \param[in] tolerance Offsets whose length is at most this are dropped
+	 * from the sparse morph targets.
+	 */
+	NIFLIB_API MorphEvaluator( NiGeomMorpherController * controller, float tolerance = 0.0f );
+
+	/*! Destructor */
+	NIFLIB_API ~MorphEvaluator();
+
+	/*!
+	 * Retrieves the number of vertices in the base mesh and the results.
+	 * \return The number of vertices.
+	 */
+	NIFLIB_API unsigned int GetVertexCount() const;
+
+	/*!
+	 * Retrieves the number of morph targets, including the base mesh.
+	 * \return The number of morph targets.
+	 */
+	NIFLIB_API unsigned int GetMorphCount() const;
+
+	/*!
+	 * Retrieves the number of vertices that a morph target moves, which is
+	 * the number of offsets kept for it.
+	 * \param[in] n The index of the morph target.
+	 * \return The number of moved vertices.
+	 */
+	NIFLIB_API unsigned int GetMovedVertexCount( unsigned int n ) const;
+
+	/*!
+	 * Computes the weight of every morph target at a certain time, from the
+	 * interpolators of the controller if the evaluator was made from one, or
+	 * from the morph keys otherwise.  An interpolator without keys or a pose
+	 * gives a weight of zero.
+	 * \param[in] time The time to evaluate the weights at.
+	 * \return The weight of each morph target.
+	 */
+	NIFLIB_API vector<float> EvaluateWeights( float time ) const;
+
+	/*!
+	 * Computes the morphed vertices for a set of weights.
+	 * \param[in] weights The weight of each morph target.  Missing weights
+	 * are treated as zero.
+	 * \param[out] vertices Receives the morphed vertices.
+	 */
+	NIFLIB_API void Evaluate( const vector<float> & weights, vector<Vector3> & vertices ) const;
+
+	/*!
+	 * Computes the morphed vertices at a certain time.
+	 * \param[in] time The time to evaluate the morph at.
+	 * \param[out] vertices Receives the morphed vertices.
+	 * \sa MorphEvaluator::EvaluateWeights
+	 */
+	NIFLIB_API void Evaluate( float time, vector<Vector3> & vertices ) const;
+
+private:
+	void init( float tolerance );
+
+	Ref<NiMorphData> data;
+	Ref<NiGeomMorpherController> controller;
+	vector<Vector3> base;
+	/*! Where the moved vertices of each morph target start in the arrays below; one more entry than there are morph targets. */
+	vector<unsigned int> morphStart;
+	/*! The index of each moved vertex. */
+	vector<unsigned int> index;
+	/*! The offset of each moved vertex, one component per array. */
+	vector<float> dx, dy, dz;
+};
+
+}
+#endif
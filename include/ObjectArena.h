@@ -0,0 +1,112 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#ifndef _OBJECT_ARENA_H_
+#define _OBJECT_ARENA_H_
+
+#include "dll_export.h"
+#include <cstddef>
+
+namespace Niflib {
+
+struct ArenaBlocks;
+
+/*!
+ * A monotonic allocator for the NIF objects of one document.  While an arena
+ * is current, every NiObject that is created, such as by ReadNifList with
+ * NifInfo::arena set, is placed in large blocks owned by the arena instead of
+ * being allocated from the heap one by one.
+ *
+ * The objects are still reference counted and their destructors still run
+ * one by one, but their memory is not returned piece by piece.  The blocks
+ * are released all at once, when the arena has been destroyed and the last of
+ * its objects has died, so objects may safely outlive the ObjectArena that
+ * made them.  This keeps a batch job that loads and discards many files from
+ * fragmenting the heap.  Memory that the objects allocate themselves, such as
+ * the storage of their vectors, still comes from the heap.
+ *
+ * Objects carry no header.  Freeing an object looks up its address among the
+ * blocks of the live arenas, which is skipped while there are none.
+ *
+ * Each thread has its own current arena.  When Niflib is built with
+ * NIFLIB_CXX11, the bookkeeping of the arenas is locked, so the objects of an
+ * arena may be released on any thread.  Otherwise, only one thread at a time
+ * may create or release objects while an arena exists.  In both cases the
+ * reference count of a single object is not synchronized, as for any NiObject.
+ */
+class ObjectArena {
+public:
+	/*!
+	 * Creates an empty arena.
+	 * \param[in] block_size The size in bytes of the blocks the arena allocates.  Larger objects get a block of their own.
+	 */
+	NIFLIB_API ObjectArena( size_t block_size = 256 * 1024 );
+
+	/*! Releases the arena.  Its blocks are freed now if none of its objects are alive, or else when the last one dies. */
+	NIFLIB_API ~ObjectArena();
+
+	/*!
+	 * Allocates memory from the arena.  The memory is aligned for any type and
+	 * stays allocated until the arena releases its blocks.
+	 * \param[in] size The number of bytes to allocate.
+	 * \return The allocated memory.
+	 */
+	NIFLIB_API void * Allocate( size_t size );
+
+	/*!
+	 * Retrieves the number of objects in the arena that have not been destroyed.
+	 * \return The number of live objects.
+	 */
+	NIFLIB_API unsigned int GetObjectCount() const;
+
+	/*!
+	 * Retrieves the number of bytes allocated from the arena, including those of destroyed objects.
+	 * \return The number of bytes in use.
+	 */
+	NIFLIB_API size_t GetBytesUsed() const;
+
+	/*!
+	 * Retrieves the number of blocks the arena has allocated from the heap.
+	 * \return The number of blocks.
+	 */
+	NIFLIB_API unsigned int GetBlockCount() const;
+
+	/*!
+	 * Retrieves the arena that new objects of the calling thread are placed in.
+	 * \return The current arena, or NULL if objects come from the heap.
+	 */
+	NIFLIB_API static ObjectArena * GetCurrent();
+
+	/*!
+	 * Makes an arena current for the lifetime of the scope, and restores the
+	 * previous arena afterwards.
+	 */
+	class Scope {
+	public:
+		/*!
+		 * Makes an arena current.
+		 * \param[in] arena The arena to place new objects in, or NULL for the heap.
+		 */
+		NIFLIB_API Scope( ObjectArena * arena );
+		/*! Restores the previous arena. */
+		NIFLIB_API ~Scope();
+	private:
+		Scope( const Scope & );
+		Scope & operator=( const Scope & );
+		ObjectArena * previous;
+	};
+
+	/*! NIFLIB_HIDDEN function.  For internal use only.  Allocates memory for a NiObject, from the current arena if there is one. */
+	NIFLIB_HIDDEN static void * AllocateObject( size_t size );
+	/*! NIFLIB_HIDDEN function.  For internal use only.  Frees the memory of a NiObject allocated by AllocateObject. */
+	NIFLIB_HIDDEN static void FreeObject( void * p );
+
+private:
+	ObjectArena( const ObjectArena & );
+	ObjectArena & operator=( const ObjectArena & );
+
+	ArenaBlocks * blocks;
+};
+
+}
+#endif
@@ -0,0 +1,69 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#ifndef _OBJECT_DEDUPLICATOR_H_
+#define _OBJECT_DEDUPLICATOR_H_
+
+#include "niflib.h"
+
+namespace Niflib {
+
+/*! What DeduplicateObjects removed from a tree. */
+struct DeduplicateResult {
+	/*! Objects that were replaced by an equal object. */
+	unsigned int removedObjects;
+	/*! How many bytes smaller the file is when written, not counting the header. */
+	unsigned int bytesSaved;
+
+	/*! Constructor.  Everything starts at zero. */
+	NIFLIB_API DeduplicateResult();
+	/*! Adds the counts of another result to this one. */
+	NIFLIB_API DeduplicateResult & operator+=( const DeduplicateResult & rh );
+};
+
+/*! An object whose content appears in more than one file. */
+struct SharedObject {
+	/*! The type name of the object. */
+	string type;
+	/*! The hash of the content of the object and of the objects it links to. */
+	unsigned long long hash;
+	/*! The size of the object in bytes. */
+	unsigned int size;
+	/*! The files that contain the object, in the order they were given. */
+	vector<string> files;
+};
+
+/*!
+ * Replaces objects that are equal to another object in a tree by that
+ * object, so that it is written once and shared.  Two objects are equal if
+ * they have the same type, the same content when written with info, and link
+ * to the same objects once those are replaced in turn, so repeated
+ * NiTriShapeData, NiSourceTexture, NiMaterialProperty, NiAlphaProperty,
+ * NiSkinData, NiTransformData and the like all collapse into one.  Contents
+ * are compared by a 64 bit FNV-1a hash of their bytes first, leaving the
+ * links out, and then in full.
+ *
+ * The links of the objects that remain are pointed at the shared objects.
+ * Scene graph objects, controllers and skin instances are never shared,
+ * since they hold the state of a single place in the scene.  Call this just
+ * before WriteNifTree, with the same info.
+ * \param[in] root The root of the tree.
+ * \param[in] info The version the tree will be written with, which decides what content is compared.  It must be 3.3.0.13 or later.
+ * \return What was removed.
+ */
+NIFLIB_API DeduplicateResult DeduplicateObjects( NiObject * root, const NifInfo & info );
+
+/*!
+ * Calls DeduplicateObjects for each of a set of files, such as the files of
+ * a directory, and writes back the files that changed with the version they
+ * were read with.  Optionally reports which objects appear in more than one
+ * of the files, which is found by hashing the content of each object together
+ * with the content of the objects it links to.
+ * \param[in] file_names The files to process.
+ * \param[out] shared If not NULL, receives the objects that are in more than one file, ordered by hash.
+ * \return The sum of what was removed from every file.
+ */
+NIFLIB_API DeduplicateResult DeduplicateFiles( const vector<string> & file_names, vector<SharedObject> * shared = NULL );
+
+}
+#endif
@@ -0,0 +1,95 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#ifndef _PACKED_GEOMETRY_H_
+#define _PACKED_GEOMETRY_H_
+
+#include "Ref.h"
+#include "nif_math.h"
+#include "obj/NiGeometryData.h"
+#include "obj/BSPackedAdditionalGeometryData.h"
+#include "obj/NiAdditionalGeometryData.h"
+
+namespace Niflib {
+
+/*!
+ * The formats of the channels of additional geometry data, as stored in
+ * AdditionalDataInfo::dataType.  They follow the shader parameter types of
+ * Gamebryo, which match the Direct3D vertex declaration types.
+ */
+enum AdditionalDataType {
+	ADT_FLOAT1 = 0, /*!< One 32 bit float. */
+	ADT_FLOAT2 = 1, /*!< Two 32 bit floats. */
+	ADT_FLOAT3 = 2, /*!< Three 32 bit floats. */
+	ADT_FLOAT4 = 3, /*!< Four 32 bit floats. */
+	ADT_UBYTECOLOR = 4, /*!< A color of four normalized unsigned bytes, in blue, green, red, alpha order. */
+	ADT_UBYTE4 = 5, /*!< Four unsigned bytes. */
+	ADT_SHORT2 = 6, /*!< Two signed shorts. */
+	ADT_SHORT4 = 7, /*!< Four signed shorts. */
+	ADT_NORMUBYTE4 = 8, /*!< Four unsigned bytes for values from 0 to 1. */
+	ADT_NORMSHORT2 = 9, /*!< Two signed shorts for values from -1 to 1. */
+	ADT_NORMSHORT4 = 10, /*!< Four signed shorts for values from -1 to 1. */
+	ADT_NORMUSHORT2 = 11, /*!< Two unsigned shorts for values from 0 to 1. */
+	ADT_NORMUSHORT4 = 12, /*!< Four unsigned shorts for values from 0 to 1. */
+	ADT_UDEC3 = 13, /*!< Three unsigned 10 bit integers in 32 bits. */
+	ADT_NORMDEC3 = 14, /*!< Three signed 10 bit values from -1 to 1 in 32 bits. */
+	ADT_FLOAT16_2 = 15, /*!< Two 16 bit half floats. */
+	ADT_FLOAT16_4 = 16 /*!< Four 16 bit half floats. */
+};
+
+/*! The values of one channel of additional geometry data. */
+struct AdditionalChannel {
+	/*! How the values are stored. */
+	AdditionalDataType type;
+	/*! One value per vertex.  Components beyond those of the type are ignored, and read back as zero. */
+	vector<Vector4> values;
+};
+
+/*!
+ * Retrieves the number of values and bytes of each vertex in a channel format.
+ * \param[in] type The channel format.
+ * \param[out] components Receives the number of values.
+ * \return The number of bytes, or zero if the format is not known.
+ */
+NIFLIB_API unsigned int GetAdditionalDataTypeSize( AdditionalDataType type, unsigned int & components );
+
+/*!
+ * Packs channels into a BSPackedAdditionalGeometryData, as used by Fallout 3
+ * and New Vegas.  The channels are interleaved in one block, in order.
+ * Values outside of the range of a format are clamped.
+ * \param[in] channels The channels to pack.  They must all have the same number of values.
+ * \param[out] errors If not NULL, receives for each channel the largest difference between a value and its stored value.
+ * \return The new data.
+ */
+NIFLIB_API Ref<BSPackedAdditionalGeometryData> PackAdditionalGeometry( const vector<AdditionalChannel> & channels, vector<float> * errors = NULL );
+
+/*!
+ * Packs channels into a NiAdditionalGeometryData, the same way as PackAdditionalGeometry.
+ * \param[in] channels The channels to pack.  They must all have the same number of values.
+ * \param[out] errors If not NULL, receives for each channel the largest difference between a value and its stored value.
+ * \return The new data.
+ */
+NIFLIB_API Ref<NiAdditionalGeometryData> BuildAdditionalGeometry( const vector<AdditionalChannel> & channels, vector<float> * errors = NULL );
+
+/*!
+ * Decodes the channels of a BSPackedAdditionalGeometryData or NiAdditionalGeometryData.
+ * \param[in] data The data to decode.
+ * \return The channels, in the order of the channel descriptions.
+ */
+NIFLIB_API vector<AdditionalChannel> UnpackAdditionalGeometry( AbstractAdditionalGeometryData * data );
+
+/*!
+ * Packs the vertices, normals, tangents, bitangents and texture coordinates
+ * of geometry data into a BSPackedAdditionalGeometryData and attaches it to
+ * the data.  Vertices use four half floats with a w of one, directions use
+ * normalized bytes mapped from -1..1 to 0..1 for the shader to expand, and
+ * texture coordinates use two half floats each.
+ * \param[in] data The geometry data to pack.
+ * \param[out] errors If not NULL, receives the largest error of each channel, in the order above, leaving out those that the data does not have.  Errors are in the units of the original values, so the error of a direction is that of its -1..1 components.
+ * \param[in] clear_original Whether to remove the packed arrays from the data with NiGeometryData::ClearPackedChannels, so that they are not stored twice.  Otherwise the original arrays are kept.
+ * \return The new data.
+ */
+NIFLIB_API Ref<BSPackedAdditionalGeometryData> PackGeometryData( NiGeometryData * data, vector<float> * errors = NULL, bool clear_original = false );
+
+}
+#endif
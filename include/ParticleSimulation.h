@@ -0,0 +1,129 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#ifndef _PARTICLE_SIMULATION_H_
+#define _PARTICLE_SIMULATION_H_
+
+#include "dll_export.h"
+#include "nif_math.h"
+#include <vector>
+
+namespace Niflib {
+
+using namespace std;
+
+/*!
+ * The particles of a simulated particle system, stored as one array per
+ * property so that the modifiers can run over each property in a tight
+ * loop.  All arrays always have the same size.
+ */
+struct ParticleState {
+	/*! Position, in the space of the particle system. */
+	vector<float> px, py, pz;
+	/*! Velocity, in units per second. */
+	vector<float> vx, vy, vz;
+	/*! The time since the particle was emitted, in seconds. */
+	vector<float> age;
+	/*! The age at which the particle dies, in seconds. */
+	vector<float> lifeSpan;
+	/*! The radius of the particle when its size is one. */
+	vector<float> radius;
+	/*! The size factor of the particle, as set by the grow and fade modifier. */
+	vector<float> size;
+	/*! The rotation angle around the particle's axis, in radians. */
+	vector<float> rotAngle;
+	/*! The rotation speed, in radians per second. */
+	vector<float> rotSpeed;
+	/*! The color of the particle. */
+	vector<float> r, g, b, a;
+	/*! The generation of the particle.  Emitted particles are generation zero. */
+	vector<unsigned short> generation;
+
+	/*!
+	 * Retrieves the number of live particles.
+	 * \return The number of particles.
+	 */
+	NIFLIB_API unsigned int Size() const;
+
+	/*!
+	 * Adds particles at the end of the arrays.  They start out at rest at the
+	 * origin, with an age of zero, a size of one and a white color.
+	 * \param[in] count The number of particles to add.
+	 * \return The index of the first new particle.
+	 */
+	NIFLIB_API unsigned int Add( unsigned int count );
+
+	/*!
+	 * Removes a particle by moving the last particle into its place, so the
+	 * order of the particles is not kept.
+	 * \param[in] index The index of the particle to remove.
+	 */
+	NIFLIB_API void Remove( unsigned int index );
+
+	/*! Removes all particles. */
+	NIFLIB_API void Clear();
+};
+
+/*!
+ * A small, seedable random number generator, so that particle simulations
+ * give the same result on every platform and every run.
+ */
+class ParticleRandom {
+public:
+	/*!
+	 * Creates a generator.
+	 * \param[in] seed The seed.  Equal seeds give equal sequences.
+	 */
+	NIFLIB_API ParticleRandom( unsigned int seed = 1 );
+
+	/*!
+	 * Draws the next random number.
+	 * \return A number in [0, 1).
+	 */
+	NIFLIB_API float Uniform();
+
+	/*!
+	 * Draws the next random number.
+	 * \return A number in [-1, 1).
+	 */
+	NIFLIB_API float Symmetric();
+
+private:
+	unsigned int state;
+};
+
+/*!
+ * The axis aligned box that holds a set of particles, including their
+ * radius, as collected over a simulation.
+ */
+struct ParticleBounds {
+	/*! Constructor.  The bounds start out empty. */
+	NIFLIB_API ParticleBounds();
+	/*! The smallest coordinates. */
+	Vector3 min;
+	/*! The largest coordinates. */
+	Vector3 max;
+	/*! Whether no particle has been added yet. */
+	bool empty;
+
+	/*!
+	 * Grows the bounds to hold every particle of a state.
+	 * \param[in] particles The particles to add.
+	 */
+	NIFLIB_API void Add( const ParticleState & particles );
+
+	/*!
+	 * Retrieves the center of the box.
+	 * \return The center.
+	 */
+	NIFLIB_API Vector3 GetCenter() const;
+
+	/*!
+	 * Retrieves the half size of the box along each axis, as stored by BSBound.
+	 * \return The half extents.
+	 */
+	NIFLIB_API Vector3 GetHalfExtents() const;
+};
+
+}
+#endif
@@ -0,0 +1,162 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#ifndef _POSE_EVALUATOR_H_
+#define _POSE_EVALUATOR_H_
+
+#include "Ref.h"
+#include "nif_math.h"
+#include "nif_basic_types.h"
+#include "gen/QTransform.h"
+#include "obj/NiAVObject.h"
+#include "obj/NiControllerManager.h"
+#include "obj/NiControllerSequence.h"
+#include <vector>
+#include <map>
+
+namespace Niflib {
+
+using namespace std;
+
+class NiKeyframeData;
+
+/*!
+ * Describes one sequence that takes part in a blended pose: which sequence
+ * it is, how far it has played, and how strongly it contributes.
+ */
+struct SequenceState {
+	/*! Constructor */
+	NIFLIB_API SequenceState( unsigned int sequence = 0, float time = 0.0f, float weight = 1.0f ) : sequence(sequence), time(time), weight(weight) {}
+	/*! The index of the sequence in the PoseEvaluator, which is its index in the controller manager. */
+	unsigned int sequence;
+	/*!
+	 * The time in seconds since the sequence started.  It is scaled by the
+	 * frequency of the sequence and wrapped, mirrored or clamped to the
+	 * sequence's start and stop time according to its cycle type.
+	 */
+	float time;
+	/*! The blend weight of the sequence.  It is multiplied by the weight stored in the sequence. */
+	float weight;
+};
+
+/*!
+ * Computes blended skeleton poses from the controller sequences of a
+ * NiControllerManager.  The bones are the objects of the manager's object
+ * palette, or every named object below the manager's target if it has no
+ * palette.  The controlled blocks of all sequences are matched to bones
+ * once, when the evaluator is created, so evaluating a pose only samples
+ * and blends the transform interpolators.
+ *
+ * Each bone blends the sequences that animate it by priority: the highest
+ * priority controlled blocks are used first, and lower priorities only fill
+ * in the weight the higher ones leave below one.  The weights used are then
+ * normalized.  Bones that no active sequence animates keep the local
+ * transform they had when the evaluator was created.
+ *
+ * When Niflib is built with NIFLIB_CXX11, the bones of large poses are
+ * sampled and blended on several threads.
+ */
+class PoseEvaluator {
+public:
+	/*!
+	 * Creates an evaluator for the sequences of a controller manager.
+	 * \param[in] manager The controller manager.  Its sequences, object
+	 * palette and target are read once, so a new evaluator must be made, or
+	 * Update called, after they change.
+	 */
+	NIFLIB_API PoseEvaluator( NiControllerManager * manager );
+
+	/*! Destructor */
+	NIFLIB_API ~PoseEvaluator();
+
+	/*!
+	 * Reads the sequences, bones and rest pose from the controller manager
+	 * again, and matches the controlled blocks to bones.
+	 */
+	NIFLIB_API void Update();
+
+	/*!
+	 * Retrieves the bones that poses are computed for.
+	 * \return The bones, in the order used by the poses.
+	 */
+	NIFLIB_API vector< Ref<NiAVObject> > GetBones() const;
+
+	/*!
+	 * Finds the index of a bone by name.
+	 * \param[in] name The name of the bone.
+	 * \return The index of the bone in the poses, or -1 if there is no bone with this name.
+	 */
+	NIFLIB_API int GetBoneIndex( const string & name ) const;
+
+	/*!
+	 * Finds the index of a sequence by name.
+	 * \param[in] name The name of the sequence.
+	 * \return The index of the sequence for SequenceState, or -1 if there is no sequence with this name.
+	 */
+	NIFLIB_API int GetSequenceIndex( const string & name ) const;
+
+	/*!
+	 * Retrieves the local transforms the bones had when the evaluator was
+	 * created or last updated.
+	 * \return The rest pose, one transform per bone.
+	 */
+	NIFLIB_API vector<QTransform> GetRestPose() const;
+
+	/*!
+	 * Evaluates and blends a set of active sequences into one pose.
+	 * \param[in] active The sequences to blend, with their times and weights.
+	 * \param[out] pose Receives the local transform of each bone.
+	 */
+	NIFLIB_API void EvaluatePose( const vector<SequenceState> & active, vector<QTransform> & pose ) const;
+
+	/*!
+	 * Writes a pose into the local transforms of the bones.
+	 * \param[in] pose The local transform of each bone, as computed by EvaluatePose.
+	 */
+	NIFLIB_API void ApplyPose( const vector<QTransform> & pose ) const;
+
+private:
+	/*! The kinds of animation data a channel can be sampled from. */
+	enum ChannelSource {
+		TRANSFORM_INTERPOLATOR,
+		BSPLINE_INTERPOLATOR,
+		KEYFRAME_DATA
+	};
+
+	/*! One controlled block of a sequence, matched to a bone. */
+	struct Channel {
+		unsigned int bone;
+		int priority;
+		ChannelSource source;
+		/*! The interpolator or keyframe data, which is kept alive by the sequence. */
+		NiObject * object;
+		/*! The keyframe data to sample, if any, so that no reference is taken while evaluating. */
+		NiKeyframeData * data;
+		/*! Which of the translation, rotation and scale tracks have keys. */
+		bool has_keys[3];
+	};
+
+	Ref<NiControllerManager> manager;
+	vector< Ref<NiAVObject> > bones;
+	vector<QTransform> restPose;
+	map<string,unsigned int> boneIndex;
+	vector< Ref<NiControllerSequence> > sequences;
+	/*! The channels of each sequence. */
+	vector< vector<Channel> > channels;
+
+	/*! One channel of an active sequence, to be sampled and blended into a bone. */
+	struct BoneSample;
+
+	/*!
+	 * Samples and blends the bones whose samples start at the given indices.
+	 * \param[in] samples The samples, sorted by bone and decreasing priority.
+	 * \param[in] starts The index of the first sample of each bone, followed by the number of samples.
+	 * \param[in] first The first bone in starts to blend.
+	 * \param[in] end One past the last bone in starts to blend.
+	 * \param[in,out] pose Receives the blended transforms of these bones.
+	 */
+	static void BlendBones( vector<BoneSample> * samples, const vector<unsigned int> * starts, unsigned int first, unsigned int end, vector<QTransform> * pose );
+};
+
+}
+#endif
@@ -5,6 +5,7 @@ All rights reserved.  Please see niflib.h for license. */
 #define _NIFLIB_REF_H_
 
 #include <ostream>
+#include "dll_export.h"
 namespace Niflib {
 
 using namespace std;
@@ -47,6 +48,17 @@ public:
    friend ostream & operator<< <T>(ostream & os, const Ref & ref);
 	Ref & operator=( T * object );
 	Ref & operator=( const Ref & ref );
+
+	/*! Exchanges the objects of two references without changing their reference counts. */
+	void swap( Ref & ref );
+
+#ifdef NIFLIB_CXX11
+	/*! Takes the object of another reference without changing its reference count, leaving the other reference NULL. */
+	Ref( Ref && ref_to_move );
+	/*! Takes the object of another reference without changing its reference count, leaving the other reference NULL. */
+	Ref & operator=( Ref && ref_to_move );
+#endif
+
 	operator T*() const;
 	T* operator->() const;
 
@@ -147,6 +159,40 @@ Ref<T> & Ref<T>::operator=( const Ref & ref ) {
 	return *this;
 }
 
+template <class T>
+void Ref<T>::swap( Ref & ref ) {
+	T * object = _object;
+	_object = ref._object;
+	ref._object = object;
+}
+
+/*! Exchanges the objects of two references without changing their reference counts. */
+template <class T>
+void swap( Ref<T> & lh, Ref<T> & rh ) {
+	lh.swap( rh );
+}
+
+#ifdef NIFLIB_CXX11
+template <class T>
+Ref<T>::Ref( Ref && ref_to_move ) : _object(ref_to_move._object) {
+	ref_to_move._object = NULL;
+}
+
+template <class T>
+Ref<T> & Ref<T>::operator=( Ref && ref_to_move ) {
+	if ( this != &ref_to_move ) {
+		//Release the previous object only after taking the new one, in case releasing it destroys the other reference
+		T * previous = _object;
+		_object = ref_to_move._object;
+		ref_to_move._object = NULL;
+		if ( previous != NULL ) {
+			previous->SubtractRef();
+		}
+	}
+	return *this;
+}
+#endif
+
 //Template functions must be in the header file
 
 template <class T>
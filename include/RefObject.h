@@ -15,6 +15,9 @@ All rights reserved.  Please see niflib.h for license. */
 #include <list>
 #include <map>
 #include <vector>
+#ifdef NIFLIB_CXX11
+#include <atomic>
+#endif
 
 namespace Niflib {
 
@@ -105,9 +108,23 @@ public:
 	 */
 	NIFLIB_API unsigned int GetNumRefs();
 
+	/*!
+	 * Allocates the memory of a new object, from the current ObjectArena if there is one.
+	 * \sa ObjectArena
+	 */
+	NIFLIB_API static void * operator new( size_t size );
+
+	/*! Frees the memory of an object.  Memory from an ObjectArena is released with the arena. */
+	NIFLIB_API static void operator delete( void * p );
+
 private:
 	mutable unsigned int _ref_count;
+	//Objects may be created on several threads, such as by Kfm::MergeActions
+#ifdef NIFLIB_CXX11
+	static std::atomic<unsigned int> objectsInMemory;
+#else
 	static unsigned int objectsInMemory;
+#endif
 
 public:
 	/*! NIFLIB_HIDDEN function.  For internal use only. */
@@ -0,0 +1,76 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#ifndef _SCENE_BOUNDS_H_
+#define _SCENE_BOUNDS_H_
+
+#include "dll_export.h"
+#include "nif_math.h"
+#include "gen/SphereBV.h"
+#include <vector>
+
+namespace Niflib {
+
+using namespace std;
+
+class NiAVObject;
+
+/*! The kinds of bounds that UpdateSceneBounds recomputes. */
+enum SceneBoundsFlags {
+	BOUNDS_GEOMETRY = 1, /*!< The bounding sphere of each NiGeometryData. */
+	BOUNDS_SKIN = 2, /*!< The bounding sphere of each bone in a NiSkinData, from the vertices that bone influences. */
+	BOUNDS_BOUNDING_BOX = 4, /*!< The bounding box of NiAVObjects that have one. */
+	BOUNDS_EXTRA_DATA = 8, /*!< BSBound extra data. */
+	BOUNDS_MULTI_BOUND = 16, /*!< The BSMultiBoundAABB or BSMultiBoundOBB of each BSMultiBoundNode. */
+	BOUNDS_ALL = 31 /*!< All of the above. */
+};
+
+/*!
+ * Computes the axis aligned box around a set of points.
+ * \param[in] points The points.
+ * \param[out] lows Receives the smallest coordinates, or zero if there are no points.
+ * \param[out] highs Receives the largest coordinates, or zero if there are no points.
+ */
+NIFLIB_API void CalcBoundingBox( const vector<Vector3> & points, Vector3 & lows, Vector3 & highs );
+
+/*!
+ * Computes a tight bounding sphere around a set of points with Ritter's
+ * algorithm.  The result is never larger than the sphere around the axis
+ * aligned box, which NiGeometryData::SetVertices uses.
+ * \param[in] points The points.
+ * \return The sphere.  It has zero radius if there are no points.
+ */
+NIFLIB_API SphereBV CalcBoundingSphere( const vector<Vector3> & points );
+
+/*!
+ * Computes an oriented box around a set of points, along the principal axes
+ * of the points.  If the axis aligned box has less volume, that is returned
+ * instead.
+ * \param[in] points The points.
+ * \param[out] center Receives the center of the box.
+ * \param[out] half_size Receives the half size of the box along each of its axes.
+ * \param[out] axes Receives the axes of the box, one per row.
+ */
+NIFLIB_API void CalcOrientedBox( const vector<Vector3> & points, Vector3 & center, Vector3 & half_size, Matrix33 & axes );
+
+/*!
+ * Recomputes the bounds stored in a scene from its geometry.  Geometry
+ * data shared by several shapes is only bounded once.  Skinned geometry is
+ * bounded in its bind pose.
+ *
+ * - NiGeometryData gets the sphere of CalcBoundingSphere.
+ * - Each bone of a NiSkinData gets the sphere of the vertices it
+ *   influences, offset by the bone transform like NiGeometry::SetBoneWeights.
+ * - The bounding box of a NiAVObject and BSBound extra data get the axis
+ *   aligned box of everything below the object, in its local coordinates.
+ * - The BSMultiBoundAABB or BSMultiBoundOBB of a BSMultiBoundNode gets the
+ *   box of everything below the node, in the local coordinates of root.
+ *
+ * \param[in] root The root of the scene.
+ * \param[in] flags Which bounds to recompute, as a combination of SceneBoundsFlags.
+ * \return The number of bounds that were recomputed.
+ */
+NIFLIB_API unsigned int UpdateSceneBounds( NiAVObject * root, unsigned int flags = BOUNDS_ALL );
+
+}
+#endif
@@ -0,0 +1,160 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#ifndef _STRING_INTERNER_H_
+#define _STRING_INTERNER_H_
+
+#include "dll_export.h"
+#include <string>
+#include <vector>
+#include <deque>
+
+namespace Niflib {
+
+using namespace std;
+
+class StringInterner;
+
+/*!
+ * A handle to a string stored once in a StringInterner.  Two handles from the
+ * same interner are equal exactly when their strings are equal, so they
+ * compare and hash in constant time, without looking at the characters.
+ * Handles from different interners must not be compared.  A default
+ * constructed handle is the empty string.
+ */
+class InternedString {
+public:
+	/*! Creates a handle to the empty string. */
+	NIFLIB_API InternedString();
+
+	/*!
+	 * Retrieves the string.
+	 * \return The interned string, which stays valid as long as its interner exists.
+	 */
+	NIFLIB_API const string & str() const;
+
+	/*!
+	 * Retrieves the characters of the string.
+	 * \return The null-terminated characters.
+	 */
+	NIFLIB_API const char * c_str() const;
+
+	/*!
+	 * Checks whether the string is empty.
+	 * \return True if the string is empty.
+	 */
+	NIFLIB_API bool empty() const;
+
+	/*!
+	 * Retrieves the index of the string in its interner.  The indices of an
+	 * interner count up from zero in the order its strings were added, so they
+	 * can index plain vectors of data about each string.
+	 * \return The index, or 0xFFFFFFFF for the empty string.
+	 */
+	NIFLIB_API unsigned int GetIndex() const;
+
+	/*!
+	 * Retrieves a hash of the handle.
+	 * \return The hash.
+	 */
+	NIFLIB_API unsigned int Hash() const;
+
+	NIFLIB_API operator const string &() const;
+
+	NIFLIB_API bool operator==( const InternedString & rh ) const;
+	NIFLIB_API bool operator!=( const InternedString & rh ) const;
+
+	/*!
+	 * Orders handles by their index, not alphabetically, so that handles can be
+	 * used as keys of a map.
+	 */
+	NIFLIB_API bool operator<( const InternedString & rh ) const;
+
+private:
+	friend class StringInterner;
+	InternedString( const string * value, unsigned int index );
+	const string * value;
+	unsigned int index;
+};
+
+/*!
+ * Stores each distinct string once, such as the node names of a scene, and
+ * hands out InternedString handles to them.  The strings are kept in blocks
+ * that never move, and are found through an open addressing hash table, so
+ * adding or finding a string costs one hash and usually one string compare.
+ *
+ * Strings are only freed when the interner is destroyed.  When Niflib is
+ * built with NIFLIB_CXX11, each call locks the interner, so one interner can
+ * be shared by several threads.  Otherwise an interner is not synchronized,
+ * so use one interner per document or per thread.
+ */
+class StringInterner {
+public:
+	/*! Creates an empty interner. */
+	NIFLIB_API StringInterner();
+
+	/*! Destroys the interner and its strings. */
+	NIFLIB_API ~StringInterner();
+
+	/*!
+	 * Adds a string, if it is not there already.
+	 * \param[in] value The string to add.
+	 * \return The handle of the string.  The empty string always gives the default handle.
+	 */
+	NIFLIB_API InternedString Intern( const string & value );
+
+	/*!
+	 * Adds many strings at once, such as the string table of a NIF header.
+	 * \param[in] values The strings to add.
+	 * \return The handle of each string, in the same order.
+	 */
+	NIFLIB_API vector<InternedString> Intern( const vector<string> & values );
+
+	/*!
+	 * Looks up a string without adding it.
+	 * \param[in] value The string to find.
+	 * \param[out] result Receives the handle of the string, if it is found.
+	 * \return True if the string was found, or is empty.
+	 */
+	NIFLIB_API bool Find( const string & value, InternedString & result ) const;
+
+	/*!
+	 * Retrieves a string by its index.
+	 * \param[in] index The index of the string, as returned by InternedString::GetIndex.
+	 * \return The handle of the string.
+	 */
+	NIFLIB_API InternedString GetString( unsigned int index ) const;
+
+	/*!
+	 * Retrieves the number of distinct non-empty strings in the interner.
+	 * \return The number of strings.
+	 */
+	NIFLIB_API unsigned int Size() const;
+
+	/*! Removes every string, which invalidates every handle from this interner. */
+	NIFLIB_API void Clear();
+
+private:
+	//Copying would leave the handles pointing into the original
+	StringInterner( const StringInterner & );
+	StringInterner & operator=( const StringInterner & );
+
+	unsigned int FindSlot( const string & value, unsigned int hash ) const;
+	void Grow();
+	InternedString InternUnlocked( const string & value );
+
+	/*! The mutex of the interner, which is empty without NIFLIB_CXX11.  It is kept behind a pointer so the class has the same layout either way. */
+	struct Lock;
+	class LockGuard;
+	Lock * lock;
+
+	/*! The strings, in the order they were added.  A deque never moves its elements. */
+	deque<string> strings;
+	/*! The hash of each string. */
+	vector<unsigned int> hashes;
+	/*! The open addressing table, holding one more than the index of a string, or zero if free. */
+	vector<unsigned int> slots;
+};
+
+}
+#endif
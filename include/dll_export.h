@@ -12,6 +12,16 @@ All rights reserved.  Please see niflib.h for license. */
 #endif
 
 
+// Niflib is written in C++98, since the Visual Studio 2005 and 2008 projects
+// build it with compilers that predate C++11.  Code that uses C++11 facilities,
+// such as move constructors, hash containers or threads, checks NIFLIB_CXX11
+// and keeps a C++98 version for those compilers.
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1700)
+#  ifndef NIFLIB_CXX11
+#    define NIFLIB_CXX11
+#  endif
+#endif
+
 #ifndef NIFLIB_STATIC_LINK
 	// Building shared library
 	#if defined(_WIN32) || defined(__WIN32__) || defined(_MSC_VER)
@@ -114,6 +114,17 @@ struct Header {
 	 */
 	NIFLIB_API vector<unsigned short> getBlockTypeIndex(); 
 
+	/*! Adds a string to the string table, unless it is there already.
+	 * \param[in] value The string to add.
+	 * \return The index of the string in the string table.
+	 */
+	NIFLIB_HIDDEN unsigned int AddString( const string & value );
+
+private:
+	/*! The index of each string of the string table, filled in by AddString. */
+	map<string, unsigned int> stringIndex;
+public:
+
 	//--END CUSTOM CODE--//
 };
 
@@ -70,7 +70,10 @@ struct Kfm {
 	NIFLIB_API unsigned int Read( const string & file_name ); // returns Kfm version
 	NIFLIB_API unsigned int Read( istream & in ); // returns Kfm version
 
-	// Reads the NIF file and all KF files referred to in this KFM, and returns the root object of the resulting NIF tree.
+	// Reads the NIF file and all KF files referred to in this KFM, relative to path, and returns the root object of the resulting NIF tree.
+	// The controller sequences of the KF files are added to the NiControllerManager of the root, which is created if needed,
+	// and share its NiDefaultAVObjectPalette.  Missing KF files are skipped.  When Niflib is built with NIFLIB_CXX11,
+	// the KF files are read on several threads, unless the calling thread has a current ObjectArena.
 	NIFLIB_API Ref<NiObject> MergeActions( const string & path );
 	//void Write( string const & file_name, unsigned int version );
 	//void Write( ostream & out, unsigned int version );
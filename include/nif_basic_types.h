@@ -51,17 +51,22 @@ typedef unsigned char	byte;
 
 //--Structures--//
 
+class StringInterner;
+class ObjectArena;
+
 /*! 
  * Used to specify optional ways the NIF file is to be written or retrieve information about
  * the way an existing file was stored. 
  */
 struct NifInfo {
-	NifInfo() : version(VER_4_0_0_2), userVersion(0), userVersion2(0), endian(ENDIAN_LITTLE) {}
+	NifInfo() : version(VER_4_0_0_2), userVersion(0), userVersion2(0), endian(ENDIAN_LITTLE), strings(NULL), arena(NULL) {}
 	NifInfo( unsigned version, unsigned userVersion = 0, unsigned userVersion2 = 0) {
 		this->version = version;
 		this->userVersion = userVersion;
 		this->userVersion2 = userVersion2;
 		endian = ENDIAN_LITTLE;
+		strings = NULL;
+		arena = NULL;
 	}
 	unsigned version;
 	unsigned userVersion;
@@ -74,6 +79,10 @@ struct NifInfo {
 	string exportInfo1;
 	/*! This is only supported in Oblivion.  It seems to contain the more specific script or options of the above. */
 	string exportInfo2;
+	/*! If set, the strings of the header string table are added to this interner as the file is read, for files that have one (20.1.0.3 and later).  It is not owned by the NifInfo. */
+	StringInterner * strings;
+	/*! If set, the objects of the file are allocated from this arena as the file is read.  It is not owned by the NifInfo. */
+	ObjectArena * arena;
 };
 
 /*! Used to enable static arrays to be members of vectors */
@@ -1196,6 +1196,35 @@ struct Quaternion {
 	* \return The inverse of this quaternion.
 	*/
 	NIFLIB_API Quaternion Inverse() const;
+
+	/*! Multiplies this quaternion by another one.  The product rotates by the right hand quaternion first, then by this one.
+	* \param[in] rhs The quaternion to multiply by.
+	* \return The product of the two quaternions.
+	*/
+	NIFLIB_API Quaternion operator*( const Quaternion & rhs ) const;
+
+	/*! Calculates a copy of this quaternion scaled to unit length.
+	* \return The normalized quaternion, or the identity rotation if this quaternion has no length.
+	*/
+	NIFLIB_API Quaternion Normalized() const;
+
+	/*! Calculates the natural logarithm of this unit quaternion.
+	* \return A quaternion with a zero W component and half the rotation angle times the rotation axis in X, Y, and Z.
+	*/
+	NIFLIB_API Quaternion Log() const;
+
+	/*! Calculates the exponential of this quaternion, which must have a zero W component.  This is the inverse of Log.
+	* \return The unit quaternion whose logarithm is this quaternion.
+	*/
+	NIFLIB_API Quaternion Exp() const;
+
+	/*! Spherically interpolates between two rotations along the shortest arc.
+	* \param[in] t The interpolation factor, 0 giving p and 1 giving q.
+	* \param[in] p The rotation to start from.
+	* \param[in] q The rotation to end at.
+	* \return The interpolated rotation.
+	*/
+	NIFLIB_API static Quaternion Slerp( float t, const Quaternion & p, const Quaternion & q );
 };
 
 
@@ -1381,6 +1410,19 @@ struct InertiaMatrix {
 	NIFLIB_API float Adjoint( int skip_r, int skip_c ) const;
 };
 
+/*!
+ * Converts a 16 bit half precision float, as stored in newer mesh data, to a float.
+ * \param[in] h The bits of the half float.
+ * \return The float value.  Infinities and NaNs are kept.
+ */
+NIFLIB_API float HalfToFloat( unsigned short h );
+
+/*!
+ * Converts a float to a 16 bit half precision float, rounding to the nearest value.
+ * \param[in] f The float value.
+ * \return The bits of the half float.  Values too large for a half become infinity.
+ */
+NIFLIB_API unsigned short FloatToHalf( float f );
 
 //--ostream functions for printing with cout--//
 
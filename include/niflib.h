@@ -233,9 +233,26 @@ NIFLIB_API Ref<NiObject> CloneNifTree( NiObject * root, unsigned version = 0xFFF
  * \param[in] right The root object of the second Nif tree to merge.
  * \param[in] version The version of the nif format to use during the clone operation on the right-hand tree.  The default is the highest version availiable.
  * \param[in] user_version The user version to use during the clone operation.
+ * \param[in] reduce Whether to remove keys that are not needed to reproduce the animation within the tolerances from the merged controllers and interpolators.  Tracks of transform interpolators that do not change are moved into their pose.
+ * \param[in] translate_tolerance The largest translation error allowed by the key reduction, as a distance.  Also used for NiPosData keys.
+ * \param[in] rotate_tolerance The largest rotation error allowed by the key reduction, as an angle in radians.
+ * \param[in] scale_tolerance The largest scale error allowed by the key reduction.  Also used for NiFloatData keys.
  */
 //NIFLIB_API void MergeNifTrees( NiNodeRef target, NiAVObjectRef right, unsigned int version = 0xFFFFFFFF );
-NIFLIB_API void MergeNifTrees( NiNode * target, NiControllerSequence * right, unsigned version = 0xFFFFFFFF, unsigned user_version = 0  );
+NIFLIB_API void MergeNifTrees( NiNode * target, NiControllerSequence * right, unsigned version = 0xFFFFFFFF, unsigned user_version = 0, bool reduce = false, float translate_tolerance = 0.001f, float rotate_tolerance = 0.001f, float scale_tolerance = 0.001f );
+
+/*!
+ * Merges many KF sequences into one Nif tree, with the same result as merging them one after another.  The node names of the target are mapped once for all sequences, the controllers of each node are looked up only once, and the controllers and interpolators are cloned object by object instead of through a whole written NIF file.  Each clone still writes the object to a stream and reads it back, as NiObject::Clone does.  Objects shared between sequences stay shared in the merged tree, and key data objects with the same content are merged into one.
+ * \param[in,out] target The root object of the Nif tree to merge into.
+ * \param[in] sequences The KF sequences to merge, in order.
+ * \param[in] version The version of the nif format that determines which data is cloned.  The default is the highest version availiable.
+ * \param[in] user_version The user version to use during the clone operation.
+ * \param[in] reduce Whether to remove keys that are not needed to reproduce the animation within the tolerances.  See the single sequence version.
+ * \param[in] translate_tolerance The largest translation error allowed by the key reduction, as a distance.
+ * \param[in] rotate_tolerance The largest rotation error allowed by the key reduction, as an angle in radians.
+ * \param[in] scale_tolerance The largest scale error allowed by the key reduction.
+ */
+NIFLIB_API void MergeNifTrees( NiNode * target, const vector< Ref<NiControllerSequence> > & sequences, unsigned version = 0xFFFFFFFF, unsigned user_version = 0, bool reduce = false, float translate_tolerance = 0.001f, float rotate_tolerance = 0.001f, float scale_tolerance = 0.001f );
 
 /*! 
  * Traverses a tree of NIF objects, attempting to move each skeleton root
@@ -246,6 +263,23 @@ NIFLIB_API void MergeNifTrees( NiNode * target, NiControllerSequence * right, un
  */
 NIFLIB_API void SendNifTreeToBindPos( NiNode * root );
 
+/*!
+ * Samples many animation data objects at many times into one buffer, laid out as
+ * one contiguous array per channel.  Key lookups are reused from one time to the
+ * next, so sampling is fastest when the times are in increasing order.
+ * \param[in] tracks The animation data to sample.  Each can be an NiKeyframeData
+ * (or NiTransformData) with 8 channels: translation x, y, z, rotation w, x, y, z,
+ * and scale; an NiBSplineTransformInterpolator or NiBSplineCompTransformInterpolator
+ * with the same 8 channels; an NiFloatData with 1 channel; an NiPosData with 3 channels; an
+ * NiBoolData with 1 channel that is 0 or 1; or an NiMorphData with one weight
+ * channel per morph target.
+ * \param[in] times The times to sample all tracks at.
+ * \param[out] first_channels Receives the index of the first channel of each track.
+ * \param[out] samples Receives the samples.  Sample m of channel c is stored at
+ * samples[c * times.size() + m].
+ */
+NIFLIB_API void SampleKeyTracks( const vector< Ref<NiObject> > & tracks, const vector<float> & times, vector<unsigned int> & first_channels, vector<float> & samples );
+
 /*!
  * Returns the common ancestor of several NiAVObjects, or NULL if there is no common
  * ancestor.  None of the objects given can be the common ansestor, the search starts
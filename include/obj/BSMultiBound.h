@@ -60,6 +60,18 @@ public:
 
 	//--BEGIN MISC CUSTOM CODE--//
 
+	/*!
+	 * Retrieves the bounding volume.
+	 * \return The bounding volume, such as a BSMultiBoundAABB or BSMultiBoundOBB.
+	 */
+	NIFLIB_API Ref<BSMultiBoundData> GetData() const;
+
+	/*!
+	 * Sets the bounding volume.
+	 * \param[in] value The new bounding volume.
+	 */
+	NIFLIB_API void SetData( BSMultiBoundData * value );
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Unknown. */
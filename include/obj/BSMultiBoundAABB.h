@@ -55,6 +55,30 @@ public:
 
 	//--BEGIN MISC CUSTOM CODE--//
 
+	/*!
+	 * Retrieves the center of the box.
+	 * \return The center.
+	 */
+	NIFLIB_API Vector3 GetPosition() const;
+
+	/*!
+	 * Sets the center of the box.
+	 * \param[in] value The new center.
+	 */
+	NIFLIB_API void SetPosition( const Vector3 & value );
+
+	/*!
+	 * Retrieves the half size of the box along each axis.
+	 * \return The extent.
+	 */
+	NIFLIB_API Vector3 GetExtent() const;
+
+	/*!
+	 * Sets the half size of the box along each axis.
+	 * \param[in] value The new extent.
+	 */
+	NIFLIB_API void SetExtent( const Vector3 & value );
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Position of the AABB's center */
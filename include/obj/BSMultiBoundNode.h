@@ -60,6 +60,18 @@ public:
 
 	//--BEGIN MISC CUSTOM CODE--//
 
+	/*!
+	 * Retrieves the multi bound of this node.
+	 * \return The multi bound.
+	 */
+	NIFLIB_API Ref<BSMultiBound> GetMultiBound() const;
+
+	/*!
+	 * Sets the multi bound of this node.
+	 * \param[in] value The new multi bound.
+	 */
+	NIFLIB_API void SetMultiBound( BSMultiBound * value );
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Unknown. */
@@ -55,6 +55,42 @@ public:
 
 	//--BEGIN MISC CUSTOM CODE--//
 
+	/*!
+	 * Retrieves the center of the box.
+	 * \return The center.
+	 */
+	NIFLIB_API Vector3 GetCenter() const;
+
+	/*!
+	 * Sets the center of the box.
+	 * \param[in] value The new center.
+	 */
+	NIFLIB_API void SetCenter( const Vector3 & value );
+
+	/*!
+	 * Retrieves the half size of the box along each of its axes.
+	 * \return The size.
+	 */
+	NIFLIB_API Vector3 GetSize() const;
+
+	/*!
+	 * Sets the half size of the box along each of its axes.
+	 * \param[in] value The new size.
+	 */
+	NIFLIB_API void SetSize( const Vector3 & value );
+
+	/*!
+	 * Retrieves the rotation of the box.  Its rows are the axes of the box.
+	 * \return The rotation.
+	 */
+	NIFLIB_API Matrix33 GetRotation() const;
+
+	/*!
+	 * Sets the rotation of the box.  Its rows are the axes of the box.
+	 * \param[in] value The new rotation.
+	 */
+	NIFLIB_API void SetRotation( const Matrix33 & value );
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Center of the box. */
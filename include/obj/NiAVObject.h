@@ -134,9 +134,9 @@ public:
 
 	/*!
 	 * Retrieves a list of all properties that affect this object.  Properties specify various charactaristics of the object that affect rendering.  They may be shared among objects.
-	 * \return All the properties that affect this object.
+	 * \return All the properties that affect this object.  The reference is valid until the properties are changed.
 	 */
-	NIFLIB_API vector< Ref<NiProperty> > GetProperties() const;
+	NIFLIB_API const vector< Ref<NiProperty> > & GetProperties() const;
 
 	/*!
 	 * Retrieves the property that matches the specified type, if there is one.  A valid object should not have more than one property of the same type.  Properties specify various charactaristics of the object that affect rendering.  They may be shared among objects.
@@ -59,6 +59,42 @@ public:
 
 	//--BEGIN MISC CUSTOM CODE--//
 
+	/*!
+	 * Retrieves the number of vertices that the data has values for.
+	 * \return The number of vertices.
+	 */
+	NIFLIB_API unsigned short GetVertexCount() const;
+
+	/*!
+	 * Sets the number of vertices that the data has values for.
+	 * \param[in] value The new number of vertices.
+	 */
+	NIFLIB_API void SetVertexCount( unsigned short value );
+
+	/*!
+	 * Retrieves the descriptions of the channels, which say where the values of each channel are stored and in what format.
+	 * \return The channel descriptions.
+	 */
+	NIFLIB_API const vector<AdditionalDataInfo> & GetBlockInfos() const;
+
+	/*!
+	 * Sets the descriptions of the channels.
+	 * \param[in] value The new channel descriptions.
+	 */
+	NIFLIB_API void SetBlockInfos( const vector<AdditionalDataInfo> & value );
+
+	/*!
+	 * Retrieves the blocks that hold the values of the channels.
+	 * \return The data blocks.
+	 */
+	NIFLIB_API const vector<AdditionalDataBlock> & GetBlocks() const;
+
+	/*!
+	 * Sets the blocks that hold the values of the channels.
+	 * \param[in] value The new data blocks.
+	 */
+	NIFLIB_API void SetBlocks( const vector<AdditionalDataBlock> & value );
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Number of vertices */
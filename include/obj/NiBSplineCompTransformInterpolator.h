@@ -11,6 +11,9 @@ All rights reserved.  Please see niflib.h for license. */
 #define _NIBSPLINECOMPTRANSFORMINTERPOLATOR_H_
 
 //--BEGIN FILE HEAD CUSTOM CODE--//
+namespace Niflib {
+	class NiTransformInterpolator;
+}
 //--END CUSTOM CODE--//
 
 #include "NiBSplineTransformInterpolator.h"
@@ -178,6 +181,49 @@ public:
 	 */
 	NIFLIB_API int GetNumControlPoints() const;
 
+	/*!
+	 * Replaces the curves of this interpolator with cubic B-splines fitted to sampled
+	 * transforms.  The curves are fitted by least squares and quantized to short control
+	 * points with a computed bias and multiplier.  The control point count, which all
+	 * curves share, is the smallest one that keeps every sample within the tolerances
+	 * after quantization, up to one control point per sample.  The curves are stored
+	 * one after another and addressed by 16 bit offsets, so a runtime_error is thrown if
+	 * the tolerances need more control points than the offsets can address.  Curves that
+	 * stay within the tolerance of their first sample are stored as the base transform
+	 * instead.
+	 * New spline and basis data objects are created, and the start and stop time are set
+	 * to the first and last sample time.
+	 * \param[in] times The sample times, in increasing order.
+	 * \param[in] translations The translation at each sample time, or an empty vector to keep the current base translation and no translate curve.
+	 * \param[in] rotations The rotation at each sample time, or an empty vector to keep the current base rotation and no rotation curve.
+	 * \param[in] scales The scale at each sample time, or an empty vector to keep the current base scale and no scale curve.
+	 * \param[in] translate_tolerance The largest allowed translation error, as a distance.
+	 * \param[in] rotate_tolerance The largest allowed rotation error, as an angle in radians.
+	 * \param[in] scale_tolerance The largest allowed scale error.
+	 */
+	NIFLIB_API void FitTransforms( const vector<float> & times, const vector<Vector3> & translations, const vector<Quaternion> & rotations, const vector<float> & scales, float translate_tolerance = 0.01f, float rotate_tolerance = 0.002f, float scale_tolerance = 0.001f );
+
+	/*!
+	 * Replaces the curves of this interpolator with cubic B-splines fitted to the keys of
+	 * a transform interpolator, which are sampled at a fixed rate between the first and
+	 * last key.  The base transform of the source interpolator is used for channels that
+	 * have no keys.  See the other overload for the fitting.
+	 * \param[in] interpolator The transform interpolator to compress.
+	 * \param[in] sample_rate The number of samples per second taken from the keys.
+	 * \param[in] translate_tolerance The largest allowed translation error, as a distance.
+	 * \param[in] rotate_tolerance The largest allowed rotation error, as an angle in radians.
+	 * \param[in] scale_tolerance The largest allowed scale error.
+	 */
+	NIFLIB_API void FitTransforms( NiTransformInterpolator * interpolator, float sample_rate = 30.0f, float translate_tolerance = 0.01f, float rotate_tolerance = 0.002f, float scale_tolerance = 0.001f );
+
+protected:
+	// decompresses the short control points with the bias and multiplier of the curve
+	virtual bool readControlPoints( SplineCurve curve, int first, int count, float * out ) const;
+
+private:
+	// fits and quantizes all curves with nctrl control points, and checks the tolerances
+	bool fitCurves( int nctrl, const vector<float> & times, const vector<float> & tvalues, const vector<float> & rvalues, const vector<float> & svalues, float translate_tolerance, float rotate_tolerance, float scale_tolerance );
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Translation Bias */
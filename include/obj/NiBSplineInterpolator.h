@@ -112,6 +112,12 @@ protected:
 	// internal method for bspline calculation in child classes
 	static void bspline(int n, int t, int l, float *control, float *output, int num_output);
 
+	// internal method that computes the basis weights of the open uniform cubic
+	// spline (or lower degree if there are fewer than 4 control points) at a time
+	// between the start and stop time.  Writes min(4, nctrl) weights and returns
+	// the index of the first control point they apply to.
+	int bsplineWeights(float time, int nctrl, float *weights) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Animation start time. */
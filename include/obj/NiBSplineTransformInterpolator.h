@@ -11,6 +11,7 @@ All rights reserved.  Please see niflib.h for license. */
 #define _NIBSPLINETRANSFORMINTERPOLATOR_H_
 
 //--BEGIN FILE HEAD CUSTOM CODE--//
+#include "../Key.h"
 //--END CUSTOM CODE--//
 
 #include "NiBSplineInterpolator.h"
@@ -174,6 +175,46 @@ public:
 	* \return The number of control points used in the spline curve.
 	*/
 	NIFLIB_API virtual int GetNumControlPoints() const;
+
+	/*!
+	* Evaluates the translation curve as an open uniform cubic B-spline.
+	* \param[in] time The time to evaluate at.  It is clamped to the start and stop time.
+	* \return The translation at the given time, or the base translation if there is no translate curve.
+	*/
+	NIFLIB_API Vector3 EvaluateTranslation( float time ) const;
+
+	/*!
+	* Evaluates the rotation curve as an open uniform cubic B-spline.
+	* \param[in] time The time to evaluate at.  It is clamped to the start and stop time.
+	* \return The normalized rotation at the given time, or the base rotation if there is no rotation curve.
+	*/
+	NIFLIB_API Quaternion EvaluateRotation( float time ) const;
+
+	/*!
+	* Evaluates the scale curve as an open uniform cubic B-spline.
+	* \param[in] time The time to evaluate at.  It is clamped to the start and stop time.
+	* \return The scale at the given time, or the base scale if there is no scale curve.
+	*/
+	NIFLIB_API float EvaluateScale( float time ) const;
+
+	/*!
+	* Samples many interpolators at many times.  The control points of each curve are
+	* decompressed only once, and the basis weights of each time are shared by all
+	* interpolators with the same control point count and time range.
+	* \param[in] interpolators The interpolators to sample.
+	* \param[in] times The times to sample all interpolators at.
+	* \param[out] samples Receives 8 channels per interpolator: translation x, y, z,
+	* rotation w, x, y, z, and scale.  Sample m of channel c of interpolator i is stored
+	* at samples[(i * 8 + c) * times.size() + m].
+	*/
+	NIFLIB_API static void SampleTransforms( const vector< Ref<NiBSplineTransformInterpolator> > & interpolators, const vector<float> & times, vector<float> & samples );
+
+protected:
+	enum SplineCurve { TRANSLATE_CURVE, ROTATE_CURVE, SCALE_CURVE };
+
+	// internal method that reads count decompressed control points of a curve,
+	// starting at control point first.  Returns false if the curve is not defined.
+	virtual bool readControlPoints( SplineCurve curve, int first, int count, float * out ) const;
 	//--END CUSTOM CODE--//
 protected:
 	/*! Base translation when translate curve not defined. */
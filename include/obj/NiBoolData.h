@@ -93,6 +93,14 @@ public:
 	 */
 	NIFLIB_API virtual void NormalizeKeys( float phase, float frequency );
 
+	/*! Evaluates the boolean keys at a certain time.  Each key holds its value until the next key, whatever the key type.
+	 * \param time The time to evaluate the keys at.  Times outside the keys are clamped.
+	 * \param hint If not NULL, a key index that is reused between calls to speed up evaluation at increasing times.  Should start out as zero.
+	 * \return The value at the given time, or false if there are no keys.
+	 * \sa FindKeyIndex
+	 */
+	NIFLIB_API bool Evaluate( float time, unsigned int * hint = NULL ) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! The boolean keys. */
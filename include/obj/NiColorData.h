@@ -81,6 +81,14 @@ public:
 	 */
 	NIFLIB_API void SetKeys( vector< Key<Color4> > const & keys );
 
+	/*! Evaluates the color keys at a certain time.
+	 * \param time The time to evaluate the keys at.  Times outside the keys are clamped.
+	 * \param hint If not NULL, a key index that is reused between calls to speed up evaluation at increasing times.  Should start out as zero.
+	 * \return The color at the given time, or white if there are no keys.
+	 * \sa InterpolateKeys
+	 */
+	NIFLIB_API Color4 Evaluate( float time, unsigned int * hint = NULL ) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! The color keys. */
@@ -267,6 +267,15 @@ public:
 	*/
 	NIFLIB_API void SetStringPalette( const Ref<NiStringPalette >& value );
 
+	/*!
+	* Adds the node, property, controller, controller ID and interpolator ID strings of
+	* every controlled block to the string palette of this sequence in one pass, creating
+	* the palette if needed, and updates the offsets of the blocks to match.  Blocks that
+	* used another palette or stored their strings directly are moved to this palette,
+	* and their direct strings are kept so the sequence can be written at any version.
+	*/
+	NIFLIB_API void BuildStringPalette();
+
 protected:
    friend class NiControllerManager;
    NiControllerManager * GetParent() const;
@@ -11,7 +11,7 @@ All rights reserved.  Please see niflib.h for license. */
 #define _NIDATASTREAM_H_
 
 //--BEGIN FILE HEAD CUSTOM CODE--//
-
+#include "../DataStreamView.h"
 //--END CUSTOM CODE--//
 
 #include "NiObject.h"
@@ -58,6 +58,93 @@ public:
 
 	//--BEGIN MISC CUSTOM CODE--//
 
+	/*!
+	 * Retrieves how the stream is used, such as for vertices or indices.
+	 * \return The stream usage.
+	 */
+	NIFLIB_API DataStreamUsage GetUsage() const;
+
+	/*!
+	 * Sets how the stream is used.
+	 * \param[in] value The new stream usage.
+	 */
+	NIFLIB_API void SetUsage( DataStreamUsage value );
+
+	/*!
+	 * Retrieves the CPU and GPU access flags of the stream.
+	 * \return The access flags.
+	 */
+	NIFLIB_API DataStreamAccess GetAccess() const;
+
+	/*!
+	 * Sets the CPU and GPU access flags of the stream.
+	 * \param[in] value The new access flags.
+	 */
+	NIFLIB_API void SetAccess( DataStreamAccess value );
+
+	/*!
+	 * Retrieves the format of each component in an element of the stream.
+	 * \return The component formats.
+	 */
+	NIFLIB_API vector<ComponentFormat> GetComponentFormats() const;
+
+	/*!
+	 * Retrieves the regions of the stream.  Each region is a range of
+	 * elements, and the submeshes of a NiMesh map to regions.
+	 * \return The regions.
+	 */
+	NIFLIB_API vector<Region> GetRegions() const;
+
+	/*!
+	 * Sets the regions of the stream.
+	 * \param[in] value The new regions, as ranges of elements.
+	 */
+	NIFLIB_API void SetRegions( const vector<Region> & value );
+
+	/*!
+	 * Retrieves the size in bytes of one element, which is the sum of the sizes of its components.
+	 * \return The stride of the stream.
+	 */
+	NIFLIB_API unsigned int GetStride() const;
+
+	/*!
+	 * Retrieves the number of elements in the stream, such as the number of vertices.
+	 * \return The number of elements.
+	 */
+	NIFLIB_API unsigned int GetElementCount() const;
+
+	/*!
+	 * Retrieves the position of a component within an element.
+	 * \param[in] component The index of the component.
+	 * \return The offset in bytes from the start of the element.
+	 */
+	NIFLIB_API unsigned int GetComponentOffset( unsigned int component ) const;
+
+	/*!
+	 * Creates a typed view of one component over all elements of the stream,
+	 * without copying the data.  The view is valid until the stream data
+	 * changes.
+	 * \param[in] component The index of the component.
+	 * \return The view.
+	 */
+	NIFLIB_API DataStreamView GetComponentView( unsigned int component ) const;
+
+	/*!
+	 * Creates a typed view of one component over the elements of one region.
+	 * \param[in] component The index of the component.
+	 * \param[in] region The index of the region.
+	 * \return The view.
+	 */
+	NIFLIB_API DataStreamView GetComponentView( unsigned int component, unsigned int region ) const;
+
+	/*!
+	 * Replaces the layout and the data of the stream.  The regions are reset
+	 * to a single region that covers every element.
+	 * \param[in] formats The format of each component in an element.
+	 * \param[in] bytes The elements, one after the other.  The size must be a multiple of the stride.
+	 */
+	NIFLIB_API void SetData( const vector<ComponentFormat> & formats, const vector<byte> & bytes );
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Unknown. */
@@ -93,6 +93,20 @@ public:
 	 */
 	NIFLIB_API virtual void NormalizeKeys( float phase, float frequency );
 
+	/*! Evaluates the float keys at a certain time.
+	 * \param time The time to evaluate the keys at.  Times outside the keys are clamped.
+	 * \param hint If not NULL, a key index that is reused between calls to speed up evaluation at increasing times.  Should start out as zero.
+	 * \return The value at the given time, or zero if there are no keys.
+	 * \sa InterpolateKeys
+	 */
+	NIFLIB_API float Evaluate( float time, unsigned int * hint = NULL ) const;
+
+	/*! Removes keys that are not needed to reproduce the animation within a tolerance.  Keys that do not change are reduced to a single key.
+	 * \param tolerance The largest allowed difference between the original and the reduced values.
+	 * \sa ReduceKeys
+	 */
+	NIFLIB_API void ReduceKeys( float tolerance );
+
 
 	//--END CUSTOM CODE--//
 protected:
@@ -119,39 +119,39 @@ public:
 
 	/*! 
 	 * Used to retrive the vertices used by this mesh.  The size of the vector will be the same as the vertex count retrieved with the IShapeData::GetVertexCount function.
-	 * \return A vector cntaining the vertices used by this mesh.
+	 * \return A vector cntaining the vertices used by this mesh.  The reference is valid until the vertices are changed.
 	 * \sa IShapeData::SetVertices, IShapeData::GetVertexCount, IShapeData::SetVertexCount.
 	 */
-	NIFLIB_API vector<Vector3> GetVertices() const;
+	NIFLIB_API const vector<Vector3> & GetVertices() const;
 
 	/*! 
 	 * Used to retrive the normals used by this mesh.  The size of the vector will either be zero if no normals are used, or be the same as the vertex count retrieved with the IShapeData::GetVertexCount function.
-	 * \return A vector cntaining the normals used by this mesh, if any.
+	 * \return A vector cntaining the normals used by this mesh, if any.  The reference is valid until the normals are changed.
 	 * \sa IShapeData::SetNormals, IShapeData::GetVertexCount, IShapeData::SetVertexCount.
 	 */
-	NIFLIB_API vector<Vector3> GetNormals() const;
+	NIFLIB_API const vector<Vector3> & GetNormals() const;
 
 	/*! 
 	 * Used to retrive the vertex colors used by this mesh.  The size of the vector will either be zero if no vertex colors are used, or be the same as the vertex count retrieved with the IShapeData::GetVertexCount function.
-	 * \return A vector cntaining the vertex colors used by this mesh, if any.
+	 * \return A vector cntaining the vertex colors used by this mesh, if any.  The reference is valid until the vertex colors are changed.
 	 * \sa IShapeData::SetVertexColors, IShapeData::GetVertexCount, IShapeData::SetVertexCount.
 	 */
-	NIFLIB_API vector<Color4> GetColors() const;
+	NIFLIB_API const vector<Color4> & GetColors() const;
 
 	/*! 
 	 * Used to retrive the texture coordinates from one of the texture sets used by this mesh.  The function will throw an exception if a texture set index that does not exist is specified.  The size of the vector will be the same as the vertex count retrieved with the IShapeData::GetVertexCount function.
 	 * \param index The index of the texture coordinate set to retrieve the texture coordinates from.  This index is zero based and must be a positive number smaller than that returned by the IShapeData::GetUVSetCount function.  If there are no texture coordinate sets, this function will throw an exception.
-	 * \return A vector cntaining the the texture coordinates used by the requested texture coordinate set.
+	 * \return A vector cntaining the the texture coordinates used by the requested texture coordinate set.  The reference is valid until the texture coordinate sets are changed.
 	 * \sa IShapeData::SetUVSet, IShapeData::GetUVSetCount, IShapeData::SetUVSetCount, IShapeData::GetVertexCount, IShapeData::SetVertexCount.
 	 */
-	NIFLIB_API vector<TexCoord> GetUVSet( int index ) const;
+	NIFLIB_API const vector<TexCoord> & GetUVSet( int index ) const;
 	
 	/*! 
 	 * Used to retrive the vertex indices used by this mesh.  The size of the vector will be the same as the vertex count retrieved with the IShapeData::GetVertexIndexCount function.
-	 * \return A vector containing the vertex indices used by this mesh.
+	 * \return A vector containing the vertex indices used by this mesh.  The reference is valid until the vertex indices are changed.
 	 * \sa IShapeData::SetVertexIndices, IShapeData::GetVertexIndexCount, IShapeData::SetVertexIndexCount.
 	 */
-	NIFLIB_API vector<int> GetVertexIndices() const;
+	NIFLIB_API const vector<int> & GetVertexIndices() const;
 
 	/*! 
 	 * Used to retrive the the NIF index corresponding to the Max map channel. If there isn't one, -1 is returned.
@@ -191,6 +191,66 @@ public:
 	 */
 	NIFLIB_API void SetUVSet( int index, const vector<TexCoord> & in );
 
+	/*!
+	 * Exchanges the vertices of this mesh with the contents of a vector, without copying them.  Like SetVertices, this clears all other vertex data and updates the bounds.
+	 * \param in The new vertices.  Receives the old vertices.
+	 * \sa IShapeData::SetVertices
+	 */
+	NIFLIB_API void SwapVertices( vector<Vector3> & in );
+
+	/*!
+	 * Exchanges the normals of this mesh with the contents of a vector, without copying them.  The size of the vector must either be zero, or the same as the vertex count.
+	 * \param in The new normals.  Receives the old normals.
+	 * \sa IShapeData::SetNormals
+	 */
+	NIFLIB_API void SwapNormals( vector<Vector3> & in );
+
+	/*!
+	 * Exchanges the vertex colors of this mesh with the contents of a vector, without copying them.  The size of the vector must either be zero, or the same as the vertex count.
+	 * \param in The new vertex colors.  Receives the old vertex colors.
+	 * \sa IShapeData::SetVertexColors
+	 */
+	NIFLIB_API void SwapVertexColors( vector<Color4> & in );
+
+	/*!
+	 * Exchanges one texture coordinate set of this mesh with the contents of a vector, without copying them.  The size of the vector must be the same as the vertex count.
+	 * \param index The index of the texture coordinate set.
+	 * \param in The new texture coordinates.  Receives the old texture coordinates.
+	 * \sa IShapeData::SetUVSet
+	 */
+	NIFLIB_API void SwapUVSet( int index, vector<TexCoord> & in );
+
+#ifdef NIFLIB_CXX11
+	/*!
+	 * Moves new vertices into this mesh.  Like SetVertices, this clears all other vertex data and updates the bounds.
+	 * \param in The new vertices, which are left empty or holding the old vertices.
+	 * \sa IShapeData::SetVertices, IShapeData::SwapVertices
+	 */
+	void SetVertices( vector<Vector3> && in ) { SwapVertices( in ); }
+
+	/*!
+	 * Moves new normals into this mesh.  The size of the vector must either be zero, or the same as the vertex count.
+	 * \param in The new normals, which are left empty or holding the old normals.
+	 * \sa IShapeData::SetNormals, IShapeData::SwapNormals
+	 */
+	void SetNormals( vector<Vector3> && in ) { SwapNormals( in ); }
+
+	/*!
+	 * Moves new vertex colors into this mesh.  The size of the vector must either be zero, or the same as the vertex count.
+	 * \param in The new vertex colors, which are left empty or holding the old vertex colors.
+	 * \sa IShapeData::SetVertexColors, IShapeData::SwapVertexColors
+	 */
+	void SetVertexColors( vector<Color4> && in ) { SwapVertexColors( in ); }
+
+	/*!
+	 * Moves new texture coordinates into one texture coordinate set of this mesh.  The size of the vector must be the same as the vertex count.
+	 * \param index The index of the texture coordinate set.
+	 * \param in The new texture coordinates, which are left empty or holding the old texture coordinates.
+	 * \sa IShapeData::SetUVSet, IShapeData::SwapUVSet
+	 */
+	void SetUVSet( int index, vector<TexCoord> && in ) { SwapUVSet( index, in ); }
+#endif
+
 	/*! 
 	 * Used to set the vertex index data used by this mesh.  Calling this function will clear all other data in this object.
 	 * \param in A vector containing the vertex indices to replace those in the mesh with.  Note that there is no way to set vertices one at a time, they must be sent in one batch.
@@ -255,9 +315,53 @@ public:
    // \param[in] value The new value.
    NIFLIB_API void SetTangents( const vector<Vector3 >& value );
 
+	/*!
+	 * Exchanges the tangents of this mesh with the contents of a vector, without copying them.
+	 * \param[in,out] value The new tangents.  Receives the old tangents.
+	 */
+	NIFLIB_API void SwapTangents( vector<Vector3> & value );
+
+	/*!
+	 * Exchanges the bitangents of this mesh with the contents of a vector, without copying them.
+	 * \param[in,out] value The new bitangents.  Receives the old bitangents.
+	 */
+	NIFLIB_API void SwapBitangents( vector<Vector3> & value );
+
+#ifdef NIFLIB_CXX11
+	/*!
+	 * Moves new tangents into this mesh.
+	 * \param[in] value The new tangents, which are left empty or holding the old tangents.
+	 */
+	void SetTangents( vector<Vector3> && value ) { SwapTangents( value ); }
+
+	/*!
+	 * Moves new bitangents into this mesh.
+	 * \param[in] value The new bitangents, which are left empty or holding the old bitangents.
+	 */
+	void SetBitangents( vector<Vector3> && value ) { SwapBitangents( value ); }
+#endif
+
    NIFLIB_API SkyrimHavokMaterial GetSkyrimMaterial() const;
 
+	/*!
+	 * Retrieves the extra per vertex data, such as BSPackedAdditionalGeometryData, if there is any.
+	 * \return The additional geometry data, or NULL if there is none.
+	 */
+	NIFLIB_API Ref<AbstractAdditionalGeometryData> GetAdditionalData() const;
+
+	/*!
+	 * Sets the extra per vertex data.
+	 * \param[in] value The new additional geometry data, or NULL to remove it.
+	 */
+	NIFLIB_API void SetAdditionalData( AbstractAdditionalGeometryData * value );
+
+	/*!
+	 * Removes the vertices, normals, tangents, bitangents and texture coordinates but keeps the vertex count that is written to the file.  This is for data whose vertices are stored in its additional data instead, as PackGeometryData does.  Vertex colors are kept.
+	 */
+	NIFLIB_API void ClearPackedChannels();
+
 private:
+   unsigned short numVerticesCalc(const NifInfo &) const;
    unsigned short numUvSetsCalc(const NifInfo &) const;
    unsigned short bsNumUvSetsCalc(const NifInfo &) const;
 
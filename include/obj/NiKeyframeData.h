@@ -220,6 +220,40 @@ public:
 	 */
 	NIFLIB_API void SetScaleKeys( vector< Key<float> > const & keys );
 
+	//--Evaluation--//
+
+	/*! Evaluates the rotation keys at a certain time.  Quaternion keys are interpolated with slerp for linear keys and squad for quadratic and TBC keys.  XYZ rotation keys are evaluated per axis and combined in X, Y, Z order.
+	 * \param time The time to evaluate the rotation at.  Times outside the keys are clamped.
+	 * \param hints If not NULL, points to three key indices that are reused between calls to speed up evaluation at increasing times.  Should start out as zero.
+	 * \return The rotation at the given time, or the identity rotation if there are no rotation keys.
+	 * \sa FindKeyIndex
+	 */
+	NIFLIB_API Quaternion EvaluateRotation( float time, unsigned int * hints = NULL ) const;
+
+	/*! Evaluates the translation keys at a certain time.
+	 * \param time The time to evaluate the translation at.  Times outside the keys are clamped.
+	 * \param hint If not NULL, a key index that is reused between calls to speed up evaluation at increasing times.  Should start out as zero.
+	 * \return The translation at the given time, or zero if there are no translation keys.
+	 * \sa InterpolateKeys
+	 */
+	NIFLIB_API Vector3 EvaluateTranslation( float time, unsigned int * hint = NULL ) const;
+
+	/*! Evaluates the scale keys at a certain time.
+	 * \param time The time to evaluate the scale at.  Times outside the keys are clamped.
+	 * \param hint If not NULL, a key index that is reused between calls to speed up evaluation at increasing times.  Should start out as zero.
+	 * \return The scale at the given time, or 1.0 if there are no scale keys.
+	 * \sa InterpolateKeys
+	 */
+	NIFLIB_API float EvaluateScale( float time, unsigned int * hint = NULL ) const;
+
+	/*! Removes keys that are not needed to reproduce the animation within the given tolerances.  Each track keeps its interpolation type, and a track that does not change is reduced to a single key.
+	 * \param translate_tolerance The largest allowed translation error, as a distance.
+	 * \param rotate_tolerance The largest allowed rotation error, as an angle in radians.  For XYZ rotation keys each axis is allowed a third of it.
+	 * \param scale_tolerance The largest allowed scale error.
+	 * \sa ReduceKeys
+	 */
+	NIFLIB_API void ReduceKeys( float translate_tolerance, float rotate_tolerance, float scale_tolerance );
+
 protected:
 	void UpdateRotationKeyCount();
 
@@ -11,7 +11,7 @@ All rights reserved.  Please see niflib.h for license. */
 #define _NIMESH_H_
 
 //--BEGIN FILE HEAD CUSTOM CODE--//
-
+#include "../DataStreamView.h"
 //--END CUSTOM CODE--//
 
 #include "NiRenderObject.h"
@@ -64,6 +64,94 @@ public:
 
 	//--BEGIN MISC CUSTOM CODE--//
 
+	/*!
+	 * Retrieves the primitive type of the mesh, such as triangles or strips.
+	 * \return The primitive type.
+	 */
+	NIFLIB_API MeshPrimitiveType GetPrimitiveType() const;
+
+	/*!
+	 * Sets the primitive type of the mesh.
+	 * \param[in] value The new primitive type.
+	 */
+	NIFLIB_API void SetPrimitiveType( MeshPrimitiveType value );
+
+	/*!
+	 * Retrieves the number of submeshes, which are drawn separately.
+	 * \return The number of submeshes.
+	 */
+	NIFLIB_API unsigned short GetSubmeshCount() const;
+
+	/*!
+	 * Sets the number of submeshes.  Each mesh data entry must map every submesh to a region of its stream.
+	 * \param[in] value The new number of submeshes.
+	 */
+	NIFLIB_API void SetSubmeshCount( unsigned short value );
+
+	/*!
+	 * Retrieves the data streams of the mesh and the semantics of their components.
+	 * \return The mesh data.
+	 */
+	NIFLIB_API vector<MeshData> GetMeshData() const;
+
+	/*!
+	 * Replaces the data streams of the mesh.
+	 * \param[in] value The new mesh data.
+	 */
+	NIFLIB_API void SetMeshData( const vector<MeshData> & value );
+
+	/*!
+	 * Retrieves the combined bounding sphere of all submeshes.
+	 * \return The bounding sphere.
+	 */
+	NIFLIB_API SphereBV GetBound() const;
+
+	/*!
+	 * Sets the combined bounding sphere of all submeshes.
+	 * \param[in] value The new bounding sphere.
+	 */
+	NIFLIB_API void SetBound( const SphereBV & value );
+
+	/*!
+	 * Retrieves the modifiers of the mesh, such as its skinning modifier.
+	 * \return The mesh modifiers.
+	 */
+	NIFLIB_API vector< Ref<NiMeshModifier> > GetModifiers() const;
+
+	/*!
+	 * Adds a modifier to the mesh.
+	 * \param[in] value The modifier to add.
+	 */
+	NIFLIB_API void AddModifier( NiMeshModifier * value );
+
+	/*!
+	 * Determines whether one of the data streams has a component with a certain semantic.
+	 * \param[in] semantic The semantic name, such as "POSITION", "NORMAL", "TEXCOORD", "BLENDINDICES" or "INDEX".
+	 * \param[in] index The semantic index, such as the UV set of a TEXCOORD.
+	 * \return True if the semantic is present.
+	 */
+	NIFLIB_API bool HasSemantic( const string & semantic, unsigned int index = 0 ) const;
+
+	/*!
+	 * Creates a typed view of the component with a certain semantic, over
+	 * every element of its data stream.  The data is not copied, so the view
+	 * is valid until the stream data changes.
+	 * \param[in] semantic The semantic name, such as "POSITION", "NORMAL", "TEXCOORD", "BLENDINDICES" or "INDEX".
+	 * \param[in] index The semantic index, such as the UV set of a TEXCOORD.
+	 * \return The view.
+	 */
+	NIFLIB_API DataStreamView GetSemanticView( const string & semantic, unsigned int index = 0 ) const;
+
+	/*!
+	 * Creates a typed view of the component with a certain semantic, over
+	 * the stream region that belongs to one submesh.
+	 * \param[in] semantic The semantic name.
+	 * \param[in] index The semantic index.
+	 * \param[in] submesh The index of the submesh.
+	 * \return The view.
+	 */
+	NIFLIB_API DataStreamView GetSemanticView( const string & semantic, unsigned int index, unsigned int submesh ) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! The primitive type of the mesh, such as triangles or lines. */
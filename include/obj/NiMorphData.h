@@ -157,6 +157,48 @@ public:
 	*/
 	NIFLIB_API void SetFrameName( int n, string const & key );
 
+	/*!
+	* Evaluates the weight keys of a specified morph target at a certain time.
+	* \param n The index of the morph target to evaluate.
+	* \param time The time to evaluate the keys at.  Times outside the keys are clamped.
+	* \param hint If not NULL, a key index that is reused between calls to speed up evaluation at increasing times.  Should start out as zero.
+	* \return The weight of the morph target at the given time, or zero if it has no keys.
+	*/
+	NIFLIB_API float EvaluateMorphWeight( int n, float time, unsigned int * hint = NULL ) const;
+
+	/*!
+	* Retrieves whether the morph targets after the first store offsets from the first one, which is the base mesh, rather than complete vertex positions.
+	* \return True if the morph targets are relative to the base mesh.  This is true in all official files.
+	*/
+	NIFLIB_API bool GetRelativeTargets() const;
+
+	/*!
+	* Sets whether the morph targets after the first store offsets from the first one, which is the base mesh, rather than complete vertex positions.  Does not affect existing vertex data.
+	* \param value True if the morph targets are relative to the base mesh.
+	*/
+	NIFLIB_API void SetRelativeTargets( bool value );
+
+	/*!
+	* Finds the vertices that at least one morph target moves away from the base mesh.  Morph target 0 is the base mesh.
+	* \param tolerance Offsets whose length is at most this are treated as zero.
+	* \return The sorted indices of the moved vertices.  The other vertices are not changed by any morph.
+	*/
+	NIFLIB_API vector<unsigned int> GetMorphedVertices( float tolerance = 0.0f ) const;
+
+	/*!
+	* Sets the offsets of morph targets that are shorter than a tolerance to exactly zero, so that they are dropped when the morphs are stored sparsely.  Morph target 0 is the base mesh and is left alone.
+	* \param tolerance Offsets whose length is at most this are cleared.
+	* \return The number of vertex offsets that were cleared, counted over all morph targets.
+	*/
+	NIFLIB_API unsigned int ClearSmallDeltas( float tolerance );
+
+	/*!
+	* Computes the offset of each vertex of a morph target from the base mesh, which is morph target 0.
+	* \param n The index of the morph target.  Morph target 0 has no offsets.
+	* \return The offset of each vertex.
+	*/
+	NIFLIB_API vector<Vector3> GetMorphDeltas( int n ) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Number of morphing object. */
@@ -76,6 +76,14 @@ public:
 	 */
 	NIFLIB_API void RemoveChild( Ref<NiAVObject> obj );
 
+	/*!
+	 * Replaces an AV Object child of this node with another, at the same position in the child list.  Unlike AddChild, this does not move geometry to the front of the list.
+	 * The caller is responsible that the old child is no longer weakly linked elsewhere, for instance, as a skin influence.
+	 * \param[in] old_child The child to replace.  It must be a child of this node.
+	 * \param[in] new_child The AV Object to put in its place.  It must not be the child of another node.
+	 */
+	NIFLIB_API void ReplaceChild( Ref<NiAVObject> old_child, Ref<NiAVObject> new_child );
+
 	/*!
 	 * Removes all AV Object children from this node.  These are a sub-leafs in the scene graph contained in a NIF file.  Each AV Object can only be the child of one node.
 	 * The caller is responsible that no child is still weakly linked elsewhere, for instance, as a skin influence.
@@ -84,9 +92,9 @@ public:
 
 	/*!
 	 * Retrieves all AV Object children from this node.  These are a sub-leafs in the scene graph contained in a NIF file.  Each AV Object can only be the child of one node.
-	 * \return A list of all the AV Objects that are children of this node in the scene graph.
+	 * \return A list of all the AV Objects that are children of this node in the scene graph.  The reference is valid until the children are changed, so copy it before adding or removing children while going through it.
 	 */
-	NIFLIB_API vector< Ref<NiAVObject> > GetChildren() const;
+	NIFLIB_API const vector< Ref<NiAVObject> > & GetChildren() const;
 
 #ifdef USE_NIFLIB_TEMPLATE_HELPERS
 	template <typename ChildEquivalence>
@@ -58,6 +58,15 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+	/*!
+	 * Removes the particles that have reached the end of their life span.
+	 * \param[in,out] particles The particles to modify.
+	 * \param[in] delta The length of the step, in seconds.
+	 * \param[in,out] random The random number generator of the simulation.
+	 */
+	NIFLIB_API virtual void UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Unknown. */
@@ -53,6 +53,46 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+	/*!
+	 * Retrieves the size of the emitter box along the x axis.
+	 * \return The width.
+	 */
+	NIFLIB_API float GetWidth() const;
+
+	/*!
+	 * Sets the size of the emitter box along the x axis.
+	 * \param[in] value The new width.
+	 */
+	NIFLIB_API void SetWidth( float value );
+
+	/*!
+	 * Retrieves the size of the emitter box along the y axis.
+	 * \return The height.
+	 */
+	NIFLIB_API float GetHeight() const;
+
+	/*!
+	 * Sets the size of the emitter box along the y axis.
+	 * \param[in] value The new height.
+	 */
+	NIFLIB_API void SetHeight( float value );
+
+	/*!
+	 * Retrieves the size of the emitter box along the z axis.
+	 * \return The depth.
+	 */
+	NIFLIB_API float GetDepth() const;
+
+	/*!
+	 * Sets the size of the emitter box along the z axis.
+	 * \param[in] value The new depth.
+	 */
+	NIFLIB_API void SetDepth( float value );
+
+protected:
+	/*! Picks a random position in the emitter volume. */
+	virtual Vector3 emitPosition( ParticleRandom & random ) const;
 	//--END CUSTOM CODE--//
 protected:
 	/*! Defines the Width of the box area. */
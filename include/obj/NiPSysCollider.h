@@ -11,6 +11,7 @@ All rights reserved.  Please see niflib.h for license. */
 #define _NIPSYSCOLLIDER_H_
 
 //--BEGIN FILE HEAD CUSTOM CODE--//
+#include "../ParticleSimulation.h"
 //--END CUSTOM CODE--//
 
 #include "NiObject.h"
@@ -60,6 +61,53 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+	/*!
+	 * Retrieves the fraction of the speed that a particle keeps when it bounces off this collider.
+	 * \return The bounce factor.
+	 */
+	NIFLIB_API float GetBounce() const;
+
+	/*!
+	 * Sets the fraction of the speed that a particle keeps when it bounces off this collider.
+	 * \param[in] value The new bounce factor.
+	 */
+	NIFLIB_API void SetBounce( float value );
+
+	/*!
+	 * Retrieves whether particles that hit this collider die.
+	 * \return True if colliding particles are removed.
+	 */
+	NIFLIB_API bool GetDieOnCollide() const;
+
+	/*!
+	 * Sets whether particles that hit this collider die.
+	 * \param[in] value True to remove colliding particles.
+	 */
+	NIFLIB_API void SetDieOnCollide( bool value );
+
+	/*!
+	 * Retrieves the next collider in the chain of the collider manager.
+	 * \return The next collider, or NULL if this is the last one.
+	 */
+	NIFLIB_API Ref<NiPSysCollider> GetNextCollider() const;
+
+	/*!
+	 * Tests whether a particle crossed this collider during the last step and
+	 * bounces it off if so.  Does nothing unless a collider type is simulated.
+	 * \param[in,out] particles The particles of the simulation.
+	 * \param[in] i The index of the particle to test.
+	 * \param[in] previous The position of the particle at the start of the step.
+	 * \return True if the particle hit the collider and must die.
+	 */
+	NIFLIB_API virtual bool CollideParticle( ParticleState & particles, unsigned int i, const Vector3 & previous ) const;
+
+protected:
+	/*! The position of the collider object, or the origin if there is none. */
+	Vector3 colliderOrigin() const;
+
+	/*! Reflects the velocity of a particle off a plane, keeping the bounce fraction of the speed. */
+	void bounceParticle( ParticleState & particles, unsigned int i, const Vector3 & normal ) const;
 	//--END CUSTOM CODE--//
 protected:
 	/*! Defines amount of bounce the collider object has. */
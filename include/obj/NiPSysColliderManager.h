@@ -61,6 +61,17 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+	/*!
+	 * Tests each particle against the chain of colliders, bouncing it off the
+	 * first one it crosses or removing it if that collider kills particles.
+	 * Must run after the position modifier.
+	 * \param[in,out] particles The particles to modify.
+	 * \param[in] delta The length of the step, in seconds.
+	 * \param[in,out] random The random number generator of the simulation.
+	 */
+	NIFLIB_API virtual void UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Link to a NiPSysPlanarCollider or NiPSysSphericalCollider. */
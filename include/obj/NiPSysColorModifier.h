@@ -61,6 +61,16 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+	/*!
+	 * Sets the color of the particles from the color keys, which run from the
+	 * birth of a particle at time zero to its death at time one.
+	 * \param[in,out] particles The particles to modify.
+	 * \param[in] delta The length of the step, in seconds.
+	 * \param[in,out] random The random number generator of the simulation.
+	 */
+	NIFLIB_API virtual void UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Refers to NiColorData object. */
@@ -53,6 +53,10 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+protected:
+	/*! Picks a random position in the emitter volume. */
+	virtual Vector3 emitPosition( ParticleRandom & random ) const;
 	//--END CUSTOM CODE--//
 protected:
 	/*! Radius of the cylinder shape. */
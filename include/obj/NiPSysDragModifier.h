@@ -55,6 +55,15 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+	/*!
+	 * Slows the particles down by the drag percentage per second.
+	 * \param[in,out] particles The particles to modify.
+	 * \param[in] delta The length of the step, in seconds.
+	 * \param[in,out] random The random number generator of the simulation.
+	 */
+	NIFLIB_API virtual void UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Parent reference. */
@@ -53,6 +53,80 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+	/*!
+	 * Retrieves the average speed of the emitted particles.
+	 * \return The speed, in units per second.
+	 */
+	NIFLIB_API float GetSpeed() const;
+
+	/*!
+	 * Sets the average speed of the emitted particles.
+	 * \param[in] value The new speed, in units per second.
+	 */
+	NIFLIB_API void SetSpeed( float value );
+
+	/*!
+	 * Retrieves the average life span of the emitted particles.
+	 * \return The life span, in seconds.
+	 */
+	NIFLIB_API float GetLifeSpan() const;
+
+	/*!
+	 * Sets the average life span of the emitted particles.
+	 * \param[in] value The new life span, in seconds.
+	 */
+	NIFLIB_API void SetLifeSpan( float value );
+
+	/*!
+	 * Retrieves the average radius of the emitted particles.
+	 * \return The radius.
+	 */
+	NIFLIB_API float GetInitialRadius() const;
+
+	/*!
+	 * Sets the average radius of the emitted particles.
+	 * \param[in] value The new radius.
+	 */
+	NIFLIB_API void SetInitialRadius( float value );
+
+	/*!
+	 * Retrieves the angle between the emitter z axis and the direction of the emitted particles.
+	 * \return The declination, in radians.
+	 */
+	NIFLIB_API float GetDeclination() const;
+
+	/*!
+	 * Sets the angle between the emitter z axis and the direction of the emitted particles.
+	 * \param[in] value The new declination, in radians.
+	 */
+	NIFLIB_API void SetDeclination( float value );
+
+	/*!
+	 * Retrieves the angle around the emitter z axis of the direction of the emitted particles.
+	 * \return The planar angle, in radians.
+	 */
+	NIFLIB_API float GetPlanarAngle() const;
+
+	/*!
+	 * Sets the angle around the emitter z axis of the direction of the emitted particles.
+	 * \param[in] value The new planar angle, in radians.
+	 */
+	NIFLIB_API void SetPlanarAngle( float value );
+
+	/*!
+	 * Adds new particles at random positions in the emitter volume, moving
+	 * in random directions around the declination and planar angle.  Called
+	 * by NiParticleSystem::Simulate.
+	 * \param[in,out] particles The particles to add to.
+	 * \param[in] count The number of particles to emit.
+	 * \param[in,out] random The random number generator of the simulation.
+	 */
+	NIFLIB_API void EmitParticles( ParticleState & particles, unsigned int count, ParticleRandom & random ) const;
+
+protected:
+	/*! Picks the position of a new particle.  The base emitter emits from the origin. */
+	virtual Vector3 emitPosition( ParticleRandom & random ) const;
 	//--END CUSTOM CODE--//
 protected:
 	/*! Speed / Inertia of particle movement. */
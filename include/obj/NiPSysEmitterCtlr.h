@@ -84,6 +84,22 @@ public:
 	 */
 	NIFLIB_API void SetVisibilityInterpolator( NiInterpolator * value );
 
+	/*!
+	 * Computes the number of particles emitted per second, from the float
+	 * interpolator of the controller.
+	 * \param[in] time The controller time.
+	 * \return The birth rate, or zero if there is no float interpolator.
+	 */
+	NIFLIB_API float EvaluateBirthRate( float time ) const;
+
+	/*!
+	 * Determines whether the emitter is switched on, from the visibility
+	 * interpolator.
+	 * \param[in] time The controller time.
+	 * \return True if the emitter is on.  Emitters without a visibility interpolator are always on.
+	 */
+	NIFLIB_API bool IsEmitterActive( float time ) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! This controller's data */
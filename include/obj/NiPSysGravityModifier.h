@@ -58,6 +58,52 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+	/*!
+	 * Retrieves the direction of planar gravity.
+	 * \return The gravity axis.
+	 */
+	NIFLIB_API Vector3 GetGravityAxis() const;
+
+	/*!
+	 * Sets the direction of planar gravity.
+	 * \param[in] value The new gravity axis.  It does not need to be normalized.
+	 */
+	NIFLIB_API void SetGravityAxis( const Vector3 & value );
+
+	/*!
+	 * Retrieves the strength of the gravity, in units per second squared.
+	 * \return The strength.
+	 */
+	NIFLIB_API float GetStrength() const;
+
+	/*!
+	 * Sets the strength of the gravity.
+	 * \param[in] value The new strength, in units per second squared.
+	 */
+	NIFLIB_API void SetStrength( float value );
+
+	/*!
+	 * Retrieves whether the gravity pulls along an axis or toward a point.
+	 * \return The force type.
+	 */
+	NIFLIB_API ForceType GetForceType() const;
+
+	/*!
+	 * Sets whether the gravity pulls along an axis or toward a point.
+	 * \param[in] value The new force type.
+	 */
+	NIFLIB_API void SetForceType( ForceType value );
+
+	/*!
+	 * Accelerates the particles, either along the gravity axis or toward the
+	 * gravity object, and adds the turbulence.
+	 * \param[in,out] particles The particles to modify.
+	 * \param[in] delta The length of the step, in seconds.
+	 * \param[in,out] random The random number generator of the simulation.
+	 */
+	NIFLIB_API virtual void UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Refers to a NiNode for gravity location. */
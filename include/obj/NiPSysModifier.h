@@ -11,6 +11,7 @@ All rights reserved.  Please see niflib.h for license. */
 #define _NIPSYSMODIFIER_H_
 
 //--BEGIN FILE HEAD CUSTOM CODE--//
+#include "../ParticleSimulation.h"
 //--END CUSTOM CODE--//
 
 #include "NiObject.h"
@@ -55,6 +56,63 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+	/*!
+	 * Retrieves the name of the modifier.  Modifier controllers find their modifier by this name.
+	 * \return The name of the modifier.
+	 */
+	NIFLIB_API string GetName() const;
+
+	/*!
+	 * Sets the name of the modifier.
+	 * \param[in] value The new name.
+	 */
+	NIFLIB_API void SetName( const string & value );
+
+	/*!
+	 * Retrieves the position of the modifier in the modifier chain.  Modifiers with a lower order run first.
+	 * \return The order of the modifier.
+	 */
+	NIFLIB_API unsigned int GetOrder() const;
+
+	/*!
+	 * Sets the position of the modifier in the modifier chain.
+	 * \param[in] value The new order.
+	 */
+	NIFLIB_API void SetOrder( unsigned int value );
+
+	/*!
+	 * Retrieves whether the modifier is in effect.
+	 * \return True if the modifier is active.
+	 */
+	NIFLIB_API bool GetActive() const;
+
+	/*!
+	 * Sets whether the modifier is in effect.
+	 * \param[in] value True to make the modifier active.
+	 */
+	NIFLIB_API void SetActive( bool value );
+
+	/*!
+	 * Sets up the newly emitted particles.  Called by NiParticleSystem::Simulate
+	 * right after an emitter adds particles.  Does nothing unless a modifier
+	 * gives its particles a starting state.
+	 * \param[in,out] particles The particles of the simulation.
+	 * \param[in] first The index of the first new particle.  The new particles run to the end of the arrays.
+	 * \param[in,out] random The random number generator of the simulation.
+	 */
+	NIFLIB_API virtual void InitializeParticles( ParticleState & particles, unsigned int first, ParticleRandom & random ) const;
+
+	/*!
+	 * Applies this modifier to the particles over one simulation step.  Called
+	 * by NiParticleSystem::Simulate for each active modifier, in order.  Does
+	 * nothing unless a modifier type is simulated.
+	 * \param[in,out] particles The particles to modify.
+	 * \param[in] delta The length of the step, in seconds.
+	 * \param[in,out] random The random number generator of the simulation.
+	 */
+	NIFLIB_API virtual void UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! The object name. */
@@ -53,6 +53,19 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+	/*!
+	 * Retrieves the name of the modifier that this controller animates.
+	 * \return The name of the modifier.
+	 */
+	NIFLIB_API string GetModifierName() const;
+
+	/*!
+	 * Sets the name of the modifier that this controller animates.
+	 * \param[in] value The name of a modifier of the target particle system.
+	 */
+	NIFLIB_API void SetModifierName( const string & value );
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Refers to modifier object by its name? */
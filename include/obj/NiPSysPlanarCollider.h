@@ -53,6 +53,16 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+	/*!
+	 * Bounces a particle that crossed the collider rectangle during the last step.
+	 * \param[in,out] particles The particles of the simulation.
+	 * \param[in] i The index of the particle to test.
+	 * \param[in] previous The position of the particle at the start of the step.
+	 * \return True if the particle hit the collider and must die.
+	 */
+	NIFLIB_API virtual bool CollideParticle( ParticleState & particles, unsigned int i, const Vector3 & previous ) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Defines the width of the plane. */
@@ -53,6 +53,23 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+	/*!
+	 * Sets up the newly emitted particles.
+	 * \param[in,out] particles The particles of the simulation.
+	 * \param[in] first The index of the first new particle.  The new particles run to the end of the arrays.
+	 * \param[in,out] random The random number generator of the simulation.
+	 */
+	NIFLIB_API virtual void InitializeParticles( ParticleState & particles, unsigned int first, ParticleRandom & random ) const;
+
+	/*!
+	 * Turns the particles at their rotation speed.
+	 * \param[in,out] particles The particles to modify.
+	 * \param[in] delta The length of the step, in seconds.
+	 * \param[in,out] random The random number generator of the simulation.
+	 */
+	NIFLIB_API virtual void UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! The initial speed of rotation. */
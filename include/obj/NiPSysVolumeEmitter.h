@@ -55,6 +55,10 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+protected:
+	/*! The position of the emitter object, or the origin if there is none. */
+	Vector3 emitterOrigin() const;
 	//--END CUSTOM CODE--//
 protected:
 	/*! Node parent of this modifier? */
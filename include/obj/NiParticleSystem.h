@@ -11,6 +11,7 @@ All rights reserved.  Please see niflib.h for license. */
 #define _NIPARTICLESYSTEM_H_
 
 //--BEGIN FILE HEAD CUSTOM CODE--//
+#include "../ParticleSimulation.h"
 //--END CUSTOM CODE--//
 
 #include "NiParticles.h"
@@ -58,6 +59,40 @@ public:
 	NIFLIB_API virtual const Type & GetType() const;
 
 	//--BEGIN MISC CUSTOM CODE--//
+
+	/*!
+	 * Retrieves the modifiers of the particle system.
+	 * \return The modifiers, in file order.
+	 */
+	NIFLIB_API vector< Ref<NiPSysModifier> > GetModifiers() const;
+
+	/*!
+	 * Replaces the modifiers of the particle system.
+	 * \param[in] value The new modifiers.
+	 */
+	NIFLIB_API void SetModifiers( const vector< Ref<NiPSysModifier> > & value );
+
+	/*!
+	 * Adds a modifier to the particle system.
+	 * \param[in] value The modifier to add.
+	 */
+	NIFLIB_API void AddModifier( NiPSysModifier * value );
+
+	/*!
+	 * Runs the particle system from a start time to a stop time with fixed
+	 * steps.  Each step, the emitter controllers add particles at their birth
+	 * rate, and then every active modifier runs on all particles in the order
+	 * of their order numbers.  The result only depends on the file data and
+	 * the seed, so it can be used to compute bounds offline.
+	 * \param[in] start The time to start at.
+	 * \param[in] stop The time to stop at.
+	 * \param[in] step The length of each step, in seconds.
+	 * \param[in] seed The seed of the random numbers used by the emitters and modifiers.
+	 * \param[out] particles Receives the particles alive at the stop time.
+	 * \return The box that held every particle at the end of every step.
+	 */
+	NIFLIB_API ParticleBounds Simulate( float start, float stop, float step, unsigned int seed, ParticleState & particles ) const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Unknown */
@@ -54,6 +54,13 @@ public:
 
 	//--BEGIN MISC CUSTOM CODE--//
 
+	/*! Filters used to scale the image down when generating mipmaps. */
+	enum MipMapFilter {
+		MIP_FILTER_BOX = 0, /*!< Averages the pixels covered by each mipmap pixel. */
+		MIP_FILTER_KAISER = 1, /*!< Kaiser windowed sinc filter.  Sharper than the box filter. */
+		MIP_FILTER_LANCZOS = 2 /*!< Three lobed Lanczos filter.  Sharpest, but may ring near hard edges. */
+	};
+
 	/*!
 	 * Retrieves the height of the texture image stored in this object.
 	 * \return The height of the texture image stored in this object.
@@ -85,7 +92,7 @@ public:
 	NIFLIB_API void Reset( int new_width, int new_height, PixelFormat px_fmt );
 	
 	/*!
-	 * Retrieves the the pixels of the texture image stored in this object.  This function does not work on palettized textures.
+	 * Retrieves the the pixels of the texture image stored in this object.  This function does not work on palettized textures.  DXT compressed textures are decompressed.
 	 * \return A vector containing the colors of each pixel in the texture image stored in this object, one row after another starting from the bottom of the image.  The width of the image must be used to interpret them correctly.
 	 * \sa NiPixelData::SetColors, NiPixelData::GetWidth
 	 */
@@ -94,11 +101,140 @@ public:
 	/*!
 	 * Sets the the pixels of the texture image stored in this object and optionally generates mipmaps.  This function does not work for palettized textures.
 	 * \param new_pixels A vector containing the colors of each new pixel to be set in the texture image stored in this object, one row after another starting from the botom of the image.
-	 * \param generate_mipmaps If true, mipmaps will be generated for the new image and stored in the file.
-	 * \sa NiPixelData::GetColors, NiPixelData::GetWidth
+	 * \param generate_mipmaps If true, mipmaps will be generated for the new image with a box filter and stored in the file.
+	 * \sa NiPixelData::GetColors, NiPixelData::GetWidth, NiPixelData::GenerateMipMaps
 	 */
 	NIFLIB_API void SetColors( const vector<Color4> & new_pixels, bool generate_mipmaps );
 
+	/*!
+	 * Replaces all mipmaps below the first one with versions filtered down from it, for every face of the texture.  Each mipmap halves the size of the previous one, rounding down, until it is 1 x 1, so sizes do not need to be powers of two.  Works on PX_FMT_RGB8, PX_FMT_RGBA8, and DXT textures.
+	 * \param filter The filter used to scale down each mipmap.
+	 * \param srgb If true, the color channels are treated as sRGB encoded and filtered in linear space.  Alpha is always filtered as is.
+	 * \sa NiPixelData::SetColors
+	 */
+	NIFLIB_API void GenerateMipMaps( MipMapFilter filter = MIP_FILTER_BOX, bool srgb = false );
+
+	/*! A writable view of the pixel data of one mipmap of one face.  It stays valid until the pixel data is resized or reformatted. */
+	struct MipMapView {
+		byte * data; /*!< The first byte of the mipmap. */
+		unsigned int size; /*!< The number of bytes in the mipmap. */
+		unsigned int width; /*!< The width of the mipmap in pixels. */
+		unsigned int height; /*!< The height of the mipmap in pixels. */
+		unsigned int rowPitch; /*!< The number of bytes per row of pixels, or per row of 4x4 blocks for DXT formats. */
+	};
+
+	/*! A read only view of the pixel data of one mipmap of one face.  It stays valid until the pixel data is resized or reformatted. */
+	struct ConstMipMapView {
+		const byte * data; /*!< The first byte of the mipmap. */
+		unsigned int size; /*!< The number of bytes in the mipmap. */
+		unsigned int width; /*!< The width of the mipmap in pixels. */
+		unsigned int height; /*!< The height of the mipmap in pixels. */
+		unsigned int rowPitch; /*!< The number of bytes per row of pixels, or per row of 4x4 blocks for DXT formats. */
+	};
+
+	/*!
+	 * Retrieves the number of mipmaps stored for each face, including the full size image.
+	 * \return The number of mipmaps.
+	 */
+	NIFLIB_API unsigned int GetNumMipMaps() const;
+
+	/*!
+	 * Retrieves the number of faces stored in this object.  Cube maps have six faces, other textures one.
+	 * \return The number of faces.
+	 */
+	NIFLIB_API unsigned int GetNumFaces() const;
+
+	/*!
+	 * Sets up the mipmap chain for the size set by Reset and allocates storage for it, without filling it in.  Pixel data that was already stored in the first mipmap of each face is kept.  Use GetMipMapView or ReadMipMap to fill in the mipmaps.
+	 * \param num_mipmaps The number of mipmaps to allocate, or zero for a full chain down to 1 x 1.
+	 * \param num_faces The number of faces to allocate, six for cube maps.
+	 * \sa NiPixelData::Reset, NiPixelData::GetMipMapView
+	 */
+	NIFLIB_API void AllocatePixelData( unsigned int num_mipmaps = 0, unsigned int num_faces = 1 );
+
+	/*!
+	 * Gives direct access to the stored bytes of one mipmap, without any copying or conversion.
+	 * \param level The mipmap level, zero being the full size image.
+	 * \param face The face of the texture.
+	 * \return A view of the mipmap data.
+	 */
+	NIFLIB_API MipMapView GetMipMapView( unsigned int level, unsigned int face = 0 );
+
+	/*!
+	 * Gives direct read only access to the stored bytes of one mipmap, without any copying or conversion.
+	 * \param level The mipmap level, zero being the full size image.
+	 * \param face The face of the texture.
+	 * \return A view of the mipmap data.
+	 */
+	NIFLIB_API ConstMipMapView GetMipMapView( unsigned int level, unsigned int face = 0 ) const;
+
+	/*!
+	 * Reads the raw data of one mipmap from a stream, in the current pixel format.  The mipmap must already be allocated.
+	 * \param in The stream to read exactly the size of the mipmap from.
+	 * \param level The mipmap level, zero being the full size image.
+	 * \param face The face of the texture.
+	 * \sa NiPixelData::AllocatePixelData, NiPixelData::WriteMipMap
+	 */
+	NIFLIB_API void ReadMipMap( istream & in, unsigned int level, unsigned int face = 0 );
+
+	/*!
+	 * Writes the raw data of one mipmap to a stream, in the current pixel format.
+	 * \param out The stream to write the mipmap to.
+	 * \param level The mipmap level, zero being the full size image.
+	 * \param face The face of the texture.
+	 * \sa NiPixelData::ReadMipMap
+	 */
+	NIFLIB_API void WriteMipMap( ostream & out, unsigned int level, unsigned int face = 0 ) const;
+
+	/*!
+	 * Converts all mipmaps of all faces to another pixel format in place.  Conversions between PX_FMT_RGB8 and PX_FMT_RGBA8 need no temporary storage when the mipmaps are packed one after another, as AllocatePixelData lays them out.  Other conversions, including DXT formats, which are compressed or decompressed one mipmap at a time, write into a new buffer.  Alpha is set to opaque when it is added.
+	 * \param px_fmt The new pixel format.  Palettized textures are not supported.
+	 */
+	NIFLIB_API void ConvertFormat( PixelFormat px_fmt );
+
+	/*!
+	 * Reorders the color channels of every pixel in place.  Each parameter gives the index of the current channel that moves into that position, so ( 2, 1, 0, 3 ) swaps red and blue.  Only works on PX_FMT_RGB8 and PX_FMT_RGBA8 textures; the alpha parameter is ignored for PX_FMT_RGB8.
+	 * \param r The channel that becomes red.
+	 * \param g The channel that becomes green.
+	 * \param b The channel that becomes blue.
+	 * \param a The channel that becomes alpha.
+	 */
+	NIFLIB_API void SwizzleChannels( unsigned int r, unsigned int g, unsigned int b, unsigned int a = 3 );
+
+	/*!
+	 * Multiplies the color channels of every pixel by its alpha in place.  Only works on PX_FMT_RGBA8 textures.
+	 */
+	NIFLIB_API void PremultiplyAlpha();
+
+	/*!
+	 * Decompresses a DXT1 or DXT5 compressed image into 8-bit RGBA pixels.
+	 * \param px_fmt The compressed pixel format of the blocks.  Must be PX_FMT_DXT1, PX_FMT_DXT5, or PX_FMT_DXT5_ALT.
+	 * \param blocks The compressed 4x4 texel blocks, one row of blocks after another.
+	 * \param width The width of the image in pixels.
+	 * \param height The height of the image in pixels.
+	 * \param rgba Receives width * height * 4 bytes of pixel data.
+	 * \sa NiPixelData::CompressBlocks
+	 */
+	NIFLIB_API static void DecompressBlocks( PixelFormat px_fmt, const byte * blocks, unsigned int width, unsigned int height, byte * rgba );
+
+	/*!
+	 * Compresses 8-bit RGBA pixels into DXT1 or DXT5 blocks.  DXT1 blocks store texels with alpha below 128 as transparent.
+	 * \param px_fmt The compressed pixel format to create.  Must be PX_FMT_DXT1, PX_FMT_DXT5, or PX_FMT_DXT5_ALT.
+	 * \param rgba The width * height * 4 bytes of pixel data to compress.
+	 * \param width The width of the image in pixels.
+	 * \param height The height of the image in pixels.
+	 * \param blocks Receives the compressed 4x4 texel blocks, 8 bytes per block for DXT1 and 16 bytes per block for DXT5.
+	 * \sa NiPixelData::DecompressBlocks
+	 */
+	NIFLIB_API static void CompressBlocks( PixelFormat px_fmt, const byte * rgba, unsigned int width, unsigned int height, byte * blocks );
+
+private:
+	/*! Sets the pixel format along with the masks and bit counts that describe it. */
+	void SetFormatFields( PixelFormat px_fmt );
+
+	/*! Rebuilds the mipmap offsets for the current size and pixel format, and returns the size of one face. */
+	unsigned int LayoutMipMaps( unsigned int num_mipmaps );
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Total number of pixels */
@@ -58,6 +58,30 @@ public:
 
 	//--BEGIN MISC CUSTOM CODE--//
 
+	/*!
+	 * Retrieves the materials of this object.
+	 * \return The name and extra data of each material.
+	 */
+	NIFLIB_API vector<MaterialData> GetMaterials() const;
+
+	/*!
+	 * Sets the materials of this object.
+	 * \param[in] value The name and extra data of each material.
+	 */
+	NIFLIB_API void SetMaterials( const vector<MaterialData> & value );
+
+	/*!
+	 * Retrieves the index of the material in use.
+	 * \return The index into the materials, or -1 if none is in use.
+	 */
+	NIFLIB_API int GetActiveMaterial() const;
+
+	/*!
+	 * Sets the index of the material in use.
+	 * \param[in] value The index into the materials, or -1 if none is in use.
+	 */
+	NIFLIB_API void SetActiveMaterial( int value );
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! The number of materials affecting this renderable object. */
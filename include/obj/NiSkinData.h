@@ -92,9 +92,9 @@ public:
 	/*!
 	 * Retrieves the skin weights for a particular bone.  This information includes the vertex index into the geometry data's vertex array, and the percentage weight that defines how much the movement of this bone influences its position.
 	 * \param[in] bone_index The numeric index of the bone that the skin weight data should be returned for.  Must be >= zero and < the number returned by GetBoneCount.
-	 * \return The skin weight data for the specified bone.
+	 * \return The skin weight data for the specified bone.  The reference is valid until the bones of this skin data are changed.
 	 */
-	NIFLIB_API vector<SkinWeight> GetBoneWeights( unsigned int bone_index ) const;
+	NIFLIB_API const vector<SkinWeight> & GetBoneWeights( unsigned int bone_index ) const;
 
 	/*!
 	 * Sets the skin weights for a particular bone.  This information includes the vertex index into the geometry data's vertex array, and the percentage weight that defines how much the movement of this bone influences its position.
@@ -112,6 +112,24 @@ public:
 	 */
 	NIFLIB_API void SetBoneWeights( unsigned int bone_index, const vector<SkinWeight> & weights );
 
+	/*!
+	 * Exchanges the skin weights of a bone with the contents of a vector, without copying them.  The center and radius are not changed.
+	 * \param[in] bone_index The numeric index of the bone.  Must be >= zero and < the number returned by GetBoneCount.
+	 * \param[in,out] weights The new skin weight data.  Receives the old skin weight data.
+	 * \sa NiSkinData::SetBoneWeights
+	 */
+	NIFLIB_API void SwapBoneWeights( unsigned int bone_index, vector<SkinWeight> & weights );
+
+#ifdef NIFLIB_CXX11
+	/*!
+	 * Moves new skin weights into a bone, without changing center and radius.
+	 * \param[in] bone_index The numeric index of the bone.  Must be >= zero and < the number returned by GetBoneCount.
+	 * \param[in] weights The new skin weight data, which is left empty or holding the old skin weight data.
+	 * \sa NiSkinData::SetBoneWeights, NiSkinData::SwapBoneWeights
+	 */
+	void SetBoneWeights( unsigned int bone_index, vector<SkinWeight> && weights ) { SwapBoneWeights( bone_index, weights ); }
+#endif
+
 	/*!
 	 * Returns a reference to the hardware skin partition data object, if any.
 	 * \return The hardware skin partition data, or NULL if none is used.
@@ -61,6 +61,62 @@ public:
 
 	//--BEGIN MISC CUSTOM CODE--//
 
+	/*!
+	 * Retrieves the skinning flags.  USE_SOFTWARE_SKINNING = 0x0001, RECOMPUTE_BOUNDS = 0x0002.
+	 * \return The flags.
+	 */
+	NIFLIB_API unsigned short GetFlags() const;
+
+	/*!
+	 * Sets the skinning flags.  Setting RECOMPUTE_BOUNDS requires a bound per bone.
+	 * \param[in] value The new flags.
+	 */
+	NIFLIB_API void SetFlags( unsigned short value );
+
+	/*!
+	 * Retrieves the root bone of the skeleton.
+	 * \return The skeleton root.
+	 */
+	NIFLIB_API Ref<NiAVObject> GetSkeletonRoot() const;
+
+	/*!
+	 * Sets the root bone of the skeleton.
+	 * \param[in] value The new skeleton root.
+	 */
+	NIFLIB_API void SetSkeletonRoot( NiAVObject * value );
+
+	/*!
+	 * Retrieves the transform from the skeleton root's parent space to skin space.
+	 * \return The skeleton transform.
+	 */
+	NIFLIB_API SkinTransform GetSkeletonTransform() const;
+
+	/*!
+	 * Sets the transform from the skeleton root's parent space to skin space.
+	 * \param[in] value The new skeleton transform.
+	 */
+	NIFLIB_API void SetSkeletonTransform( const SkinTransform & value );
+
+	/*!
+	 * Retrieves the bones that influence the skin.
+	 * \return The bones.
+	 */
+	NIFLIB_API vector< Ref<NiAVObject> > GetBones() const;
+
+	/*!
+	 * Retrieves the bind pose transform of each bone.
+	 * \return The transforms from skin space to bone space.
+	 */
+	NIFLIB_API vector<SkinTransform> GetBoneTransforms() const;
+
+	/*!
+	 * Replaces the bones that influence the skin.  The bone bounds are
+	 * cleared, along with the RECOMPUTE_BOUNDS flag.
+	 * \param[in] bones The bones.
+	 * \param[in] transforms The transform from skin space to bone space of each bone.
+	 */
+	NIFLIB_API void SetBones( const vector< Ref<NiAVObject> > & bones, const vector<SkinTransform> & transforms );
+
 	//--END CUSTOM CODE--//
 protected:
 	/*!
@@ -86,6 +86,34 @@ public:
 	 */
 	NIFLIB_API unsigned int AddSubStr( const string & n );
 
+	/*!
+	 * Adds several sub strings to the string palette at once.  Each string gets the same offset that NiStringPalette::AddSubStr would give it when the strings are added one after another, but the palette is only grown once.
+	 * \param[in] strings The sub strings to add.
+	 * \return The offset of each sub string in the string palette.
+	 */
+	NIFLIB_API vector<unsigned int> AddSubStrs( const vector<string> & strings );
+
+private:
+	/*! Brings the sub string index up to date with the palette string, rebuilding it if the palette was replaced. */
+	void updateIndex();
+	/*!
+	 * Maps each whole string in the palette to the first offset where it
+	 * starts.  The map is a hash map where the compiler has one, so it is
+	 * kept behind a pointer and the class layout is the same either way.  A
+	 * copy starts without an index and builds its own from its palette.
+	 */
+	class SubStrIndex {
+	public:
+		struct Impl;
+		SubStrIndex() : impl(NULL) {}
+		SubStrIndex( const SubStrIndex & ) : impl(NULL) {}
+		SubStrIndex & operator=( const SubStrIndex & ) { clear(); return *this; }
+		~SubStrIndex() { clear(); }
+		void clear();
+		Impl * impl;
+	};
+	SubStrIndex subStrIndex;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! A bunch of 0x00 seperated strings. */
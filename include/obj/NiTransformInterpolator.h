@@ -119,6 +119,20 @@ public:
 	 */
 	NIFLIB_API virtual void NormalizeKeys( float phase, float frequency );
 
+	/*!
+	 * Removes keys from the data object that are not needed to reproduce the
+	 * animation within the given tolerances.  Tracks that do not change are
+	 * moved into the pose translation, rotation, or scale of this interpolator,
+	 * and the data object is released when no keys are left.  The data object
+	 * is changed in place, so other interpolators that share it are affected
+	 * as well.
+	 * \param[in] translate_tolerance The largest allowed translation error, as a distance.
+	 * \param[in] rotate_tolerance The largest allowed rotation error, as an angle in radians.
+	 * \param[in] scale_tolerance The largest allowed scale error.
+	 * \sa NiKeyframeData::ReduceKeys
+	 */
+	NIFLIB_API void ReduceKeys( float translate_tolerance, float rotate_tolerance, float scale_tolerance );
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Translate. */
@@ -69,6 +69,12 @@ public:
 	//when vertices are updated.
 	NIFLIB_API virtual void SetVertices( const vector<Vector3> & in );
 
+#ifdef NIFLIB_CXX11
+	//The overload that moves vertices in clears match detection data through
+	//the virtual SetVertices
+	using NiTriBasedGeomData::SetVertices;
+#endif
+
 	/*!
 	 * This function generates match detection data based on the current
 	 * vertex list.  The function of this data is unknown and appears to be
@@ -109,6 +115,22 @@ public:
 	 */
 	NIFLIB_API virtual void SetTriangles( const vector<Triangle> & in );
 
+	/*!
+	 * Exchanges the triangle face data in this mesh with the contents of a vector, without copying them.
+	 * \param in The new face data.  Maximum size is 65,535.  Receives the old face data.
+	 * \sa NiTriShapeData::SetTriangles
+	 */
+	NIFLIB_API void SwapTriangles( vector<Triangle> & in );
+
+#ifdef NIFLIB_CXX11
+	/*!
+	 * Moves new triangle face data into this mesh.
+	 * \param in The new face data.  Maximum size is 65,535.  It is left empty or holding the old face data.
+	 * \sa NiTriShapeData::SetTriangles, NiTriShapeData::SwapTriangles
+	 */
+	void SetTriangles( vector<Triangle> && in ) { SwapTriangles( in ); }
+#endif
+
 private:
 	bool hasTrianglesCalc(const NifInfo & info) const {
 		return (triangles.size() > 0);
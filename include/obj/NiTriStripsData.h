@@ -82,10 +82,10 @@ public:
 	/*!
 	 * Used to retrieve all the triangles from a specific triangle strip.
 	 * \param index The index of the triangle strip to retrieve the triangles from.  This is a zero-based index which must be a positive number less than that returned by NiTriStripsData::GetStripCount.
-	 * \return A vector containing all the triangle faces from the triangle strip specified by index.
+	 * \return A vector containing all the triangle faces from the triangle strip specified by index.  The reference is valid until the strips are changed.
 	 * \sa NiTriStripData::SetStrip, NiTriStripData::GetTriangles
 	 */
-	NIFLIB_API vector<unsigned short> GetStrip( int index ) const;
+	NIFLIB_API const vector<unsigned short> & GetStrip( int index ) const;
 
 	/*!
 	 * This is a conveniance function which returns all triangle faces in all triangle strips that make up this mesh.  It is similar to the ITriShapeData::GetTriangles function.
@@ -104,6 +104,24 @@ public:
 	 */
 	NIFLIB_API void SetStrip( int index, const vector<unsigned short> & in );
 
+	/*!
+	 * Exchanges the vertex indices of a triangle strip with the contents of a vector, without copying them.
+	 * \param index The index of the triangle strip.  This is a zero-based index which must be a positive number less than that returned by NiTriStripsData::GetStripCount.
+	 * \param in The new vertex indices of the strip.  Receives the old vertex indices.
+	 * \sa NiTriStripData::SetStrip
+	 */
+	NIFLIB_API void SwapStrip( int index, vector<unsigned short> & in );
+
+#ifdef NIFLIB_CXX11
+	/*!
+	 * Moves new vertex indices into a triangle strip.
+	 * \param index The index of the triangle strip.  This is a zero-based index which must be a positive number less than that returned by NiTriStripsData::GetStripCount.
+	 * \param in The new vertex indices of the strip, which are left empty or holding the old vertex indices.
+	 * \sa NiTriStripData::SetStrip, NiTriStripData::SwapStrip
+	 */
+	void SetStrip( int index, vector<unsigned short> && in ) { SwapStrip( index, in ); }
+#endif
+
 	/*!
 	 * Replaces the triangle face data in this mesh with new data.
 	 * \param in A vector containing the new face data.  Maximum size is 65,535.
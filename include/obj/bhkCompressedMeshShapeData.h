@@ -264,6 +264,29 @@ public:
      */
 	NIFLIB_API virtual unsigned int SetChunks(vector<bhkCMSDChunk>& theChunks);
 
+	/*!
+	 * Expands all chunks and big triangles into a single triangle mesh.  Chunk
+	 * vertices are dequantized with the error value, offset by the chunk
+	 * translation, and moved by the chunk transform.
+	 * \param[out] vertices Receives the vertices, in havok units.
+	 * \param[out] triangles Receives the triangles.
+	 * \param[out] materials If not NULL, receives the index into the chunk materials of each triangle.
+	 */
+	NIFLIB_API void GetTriangleMesh( vector<Vector3> & vertices, vector<Triangle> & triangles, vector<unsigned int> * materials = NULL ) const;
+
+	/*!
+	 * Replaces all chunks, big vertices, big triangles and chunk transforms with
+	 * a compressed version of the given triangle mesh.  The triangles are
+	 * spatially partitioned into chunks per material, each chunk is quantized
+	 * with the given error, and stripped.  Triangles too large for a chunk are
+	 * stored as big triangles.
+	 * \param[in] vertices The vertices of the mesh, in havok units.
+	 * \param[in] triangles The triangles of the mesh.
+	 * \param[in] materials The index into the chunk materials of each triangle, or an empty vector to use the first material for all triangles.  If there are no chunk materials yet, a stone material is added.
+	 * \param[in] error The maximum quantization step of the chunk vertices.
+	 */
+	NIFLIB_API void SetTriangleMesh( const vector<Vector3> & vertices, const vector<Triangle> & triangles, const vector<unsigned int> & materials = vector<unsigned int>(), float error = 0.001f );
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Number of bits in the shape-key reserved for a triangle index */
@@ -130,6 +130,42 @@ public:
 	*/
 	NIFLIB_API void SetMoppScale( float value );
 
+	/*!
+	* Builds new mopp code, origin, and scale for the given triangle mesh.  The tree is
+	* constructed with a surface area heuristic over the triangle bounds, which are
+	* quantized to the 8 bit mopp coordinates defined by the origin and scale.  The shape
+	* key stored for each triangle is its index in the triangle vector.  Degenerate
+	* triangles are left out of the tree.
+	* \param[in] vertices The vertices of the collision mesh, in havok units.
+	* \param[in] triangles The triangles of the collision mesh.
+	*/
+	NIFLIB_API void BuildMoppCode( const vector<Vector3> & vertices, const vector<Triangle> & triangles );
+
+	/*!
+	* Builds new mopp code, origin, and scale from the geometry of the attached shape.
+	* Currently the shape must be a bhkPackedNiTriStripsShape.
+	*/
+	NIFLIB_API void BuildMoppCode();
+
+	/*!
+	* Decodes the mopp code and returns every shape key it references.  Throws an
+	* exception if the code is malformed or contains an unknown instruction, so this
+	* can also be used to validate mopp code.
+	* \return The sorted shape keys (triangle indices) referenced by the mopp code.
+	*/
+	NIFLIB_API vector<unsigned int> GetMoppTriangleIndices() const;
+
+	/*!
+	* Runs a ray query through the mopp code and returns the shape keys of all
+	* triangles whose mopp bounds are crossed by the segment.  The result is
+	* conservative: it contains every triangle hit by the segment, but may also contain
+	* triangles that are merely close to it.
+	* \param[in] start The start of the ray segment, in havok units.
+	* \param[in] end The end of the ray segment, in havok units.
+	* \return The sorted shape keys (triangle indices) of the candidate triangles.
+	*/
+	NIFLIB_API vector<unsigned int> QueryMoppRay( const Vector3 & start, const Vector3 & end ) const;
+
 	/*! Helper routine for calculating mass properties.
 	 *  \param[in]  density Uniform density of object
 	 *  \param[in]  solid Determines whether the object is assumed to be solid or not
@@ -293,10 +293,10 @@ void ComplexShape::Merge( NiAVObject * root ) {
 		}
 
 		
-		vector<Color4> shapeColors = geomData->GetColors();
-		vector< vector<TexCoord> > shapeUVs( geomData->GetUVSetCount() );
+		const vector<Color4> & shapeColors = geomData->GetColors();
+		vector< const vector<TexCoord> * > shapeUVs( geomData->GetUVSetCount() );
 		for ( unsigned int i = 0; i < shapeUVs.size(); ++i ) {
-			shapeUVs[i] = geomData->GetUVSet(i);
+			shapeUVs[i] = &geomData->GetUVSet(i);
 		}
 		vector<Triangle> shapeTris= geomData->GetTriangles();
 
@@ -464,10 +464,10 @@ void ComplexShape::Merge( NiAVObject * root ) {
 				if ( set >= shapeUVs.size() || set < 0 ) {
 					throw runtime_error("One of the UV sets specified in the NiTexturingProperty did not exist in the NiTriBasedGeomData.");
 				}
-				for ( unsigned int v = 0; v < shapeUVs[set].size(); ++v ) {
+				for ( unsigned int v = 0; v < shapeUVs[set]->size(); ++v ) {
 					TexCoord newCoord;
 
-					newCoord = shapeUVs[set][v];
+					newCoord = (*shapeUVs[set])[v];
 
 					//Search for matching texture coordinate
 					bool match_found = false;
@@ -530,9 +530,8 @@ void ComplexShape::Merge( NiAVObject * root ) {
 				vector<NiNodeRef> shapeBones = skinInst->GetBones();
 
 				//Get weights
-				vector<SkinWeight> shapeWeights;
 				for ( unsigned int b = 0; b < shapeBones.size(); ++b ) {
-					shapeWeights = skinData->GetBoneWeights(b);
+					const vector<SkinWeight> & shapeWeights = skinData->GetBoneWeights(b);
 					for ( unsigned int w = 0; w < shapeWeights.size(); ++w ) {
 						unsigned int vn_index = lookUp[ shapeWeights[w].index ].vertIndex;
 						NiNodeRef boneRef = shapeBones[b];
@@ -1025,19 +1024,19 @@ Ref<NiAVObject> ComplexShape::Split( NiNode * parent, Matrix44 & transform, int
 
 		//Finally, set the data into the NiTriShapeData
 		if ( vertices.size() > 0 ) {
-			niData->SetVertices( shapeVerts );
+			niData->SwapVertices( shapeVerts );
 			niData->SetTriangles( shapeTriangles );
 		}
 		if ( normals.size() > 0 ) {
-			niData->SetNormals( shapeNorms );
+			niData->SwapNormals( shapeNorms );
 		}
 		if ( colors.size() > 0 ) {
-			niData->SetVertexColors( shapeColors );
+			niData->SwapVertexColors( shapeColors );
 		}
 		if ( texCoordSets.size() > 0 ) {
 			niData->SetUVSetCount( int(shapeTCs.size()) );
 			for ( unsigned int tex_index = 0; tex_index < shapeTCs.size(); ++tex_index ) {
-				niData->SetUVSet( tex_index, shapeTCs[tex_index] );
+				niData->SwapUVSet( tex_index, shapeTCs[tex_index] );
 			}
 		}
 
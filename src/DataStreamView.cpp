@@ -0,0 +1,278 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#include "../include/DataStreamView.h"
+#include <cstring>
+#include <stdexcept>
+
+using namespace Niflib;
+
+namespace Niflib {
+
+//The low byte of a component format numbers the formats; the first 56 come
+//in groups of four, one per value count, in this order of storage types.
+//The ones after them are packed formats, except for BGRA colors.
+enum ComponentStorage {
+	STORE_INT8, STORE_UINT8, STORE_NORMINT8, STORE_NORMUINT8,
+	STORE_INT16, STORE_UINT16, STORE_NORMINT16, STORE_NORMUINT16,
+	STORE_INT32, STORE_UINT32, STORE_NORMINT32, STORE_NORMUINT32,
+	STORE_FLOAT16, STORE_FLOAT32, STORE_PACKED
+};
+
+static ComponentStorage GetStorage( ComponentFormat format ) {
+	unsigned int id = (unsigned int)(format) & 0xFF;
+	if ( id == 0 ) {
+		throw runtime_error( "Cannot decode a data stream component of unknown format." );
+	}
+	switch ( format ) {
+		case F_UINT_10_10_10_L1:
+		case F_NORMINT_10_10_10_L1:
+		case F_NORMINT_11_11_10:
+		case F_NORMINT_10_10_10_2:
+		case F_UINT_10_10_10_2:
+			return STORE_PACKED;
+		case F_NORMUINT8_4_BGRA:
+			return STORE_NORMUINT8;
+		default:
+			break;
+	}
+	if ( id > 0x38 ) {
+		throw runtime_error( "Cannot decode a data stream component of unknown format." );
+	}
+	return ComponentStorage( ( id - 1 ) / 4 );
+}
+
+template <class T>
+static T ReadRaw( const byte * p ) {
+	T v;
+	memcpy( &v, p, sizeof(T) );
+	return v;
+}
+
+//Converts each stored value, scaled, with a lower limit for the signed normalized formats
+template <class T>
+static void DecodeScaled( const byte * base, unsigned int stride, unsigned int count, unsigned int n, float scale, float lowest, float * out ) {
+	for ( unsigned int i = 0; i < count; ++i ) {
+		const byte * p = base + i * stride;
+		for ( unsigned int k = 0; k < n; ++k ) {
+			float v = float( ReadRaw<T>( p + k * sizeof(T) ) ) * scale;
+			*out++ = v < lowest ? lowest : v;
+		}
+	}
+}
+
+//Sign extends the low bits of a packed value
+static int SignExtend( unsigned int v, unsigned int bits ) {
+	unsigned int m = 1u << ( bits - 1 );
+	v &= ( 1u << bits ) - 1;
+	return int( v ^ m ) - int( m );
+}
+
+static float NormSigned( int v, unsigned int bits ) {
+	float f = float(v) / float( ( 1 << ( bits - 1 ) ) - 1 );
+	return f < -1.0f ? -1.0f : f;
+}
+
+static void DecodePacked( const byte * base, unsigned int stride, unsigned int count, ComponentFormat format, float * out ) {
+	for ( unsigned int i = 0; i < count; ++i ) {
+		unsigned int v = ReadRaw<unsigned int>( base + i * stride );
+		switch ( format ) {
+			case F_UINT_10_10_10_L1:
+			case F_UINT_10_10_10_2:
+				*out++ = float( v & 0x3FF );
+				*out++ = float( ( v >> 10 ) & 0x3FF );
+				*out++ = float( ( v >> 20 ) & 0x3FF );
+				if ( format == F_UINT_10_10_10_2 ) {
+					*out++ = float( v >> 30 );
+				}
+				break;
+			case F_NORMINT_10_10_10_L1:
+			case F_NORMINT_10_10_10_2:
+				*out++ = NormSigned( SignExtend( v, 10 ), 10 );
+				*out++ = NormSigned( SignExtend( v >> 10, 10 ), 10 );
+				*out++ = NormSigned( SignExtend( v >> 20, 10 ), 10 );
+				if ( format == F_NORMINT_10_10_10_2 ) {
+					*out++ = NormSigned( SignExtend( v >> 30, 2 ), 2 );
+				}
+				break;
+			case F_NORMINT_11_11_10:
+				*out++ = NormSigned( SignExtend( v, 11 ), 11 );
+				*out++ = NormSigned( SignExtend( v >> 11, 11 ), 11 );
+				*out++ = NormSigned( SignExtend( v >> 22, 10 ), 10 );
+				break;
+			default:
+				throw runtime_error( "Cannot decode a data stream component of unknown packed format." );
+		}
+	}
+}
+
+//Decodes count elements to GetComponentFormatValueCount( format ) floats each
+static void DecodeRange( const byte * base, unsigned int stride, unsigned int count, ComponentFormat format, float * out ) {
+	const unsigned int n = GetComponentFormatValueCount( format );
+	const float none = -3.402823466e+38f;
+	switch ( GetStorage( format ) ) {
+		case STORE_INT8: DecodeScaled<signed char>( base, stride, count, n, 1.0f, none, out ); break;
+		case STORE_UINT8: DecodeScaled<unsigned char>( base, stride, count, n, 1.0f, none, out ); break;
+		case STORE_NORMINT8: DecodeScaled<signed char>( base, stride, count, n, 1.0f / 127.0f, -1.0f, out ); break;
+		case STORE_NORMUINT8: DecodeScaled<unsigned char>( base, stride, count, n, 1.0f / 255.0f, none, out ); break;
+		case STORE_INT16: DecodeScaled<short>( base, stride, count, n, 1.0f, none, out ); break;
+		case STORE_UINT16: DecodeScaled<unsigned short>( base, stride, count, n, 1.0f, none, out ); break;
+		case STORE_NORMINT16: DecodeScaled<short>( base, stride, count, n, 1.0f / 32767.0f, -1.0f, out ); break;
+		case STORE_NORMUINT16: DecodeScaled<unsigned short>( base, stride, count, n, 1.0f / 65535.0f, none, out ); break;
+		case STORE_INT32: DecodeScaled<int>( base, stride, count, n, 1.0f, none, out ); break;
+		case STORE_UINT32: DecodeScaled<unsigned int>( base, stride, count, n, 1.0f, none, out ); break;
+		case STORE_NORMINT32: DecodeScaled<int>( base, stride, count, n, 1.0f / 2147483647.0f, -1.0f, out ); break;
+		case STORE_NORMUINT32: DecodeScaled<unsigned int>( base, stride, count, n, 1.0f / 4294967295.0f, none, out ); break;
+		case STORE_FLOAT16:
+			for ( unsigned int i = 0; i < count; ++i ) {
+				const byte * p = base + i * stride;
+				for ( unsigned int k = 0; k < n; ++k ) {
+					*out++ = HalfToFloat( ReadRaw<unsigned short>( p + 2 * k ) );
+				}
+			}
+			break;
+		case STORE_FLOAT32:
+			for ( unsigned int i = 0; i < count; ++i ) {
+				memcpy( out, base + i * stride, n * sizeof(float) );
+				out += n;
+			}
+			break;
+		case STORE_PACKED:
+			DecodePacked( base, stride, count, format, out );
+			break;
+	}
+}
+
+unsigned int GetComponentFormatSize( ComponentFormat format ) {
+	//The second byte is the size of one stored value, the third the number of stored values
+	return ( ( (unsigned int)(format) >> 8 ) & 0xFF ) * ( ( (unsigned int)(format) >> 16 ) & 0xFF );
+}
+
+unsigned int GetComponentFormatValueCount( ComponentFormat format ) {
+	switch ( format ) {
+		case F_UINT_10_10_10_L1:
+		case F_NORMINT_10_10_10_L1:
+		case F_NORMINT_11_11_10:
+			return 3;
+		case F_UINT_10_10_10_2:
+		case F_NORMINT_10_10_10_2:
+			return 4;
+		default:
+			return ( (unsigned int)(format) >> 16 ) & 0xFF;
+	}
+}
+
+DataStreamView::DataStreamView() : base(NULL), stride(0), count(0), format(F_UNKNOWN) {}
+
+DataStreamView::DataStreamView( const byte * base, unsigned int stride, unsigned int count, ComponentFormat format ) : base(base), stride(stride), count(count), format(format) {}
+
+unsigned int DataStreamView::Size() const {
+	return count;
+}
+
+ComponentFormat DataStreamView::GetFormat() const {
+	return format;
+}
+
+unsigned int DataStreamView::GetStride() const {
+	return stride;
+}
+
+unsigned int DataStreamView::GetValueCount() const {
+	return GetComponentFormatValueCount( format );
+}
+
+const byte * DataStreamView::GetElement( unsigned int i ) const {
+	if ( i >= count ) {
+		throw runtime_error( "Attempted to access a data stream element that is out of range." );
+	}
+	return base + i * stride;
+}
+
+float DataStreamView::GetFloat( unsigned int i, unsigned int value ) const {
+	float values[4];
+	if ( value >= GetValueCount() ) {
+		throw runtime_error( "Attempted to access a data stream value that is out of range." );
+	}
+	DecodeRange( GetElement( i ), stride, 1, format, values );
+	return values[value];
+}
+
+unsigned int DataStreamView::GetUInt( unsigned int i, unsigned int value ) const {
+	const byte * p = GetElement( i );
+	if ( value >= GetValueCount() ) {
+		throw runtime_error( "Attempted to access a data stream value that is out of range." );
+	}
+	//Integers are read exactly, since a float cannot hold every 32 bit index
+	switch ( GetStorage( format ) ) {
+		case STORE_UINT8: return ReadRaw<unsigned char>( p + value );
+		case STORE_UINT16: return ReadRaw<unsigned short>( p + 2 * value );
+		case STORE_UINT32: return ReadRaw<unsigned int>( p + 4 * value );
+		case STORE_INT8: return (unsigned int)( ReadRaw<signed char>( p + value ) );
+		case STORE_INT16: return (unsigned int)( ReadRaw<short>( p + 2 * value ) );
+		case STORE_INT32: return (unsigned int)( ReadRaw<int>( p + 4 * value ) );
+		default: return (unsigned int)( GetFloat( i, value ) );
+	}
+}
+
+Vector3 DataStreamView::GetVector3( unsigned int i ) const {
+	float v[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	DecodeRange( GetElement( i ), stride, 1, format, v );
+	return Vector3( v[0], v[1], v[2] );
+}
+
+TexCoord DataStreamView::GetTexCoord( unsigned int i ) const {
+	float v[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	DecodeRange( GetElement( i ), stride, 1, format, v );
+	return TexCoord( v[0], v[1] );
+}
+
+Color4 DataStreamView::GetColor4( unsigned int i ) const {
+	float v[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	DecodeRange( GetElement( i ), stride, 1, format, v );
+	if ( format == F_NORMUINT8_4_BGRA ) {
+		return Color4( v[2], v[1], v[0], v[3] );
+	}
+	return Color4( v[0], v[1], v[2], v[3] );
+}
+
+void DataStreamView::DecodeFloats( vector<float> & values ) const {
+	values.resize( count * GetValueCount() );
+	if ( count > 0 ) {
+		DecodeRange( base, stride, count, format, &values[0] );
+	}
+}
+
+void DataStreamView::DecodeUInts( vector<unsigned int> & values ) const {
+	const unsigned int n = GetValueCount();
+	values.resize( count * n );
+	for ( unsigned int i = 0; i < count; ++i ) {
+		for ( unsigned int k = 0; k < n; ++k ) {
+			values[i * n + k] = GetUInt( i, k );
+		}
+	}
+}
+
+void DataStreamView::DecodeVector3s( vector<Vector3> & values ) const {
+	const unsigned int n = GetValueCount();
+	vector<float> f;
+	DecodeFloats( f );
+	values.resize( count );
+	for ( unsigned int i = 0; i < count; ++i ) {
+		const float * v = &f[i * n];
+		values[i].Set( v[0], n > 1 ? v[1] : 0.0f, n > 2 ? v[2] : 0.0f );
+	}
+}
+
+void DataStreamView::DecodeTexCoords( vector<TexCoord> & values ) const {
+	const unsigned int n = GetValueCount();
+	vector<float> f;
+	DecodeFloats( f );
+	values.resize( count );
+	for ( unsigned int i = 0; i < count; ++i ) {
+		const float * v = &f[i * n];
+		values[i].Set( v[0], n > 1 ? v[1] : 0.0f );
+	}
+}
+
+} //End namespace Niflib
@@ -0,0 +1,688 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#include "../include/GeometryOptimizer.h"
+#include "../include/obj/NiTriShapeData.h"
+#include "../include/obj/NiTriStripsData.h"
+#include "../include/obj/NiSkinInstance.h"
+#include "../include/obj/NiSkinData.h"
+#include "../include/obj/NiSkinPartition.h"
+#include "../include/obj/NiGeomMorpherController.h"
+#include "../include/obj/NiMorphData.h"
+#include "../include/obj/NiTexturingProperty.h"
+#include "../include/obj/NiExtraData.h"
+#include "../include/obj/AbstractAdditionalGeometryData.h"
+#include "../include/gen/SkinWeight.h"
+#include "../include/gen/TexDesc.h"
+#include <algorithm>
+#include <cmath>
+#ifdef NIFLIB_CXX11
+#include <functional>
+#include <unordered_map>
+#endif
+
+using namespace Niflib;
+
+static const unsigned int REMOVED = 0xFFFFFFFF;
+static const char * TANGENT_SPACE_NAME = "Tangent space (binormal & tangent vectors)";
+
+//Everything that indexes the vertices of some geometry data
+struct GeometryParts {
+	NiTriBasedGeomDataRef data;
+	NiSkinDataRef skinData;
+	vector<NiSkinPartitionRef> partitions;
+	vector<NiMorphDataRef> morphs;
+	//The shapes whose tangent space extra data must be rebuilt
+	vector<NiTriBasedGeomRef> tangentShapes;
+	//The highest texture coordinate set a texture uses, or -1
+	int highestUVSet;
+};
+
+static void FindParts( const vector<NiTriBasedGeomRef> & shapes, GeometryParts & parts ) {
+	parts.data = DynamicCast<NiTriBasedGeomData>( shapes[0]->GetData() );
+	parts.highestUVSet = -1;
+	for ( unsigned int s = 0; s < shapes.size(); ++s ) {
+		NiTriBasedGeom * shape = shapes[s];
+		NiSkinInstanceRef skin = shape->GetSkinInstance();
+		if ( skin != NULL && skin->GetSkinData() != NULL ) {
+			parts.skinData = skin->GetSkinData();
+			NiSkinPartitionRef partitions[2] = { skin->GetSkinPartition(), parts.skinData->GetSkinPartition() };
+			for ( int k = 0; k < 2; ++k ) {
+				if ( partitions[k] != NULL && find( parts.partitions.begin(), parts.partitions.end(), partitions[k] ) == parts.partitions.end() ) {
+					parts.partitions.push_back( partitions[k] );
+				}
+			}
+		}
+		list<NiTimeControllerRef> controllers = shape->GetControllers();
+		for ( list<NiTimeControllerRef>::iterator it = controllers.begin(); it != controllers.end(); ++it ) {
+			NiGeomMorpherControllerRef morpher = DynamicCast<NiGeomMorpherController>( *it );
+			if ( morpher != NULL && morpher->GetData() != NULL && find( parts.morphs.begin(), parts.morphs.end(), morpher->GetData() ) == parts.morphs.end() ) {
+				parts.morphs.push_back( morpher->GetData() );
+			}
+		}
+		list<NiExtraDataRef> extras = shape->GetExtraData();
+		for ( list<NiExtraDataRef>::iterator it = extras.begin(); it != extras.end(); ++it ) {
+			if ( (*it)->GetName() == TANGENT_SPACE_NAME ) {
+				parts.tangentShapes.push_back( shape );
+				break;
+			}
+		}
+		const vector<NiPropertyRef> & properties = shape->GetProperties();
+		for ( unsigned int i = 0; i < properties.size(); ++i ) {
+			NiTexturingPropertyRef texturing = DynamicCast<NiTexturingProperty>( properties[i] );
+			if ( texturing == NULL ) {
+				continue;
+			}
+			for ( int n = BASE_MAP; n <= DECAL_3_MAP; ++n ) {
+				if ( texturing->HasTexture( n ) ) {
+					parts.highestUVSet = max( parts.highestUVSet, int( texturing->GetTexture( n ).uvSet ) );
+				}
+			}
+			for ( int n = 0; n < texturing->GetShaderTextureCount(); ++n ) {
+				parts.highestUVSet = max( parts.highestUVSet, int( texturing->GetShaderTexture( n ).uvSet ) );
+			}
+		}
+	}
+}
+
+//The size of everything that is indexed by vertex, as written to a file
+static unsigned int PartsBytes( const GeometryParts & parts ) {
+	NiTriBasedGeomData * data = parts.data;
+	const unsigned int nv = (unsigned int)(data->GetVertices().size());
+	unsigned int bytes = nv * 12;
+	bytes += (unsigned int)(data->GetNormals().size()) * 12;
+	bytes += (unsigned int)(data->GetColors().size()) * 16;
+	bytes += (unsigned int)(data->GetTangents().size() + data->GetBitangents().size()) * 12;
+	bytes += (unsigned int)(data->GetUVSetCount()) * nv * 8;
+	NiTriStripsDataRef strips = DynamicCast<NiTriStripsData>( parts.data );
+	if ( strips != NULL ) {
+		for ( unsigned int i = 0; i < strips->GetStripCount(); ++i ) {
+			bytes += (unsigned int)(strips->GetStrip( i ).size()) * 2;
+		}
+	} else {
+		bytes += (unsigned int)(data->GetTriangles().size()) * 6;
+	}
+	if ( parts.skinData != NULL ) {
+		for ( unsigned int b = 0; b < parts.skinData->GetBoneCount(); ++b ) {
+			bytes += (unsigned int)(parts.skinData->GetBoneWeights( b ).size()) * 6;
+		}
+	}
+	for ( unsigned int p = 0; p < parts.partitions.size(); ++p ) {
+		NiSkinPartition * partition = parts.partitions[p];
+		for ( int i = 0; i < partition->GetNumPartitions(); ++i ) {
+			unsigned int perVertex = 2;
+			if ( partition->HasVertexWeights( i ) ) perVertex += 4 * partition->GetWeightsPerVertex( i );
+			if ( partition->HasVertexBoneIndices( i ) ) perVertex += partition->GetWeightsPerVertex( i );
+			bytes += perVertex * partition->GetNumVertices( i );
+			if ( partition->GetStripCount( i ) > 0 ) {
+				for ( unsigned int s = 0; s < partition->GetStripCount( i ); ++s ) {
+					bytes += (unsigned int)(partition->GetStrip( i, s ).size()) * 2;
+				}
+			} else {
+				bytes += (unsigned int)(partition->GetTriangles( i ).size()) * 6;
+			}
+		}
+	}
+	for ( unsigned int m = 0; m < parts.morphs.size(); ++m ) {
+		bytes += parts.morphs[m]->GetMorphCount() * parts.morphs[m]->GetVertexCount() * 12;
+	}
+	bytes += (unsigned int)(parts.tangentShapes.size()) * nv * 24;
+	return bytes;
+}
+
+//A cell of the grid that welding searches
+struct CellKey {
+	double x, y, z;
+	bool operator<( const CellKey & rh ) const {
+		if ( x != rh.x ) return x < rh.x;
+		if ( y != rh.y ) return y < rh.y;
+		return z < rh.z;
+	}
+	bool operator==( const CellKey & rh ) const {
+		return x == rh.x && y == rh.y && z == rh.z;
+	}
+};
+
+#ifdef NIFLIB_CXX11
+struct CellKeyHash {
+	size_t operator()( const CellKey & key ) const {
+		std::hash<double> h;
+		size_t seed = h( key.x );
+		seed ^= h( key.y ) + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 );
+		seed ^= h( key.z ) + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 );
+		return seed;
+	}
+};
+#else
+struct CellEntry {
+	CellKey key;
+	unsigned int index;
+	bool operator<( const CellEntry & rh ) const {
+		return key < rh.key;
+	}
+};
+#endif
+
+static CellKey CellOf( const Vector3 & p, float tolerance ) {
+	CellKey key;
+	if ( tolerance > 0.0f ) {
+		key.x = floor( p.x / tolerance );
+		key.y = floor( p.y / tolerance );
+		key.z = floor( p.z / tolerance );
+	} else {
+		//Without a tolerance only equal positions meet, so the position is the cell
+		key.x = p.x;
+		key.y = p.y;
+		key.z = p.z;
+	}
+	return key;
+}
+
+//The vertices of the welding grid, placed so that the vertices of each cell
+//are one run.  With NIFLIB_CXX11 the cells are numbered in a hash table and
+//the runs are placed with a counting sort, so that finding a cell costs no
+//binary search.  Otherwise the vertices are sorted by cell.
+class CellIndex {
+public:
+	CellIndex( const vector<Vector3> & verts, float tolerance ) {
+		const unsigned int nv = (unsigned int)(verts.size());
+#ifdef NIFLIB_CXX11
+		vector<unsigned int> cellOf( nv );
+		ids.reserve( nv );
+		for ( unsigned int i = 0; i < nv; ++i ) {
+			cellOf[i] = ids.insert( Ids::value_type( CellOf( verts[i], tolerance ), (unsigned int)(ids.size()) ) ).first->second;
+		}
+		starts.assign( ids.size() + 1, 0 );
+		for ( unsigned int i = 0; i < nv; ++i ) {
+			++starts[cellOf[i] + 1];
+		}
+		for ( unsigned int c = 0; c < ids.size(); ++c ) {
+			starts[c + 1] += starts[c];
+		}
+		vector<unsigned int> next( starts.begin(), starts.end() - 1 );
+		order.resize( nv );
+		for ( unsigned int i = 0; i < nv; ++i ) {
+			order[next[cellOf[i]]++] = i;
+		}
+#else
+		cells.resize( nv );
+		for ( unsigned int i = 0; i < nv; ++i ) {
+			cells[i].key = CellOf( verts[i], tolerance );
+			cells[i].index = i;
+		}
+		sort( cells.begin(), cells.end() );
+#endif
+	}
+
+	//Finds the run of a cell, which is empty if no vertex is in it
+	pair<unsigned int, unsigned int> Find( const CellKey & key ) const {
+#ifdef NIFLIB_CXX11
+		Ids::const_iterator it = ids.find( key );
+		if ( it == ids.end() ) {
+			return pair<unsigned int, unsigned int>( 0, 0 );
+		}
+		return pair<unsigned int, unsigned int>( starts[it->second], starts[it->second + 1] );
+#else
+		CellEntry probe;
+		probe.key = key;
+		pair<vector<CellEntry>::const_iterator, vector<CellEntry>::const_iterator> range = equal_range( cells.begin(), cells.end(), probe );
+		return pair<unsigned int, unsigned int>( (unsigned int)(range.first - cells.begin()), (unsigned int)(range.second - cells.begin()) );
+#endif
+	}
+
+	//Retrieves the vertex at a place in the runs
+	unsigned int Vertex( unsigned int k ) const {
+#ifdef NIFLIB_CXX11
+		return order[k];
+#else
+		return cells[k].index;
+#endif
+	}
+
+private:
+#ifdef NIFLIB_CXX11
+	typedef std::unordered_map<CellKey, unsigned int, CellKeyHash> Ids;
+	Ids ids;
+	vector<unsigned int> starts;
+	vector<unsigned int> order;
+#else
+	vector<CellEntry> cells;
+#endif
+};
+
+//Welds each vertex to the first vertex close enough with the same attributes, and returns that vertex for each
+static vector<unsigned int> WeldVertices( const GeometryParts & parts, float tolerance, float attribute_tolerance ) {
+	NiTriBasedGeomData * data = parts.data;
+	const vector<Vector3> & verts = data->GetVertices();
+	const unsigned int nv = (unsigned int)(verts.size());
+
+	//Every other attribute of a vertex, as one row of floats
+	vector<float> attributes;
+	unsigned int size = 0;
+	vector<const vector<Vector3> *> vectors;
+	vector<Vector3> tangents = data->GetTangents(), bitangents = data->GetBitangents();
+	vector< vector<Vector3> > morphVerts;
+	for ( unsigned int m = 0; m < parts.morphs.size(); ++m ) {
+		for ( int i = 0; i < parts.morphs[m]->GetMorphCount(); ++i ) {
+			morphVerts.push_back( parts.morphs[m]->GetMorphVerts( i ) );
+		}
+	}
+	if ( data->GetNormals().size() == nv ) vectors.push_back( &data->GetNormals() );
+	if ( tangents.size() == nv ) vectors.push_back( &tangents );
+	if ( bitangents.size() == nv ) vectors.push_back( &bitangents );
+	for ( unsigned int i = 0; i < morphVerts.size(); ++i ) {
+		if ( morphVerts[i].size() == nv ) vectors.push_back( &morphVerts[i] );
+	}
+	const bool hasColors = data->GetColors().size() == nv;
+	const int uvSets = data->GetUVSetCount();
+	size = 3 * (unsigned int)(vectors.size()) + ( hasColors ? 4 : 0 ) + 2 * uvSets;
+	attributes.resize( nv * size );
+	for ( unsigned int i = 0; i < nv; ++i ) {
+		float * a = size > 0 ? &attributes[i * size] : NULL;
+		for ( unsigned int k = 0; k < vectors.size(); ++k ) {
+			const Vector3 & v = (*vectors[k])[i];
+			*a++ = v.x; *a++ = v.y; *a++ = v.z;
+		}
+		if ( hasColors ) {
+			const Color4 & c = data->GetColors()[i];
+			*a++ = c.r; *a++ = c.g; *a++ = c.b; *a++ = c.a;
+		}
+		for ( int s = 0; s < uvSets; ++s ) {
+			const TexCoord & uv = data->GetUVSet( s )[i];
+			*a++ = uv.u; *a++ = uv.v;
+		}
+	}
+	vector< vector< pair<unsigned int, float> > > boneWeights( nv );
+	if ( parts.skinData != NULL ) {
+		for ( unsigned int b = 0; b < parts.skinData->GetBoneCount(); ++b ) {
+			const vector<SkinWeight> & weights = parts.skinData->GetBoneWeights( b );
+			for ( unsigned int i = 0; i < weights.size(); ++i ) {
+				if ( weights[i].index < nv ) {
+					boneWeights[weights[i].index].push_back( pair<unsigned int, float>( b, weights[i].weight ) );
+				}
+			}
+		}
+	}
+
+	const CellIndex cells( verts, tolerance );
+
+	vector<unsigned int> weld( nv, REMOVED );
+	const int reach = tolerance > 0.0f ? 1 : 0;
+	const float tolerance2 = tolerance * tolerance;
+	for ( unsigned int i = 0; i < nv; ++i ) {
+		if ( weld[i] != REMOVED ) {
+			continue;
+		}
+		weld[i] = i;
+		const CellKey home = CellOf( verts[i], tolerance );
+		for ( int dx = -reach; dx <= reach; ++dx ) {
+			for ( int dy = -reach; dy <= reach; ++dy ) {
+				for ( int dz = -reach; dz <= reach; ++dz ) {
+					CellKey key;
+					key.x = home.x + dx;
+					key.y = home.y + dy;
+					key.z = home.z + dz;
+					pair<unsigned int, unsigned int> range = cells.Find( key );
+					for ( unsigned int k = range.first; k < range.second; ++k ) {
+						const unsigned int j = cells.Vertex( k );
+						if ( j <= i || weld[j] != REMOVED ) {
+							continue;
+						}
+						Vector3 d = verts[j] - verts[i];
+						if ( d.DotProduct( d ) > tolerance2 ) {
+							continue;
+						}
+						bool same = boneWeights[i].size() == boneWeights[j].size();
+						for ( unsigned int k = 0; same && k < size; ++k ) {
+							same = fabs( attributes[i * size + k] - attributes[j * size + k] ) <= attribute_tolerance;
+						}
+						for ( unsigned int k = 0; same && k < boneWeights[i].size(); ++k ) {
+							same = boneWeights[i][k].first == boneWeights[j][k].first && fabs( boneWeights[i][k].second - boneWeights[j][k].second ) <= attribute_tolerance;
+						}
+						if ( same ) {
+							weld[j] = i;
+						}
+					}
+				}
+			}
+		}
+	}
+	return weld;
+}
+
+template <class T>
+static vector<T> Compact( const vector<T> & in, const vector<unsigned int> & keep ) {
+	vector<T> out( keep.size() );
+	for ( unsigned int i = 0; i < keep.size(); ++i ) {
+		out[i] = in[keep[i]];
+	}
+	return out;
+}
+
+//Reindexes the partitions of a skin, merging the local vertices that now share a vertex
+static void RemapPartition( NiSkinPartition * partition, const vector<unsigned int> & remap ) {
+	for ( int p = 0; p < partition->GetNumPartitions(); ++p ) {
+		vector<unsigned short> vertexMap = partition->GetVertexMap( p );
+		const bool hasWeights = partition->HasVertexWeights( p );
+		const bool hasBones = partition->HasVertexBoneIndices( p );
+		vector<unsigned short> newMap;
+		vector< vector<float> > weights;
+		vector< vector<unsigned short> > bones;
+		vector<unsigned int> local( vertexMap.size(), REMOVED );
+		map<unsigned int, unsigned int> localOf;
+		for ( unsigned int l = 0; l < vertexMap.size(); ++l ) {
+			const unsigned int v = vertexMap[l] < remap.size() ? remap[vertexMap[l]] : REMOVED;
+			if ( v == REMOVED ) {
+				continue;
+			}
+			map<unsigned int, unsigned int>::iterator found = localOf.find( v );
+			if ( found != localOf.end() ) {
+				local[l] = found->second;
+				continue;
+			}
+			local[l] = localOf[v] = (unsigned int)(newMap.size());
+			newMap.push_back( (unsigned short)(v) );
+			if ( hasWeights ) weights.push_back( partition->GetVertexWeights( p, l ) );
+			if ( hasBones ) bones.push_back( partition->GetVertexBoneIndices( p, l ) );
+		}
+
+		const unsigned short strips = partition->GetStripCount( p );
+		vector< vector<unsigned short> > newStrips( strips );
+		for ( unsigned short s = 0; s < strips; ++s ) {
+			newStrips[s] = partition->GetStrip( p, s );
+			for ( unsigned int k = 0; k < newStrips[s].size(); ++k ) {
+				newStrips[s][k] = (unsigned short)(local[newStrips[s][k]]);
+			}
+		}
+		vector<Triangle> tris;
+		if ( strips == 0 ) {
+			tris = partition->GetTriangles( p );
+			unsigned int kept = 0;
+			for ( unsigned int t = 0; t < tris.size(); ++t ) {
+				const unsigned int a = local[tris[t].v1], b = local[tris[t].v2], c = local[tris[t].v3];
+				if ( a != REMOVED && b != REMOVED && c != REMOVED && a != b && b != c && c != a ) {
+					tris[kept++] = Triangle( (unsigned short)(a), (unsigned short)(b), (unsigned short)(c) );
+				}
+			}
+			tris.resize( kept );
+		}
+
+		partition->SetVertexMap( p, newMap );
+		partition->EnableVertexWeights( p, hasWeights );
+		partition->EnableVertexBoneIndices( p, hasBones );
+		for ( unsigned int l = 0; l < newMap.size(); ++l ) {
+			if ( hasWeights ) partition->SetVertexWeights( p, l, weights[l] );
+			if ( hasBones ) partition->SetVertexBoneIndices( p, l, bones[l] );
+		}
+		if ( strips > 0 ) {
+			for ( unsigned short s = 0; s < strips; ++s ) {
+				partition->SetStrip( p, s, newStrips[s] );
+			}
+		} else {
+			partition->SetTriangles( p, tris );
+		}
+	}
+}
+
+static GeometryOptimizeResult Optimize( const vector<NiTriBasedGeomRef> & shapes, float tolerance, float attribute_tolerance ) {
+	GeometryOptimizeResult result;
+	GeometryParts parts;
+	FindParts( shapes, parts );
+	NiTriBasedGeomData * data = parts.data;
+	if ( data == NULL || data->GetAdditionalData() != NULL ) {
+		return result;
+	}
+	NiTriShapeDataRef shapeData = DynamicCast<NiTriShapeData>( parts.data );
+	NiTriStripsDataRef stripsData = DynamicCast<NiTriStripsData>( parts.data );
+	if ( shapeData == NULL && stripsData == NULL ) {
+		throw runtime_error( "Only NiTriShapeData and NiTriStripsData can be optimized." );
+	}
+	const unsigned int nv = (unsigned int)(data->GetVertices().size());
+	const unsigned int bytesBefore = PartsBytes( parts );
+
+	//Weld, and find the vertices that the remaining faces use
+	vector<unsigned int> weld = WeldVertices( parts, tolerance, attribute_tolerance );
+	vector<bool> used( nv, false );
+	vector<Triangle> tris;
+	vector< vector<unsigned short> > strips;
+	if ( stripsData != NULL ) {
+		strips.resize( stripsData->GetStripCount() );
+		for ( unsigned int s = 0; s < strips.size(); ++s ) {
+			strips[s] = stripsData->GetStrip( s );
+			for ( unsigned int k = 0; k < strips[s].size(); ++k ) {
+				if ( strips[s][k] < nv ) {
+					strips[s][k] = (unsigned short)(weld[strips[s][k]]);
+					used[strips[s][k]] = true;
+				}
+			}
+		}
+	} else {
+		tris = shapeData->GetTriangles();
+		unsigned int kept = 0;
+		for ( unsigned int t = 0; t < tris.size(); ++t ) {
+			Triangle tri = tris[t];
+			if ( tri.v1 >= nv || tri.v2 >= nv || tri.v3 >= nv ) {
+				continue;
+			}
+			tri.v1 = (unsigned short)(weld[tri.v1]);
+			tri.v2 = (unsigned short)(weld[tri.v2]);
+			tri.v3 = (unsigned short)(weld[tri.v3]);
+			if ( tri.v1 == tri.v2 || tri.v2 == tri.v3 || tri.v3 == tri.v1 ) {
+				++result.degenerateTriangles;
+				continue;
+			}
+			used[tri.v1] = used[tri.v2] = used[tri.v3] = true;
+			tris[kept++] = tri;
+		}
+		tris.resize( kept );
+	}
+	//Partition strips may use vertices for joins that no triangle of the data uses
+	for ( unsigned int i = 0; i < parts.partitions.size(); ++i ) {
+		NiSkinPartition * partition = parts.partitions[i];
+		for ( int p = 0; p < partition->GetNumPartitions(); ++p ) {
+			vector<unsigned short> vertexMap = partition->GetVertexMap( p );
+			for ( unsigned short s = 0; s < partition->GetStripCount( p ); ++s ) {
+				vector<unsigned short> strip = partition->GetStrip( p, s );
+				for ( unsigned int k = 0; k < strip.size(); ++k ) {
+					if ( strip[k] < vertexMap.size() && vertexMap[strip[k]] < nv ) {
+						used[weld[vertexMap[strip[k]]]] = true;
+					}
+				}
+			}
+		}
+	}
+
+	//Number the vertices that remain
+	vector<unsigned int> remap( nv, REMOVED );
+	vector<unsigned int> keep;
+	for ( unsigned int i = 0; i < nv; ++i ) {
+		if ( weld[i] != i ) {
+			++result.weldedVertices;
+		} else if ( !used[i] ) {
+			++result.unusedVertices;
+		} else {
+			remap[i] = (unsigned int)(keep.size());
+			keep.push_back( i );
+		}
+	}
+	for ( unsigned int i = 0; i < nv; ++i ) {
+		remap[i] = remap[weld[i]];
+	}
+
+	//Find the texture coordinate sets that repeat an earlier set and that no texture needs
+	vector<int> uvSets;
+	for ( int s = 0; s < data->GetUVSetCount(); ++s ) {
+		bool duplicate = false;
+		for ( unsigned int k = 0; k < uvSets.size() && !duplicate && s > parts.highestUVSet; ++k ) {
+			const vector<TexCoord> & a = data->GetUVSet( s );
+			const vector<TexCoord> & b = data->GetUVSet( uvSets[k] );
+			duplicate = true;
+			for ( unsigned int i = 0; i < a.size() && duplicate; ++i ) {
+				duplicate = a[i].u == b[i].u && a[i].v == b[i].v;
+			}
+		}
+		if ( duplicate ) {
+			++result.duplicateUVSets;
+		} else {
+			uvSets.push_back( s );
+		}
+	}
+	if ( keep.size() == nv && result.degenerateTriangles == 0 && result.duplicateUVSets == 0 ) {
+		return result;
+	}
+
+	//Compact the data
+	vector<Vector3> normals = data->GetNormals();
+	vector<Color4> colors = data->GetColors();
+	vector<Vector3> tangents = data->GetTangents(), bitangents = data->GetBitangents();
+	vector<int> vertexIndices = data->GetVertexIndices();
+	vector< vector<TexCoord> > uvs( uvSets.size() );
+	for ( unsigned int s = 0; s < uvSets.size(); ++s ) {
+		uvs[s] = Compact( data->GetUVSet( uvSets[s] ), keep );
+	}
+	data->SetVertices( Compact( data->GetVertices(), keep ) );
+	if ( normals.size() == nv ) data->SetNormals( Compact( normals, keep ) );
+	if ( colors.size() == nv ) data->SetVertexColors( Compact( colors, keep ) );
+	if ( tangents.size() == nv ) data->SetTangents( Compact( tangents, keep ) );
+	if ( bitangents.size() == nv ) data->SetBitangents( Compact( bitangents, keep ) );
+	if ( vertexIndices.size() == nv ) data->SetVertexIndices( Compact( vertexIndices, keep ) );
+	data->SetUVSetCount( (int)(uvs.size()) );
+	for ( unsigned int s = 0; s < uvs.size(); ++s ) {
+		data->SwapUVSet( s, uvs[s] );
+	}
+
+	//Reindex the faces
+	if ( stripsData != NULL ) {
+		for ( unsigned int s = 0; s < strips.size(); ++s ) {
+			for ( unsigned int k = 0; k < strips[s].size(); ++k ) {
+				strips[s][k] = (unsigned short)(remap[strips[s][k]]);
+			}
+			stripsData->SwapStrip( s, strips[s] );
+		}
+	} else {
+		for ( unsigned int t = 0; t < tris.size(); ++t ) {
+			tris[t].v1 = (unsigned short)(remap[tris[t].v1]);
+			tris[t].v2 = (unsigned short)(remap[tris[t].v2]);
+			tris[t].v3 = (unsigned short)(remap[tris[t].v3]);
+		}
+		const bool matchData = shapeData->HasMatchData();
+		shapeData->SetTriangles( tris );
+		if ( matchData ) {
+			shapeData->DoMatchDetection();
+		}
+	}
+
+	//The welded vertices had the same weights and morphs as the vertex they were welded to
+	if ( parts.skinData != NULL ) {
+		for ( unsigned int b = 0; b < parts.skinData->GetBoneCount(); ++b ) {
+			vector<SkinWeight> weights = parts.skinData->GetBoneWeights( b );
+			unsigned int kept = 0;
+			for ( unsigned int i = 0; i < weights.size(); ++i ) {
+				const unsigned int v = weights[i].index;
+				if ( v < nv && weld[v] == v && remap[v] != REMOVED ) {
+					weights[kept] = weights[i];
+					weights[kept++].index = (unsigned short)(remap[v]);
+				}
+			}
+			weights.resize( kept );
+			parts.skinData->SwapBoneWeights( b, weights );
+		}
+	}
+	for ( unsigned int i = 0; i < parts.partitions.size(); ++i ) {
+		RemapPartition( parts.partitions[i], remap );
+	}
+	for ( unsigned int m = 0; m < parts.morphs.size(); ++m ) {
+		NiMorphData * morph = parts.morphs[m];
+		if ( morph->GetVertexCount() != int(nv) ) {
+			continue;
+		}
+		vector< vector<Vector3> > targets( morph->GetMorphCount() );
+		for ( unsigned int i = 0; i < targets.size(); ++i ) {
+			targets[i] = Compact( morph->GetMorphVerts( i ), keep );
+		}
+		morph->SetVertexCount( (int)(keep.size()) );
+		for ( unsigned int i = 0; i < targets.size(); ++i ) {
+			morph->SetMorphVerts( i, targets[i] );
+		}
+	}
+	for ( unsigned int i = 0; i < parts.tangentShapes.size(); ++i ) {
+		parts.tangentShapes[i]->UpdateTangentSpace();
+	}
+
+	const unsigned int bytesAfter = PartsBytes( parts );
+	result.bytesSaved = bytesBefore > bytesAfter ? bytesBefore - bytesAfter : 0;
+	return result;
+}
+
+//Lists the shapes below a node by the data they use
+static void CollectShapes( NiNode * node, map<NiGeometryData *, vector<NiTriBasedGeomRef> > & shapes, vector<NiGeometryData *> & order ) {
+	const vector<NiAVObjectRef> & children = node->GetChildren();
+	for ( unsigned int i = 0; i < children.size(); ++i ) {
+		NiNodeRef child = DynamicCast<NiNode>( children[i] );
+		if ( child != NULL ) {
+			CollectShapes( child, shapes, order );
+			continue;
+		}
+		NiTriBasedGeomRef geom = DynamicCast<NiTriBasedGeom>( children[i] );
+		if ( geom == NULL || geom->GetData() == NULL ) {
+			continue;
+		}
+		NiGeometryData * data = geom->GetData();
+		vector<NiTriBasedGeomRef> & users = shapes[data];
+		if ( users.empty() ) {
+			order.push_back( data );
+		}
+		if ( find( users.begin(), users.end(), geom ) == users.end() ) {
+			users.push_back( geom );
+		}
+	}
+}
+
+namespace Niflib {
+
+GeometryOptimizeResult::GeometryOptimizeResult() : weldedVertices(0), unusedVertices(0), degenerateTriangles(0), duplicateUVSets(0), bytesSaved(0) {}
+
+GeometryOptimizeResult & GeometryOptimizeResult::operator+=( const GeometryOptimizeResult & rh ) {
+	weldedVertices += rh.weldedVertices;
+	unusedVertices += rh.unusedVertices;
+	degenerateTriangles += rh.degenerateTriangles;
+	duplicateUVSets += rh.duplicateUVSets;
+	bytesSaved += rh.bytesSaved;
+	return *this;
+}
+
+GeometryOptimizeResult OptimizeGeometry( NiTriBasedGeom * shape, float tolerance, float attribute_tolerance ) {
+	if ( shape == NULL || shape->GetData() == NULL ) {
+		throw runtime_error( "Attempted to optimize a shape without data." );
+	}
+	vector<NiTriBasedGeomRef> shapes( 1, NiTriBasedGeomRef( shape ) );
+	return Optimize( shapes, tolerance, attribute_tolerance );
+}
+
+GeometryOptimizeResult OptimizeSceneGeometry( NiNode * root, float tolerance, float attribute_tolerance ) {
+	GeometryOptimizeResult result;
+	if ( root == NULL ) {
+		return result;
+	}
+	map<NiGeometryData *, vector<NiTriBasedGeomRef> > shapes;
+	vector<NiGeometryData *> order;
+	CollectShapes( root, shapes, order );
+	for ( unsigned int i = 0; i < order.size(); ++i ) {
+		const vector<NiTriBasedGeomRef> & users = shapes[order[i]];
+		if ( DynamicCast<NiTriShapeData>( order[i] ) == NULL && DynamicCast<NiTriStripsData>( order[i] ) == NULL ) {
+			continue;
+		}
+		bool independent = true;
+		for ( unsigned int k = 0; k < users.size() && users.size() > 1; ++k ) {
+			GeometryParts parts;
+			FindParts( vector<NiTriBasedGeomRef>( 1, users[k] ), parts );
+			independent = independent && parts.skinData == NULL && parts.morphs.empty();
+		}
+		if ( independent ) {
+			result += Optimize( users, tolerance, attribute_tolerance );
+		}
+	}
+	return result;
+}
+
+} //End namespace Niflib
@@ -0,0 +1,643 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#include "../include/MeshConverter.h"
+#include "../include/obj/NiTriBasedGeomData.h"
+#include "../include/obj/NiTriShapeData.h"
+#include "../include/obj/NiSkinInstance.h"
+#include "../include/obj/NiSkinData.h"
+#include "../include/obj/NiSkinPartition.h"
+#include "../include/obj/NiSkinningMeshModifier.h"
+#include "../include/obj/NiDataStream.h"
+#include "../include/obj/NiProperty.h"
+#include "../include/obj/NiExtraData.h"
+#include "../include/obj/NiTimeController.h"
+#include "../include/obj/NiCollisionObject.h"
+#include "../include/gen/SkinWeight.h"
+
+using namespace Niflib;
+
+//The vertex data of the geometry being converted
+struct GeometrySource {
+	vector<Vector3> vertices;
+	vector<Vector3> normals;
+	vector<Color4> colors;
+	vector< vector<TexCoord> > uvSets;
+};
+
+//One submesh, as indices into the geometry vertices
+struct SubmeshSource {
+	/*! The geometry vertex of each submesh vertex. */
+	vector<unsigned int> vertices;
+	/*! The triangles, in submesh vertices. */
+	vector<Triangle> triangles;
+	/*! The skin bone of each bone palette entry. */
+	vector<unsigned short> bones;
+	/*! Four weights per submesh vertex. */
+	vector<float> weights;
+	/*! Four bone palette indices per submesh vertex. */
+	vector<unsigned short> boneIndices;
+};
+
+enum VertexComponentKind {
+	VC_POSITION, VC_NORMAL, VC_COLOR, VC_TEXCOORD, VC_BLENDWEIGHT, VC_BLENDINDICES
+};
+
+struct VertexComponent {
+	VertexComponentKind kind;
+	const char * semantic;
+	unsigned int index;
+	ComponentFormat format;
+};
+
+static VertexComponent MakeComponent( VertexComponentKind kind, const char * semantic, unsigned int index, ComponentFormat format ) {
+	VertexComponent c;
+	c.kind = kind;
+	c.semantic = semantic;
+	c.index = index;
+	c.format = format;
+	return c;
+}
+
+template <class T>
+static void AppendRaw( vector<Niflib::byte> & bytes, const T & value ) {
+	const Niflib::byte * p = reinterpret_cast<const Niflib::byte *>( &value );
+	bytes.insert( bytes.end(), p, p + sizeof(T) );
+}
+
+static void AppendVertex( vector<Niflib::byte> & bytes, const VertexComponent & c, const GeometrySource & geo, const SubmeshSource & sub, unsigned int k ) {
+	const unsigned int v = sub.vertices[k];
+	switch ( c.kind ) {
+		case VC_POSITION:
+			AppendRaw( bytes, geo.vertices[v].x );
+			AppendRaw( bytes, geo.vertices[v].y );
+			AppendRaw( bytes, geo.vertices[v].z );
+			break;
+		case VC_NORMAL:
+			AppendRaw( bytes, geo.normals[v].x );
+			AppendRaw( bytes, geo.normals[v].y );
+			AppendRaw( bytes, geo.normals[v].z );
+			break;
+		case VC_COLOR:
+			AppendRaw( bytes, geo.colors[v].r );
+			AppendRaw( bytes, geo.colors[v].g );
+			AppendRaw( bytes, geo.colors[v].b );
+			AppendRaw( bytes, geo.colors[v].a );
+			break;
+		case VC_TEXCOORD:
+			AppendRaw( bytes, geo.uvSets[c.index][v].u );
+			AppendRaw( bytes, geo.uvSets[c.index][v].v );
+			break;
+		case VC_BLENDWEIGHT:
+			for ( unsigned int j = 0; j < 4; ++j ) {
+				AppendRaw( bytes, sub.weights[4 * k + j] );
+			}
+			break;
+		case VC_BLENDINDICES:
+			for ( unsigned int j = 0; j < 4; ++j ) {
+				if ( c.format == F_UINT8_4 ) {
+					AppendRaw( bytes, (unsigned char)( sub.boneIndices[4 * k + j] ) );
+				} else {
+					AppendRaw( bytes, sub.boneIndices[4 * k + j] );
+				}
+			}
+			break;
+	}
+}
+
+static NiDataStreamRef MakeStream( DataStreamUsage usage, const vector<ComponentFormat> & formats, const vector<Niflib::byte> & bytes, const vector<Region> & regions ) {
+	NiDataStreamRef stream = new NiDataStream;
+	stream->SetUsage( usage );
+	stream->SetAccess( DataStreamAccess( CPU_WRITE_STATIC | GPU_READ ) );
+	stream->SetData( formats, bytes );
+	stream->SetRegions( regions );
+	return stream;
+}
+
+static MeshData MakeMeshData( NiDataStream * stream, const vector<SemanticData> & semantics, unsigned int submeshes ) {
+	MeshData md;
+	md.stream = stream;
+	md.isPerInstance = false;
+	for ( unsigned int s = 0; s < submeshes; ++s ) {
+		md.submeshToRegionMap.push_back( (unsigned short)(s) );
+	}
+	md.componentSemantics = semantics;
+	return md;
+}
+
+static SemanticData MakeSemantic( const char * name, unsigned int index ) {
+	SemanticData sem;
+	sem.name = name;
+	sem.index = index;
+	return sem;
+}
+
+//Builds one vertex stream holding a set of components for every submesh
+static MeshData MakeVertexData( const vector<VertexComponent> & comps, const GeometrySource & geo, const vector<SubmeshSource> & subs, const vector<Region> & regions ) {
+	vector<ComponentFormat> formats;
+	vector<SemanticData> semantics;
+	unsigned int stride = 0;
+	for ( unsigned int c = 0; c < comps.size(); ++c ) {
+		formats.push_back( comps[c].format );
+		semantics.push_back( MakeSemantic( comps[c].semantic, comps[c].index ) );
+		stride += GetComponentFormatSize( comps[c].format );
+	}
+	vector<Niflib::byte> bytes;
+	if ( !regions.empty() ) {
+		bytes.reserve( stride * ( regions.back().startIndex + regions.back().numIndices ) );
+	}
+	for ( unsigned int s = 0; s < subs.size(); ++s ) {
+		for ( unsigned int k = 0; k < subs[s].vertices.size(); ++k ) {
+			for ( unsigned int c = 0; c < comps.size(); ++c ) {
+				AppendVertex( bytes, comps[c], geo, subs[s], k );
+			}
+		}
+	}
+	return MakeMeshData( MakeStream( USAGE_VERTEX, formats, bytes, regions ), semantics, (unsigned int)(subs.size()) );
+}
+
+//Keeps the four largest influences of each vertex
+static void AddInfluence( SubmeshSource & sub, unsigned int k, unsigned short bone, float weight ) {
+	unsigned int slot = 4;
+	float smallest = weight;
+	for ( unsigned int j = 0; j < 4; ++j ) {
+		if ( sub.weights[4 * k + j] < smallest ) {
+			smallest = sub.weights[4 * k + j];
+			slot = j;
+		}
+	}
+	if ( slot < 4 ) {
+		sub.weights[4 * k + slot] = weight;
+		sub.boneIndices[4 * k + slot] = bone;
+	}
+}
+
+static SkinTransform ToSkinTransform( const Matrix44 & m ) {
+	SkinTransform t;
+	m.Decompose( t.translation, t.rotation, t.scale );
+	return t;
+}
+
+//Gives a converted object the properties of the original and takes over its
+//extra data, controllers and collision object, which belong to one object only
+static void TransferObjectState( NiAVObject * from, NiAVObject * to ) {
+	to->SetName( from->GetName() );
+	to->SetFlags( from->GetFlags() );
+	to->SetLocalTransform( from->GetLocalTransform() );
+	const vector<NiPropertyRef> & properties = from->GetProperties();
+	for ( unsigned int i = 0; i < properties.size(); ++i ) {
+		to->AddProperty( properties[i] );
+	}
+
+	list<NiExtraDataRef> extras = from->GetExtraData();
+	from->ClearExtraData();
+	for ( list<NiExtraDataRef>::iterator it = extras.begin(); it != extras.end(); ++it ) {
+		(*it)->SetNextExtraData( NULL );
+		to->AddExtraData( *it );
+	}
+
+	//AddController inserts at the front, so add them back to front
+	list<NiTimeControllerRef> controllers = from->GetControllers();
+	from->ClearControllers();
+	for ( list<NiTimeControllerRef>::reverse_iterator it = controllers.rbegin(); it != controllers.rend(); ++it ) {
+		to->AddController( *it );
+	}
+
+	NiCollisionObjectRef collision = from->GetCollisionObject();
+	if ( collision != NULL ) {
+		from->SetCollisionObject( NULL );
+		to->SetCollisionObject( collision );
+	}
+}
+
+namespace Niflib {
+
+Ref<NiMesh> ConvertToMesh( NiTriBasedGeom * geom, MeshStreamLayout layout ) {
+	if ( geom == NULL ) {
+		throw runtime_error( "Attempted to convert a null geometry to a mesh." );
+	}
+	NiTriBasedGeomDataRef data = DynamicCast<NiTriBasedGeomData>( geom->GetData() );
+	if ( data == NULL ) {
+		throw runtime_error( "Attempted to convert a geometry without triangle data to a mesh." );
+	}
+
+	GeometrySource geo;
+	geo.vertices = data->GetVertices();
+	const unsigned int nv = (unsigned int)(geo.vertices.size());
+	geo.normals = data->GetNormals();
+	geo.colors = data->GetColors();
+	geo.uvSets.resize( data->GetUVSetCount() );
+	for ( unsigned int i = 0; i < geo.uvSets.size(); ++i ) {
+		geo.uvSets[i] = data->GetUVSet( i );
+	}
+
+	//Split the geometry into submeshes, one per skin partition
+	NiSkinInstanceRef skin = geom->GetSkinInstance();
+	NiSkinDataRef skinData;
+	NiSkinPartitionRef partition;
+	if ( skin != NULL ) {
+		skinData = skin->GetSkinData();
+		partition = skin->GetSkinPartition();
+		if ( partition == NULL && skinData != NULL ) {
+			partition = skinData->GetSkinPartition();
+		}
+	}
+	const bool skinned = ( skinData != NULL );
+	vector<SubmeshSource> subs;
+	if ( skinned && partition != NULL && partition->GetNumPartitions() > 0 ) {
+		subs.resize( partition->GetNumPartitions() );
+		for ( unsigned int p = 0; p < subs.size(); ++p ) {
+			SubmeshSource & sub = subs[p];
+			vector<unsigned short> vmap = partition->GetVertexMap( p );
+			sub.vertices.assign( vmap.begin(), vmap.end() );
+			sub.triangles = partition->GetTriangles( p );
+			sub.bones = partition->GetBoneMap( p );
+			const unsigned int n = (unsigned int)(sub.vertices.size());
+			const unsigned int wpv = partition->GetWeightsPerVertex( p );
+			const bool hasWeights = partition->HasVertexWeights( p );
+			const bool hasIndices = partition->HasVertexBoneIndices( p );
+			sub.weights.assign( 4 * n, 0.0f );
+			sub.boneIndices.assign( 4 * n, 0 );
+			for ( unsigned int k = 0; k < n; ++k ) {
+				vector<float> w;
+				vector<unsigned short> bi;
+				if ( hasWeights ) {
+					w = partition->GetVertexWeights( p, k );
+				}
+				if ( hasIndices ) {
+					bi = partition->GetVertexBoneIndices( p, k );
+				}
+				for ( unsigned int j = 0; j < 4 && j < wpv; ++j ) {
+					if ( j < w.size() ) {
+						sub.weights[4 * k + j] = w[j];
+					} else if ( !hasWeights && j == 0 ) {
+						sub.weights[4 * k] = 1.0f;
+					}
+					sub.boneIndices[4 * k + j] = j < bi.size() ? bi[j] : (unsigned short)(j);
+				}
+			}
+		}
+	} else {
+		subs.resize( 1 );
+		SubmeshSource & sub = subs[0];
+		sub.vertices.resize( nv );
+		for ( unsigned int v = 0; v < nv; ++v ) {
+			sub.vertices[v] = v;
+		}
+		sub.triangles = data->GetTriangles();
+		if ( skinned ) {
+			sub.weights.assign( 4 * nv, 0.0f );
+			sub.boneIndices.assign( 4 * nv, 0 );
+			for ( unsigned int b = 0; b < skinData->GetBoneCount(); ++b ) {
+				sub.bones.push_back( (unsigned short)(b) );
+				vector<SkinWeight> weights = skinData->GetBoneWeights( b );
+				for ( unsigned int i = 0; i < weights.size(); ++i ) {
+					if ( weights[i].index < nv ) {
+						AddInfluence( sub, weights[i].index, (unsigned short)(b), weights[i].weight );
+					}
+				}
+			}
+		}
+	}
+
+	//Every stream of the same kind gets one region per submesh
+	vector<Region> vertexRegions( subs.size() ), indexRegions( subs.size() ), paletteRegions( subs.size() );
+	unsigned int vertexCount = 0, indexCount = 0, paletteCount = 0, largestPalette = 0;
+	for ( unsigned int s = 0; s < subs.size(); ++s ) {
+		vertexRegions[s].startIndex = vertexCount;
+		vertexRegions[s].numIndices = (unsigned int)(subs[s].vertices.size());
+		vertexCount += vertexRegions[s].numIndices;
+		indexRegions[s].startIndex = indexCount;
+		indexRegions[s].numIndices = 3 * (unsigned int)(subs[s].triangles.size());
+		indexCount += indexRegions[s].numIndices;
+		paletteRegions[s].startIndex = paletteCount;
+		paletteRegions[s].numIndices = (unsigned int)(subs[s].bones.size());
+		paletteCount += paletteRegions[s].numIndices;
+		if ( subs[s].bones.size() > largestPalette ) {
+			largestPalette = (unsigned int)(subs[s].bones.size());
+		}
+	}
+
+	vector<VertexComponent> comps;
+	comps.push_back( MakeComponent( VC_POSITION, "POSITION", 0, F_FLOAT32_3 ) );
+	if ( nv > 0 && geo.normals.size() == nv ) {
+		comps.push_back( MakeComponent( VC_NORMAL, "NORMAL", 0, F_FLOAT32_3 ) );
+	}
+	if ( nv > 0 && geo.colors.size() == nv ) {
+		comps.push_back( MakeComponent( VC_COLOR, "COLOR", 0, F_FLOAT32_4 ) );
+	}
+	for ( unsigned int i = 0; i < geo.uvSets.size(); ++i ) {
+		if ( nv > 0 && geo.uvSets[i].size() == nv ) {
+			comps.push_back( MakeComponent( VC_TEXCOORD, "TEXCOORD", i, F_FLOAT32_2 ) );
+		}
+	}
+	if ( skinned ) {
+		comps.push_back( MakeComponent( VC_BLENDWEIGHT, "BLENDWEIGHT", 0, F_FLOAT32_4 ) );
+		comps.push_back( MakeComponent( VC_BLENDINDICES, "BLENDINDICES", 0, largestPalette <= 256 ? F_UINT8_4 : F_UINT16_4 ) );
+	}
+
+	vector<MeshData> datas;
+	if ( layout == MESH_INTERLEAVED ) {
+		datas.push_back( MakeVertexData( comps, geo, subs, vertexRegions ) );
+	} else {
+		for ( unsigned int c = 0; c < comps.size(); ++c ) {
+			datas.push_back( MakeVertexData( vector<VertexComponent>( 1, comps[c] ), geo, subs, vertexRegions ) );
+		}
+	}
+
+	vector<byte> bytes;
+	bytes.reserve( 2 * indexCount );
+	for ( unsigned int s = 0; s < subs.size(); ++s ) {
+		for ( unsigned int t = 0; t < subs[s].triangles.size(); ++t ) {
+			AppendRaw( bytes, subs[s].triangles[t].v1 );
+			AppendRaw( bytes, subs[s].triangles[t].v2 );
+			AppendRaw( bytes, subs[s].triangles[t].v3 );
+		}
+	}
+	datas.push_back( MakeMeshData( MakeStream( USAGE_VERTEX_INDEX, vector<ComponentFormat>( 1, F_UINT16_1 ), bytes, indexRegions ), vector<SemanticData>( 1, MakeSemantic( "INDEX", 0 ) ), (unsigned int)(subs.size()) ) );
+
+	NiMeshRef mesh = new NiMesh;
+	if ( skinned ) {
+		bytes.clear();
+		for ( unsigned int s = 0; s < subs.size(); ++s ) {
+			for ( unsigned int b = 0; b < subs[s].bones.size(); ++b ) {
+				AppendRaw( bytes, subs[s].bones[b] );
+			}
+		}
+		datas.push_back( MakeMeshData( MakeStream( USAGE_USER, vector<ComponentFormat>( 1, F_UINT16_1 ), bytes, paletteRegions ), vector<SemanticData>( 1, MakeSemantic( "BONE_PALETTE", 0 ) ), (unsigned int)(subs.size()) ) );
+
+		NiSkinningMeshModifierRef modifier = new NiSkinningMeshModifier;
+		modifier->SetSkeletonRoot( skin->GetSkeletonRoot() );
+		modifier->SetSkeletonTransform( ToSkinTransform( skinData->GetOverallTransform() ) );
+		vector<NiNodeRef> bones = skin->GetBones();
+		vector<NiAVObjectRef> boneObjects( bones.size() );
+		vector<SkinTransform> boneTransforms( bones.size() );
+		for ( unsigned int b = 0; b < bones.size(); ++b ) {
+			boneObjects[b] = StaticCast<NiAVObject>( bones[b] );
+			boneTransforms[b] = ToSkinTransform( skinData->GetBoneTransform( b ) );
+		}
+		modifier->SetBones( boneObjects, boneTransforms );
+		mesh->AddModifier( modifier );
+	}
+
+	TransferObjectState( geom, mesh );
+	//A mesh has no slots for the Bethesda properties, so they join the others
+	array<2,NiPropertyRef> bsProperties = geom->GetBSProperties();
+	for ( unsigned int i = 0; i < 2; ++i ) {
+		if ( bsProperties[i] != NULL ) {
+			mesh->AddProperty( bsProperties[i] );
+		}
+	}
+	//The shader became the material in the versions that have NiMesh
+	if ( geom->HasShader() ) {
+		MaterialData material;
+		material.materialName = geom->GetShader();
+		material.materialExtraData = 0;
+		mesh->SetMaterials( vector<MaterialData>( 1, material ) );
+		mesh->SetActiveMaterial( 0 );
+	}
+	mesh->SetPrimitiveType( MESH_PRIMITIVE_TRIANGLES );
+	mesh->SetSubmeshCount( (unsigned short)(subs.size()) );
+	mesh->SetMeshData( datas );
+	SphereBV bound;
+	bound.center = data->GetCenter();
+	bound.radius = data->GetRadius();
+	mesh->SetBound( bound );
+	return mesh;
+}
+
+} //End namespace Niflib
+
+//The first element of the region that a submesh uses in the stream of a semantic
+static unsigned int GetRegionStart( NiMesh * mesh, const string & semantic, unsigned int submesh ) {
+	if ( mesh->GetSubmeshCount() == 0 ) {
+		return 0;
+	}
+	vector<MeshData> datas = mesh->GetMeshData();
+	for ( unsigned int d = 0; d < datas.size(); ++d ) {
+		for ( unsigned int c = 0; c < datas[d].componentSemantics.size(); ++c ) {
+			const SemanticData & sem = datas[d].componentSemantics[c];
+			if ( sem.index != 0 || string(sem.name) != semantic || datas[d].stream == NULL ) {
+				continue;
+			}
+			vector<Region> regions = datas[d].stream->GetRegions();
+			if ( submesh >= datas[d].submeshToRegionMap.size() || datas[d].submeshToRegionMap[submesh] >= regions.size() ) {
+				throw runtime_error( "The submesh has no region in the " + semantic + " stream." );
+			}
+			return regions[datas[d].submeshToRegionMap[submesh]].startIndex;
+		}
+	}
+	throw runtime_error( "The mesh has no data stream with the semantic " + semantic + "." );
+}
+
+//A view of a semantic for one submesh, or for the whole stream if the mesh has no submeshes
+static DataStreamView GetSubmeshView( NiMesh * mesh, const string & semantic, unsigned int submesh ) {
+	if ( mesh->GetSubmeshCount() == 0 ) {
+		return mesh->GetSemanticView( semantic );
+	}
+	return mesh->GetSemanticView( semantic, 0, submesh );
+}
+
+namespace Niflib {
+
+Ref<NiTriShape> ConvertToTriShape( NiMesh * mesh ) {
+	if ( mesh == NULL ) {
+		throw runtime_error( "Attempted to convert a null mesh to a NiTriShape." );
+	}
+	if ( mesh->GetPrimitiveType() != MESH_PRIMITIVE_TRIANGLES ) {
+		throw runtime_error( "Only triangle meshes can be converted to a NiTriShape." );
+	}
+
+	vector<Vector3> vertices;
+	mesh->GetSemanticView( "POSITION" ).DecodeVector3s( vertices );
+	const unsigned int nv = (unsigned int)(vertices.size());
+	if ( nv > 65536 ) {
+		throw runtime_error( "The mesh has too many vertices for a NiTriShape." );
+	}
+
+	//Merge the submeshes, offsetting each one's indices to its vertex region
+	vector<Triangle> triangles;
+	const bool indexed = mesh->HasSemantic( "INDEX" );
+	const unsigned int submeshes = mesh->GetSubmeshCount() > 0 ? mesh->GetSubmeshCount() : 1;
+	for ( unsigned int s = 0; s < submeshes; ++s ) {
+		const unsigned int start = GetRegionStart( mesh, "POSITION", s );
+		vector<unsigned int> indices;
+		if ( indexed ) {
+			GetSubmeshView( mesh, "INDEX", s ).DecodeUInts( indices );
+		} else {
+			indices.resize( GetSubmeshView( mesh, "POSITION", s ).Size() );
+			for ( unsigned int i = 0; i < indices.size(); ++i ) {
+				indices[i] = i;
+			}
+		}
+		for ( unsigned int i = 0; i + 2 < indices.size(); i += 3 ) {
+			unsigned int a = start + indices[i], b = start + indices[i + 1], c = start + indices[i + 2];
+			if ( a >= nv || b >= nv || c >= nv ) {
+				throw runtime_error( "A mesh index refers to a vertex that does not exist." );
+			}
+			triangles.push_back( Triangle( (unsigned short)(a), (unsigned short)(b), (unsigned short)(c) ) );
+		}
+	}
+
+	NiTriShapeDataRef data = new NiTriShapeData;
+	data->SetVertices( vertices );
+	if ( mesh->HasSemantic( "NORMAL" ) ) {
+		DataStreamView view = mesh->GetSemanticView( "NORMAL" );
+		if ( view.Size() == nv ) {
+			vector<Vector3> normals;
+			view.DecodeVector3s( normals );
+			data->SetNormals( normals );
+		}
+	}
+	if ( mesh->HasSemantic( "COLOR" ) ) {
+		DataStreamView view = mesh->GetSemanticView( "COLOR" );
+		if ( view.Size() == nv ) {
+			vector<Color4> colors( nv );
+			for ( unsigned int i = 0; i < nv; ++i ) {
+				colors[i] = view.GetColor4( i );
+			}
+			data->SetVertexColors( colors );
+		}
+	}
+	unsigned int uvSets = 0;
+	while ( mesh->HasSemantic( "TEXCOORD", uvSets ) && mesh->GetSemanticView( "TEXCOORD", uvSets ).Size() == nv ) {
+		++uvSets;
+	}
+	data->SetUVSetCount( uvSets );
+	for ( unsigned int i = 0; i < uvSets; ++i ) {
+		vector<TexCoord> uvs;
+		mesh->GetSemanticView( "TEXCOORD", i ).DecodeTexCoords( uvs );
+		data->SetUVSet( i, uvs );
+	}
+	data->SetTriangles( triangles );
+
+	NiTriShapeRef shape = new NiTriShape;
+	TransferObjectState( mesh, shape );
+	vector<MaterialData> materials = mesh->GetMaterials();
+	if ( !materials.empty() ) {
+		int active = mesh->GetActiveMaterial();
+		if ( active < 0 || active >= int(materials.size()) ) {
+			active = 0;
+		}
+		shape->SetShader( materials[active].materialName );
+	}
+	shape->SetData( data );
+	return shape;
+}
+
+} //End namespace Niflib
+
+//Binds the skin of a converted mesh to its bones, with the weights of its blend streams
+static void BindMeshSkin( NiTriShape * shape, NiMesh * mesh ) {
+	NiSkinningMeshModifierRef modifier;
+	vector<NiMeshModifierRef> modifiers = mesh->GetModifiers();
+	for ( unsigned int i = 0; i < modifiers.size() && modifier == NULL; ++i ) {
+		modifier = DynamicCast<NiSkinningMeshModifier>( modifiers[i] );
+	}
+	if ( modifier == NULL || !mesh->HasSemantic( "BLENDWEIGHT" ) || !mesh->HasSemantic( "BLENDINDICES" ) ) {
+		return;
+	}
+	vector<NiAVObjectRef> boneObjects = modifier->GetBones();
+	vector<NiNodeRef> bones( boneObjects.size() );
+	for ( unsigned int b = 0; b < bones.size(); ++b ) {
+		bones[b] = DynamicCast<NiNode>( boneObjects[b] );
+		if ( bones[b] == NULL ) {
+			throw runtime_error( "The bones of a skinned mesh must be NiNodes to bind a NiTriShape skin." );
+		}
+	}
+
+	vector< vector<SkinWeight> > weights( bones.size() );
+	const bool palette = mesh->HasSemantic( "BONE_PALETTE" );
+	const unsigned int submeshes = mesh->GetSubmeshCount() > 0 ? mesh->GetSubmeshCount() : 1;
+	for ( unsigned int s = 0; s < submeshes; ++s ) {
+		const unsigned int start = GetRegionStart( mesh, "POSITION", s );
+		DataStreamView wv = GetSubmeshView( mesh, "BLENDWEIGHT", s );
+		DataStreamView iv = GetSubmeshView( mesh, "BLENDINDICES", s );
+		vector<float> w;
+		vector<unsigned int> bi, pal;
+		wv.DecodeFloats( w );
+		iv.DecodeUInts( bi );
+		if ( palette ) {
+			GetSubmeshView( mesh, "BONE_PALETTE", s ).DecodeUInts( pal );
+		}
+		const unsigned int nw = wv.GetValueCount(), ni = iv.GetValueCount();
+		for ( unsigned int k = 0; k < wv.Size() && k < iv.Size(); ++k ) {
+			for ( unsigned int j = 0; j < nw && j < ni; ++j ) {
+				float weight = w[k * nw + j];
+				if ( weight <= 0.0f ) {
+					continue;
+				}
+				unsigned int b = bi[k * ni + j];
+				if ( palette ) {
+					if ( b >= pal.size() ) {
+						throw runtime_error( "A mesh blend index is outside of the bone palette." );
+					}
+					b = pal[b];
+				}
+				if ( b >= bones.size() ) {
+					throw runtime_error( "A mesh blend index refers to a bone that does not exist." );
+				}
+				SkinWeight sw;
+				sw.index = (unsigned short)( start + k );
+				sw.weight = weight;
+				weights[b].push_back( sw );
+			}
+		}
+	}
+
+	shape->BindSkin( bones );
+	for ( unsigned int b = 0; b < bones.size(); ++b ) {
+		shape->SetBoneWeights( b, weights[b] );
+	}
+}
+
+namespace Niflib {
+
+unsigned int ConvertSceneToMeshes( NiNode * root, MeshStreamLayout layout ) {
+	if ( root == NULL ) {
+		return 0;
+	}
+	unsigned int count = 0;
+	vector<NiAVObjectRef> children = root->GetChildren();
+	for ( unsigned int i = 0; i < children.size(); ++i ) {
+		NiNodeRef node = DynamicCast<NiNode>( children[i] );
+		if ( node != NULL ) {
+			count += ConvertSceneToMeshes( node, layout );
+			continue;
+		}
+		NiTriBasedGeomRef geom = DynamicCast<NiTriBasedGeom>( children[i] );
+		if ( geom == NULL ) {
+			continue;
+		}
+		NiMeshRef mesh = ConvertToMesh( geom, layout );
+		root->ReplaceChild( children[i], StaticCast<NiAVObject>( mesh ) );
+		++count;
+	}
+	return count;
+}
+
+unsigned int ConvertSceneToTriShapes( NiNode * root ) {
+	if ( root == NULL ) {
+		return 0;
+	}
+	unsigned int count = 0;
+	vector<NiAVObjectRef> children = root->GetChildren();
+	for ( unsigned int i = 0; i < children.size(); ++i ) {
+		NiNodeRef node = DynamicCast<NiNode>( children[i] );
+		if ( node != NULL ) {
+			count += ConvertSceneToTriShapes( node );
+			continue;
+		}
+		NiMeshRef mesh = DynamicCast<NiMesh>( children[i] );
+		if ( mesh == NULL ) {
+			continue;
+		}
+		NiTriShapeRef shape = ConvertToTriShape( mesh );
+		root->ReplaceChild( children[i], StaticCast<NiAVObject>( shape ) );
+		BindMeshSkin( shape, mesh );
+		++count;
+	}
+	return count;
+}
+
+} //End namespace Niflib
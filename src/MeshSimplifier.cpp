@@ -0,0 +1,697 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#include "../include/MeshSimplifier.h"
+#include "../include/obj/NiTriShape.h"
+#include "../include/obj/NiTriShapeData.h"
+#include "../include/obj/NiSkinInstance.h"
+#include "../include/obj/NiSkinPartition.h"
+#include "../include/obj/NiRangeLODData.h"
+#include "../include/obj/NiProperty.h"
+#include "../include/gen/SkinWeight.h"
+#include "../include/gen/LODRange.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <queue>
+#include <sstream>
+
+using namespace Niflib;
+
+//How much more open borders resist moving than the surface itself
+static const double BORDER_WEIGHT = 10.0;
+
+//The sum of the squared distances to a set of weighted planes, stored as the
+//upper triangle of a symmetric 4x4 matrix: xx xy xz xd yy yz yd zz zd dd
+struct Quadric {
+	double a[10];
+	double weight;
+
+	Quadric() : weight(0.0) {
+		for ( int i = 0; i < 10; ++i ) {
+			a[i] = 0.0;
+		}
+	}
+
+	void AddPlane( const Vector3 & n, double d, double w ) {
+		const double p[4] = { n.x, n.y, n.z, d };
+		int k = 0;
+		for ( int i = 0; i < 4; ++i ) {
+			for ( int j = i; j < 4; ++j ) {
+				a[k++] += w * p[i] * p[j];
+			}
+		}
+		weight += w;
+	}
+
+	Quadric & operator+=( const Quadric & rh ) {
+		for ( int i = 0; i < 10; ++i ) {
+			a[i] += rh.a[i];
+		}
+		weight += rh.weight;
+		return *this;
+	}
+
+	double Evaluate( const Vector3 & v ) const {
+		const double x = v.x, y = v.y, z = v.z;
+		return a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0 * a[3] * x
+			+ a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y
+			+ a[7] * z * z + 2.0 * a[8] * z + a[9];
+	}
+};
+
+//A possible collapse of the vertices at one position onto those at another
+struct Collapse {
+	double cost;
+	unsigned int from, to;
+	unsigned int version;
+
+	bool operator<( const Collapse & rh ) const {
+		//The cheapest collapse comes first in a priority_queue
+		return cost > rh.cost;
+	}
+};
+
+struct PositionLess {
+	const vector<Vector3> * verts;
+	bool operator()( unsigned int a, unsigned int b ) const {
+		const Vector3 & p = (*verts)[a];
+		const Vector3 & q = (*verts)[b];
+		if ( p.x != q.x ) return p.x < q.x;
+		if ( p.y != q.y ) return p.y < q.y;
+		return p.z < q.z;
+	}
+};
+
+static Vector3 FaceNormal( const Vector3 & a, const Vector3 & b, const Vector3 & c ) {
+	return ( b - a ).CrossProduct( c - a );
+}
+
+//The simplification of one mesh.  Vertices at the same position form a group,
+//and a collapse moves every vertex of one group onto a vertex of another.
+class Simplifier {
+public:
+	Simplifier( NiTriBasedGeomData * data, NiSkinData * skin, float attribute_weight );
+	vector<Triangle> Run( unsigned int target, float & error );
+
+private:
+	bool Evaluate( unsigned int from, unsigned int to, double & cost, double & error, vector<unsigned int> * targets ) const;
+	void Apply( unsigned int from, unsigned int to, const vector<unsigned int> & targets );
+	void PushCollapses( unsigned int g );
+	void Neighbors( unsigned int g, vector<unsigned int> & result ) const;
+	double AttributeDistance( unsigned int a, unsigned int b ) const;
+	bool IsDegenerate( const Triangle & t ) const;
+
+	vector<Vector3> verts;
+	//Normals, colors and texture coordinates, attributeSize per vertex
+	vector<float> attributes;
+	unsigned int attributeSize;
+	//Bone and weight pairs of each vertex, sorted by bone
+	vector< vector< pair<unsigned int, float> > > boneWeights;
+	double attributeScale;
+
+	vector<unsigned int> group;
+	vector< vector<unsigned int> > members;
+	vector<Quadric> quadrics;
+	vector<unsigned int> versions;
+	vector<bool> groupAlive;
+
+	vector<Triangle> tris;
+	vector<bool> triAlive;
+	vector< vector<unsigned int> > vertTris;
+	unsigned int aliveCount;
+
+	priority_queue<Collapse> heap;
+};
+
+Simplifier::Simplifier( NiTriBasedGeomData * data, NiSkinData * skin, float attribute_weight ) : attributeSize(0), attributeScale(0.0), aliveCount(0) {
+	verts = data->GetVertices();
+	tris = data->GetTriangles();
+	const unsigned int nv = (unsigned int)(verts.size());
+
+	//Gather the attributes that are present
+	const vector<Vector3> & normals = data->GetNormals();
+	const vector<Color4> & colors = data->GetColors();
+	const unsigned int uvSets = data->GetUVSetCount() > 0 ? data->GetUVSetCount() : 0;
+	const bool hasNormals = normals.size() == nv;
+	const bool hasColors = colors.size() == nv;
+	attributeSize = ( hasNormals ? 3 : 0 ) + ( hasColors ? 4 : 0 ) + 2 * uvSets;
+	attributes.resize( nv * attributeSize );
+	for ( unsigned int i = 0; i < nv; ++i ) {
+		float * a = nv > 0 && attributeSize > 0 ? &attributes[i * attributeSize] : NULL;
+		if ( hasNormals ) {
+			*a++ = normals[i].x; *a++ = normals[i].y; *a++ = normals[i].z;
+		}
+		if ( hasColors ) {
+			*a++ = colors[i].r; *a++ = colors[i].g; *a++ = colors[i].b; *a++ = colors[i].a;
+		}
+	}
+	for ( unsigned int s = 0; s < uvSets; ++s ) {
+		const vector<TexCoord> & uvs = data->GetUVSet( s );
+		const unsigned int offset = ( hasNormals ? 3 : 0 ) + ( hasColors ? 4 : 0 ) + 2 * s;
+		for ( unsigned int i = 0; i < nv && i < uvs.size(); ++i ) {
+			attributes[i * attributeSize + offset] = uvs[i].u;
+			attributes[i * attributeSize + offset + 1] = uvs[i].v;
+		}
+	}
+	boneWeights.resize( nv );
+	if ( skin != NULL ) {
+		for ( unsigned int b = 0; b < skin->GetBoneCount(); ++b ) {
+			const vector<SkinWeight> & weights = skin->GetBoneWeights( b );
+			for ( unsigned int i = 0; i < weights.size(); ++i ) {
+				if ( weights[i].index < nv ) {
+					boneWeights[weights[i].index].push_back( pair<unsigned int, float>( b, weights[i].weight ) );
+				}
+			}
+		}
+	}
+
+	//Group the vertices by position
+	vector<unsigned int> order( nv );
+	for ( unsigned int i = 0; i < nv; ++i ) {
+		order[i] = i;
+	}
+	PositionLess less;
+	less.verts = &verts;
+	sort( order.begin(), order.end(), less );
+	group.resize( nv );
+	for ( unsigned int i = 0; i < nv; ++i ) {
+		if ( i == 0 || less( order[i - 1], order[i] ) ) {
+			members.push_back( vector<unsigned int>() );
+		}
+		group[order[i]] = (unsigned int)(members.size()) - 1;
+		members.back().push_back( order[i] );
+	}
+	quadrics.resize( members.size() );
+	versions.assign( members.size(), 0 );
+	groupAlive.assign( members.size(), true );
+
+	//Every face adds its plane to its corners, weighted by its area
+	triAlive.assign( tris.size(), false );
+	vertTris.resize( nv );
+	map< pair<unsigned int, unsigned int>, unsigned int > edgeUses;
+	double totalArea = 0.0, totalEdge2 = 0.0;
+	for ( unsigned int t = 0; t < tris.size(); ++t ) {
+		const Triangle & tri = tris[t];
+		if ( tri.v1 >= nv || tri.v2 >= nv || tri.v3 >= nv || IsDegenerate( tri ) ) {
+			continue;
+		}
+		triAlive[t] = true;
+		++aliveCount;
+		const unsigned int corners[3] = { tri.v1, tri.v2, tri.v3 };
+		for ( int k = 0; k < 3; ++k ) {
+			vertTris[corners[k]].push_back( t );
+			unsigned int a = group[corners[k]], b = group[corners[( k + 1 ) % 3]];
+			++edgeUses[ pair<unsigned int, unsigned int>( min( a, b ), max( a, b ) ) ];
+			Vector3 e = verts[corners[( k + 1 ) % 3]] - verts[corners[k]];
+			totalEdge2 += e.DotProduct( e );
+		}
+		Vector3 n = FaceNormal( verts[tri.v1], verts[tri.v2], verts[tri.v3] );
+		float len = n.Magnitude();
+		if ( len <= 0.0f ) {
+			continue;
+		}
+		n = n / len;
+		totalArea += 0.5 * len;
+		for ( int k = 0; k < 3; ++k ) {
+			quadrics[group[corners[k]]].AddPlane( n, -n.DotProduct( verts[tri.v1] ), 0.5 * len );
+		}
+	}
+
+	//Open borders add a plane through the edge, upright to the face
+	for ( unsigned int t = 0; t < tris.size(); ++t ) {
+		if ( !triAlive[t] ) {
+			continue;
+		}
+		const Triangle & tri = tris[t];
+		const unsigned int corners[3] = { tri.v1, tri.v2, tri.v3 };
+		Vector3 n = FaceNormal( verts[tri.v1], verts[tri.v2], verts[tri.v3] ).Normalized();
+		for ( int k = 0; k < 3; ++k ) {
+			unsigned int a = group[corners[k]], b = group[corners[( k + 1 ) % 3]];
+			if ( edgeUses[ pair<unsigned int, unsigned int>( min( a, b ), max( a, b ) ) ] != 1 ) {
+				continue;
+			}
+			const Vector3 & p = verts[corners[k]];
+			Vector3 e = verts[corners[( k + 1 ) % 3]] - p;
+			Vector3 side = e.CrossProduct( n );
+			float len = side.Magnitude();
+			if ( len <= 0.0f ) {
+				continue;
+			}
+			side = side / len;
+			double w = BORDER_WEIGHT * e.DotProduct( e );
+			quadrics[a].AddPlane( side, -side.DotProduct( p ), w );
+			quadrics[b].AddPlane( side, -side.DotProduct( p ), w );
+		}
+	}
+
+	//Attribute differences are unitless, so scale them to an area times a squared distance like the quadrics
+	if ( aliveCount > 0 ) {
+		attributeScale = attribute_weight * ( totalArea / aliveCount ) * ( totalEdge2 / ( 3.0 * aliveCount ) );
+	}
+}
+
+bool Simplifier::IsDegenerate( const Triangle & t ) const {
+	return group[t.v1] == group[t.v2] || group[t.v2] == group[t.v3] || group[t.v3] == group[t.v1];
+}
+
+double Simplifier::AttributeDistance( unsigned int a, unsigned int b ) const {
+	double d = 0.0;
+	for ( unsigned int k = 0; k < attributeSize; ++k ) {
+		double x = attributes[a * attributeSize + k] - attributes[b * attributeSize + k];
+		d += x * x;
+	}
+	//The weights of bones that only one of the vertices has count in full
+	const vector< pair<unsigned int, float> > & wa = boneWeights[a];
+	const vector< pair<unsigned int, float> > & wb = boneWeights[b];
+	unsigned int i = 0, j = 0;
+	while ( i < wa.size() || j < wb.size() ) {
+		if ( j == wb.size() || ( i < wa.size() && wa[i].first < wb[j].first ) ) {
+			d += fabs( wa[i++].second );
+		} else if ( i == wa.size() || wb[j].first < wa[i].first ) {
+			d += fabs( wb[j++].second );
+		} else {
+			d += fabs( wa[i++].second - wb[j++].second );
+		}
+	}
+	return d;
+}
+
+void Simplifier::Neighbors( unsigned int g, vector<unsigned int> & result ) const {
+	result.clear();
+	const vector<unsigned int> & m = members[g];
+	for ( unsigned int i = 0; i < m.size(); ++i ) {
+		const vector<unsigned int> & vt = vertTris[m[i]];
+		for ( unsigned int j = 0; j < vt.size(); ++j ) {
+			if ( !triAlive[vt[j]] ) {
+				continue;
+			}
+			const Triangle & t = tris[vt[j]];
+			const unsigned int corners[3] = { group[t.v1], group[t.v2], group[t.v3] };
+			for ( int k = 0; k < 3; ++k ) {
+				if ( corners[k] != g && find( result.begin(), result.end(), corners[k] ) == result.end() ) {
+					result.push_back( corners[k] );
+				}
+			}
+		}
+	}
+}
+
+bool Simplifier::Evaluate( unsigned int from, unsigned int to, double & cost, double & error, vector<unsigned int> * targets ) const {
+	const Vector3 & p = verts[members[to][0]];
+	Quadric q = quadrics[from];
+	q += quadrics[to];
+	const double geometric = max( 0.0, q.Evaluate( p ) );
+	double attribute = 0.0;
+
+	const vector<unsigned int> & m = members[from];
+	if ( targets != NULL ) {
+		targets->assign( m.size(), 0xFFFFFFFF );
+	}
+	for ( unsigned int i = 0; i < m.size(); ++i ) {
+		const unsigned int u = m[i];
+		const vector<unsigned int> & vt = vertTris[u];
+		//Merge each vertex with the best matching vertex it shares a face with
+		unsigned int best = 0xFFFFFFFF;
+		double bestDistance = 0.0;
+		bool used = false;
+		for ( unsigned int j = 0; j < vt.size(); ++j ) {
+			if ( !triAlive[vt[j]] ) {
+				continue;
+			}
+			used = true;
+			const Triangle & t = tris[vt[j]];
+			const unsigned int corners[3] = { t.v1, t.v2, t.v3 };
+			bool touches = false;
+			for ( int k = 0; k < 3; ++k ) {
+				if ( group[corners[k]] != to ) {
+					continue;
+				}
+				touches = true;
+				double d = AttributeDistance( u, corners[k] );
+				if ( best == 0xFFFFFFFF || d < bestDistance ) {
+					best = corners[k];
+					bestDistance = d;
+				}
+			}
+			if ( touches ) {
+				continue;
+			}
+			//Faces that survive must not flip over
+			Vector3 pos[3];
+			for ( int k = 0; k < 3; ++k ) {
+				pos[k] = corners[k] == u ? p : verts[corners[k]];
+			}
+			Vector3 before = FaceNormal( verts[corners[0]], verts[corners[1]], verts[corners[2]] );
+			Vector3 after = FaceNormal( pos[0], pos[1], pos[2] );
+			if ( before.DotProduct( after ) <= 0.0f ) {
+				return false;
+			}
+		}
+		if ( !used ) {
+			continue;
+		}
+		if ( best == 0xFFFFFFFF ) {
+			//Moving this vertex would tear the seam it lies on
+			return false;
+		}
+		attribute += bestDistance;
+		if ( targets != NULL ) {
+			(*targets)[i] = best;
+		}
+	}
+	cost = geometric + attribute * attributeScale;
+	error = q.weight > 0.0 ? sqrt( geometric / q.weight ) : 0.0;
+	return true;
+}
+
+void Simplifier::PushCollapses( unsigned int g ) {
+	vector<unsigned int> neighbors;
+	Neighbors( g, neighbors );
+	for ( unsigned int i = 0; i < neighbors.size(); ++i ) {
+		const unsigned int pairs[2][2] = { { g, neighbors[i] }, { neighbors[i], g } };
+		for ( int k = 0; k < 2; ++k ) {
+			Collapse c;
+			double error;
+			if ( !Evaluate( pairs[k][0], pairs[k][1], c.cost, error, NULL ) ) {
+				continue;
+			}
+			c.from = pairs[k][0];
+			c.to = pairs[k][1];
+			c.version = versions[c.from] + versions[c.to];
+			heap.push( c );
+		}
+	}
+}
+
+void Simplifier::Apply( unsigned int from, unsigned int to, const vector<unsigned int> & targets ) {
+	const vector<unsigned int> & m = members[from];
+	for ( unsigned int i = 0; i < m.size(); ++i ) {
+		const unsigned int u = m[i], v = targets[i];
+		if ( v == 0xFFFFFFFF ) {
+			continue;
+		}
+		vector<unsigned int> & vt = vertTris[u];
+		for ( unsigned int j = 0; j < vt.size(); ++j ) {
+			if ( !triAlive[vt[j]] ) {
+				continue;
+			}
+			Triangle & t = tris[vt[j]];
+			if ( t.v1 == u ) t.v1 = (unsigned short)(v);
+			if ( t.v2 == u ) t.v2 = (unsigned short)(v);
+			if ( t.v3 == u ) t.v3 = (unsigned short)(v);
+			if ( IsDegenerate( t ) ) {
+				triAlive[vt[j]] = false;
+				--aliveCount;
+			} else {
+				vertTris[v].push_back( vt[j] );
+			}
+		}
+		vt.clear();
+	}
+	quadrics[to] += quadrics[from];
+	groupAlive[from] = false;
+	++versions[from];
+	++versions[to];
+}
+
+vector<Triangle> Simplifier::Run( unsigned int target, float & error ) {
+	error = 0.0f;
+	for ( unsigned int g = 0; g < members.size(); ++g ) {
+		//Each pair is found from both of its groups, so only push it from the lower one
+		vector<unsigned int> neighbors;
+		Neighbors( g, neighbors );
+		for ( unsigned int i = 0; i < neighbors.size(); ++i ) {
+			if ( neighbors[i] < g ) {
+				continue;
+			}
+			const unsigned int pairs[2][2] = { { g, neighbors[i] }, { neighbors[i], g } };
+			for ( int k = 0; k < 2; ++k ) {
+				Collapse c;
+				double e;
+				if ( Evaluate( pairs[k][0], pairs[k][1], c.cost, e, NULL ) ) {
+					c.from = pairs[k][0];
+					c.to = pairs[k][1];
+					c.version = versions[c.from] + versions[c.to];
+					heap.push( c );
+				}
+			}
+		}
+	}
+
+	vector<unsigned int> targets;
+	while ( aliveCount > target && !heap.empty() ) {
+		Collapse c = heap.top();
+		heap.pop();
+		if ( !groupAlive[c.from] || !groupAlive[c.to] || c.version != versions[c.from] + versions[c.to] ) {
+			continue;
+		}
+		//The faces around the groups may have changed since the collapse was pushed
+		double cost, e;
+		if ( !Evaluate( c.from, c.to, cost, e, &targets ) ) {
+			continue;
+		}
+		if ( cost > c.cost * ( 1.0 + 1e-6 ) + 1e-12 ) {
+			c.cost = cost;
+			heap.push( c );
+			continue;
+		}
+		Apply( c.from, c.to, targets );
+		error = max( error, (float)(e) );
+		PushCollapses( c.to );
+	}
+
+	vector<Triangle> result;
+	result.reserve( aliveCount );
+	for ( unsigned int t = 0; t < tris.size(); ++t ) {
+		if ( triAlive[t] ) {
+			result.push_back( tris[t] );
+		}
+	}
+	return result;
+}
+
+//Copies the vertices of a data object that are listed in keep to a new NiTriShapeData
+static NiTriShapeDataRef CopyVertices( NiGeometryData * data, const vector<unsigned int> & keep ) {
+	NiTriShapeDataRef result = new NiTriShapeData;
+	const unsigned int nv = (unsigned int)(data->GetVertices().size());
+	vector<Vector3> verts( keep.size() );
+	for ( unsigned int i = 0; i < keep.size(); ++i ) {
+		verts[i] = data->GetVertices()[keep[i]];
+	}
+	result->SetVertices( verts );
+	if ( data->GetNormals().size() == nv ) {
+		for ( unsigned int i = 0; i < keep.size(); ++i ) {
+			verts[i] = data->GetNormals()[keep[i]];
+		}
+		result->SetNormals( verts );
+	}
+	vector<Vector3> tangents = data->GetTangents(), bitangents = data->GetBitangents();
+	if ( tangents.size() == nv && bitangents.size() == nv ) {
+		vector<Vector3> t( keep.size() ), b( keep.size() );
+		for ( unsigned int i = 0; i < keep.size(); ++i ) {
+			t[i] = tangents[keep[i]];
+			b[i] = bitangents[keep[i]];
+		}
+		result->SetTangents( t );
+		result->SetBitangents( b );
+	}
+	if ( data->GetColors().size() == nv ) {
+		vector<Color4> colors( keep.size() );
+		for ( unsigned int i = 0; i < keep.size(); ++i ) {
+			colors[i] = data->GetColors()[keep[i]];
+		}
+		result->SetVertexColors( colors );
+	}
+	const int uvSets = data->GetUVSetCount();
+	result->SetUVSetCount( uvSets );
+	for ( int s = 0; s < uvSets; ++s ) {
+		const vector<TexCoord> & uvs = data->GetUVSet( s );
+		vector<TexCoord> copy( keep.size() );
+		for ( unsigned int i = 0; i < keep.size() && keep[i] < uvs.size(); ++i ) {
+			copy[i] = uvs[keep[i]];
+		}
+		result->SetUVSet( s, copy );
+	}
+	return result;
+}
+
+//Makes a NiTriShape with the look of a shape and the given triangles
+static NiTriShapeRef MakeLODShape( NiTriBasedGeom * shape, vector<Triangle> tris ) {
+	NiGeometryDataRef data = shape->GetData();
+	NiSkinInstanceRef skin = shape->GetSkinInstance();
+	const bool skinned = skin != NULL && skin->GetSkinData() != NULL;
+	const unsigned int nv = (unsigned int)(data->GetVertices().size());
+
+	//Skinned levels keep every vertex so that the weights of the skin data stay valid
+	vector<unsigned int> keep;
+	if ( skinned ) {
+		keep.resize( nv );
+		for ( unsigned int i = 0; i < nv; ++i ) {
+			keep[i] = i;
+		}
+	} else {
+		vector<unsigned int> remap( nv, 0xFFFFFFFF );
+		for ( unsigned int t = 0; t < tris.size(); ++t ) {
+			unsigned short * corners[3] = { &tris[t].v1, &tris[t].v2, &tris[t].v3 };
+			for ( int k = 0; k < 3; ++k ) {
+				if ( remap[*corners[k]] == 0xFFFFFFFF ) {
+					remap[*corners[k]] = (unsigned int)(keep.size());
+					keep.push_back( *corners[k] );
+				}
+				*corners[k] = (unsigned short)(remap[*corners[k]]);
+			}
+		}
+	}
+	NiTriShapeDataRef lodData = CopyVertices( data, keep );
+	lodData->SetTriangles( tris );
+
+	NiTriShapeRef lod = new NiTriShape;
+	lod->SetName( shape->GetName() );
+	lod->SetFlags( shape->GetFlags() );
+	lod->SetLocalTransform( shape->GetLocalTransform() );
+	lod->SetData( lodData );
+	const vector<NiPropertyRef> & properties = shape->GetProperties();
+	for ( unsigned int i = 0; i < properties.size(); ++i ) {
+		lod->AddProperty( properties[i] );
+	}
+	lod->SetBSProperties( shape->GetBSProperties() );
+	if ( shape->HasShader() ) {
+		lod->SetShader( shape->GetShader() );
+	}
+
+	if ( skinned ) {
+		NiSkinInstanceRef lodSkin = new NiSkinInstance;
+		lodSkin->BindSkin( skin->GetSkeletonRoot(), skin->GetBones() );
+		//Partitioning sets the partition on the skin data too, so each level needs its own
+		//Clone leaves the links out, so the copy has no partition yet
+		lodSkin->SetSkinData( DynamicCast<NiSkinData>( skin->GetSkinData()->Clone() ) );
+		lod->SetSkinInstance( lodSkin );
+		if ( skin->GetSkinPartition() != NULL ) {
+			lod->GenHardwareSkinInfo();
+		}
+	}
+	return lod;
+}
+
+namespace Niflib {
+
+vector<Triangle> SimplifyTriangles( NiTriBasedGeomData * data, unsigned int target_triangles, NiSkinData * skin, float attribute_weight, float * error ) {
+	if ( data == NULL ) {
+		throw runtime_error( "Attempted to simplify a mesh without data." );
+	}
+	Simplifier simplifier( data, skin, attribute_weight );
+	float e;
+	vector<Triangle> result = simplifier.Run( target_triangles, e );
+	if ( error != NULL ) {
+		*error = e;
+	}
+	return result;
+}
+
+Ref<NiLODNode> GenerateLODs( NiTriBasedGeom * shape, const vector<float> & ratios, float screen_error, float attribute_weight ) {
+	if ( shape == NULL ) {
+		throw runtime_error( "Attempted to generate levels of detail without a shape." );
+	}
+	NiTriBasedGeomDataRef data = DynamicCast<NiTriBasedGeomData>( shape->GetData() );
+	if ( data == NULL ) {
+		throw runtime_error( "Attempted to generate levels of detail for a shape without triangle data." );
+	}
+	if ( screen_error <= 0.0f ) {
+		throw runtime_error( "The screen error of levels of detail must be positive." );
+	}
+	NiTriBasedGeomRef keep( shape );
+	NiSkinInstanceRef skin = shape->GetSkinInstance();
+	NiSkinDataRef skinData = skin != NULL ? skin->GetSkinData() : NiSkinDataRef();
+
+	NiLODNodeRef node = new NiLODNode;
+	node->SetName( shape->GetName() );
+	NiNodeRef parent = shape->GetParent();
+	if ( parent != NULL ) {
+		parent->RemoveChild( StaticCast<NiAVObject>( keep ) );
+		parent->AddChild( StaticCast<NiAVObject>( node ) );
+	}
+
+	const unsigned int triangles = (unsigned int)(data->GetTriangles().size());
+	vector<NiTriShapeRef> levels;
+	vector<float> errors;
+	for ( unsigned int i = 0; i < ratios.size(); ++i ) {
+		float error;
+		vector<Triangle> tris = SimplifyTriangles( data, (unsigned int)( triangles * ratios[i] ), skinData, attribute_weight, &error );
+		levels.push_back( MakeLODShape( shape, tris ) );
+		errors.push_back( error );
+	}
+	//AddChild puts shapes first, so add the levels from the last to keep them in order
+	for ( unsigned int i = (unsigned int)(levels.size()); i > 0; --i ) {
+		node->AddChild( StaticCast<NiAVObject>( levels[i - 1] ) );
+	}
+	node->AddChild( StaticCast<NiAVObject>( keep ) );
+
+	//Switch to the next level once its error is small enough on the screen
+	vector<LODRange> ranges( ratios.size() + 1 );
+	float near_extent = 0.0f;
+	for ( unsigned int i = 0; i < ranges.size(); ++i ) {
+		ranges[i].nearExtent = near_extent;
+		ranges[i].farExtent = i < errors.size() ? max( near_extent, errors[i] / screen_error ) : FLT_MAX;
+		near_extent = ranges[i].farExtent;
+	}
+	Vector3 center = shape->GetLocalTransform() * data->GetCenter();
+	node->SetLODCenter( center );
+	node->SetLODLevels( ranges );
+	NiRangeLODDataRef rangeData = new NiRangeLODData;
+	rangeData->SetLODCenter( center );
+	rangeData->SetLODLevels( ranges );
+	node->SetLODLevelData( StaticCast<NiLODData>( rangeData ) );
+	return node;
+}
+
+unsigned int GenerateSceneLODs( NiNode * root, const vector<float> & ratios, float screen_error, float attribute_weight ) {
+	if ( root == NULL || root->IsDerivedType( NiLODNode::TYPE ) ) {
+		return 0;
+	}
+	unsigned int count = 0;
+	vector<NiAVObjectRef> children = root->GetChildren();
+	for ( unsigned int i = 0; i < children.size(); ++i ) {
+		NiNodeRef node = DynamicCast<NiNode>( children[i] );
+		if ( node != NULL ) {
+			count += GenerateSceneLODs( node, ratios, screen_error, attribute_weight );
+			continue;
+		}
+		NiTriBasedGeomRef geom = DynamicCast<NiTriBasedGeom>( children[i] );
+		if ( geom == NULL || geom->IsDerivedType( BSLODTriShape::TYPE ) || DynamicCast<NiTriBasedGeomData>( geom->GetData() ) == NULL ) {
+			continue;
+		}
+		GenerateLODs( geom, ratios, screen_error, attribute_weight );
+		++count;
+	}
+	return count;
+}
+
+void GenerateLODTriShapeLevels( BSLODTriShape * shape, float level1_ratio, float level2_ratio, float attribute_weight ) {
+	if ( shape == NULL ) {
+		throw runtime_error( "Attempted to generate levels of detail without a shape." );
+	}
+	NiTriShapeDataRef data = DynamicCast<NiTriShapeData>( shape->GetData() );
+	if ( data == NULL ) {
+		throw runtime_error( "The levels of a BSLODTriShape can only be generated for NiTriShapeData." );
+	}
+	vector<Triangle> tris = data->GetTriangles();
+	const unsigned int level0 = shape->GetLODLevelSize( 0 );
+	if ( level0 > 0 && level0 + shape->GetLODLevelSize( 1 ) + shape->GetLODLevelSize( 2 ) == tris.size() ) {
+		tris.resize( level0 );
+		data->SetTriangles( tris );
+	}
+	NiSkinInstanceRef skin = shape->GetSkinInstance();
+	NiSkinDataRef skinData = skin != NULL ? skin->GetSkinData() : NiSkinDataRef();
+	const unsigned int count = (unsigned int)(tris.size());
+	vector<Triangle> level1 = SimplifyTriangles( data, (unsigned int)( count * level1_ratio ), skinData, attribute_weight );
+	vector<Triangle> level2 = SimplifyTriangles( data, (unsigned int)( count * level2_ratio ), skinData, attribute_weight );
+	tris.insert( tris.end(), level1.begin(), level1.end() );
+	tris.insert( tris.end(), level2.begin(), level2.end() );
+	data->SetTriangles( tris );
+	shape->SetLODLevelSize( 0, count );
+	shape->SetLODLevelSize( 1, (unsigned int)(level1.size()) );
+	shape->SetLODLevelSize( 2, (unsigned int)(level2.size()) );
+}
+
+} //End namespace Niflib
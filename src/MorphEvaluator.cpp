@@ -0,0 +1,130 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#include "../include/MorphEvaluator.h"
+#include "../include/obj/NiFloatInterpolator.h"
+#include "../include/obj/NiFloatData.h"
+
+using namespace Niflib;
+
+//Float interpolators use a huge negative value when their pose is not set
+static bool IsValidPose( float value ) {
+	return value > -1.0e30f && value < 1.0e30f;
+}
+
+MorphEvaluator::MorphEvaluator( NiMorphData * data, float tolerance ) : data(data) {
+	if ( data == NULL ) {
+		throw runtime_error( "Attempted to create a MorphEvaluator for null morph data." );
+	}
+	init( tolerance );
+}
+
+MorphEvaluator::MorphEvaluator( NiGeomMorpherController * controller, float tolerance ) : controller(controller) {
+	if ( controller == NULL ) {
+		throw runtime_error( "Attempted to create a MorphEvaluator for a null controller." );
+	}
+	data = controller->GetData();
+	if ( data == NULL ) {
+		throw runtime_error( "Attempted to create a MorphEvaluator for a controller without morph data." );
+	}
+	init( tolerance );
+}
+
+MorphEvaluator::~MorphEvaluator() {}
+
+void MorphEvaluator::init( float tolerance ) {
+	unsigned int count = (unsigned int)(data->GetMorphCount());
+	if ( count > 0 ) {
+		base = data->GetMorphVerts( 0 );
+	}
+
+	//Keep only the offsets that move a vertex, in one run per morph target
+	float tol2 = tolerance * tolerance;
+	morphStart.push_back( 0 );
+	if ( count > 0 ) {
+		morphStart.push_back( 0 );
+	}
+	for ( unsigned int n = 1; n < count; ++n ) {
+		vector<Vector3> deltas = data->GetMorphDeltas( n );
+		for ( unsigned int i = 0; i < deltas.size() && i < base.size(); ++i ) {
+			const Vector3 & d = deltas[i];
+			float len2 = d.DotProduct( d );
+			if ( len2 > tol2 && len2 > 0.0f ) {
+				index.push_back( i );
+				dx.push_back( d.x );
+				dy.push_back( d.y );
+				dz.push_back( d.z );
+			}
+		}
+		morphStart.push_back( (unsigned int)(index.size()) );
+	}
+}
+
+unsigned int MorphEvaluator::GetVertexCount() const {
+	return (unsigned int)(base.size());
+}
+
+unsigned int MorphEvaluator::GetMorphCount() const {
+	return (unsigned int)(morphStart.size() - 1);
+}
+
+unsigned int MorphEvaluator::GetMovedVertexCount( unsigned int n ) const {
+	if ( n + 1 >= morphStart.size() ) {
+		throw runtime_error( "MorphEvaluator::GetMovedVertexCount was given a morph index that is out of range." );
+	}
+	return morphStart[n + 1] - morphStart[n];
+}
+
+vector<float> MorphEvaluator::EvaluateWeights( float time ) const {
+	unsigned int count = GetMorphCount();
+	vector<float> weights( count, 0.0f );
+	vector< Ref<NiInterpolator> > interps;
+	if ( controller != NULL ) {
+		interps = controller->GetInterpolators();
+	}
+	for ( unsigned int n = 0; n < count; ++n ) {
+		NiFloatInterpolatorRef interp;
+		if ( n < interps.size() ) {
+			interp = DynamicCast<NiFloatInterpolator>( interps[n] );
+		}
+		if ( interp == NULL ) {
+			//Older files keep the weight keys with the morph targets
+			weights[n] = data->EvaluateMorphWeight( n, time );
+			continue;
+		}
+		NiFloatDataRef fdata = interp->GetData();
+		if ( fdata != NULL && !fdata->GetKeys().empty() ) {
+			weights[n] = fdata->Evaluate( time );
+		} else if ( IsValidPose( interp->GetFloatValue() ) ) {
+			weights[n] = interp->GetFloatValue();
+		}
+	}
+	return weights;
+}
+
+void MorphEvaluator::Evaluate( const vector<float> & weights, vector<Vector3> & vertices ) const {
+	vertices = base;
+	if ( vertices.empty() ) {
+		return;
+	}
+
+	//Accumulate the sparse offsets of each weighted morph target
+	unsigned int count = GetMorphCount();
+	for ( unsigned int n = 1; n < count && n < weights.size(); ++n ) {
+		float w = weights[n];
+		if ( w == 0.0f ) {
+			continue;
+		}
+		unsigned int end = morphStart[n + 1];
+		for ( unsigned int k = morphStart[n]; k < end; ++k ) {
+			Vector3 & v = vertices[index[k]];
+			v.x += w * dx[k];
+			v.y += w * dy[k];
+			v.z += w * dz[k];
+		}
+	}
+}
+
+void MorphEvaluator::Evaluate( float time, vector<Vector3> & vertices ) const {
+	Evaluate( EvaluateWeights( time ), vertices );
+}
@@ -728,18 +728,11 @@ static void FromIndexString(IndexString const &value, Header* header, unsigned i
 	if (value.empty()) {
 		idx = 0xffffffff;
 	} else {
-		size_t i = 0;
-		for ( ; i < header->strings.size(); i++) {
-			if (header->strings[i] == value)
-				break;
-		}
-		if (i >= header->numStrings)
-			header->numStrings = i;
+		idx = header->AddString(value);
+		header->numStrings = (unsigned int)(header->strings.size());
 		size_t len = value.length();
 		if (header->maxStringLength < len)
 			header->maxStringLength = len;
-		header->strings.push_back(value);
-		idx = i;
 	}
 }
 
@@ -0,0 +1,217 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#include "../include/ObjectArena.h"
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <map>
+#ifdef NIFLIB_CXX11
+#include <atomic>
+#include <mutex>
+#endif
+
+#if defined(_MSC_VER)
+#define NIFLIB_THREAD_LOCAL __declspec(thread)
+#else
+#define NIFLIB_THREAD_LOCAL __thread
+#endif
+
+namespace Niflib {
+
+using namespace std;
+
+struct ArenaBlocks;
+
+//The address range of a block and the arena blocks it belongs to
+struct BlockRange {
+	const char * end;
+	ArenaBlocks * blocks;
+};
+
+//The blocks of all arenas by start address, so that freeing an object finds
+//the arena it came from without a header in front of every object
+typedef map<const char *,BlockRange> BlockRanges;
+
+static BlockRanges & GetBlockRanges() {
+	static BlockRanges ranges;
+	return ranges;
+}
+
+//The number of blocks in the map, so that objects from the heap can be freed
+//without looking at the map while no arena exists.  With NIFLIB_CXX11 the map
+//and the object counts of the arenas are guarded by a mutex, since objects may
+//be released on any thread.
+#ifdef NIFLIB_CXX11
+static std::atomic<unsigned int> block_count( 0 );
+
+static std::mutex & GetBlockMutex() {
+	static std::mutex mutex;
+	return mutex;
+}
+
+class BlockLock {
+public:
+	BlockLock() : guard( GetBlockMutex() ) {}
+private:
+	std::lock_guard<std::mutex> guard;
+};
+#else
+static unsigned int block_count = 0;
+
+class BlockLock {
+public:
+	BlockLock() {}
+};
+#endif
+
+//The blocks of an arena.  They live until the arena and all of its objects are gone.
+struct ArenaBlocks {
+	vector<char *> blocks;
+	size_t blockSize;
+	size_t used;
+	size_t bytes;
+	unsigned int objects;
+	bool released;
+
+	//Must be called with the BlockLock held
+	~ArenaBlocks() {
+		for ( unsigned int i = 0; i < blocks.size(); ++i ) {
+			GetBlockRanges().erase( blocks[i] );
+			--block_count;
+			free( blocks[i] );
+		}
+	}
+
+	char * NewBlock( size_t size ) {
+		char * p = (char *)( malloc( size ) );
+		if ( p == NULL ) {
+			throw bad_alloc();
+		}
+		BlockRange range;
+		range.end = p + size;
+		range.blocks = this;
+		BlockLock lock;
+		GetBlockRanges()[p] = range;
+		++block_count;
+		return p;
+	}
+
+	//Must be called with the BlockLock held
+	void DeleteIfUnused() {
+		if ( released && objects == 0 ) {
+			delete this;
+		}
+	}
+};
+
+//Allocations are padded so that every object stays aligned for any type
+union MaxAlign {
+	double alignDouble;
+	long double alignLongDouble;
+	void * alignPointer;
+};
+
+static const size_t ALIGNMENT = sizeof(MaxAlign);
+
+static NIFLIB_THREAD_LOCAL ObjectArena * current_arena = NULL;
+
+ObjectArena::ObjectArena( size_t block_size ) : blocks( new ArenaBlocks ) {
+	blocks->blockSize = block_size;
+	blocks->used = block_size;
+	blocks->bytes = 0;
+	blocks->objects = 0;
+	blocks->released = false;
+}
+
+ObjectArena::~ObjectArena() {
+	if ( current_arena == this ) {
+		current_arena = NULL;
+	}
+	BlockLock lock;
+	blocks->released = true;
+	blocks->DeleteIfUnused();
+}
+
+void * ObjectArena::Allocate( size_t size ) {
+	size = ( size + ALIGNMENT - 1 ) / ALIGNMENT * ALIGNMENT;
+	if ( size > blocks->blockSize ) {
+		//Too large to share a block; put it before the current block so that the rest of that stays in use
+		char * p = blocks->NewBlock( size );
+		blocks->blocks.insert( blocks->blocks.end() - ( blocks->blocks.empty() ? 0 : 1 ), p );
+		blocks->bytes += size;
+		return p;
+	}
+	if ( blocks->used + size > blocks->blockSize ) {
+		char * p = blocks->NewBlock( blocks->blockSize );
+		blocks->blocks.push_back( p );
+		blocks->used = 0;
+	}
+	void * p = blocks->blocks.back() + blocks->used;
+	blocks->used += size;
+	blocks->bytes += size;
+	return p;
+}
+
+unsigned int ObjectArena::GetObjectCount() const {
+	BlockLock lock;
+	return blocks->objects;
+}
+
+size_t ObjectArena::GetBytesUsed() const {
+	return blocks->bytes;
+}
+
+unsigned int ObjectArena::GetBlockCount() const {
+	return (unsigned int)( blocks->blocks.size() );
+}
+
+ObjectArena * ObjectArena::GetCurrent() {
+	return current_arena;
+}
+
+ObjectArena::Scope::Scope( ObjectArena * arena ) : previous( current_arena ) {
+	current_arena = arena;
+}
+
+ObjectArena::Scope::~Scope() {
+	current_arena = previous;
+}
+
+void * ObjectArena::AllocateObject( size_t size ) {
+	if ( current_arena != NULL ) {
+		void * p = current_arena->Allocate( size );
+		BlockLock lock;
+		++current_arena->blocks->objects;
+		return p;
+	}
+	void * p = malloc( size );
+	if ( p == NULL ) {
+		throw bad_alloc();
+	}
+	return p;
+}
+
+void ObjectArena::FreeObject( void * p ) {
+	if ( p == NULL ) {
+		return;
+	}
+	if ( block_count != 0 ) {
+		BlockLock lock;
+		BlockRanges & ranges = GetBlockRanges();
+		BlockRanges::iterator it = ranges.upper_bound( (const char *)( p ) );
+		if ( it != ranges.begin() ) {
+			--it;
+			if ( (const char *)( p ) < it->second.end ) {
+				//Arena memory is only released with the whole arena
+				ArenaBlocks * blocks = it->second.blocks;
+				--blocks->objects;
+				blocks->DeleteIfUnused();
+				return;
+			}
+		}
+	}
+	free( p );
+}
+
+} //End namespace Niflib
@@ -0,0 +1,273 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#include "../include/ObjectDeduplicator.h"
+#include "../include/NIF_IO.h"
+#include "../include/obj/NiObject.h"
+#include "../include/obj/NiNode.h"
+#include "../include/obj/NiTimeController.h"
+#include "../include/obj/NiSkinInstance.h"
+#include "../include/gen/Header.h"
+#include <set>
+#include <sstream>
+
+using namespace Niflib;
+
+static const unsigned long long FNV_OFFSET = 14695981039346656037ULL;
+static const unsigned long long FNV_PRIME = 1099511628211ULL;
+
+static unsigned long long HashBytes( const char * bytes, size_t size, unsigned long long hash = FNV_OFFSET ) {
+	for ( size_t i = 0; i < size; ++i ) {
+		hash ^= (unsigned char)(bytes[i]);
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+static unsigned long long HashValue( unsigned long long value, unsigned long long hash ) {
+	for ( unsigned int i = 0; i < 8; ++i ) {
+		hash ^= (unsigned char)( value >> ( 8 * i ) );
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+//An object as it is written, with every link left out
+struct ObjectContent {
+	//The type name, the data and the strings the data indexes
+	string bytes;
+	//The size of the data alone
+	unsigned int size;
+	//The objects linked to, in the order they are written
+	vector<NiObject *> links;
+};
+
+static void GetContent( NiObject * obj, const NifInfo & info, ObjectContent & content ) {
+	//A header of its own keeps the string indices of each object independent
+	Header header;
+	stringstream tmp;
+	tmp << hdrInfo(&header);
+	map<NiObjectRef,unsigned int> link_map;
+	list<NiObject *> missing_link_stack;
+	obj->Write( tmp, link_map, missing_link_stack, info );
+
+	string data = tmp.str();
+	content.size = (unsigned int)(data.size());
+	content.bytes = obj->GetType().GetTypeName();
+	content.bytes += '\0';
+	content.bytes += data;
+	for ( unsigned int i = 0; i < header.strings.size(); ++i ) {
+		content.bytes += '\0';
+		content.bytes += header.strings[i];
+	}
+	content.links.assign( missing_link_stack.begin(), missing_link_stack.end() );
+}
+
+//Lists the objects of a tree with every object after the objects it refers to
+static void CollectObjects( NiObject * obj, set<NiObject *> & visited, vector<NiObject *> & order ) {
+	if ( obj == NULL || !visited.insert( obj ).second ) {
+		return;
+	}
+	list<NiObjectRef> refs = obj->GetRefs();
+	for ( list<NiObjectRef>::iterator it = refs.begin(); it != refs.end(); ++it ) {
+		CollectObjects( *it, visited, order );
+	}
+	order.push_back( obj );
+}
+
+static bool IsShareable( NiObject * obj ) {
+	return !obj->IsDerivedType( NiAVObject::TYPE ) && !obj->IsDerivedType( NiTimeController::TYPE ) && !obj->IsDerivedType( NiSkinInstance::TYPE );
+}
+
+static NiObject * Canonical( const map<NiObject *,NiObject *> & canonical, NiObject * obj ) {
+	map<NiObject *,NiObject *>::const_iterator it = canonical.find( obj );
+	return it != canonical.end() ? it->second : obj;
+}
+
+//Reads an object back from what it writes, with its links going through objects
+static void Relink( NiObject * obj, const map<NiObjectRef,unsigned int> & link_map, const map<unsigned int,NiObjectRef> & objects, const NifInfo & info ) {
+	Header header;
+	stringstream tmp;
+	tmp << hdrInfo(&header);
+	list<NiObject *> missing_link_stack;
+	obj->Write( tmp, link_map, missing_link_stack, info );
+
+	list<unsigned int> link_stack;
+	obj->Read( tmp, link_stack, info );
+	list<NiObjectRef> missing;
+	obj->FixLinks( objects, link_stack, missing, info );
+
+	//FixLinks attaches a skin instance to its skeleton root again
+	NiSkinInstanceRef skin = DynamicCast<NiSkinInstance>( obj );
+	if ( skin != NULL && skin->GetSkeletonRoot() != NULL ) {
+		skin->GetSkeletonRoot()->RemoveSkin( skin );
+		skin->GetSkeletonRoot()->AddSkin( skin );
+	}
+}
+
+//Hashes the objects of a tree together with the objects they link to and
+//records the shareable ones as found in a file
+static void FindFileObjects( NiObject * root, const NifInfo & info, const string & file_name, map<unsigned long long,SharedObject> & found ) {
+	set<NiObject *> visited;
+	vector<NiObject *> order;
+	CollectObjects( root, visited, order );
+
+	map<NiObject *,unsigned long long> hashes;
+	for ( unsigned int i = 0; i < order.size(); ++i ) {
+		ObjectContent content;
+		GetContent( order[i], info, content );
+		unsigned long long hash = HashBytes( content.bytes.data(), content.bytes.size() );
+		for ( unsigned int j = 0; j < content.links.size(); ++j ) {
+			NiObject * link = content.links[j];
+			map<NiObject *,unsigned long long>::iterator it = hashes.find( link );
+			if ( link == NULL ) {
+				hash = HashValue( 0, hash );
+			} else if ( it != hashes.end() ) {
+				hash = HashValue( it->second, hash );
+			} else {
+				//A link back up the tree, which only the type can stand for
+				const string & type = link->GetType().GetTypeName();
+				hash = HashBytes( type.data(), type.size(), hash );
+			}
+		}
+		hashes[order[i]] = hash;
+
+		if ( !IsShareable( order[i] ) ) {
+			continue;
+		}
+		SharedObject & obj = found[hash];
+		if ( obj.files.empty() ) {
+			obj.type = order[i]->GetType().GetTypeName();
+			obj.hash = hash;
+			obj.size = content.size;
+		}
+		if ( obj.files.empty() || obj.files.back() != file_name ) {
+			obj.files.push_back( file_name );
+		}
+	}
+}
+
+namespace Niflib {
+
+DeduplicateResult::DeduplicateResult() : removedObjects(0), bytesSaved(0) {}
+
+DeduplicateResult & DeduplicateResult::operator+=( const DeduplicateResult & rh ) {
+	removedObjects += rh.removedObjects;
+	bytesSaved += rh.bytesSaved;
+	return *this;
+}
+
+DeduplicateResult DeduplicateObjects( NiObject * root, const NifInfo & info ) {
+	if ( info.version < VER_3_3_0_13 ) {
+		throw runtime_error("Objects can only be deduplicated for versions that write links as indices.");
+	}
+	DeduplicateResult result;
+
+	set<NiObject *> visited;
+	vector<NiObject *> order;
+	CollectObjects( root, visited, order );
+
+	//Objects come after those they refer to, so the links of each object can
+	//be compared through the objects that have already been replaced
+	vector<ObjectContent> contents( order.size() );
+	map<NiObject *,NiObject *> canonical;
+	multimap<unsigned long long,unsigned int> by_hash;
+	for ( unsigned int i = 0; i < order.size(); ++i ) {
+		GetContent( order[i], info, contents[i] );
+		if ( order[i] == root || !IsShareable( order[i] ) ) {
+			continue;
+		}
+		vector<NiObject *> links( contents[i].links );
+		for ( unsigned int j = 0; j < links.size(); ++j ) {
+			links[j] = Canonical( canonical, links[j] );
+		}
+
+		unsigned long long hash = HashBytes( contents[i].bytes.data(), contents[i].bytes.size() );
+		pair< multimap<unsigned long long,unsigned int>::iterator, multimap<unsigned long long,unsigned int>::iterator > range = by_hash.equal_range( hash );
+		bool duplicate = false;
+		for ( multimap<unsigned long long,unsigned int>::iterator it = range.first; it != range.second; ++it ) {
+			const ObjectContent & other = contents[it->second];
+			if ( other.bytes != contents[i].bytes || other.links.size() != links.size() ) {
+				continue;
+			}
+			unsigned int j = 0;
+			while ( j < links.size() && Canonical( canonical, other.links[j] ) == links[j] ) {
+				++j;
+			}
+			if ( j == links.size() ) {
+				canonical[order[i]] = order[it->second];
+				++result.removedObjects;
+				result.bytesSaved += contents[i].size;
+				duplicate = true;
+				break;
+			}
+		}
+		if ( !duplicate ) {
+			by_hash.insert( make_pair( hash, i ) );
+		}
+	}
+	if ( canonical.empty() ) {
+		return result;
+	}
+
+	//Number every object that is linked to, including those outside of the tree
+	map<NiObjectRef,unsigned int> link_map;
+	map<unsigned int,NiObjectRef> objects;
+	for ( unsigned int i = 0; i < order.size(); ++i ) {
+		link_map[order[i]] = i;
+		objects[i] = Canonical( canonical, order[i] );
+	}
+	for ( unsigned int i = 0; i < contents.size(); ++i ) {
+		for ( unsigned int j = 0; j < contents[i].links.size(); ++j ) {
+			NiObject * link = contents[i].links[j];
+			if ( link != NULL && link_map.find( link ) == link_map.end() ) {
+				unsigned int index = (unsigned int)(link_map.size());
+				link_map[link] = index;
+				objects[index] = link;
+			}
+		}
+	}
+
+	//Point the links of the remaining objects at the shared objects
+	for ( unsigned int i = 0; i < order.size(); ++i ) {
+		if ( canonical.find( order[i] ) != canonical.end() ) {
+			continue;
+		}
+		for ( unsigned int j = 0; j < contents[i].links.size(); ++j ) {
+			if ( canonical.find( contents[i].links[j] ) != canonical.end() ) {
+				Relink( order[i], link_map, objects, info );
+				break;
+			}
+		}
+	}
+	return result;
+}
+
+DeduplicateResult DeduplicateFiles( const vector<string> & file_names, vector<SharedObject> * shared ) {
+	DeduplicateResult result;
+	map<unsigned long long,SharedObject> found;
+	for ( unsigned int i = 0; i < file_names.size(); ++i ) {
+		NifInfo info;
+		NiObjectRef root = ReadNifTree( file_names[i], &info );
+		DeduplicateResult removed = DeduplicateObjects( root, info );
+		if ( removed.removedObjects > 0 ) {
+			WriteNifTree( file_names[i], root, info );
+		}
+		result += removed;
+		if ( shared != NULL ) {
+			FindFileObjects( root, info, file_names[i], found );
+		}
+	}
+
+	if ( shared != NULL ) {
+		shared->clear();
+		for ( map<unsigned long long,SharedObject>::iterator it = found.begin(); it != found.end(); ++it ) {
+			if ( it->second.files.size() > 1 ) {
+				shared->push_back( it->second );
+			}
+		}
+	}
+	return result;
+}
+
+} //End namespace Niflib
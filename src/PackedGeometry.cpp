@@ -0,0 +1,465 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#include "../include/PackedGeometry.h"
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+using namespace Niflib;
+
+namespace Niflib {
+
+//Stores values in little endian order, the byte order of the files
+static void PutShort( byte * dest, unsigned short value ) {
+	dest[0] = byte( value & 0xFF );
+	dest[1] = byte( value >> 8 );
+}
+
+static void PutInt( byte * dest, unsigned int value ) {
+	dest[0] = byte( value & 0xFF );
+	dest[1] = byte( ( value >> 8 ) & 0xFF );
+	dest[2] = byte( ( value >> 16 ) & 0xFF );
+	dest[3] = byte( value >> 24 );
+}
+
+static unsigned short GetShort( const byte * src ) {
+	return (unsigned short)( src[0] | ( src[1] << 8 ) );
+}
+
+static unsigned int GetInt( const byte * src ) {
+	return (unsigned int)(src[0]) | ( (unsigned int)(src[1]) << 8 ) | ( (unsigned int)(src[2]) << 16 ) | ( (unsigned int)(src[3]) << 24 );
+}
+
+static float Clamp( float v, float lo, float hi ) {
+	return v < lo ? lo : ( v > hi ? hi : v );
+}
+
+//Rounds a value to the nearest integer from lo to hi
+static int Quantize( float v, float lo, float hi ) {
+	v = Clamp( v, lo, hi );
+	return int( std::floor( v + 0.5f ) );
+}
+
+static float Component( const Vector4 & v, unsigned int i ) {
+	switch ( i ) {
+		case 0: return v.x;
+		case 1: return v.y;
+		case 2: return v.z;
+		default: return v.w;
+	}
+}
+
+static void SetComponent( Vector4 & v, unsigned int i, float value ) {
+	switch ( i ) {
+		case 0: v.x = value; break;
+		case 1: v.y = value; break;
+		case 2: v.z = value; break;
+		default: v.w = value; break;
+	}
+}
+
+static void EncodeValue( AdditionalDataType type, const Vector4 & v, byte * dest ) {
+	unsigned int count;
+	GetAdditionalDataTypeSize( type, count );
+	switch ( type ) {
+		case ADT_FLOAT1:
+		case ADT_FLOAT2:
+		case ADT_FLOAT3:
+		case ADT_FLOAT4:
+			for ( unsigned int i = 0; i < count; ++i ) {
+				float f = Component( v, i );
+				unsigned int bits;
+				memcpy( &bits, &f, sizeof(bits) );
+				PutInt( dest + 4 * i, bits );
+			}
+			break;
+		case ADT_UBYTECOLOR:
+			//Stored as a little endian ARGB value
+			dest[0] = byte( Quantize( v.z * 255.0f, 0.0f, 255.0f ) );
+			dest[1] = byte( Quantize( v.y * 255.0f, 0.0f, 255.0f ) );
+			dest[2] = byte( Quantize( v.x * 255.0f, 0.0f, 255.0f ) );
+			dest[3] = byte( Quantize( v.w * 255.0f, 0.0f, 255.0f ) );
+			break;
+		case ADT_UBYTE4:
+			for ( unsigned int i = 0; i < 4; ++i ) {
+				dest[i] = byte( Quantize( Component( v, i ), 0.0f, 255.0f ) );
+			}
+			break;
+		case ADT_NORMUBYTE4:
+			for ( unsigned int i = 0; i < 4; ++i ) {
+				dest[i] = byte( Quantize( Component( v, i ) * 255.0f, 0.0f, 255.0f ) );
+			}
+			break;
+		case ADT_SHORT2:
+		case ADT_SHORT4:
+			for ( unsigned int i = 0; i < count; ++i ) {
+				PutShort( dest + 2 * i, (unsigned short)( Quantize( Component( v, i ), -32768.0f, 32767.0f ) ) );
+			}
+			break;
+		case ADT_NORMSHORT2:
+		case ADT_NORMSHORT4:
+			for ( unsigned int i = 0; i < count; ++i ) {
+				PutShort( dest + 2 * i, (unsigned short)( Quantize( Component( v, i ) * 32767.0f, -32767.0f, 32767.0f ) ) );
+			}
+			break;
+		case ADT_NORMUSHORT2:
+		case ADT_NORMUSHORT4:
+			for ( unsigned int i = 0; i < count; ++i ) {
+				PutShort( dest + 2 * i, (unsigned short)( Quantize( Component( v, i ) * 65535.0f, 0.0f, 65535.0f ) ) );
+			}
+			break;
+		case ADT_UDEC3:
+		case ADT_NORMDEC3: {
+			unsigned int bits = 0;
+			for ( unsigned int i = 0; i < 3; ++i ) {
+				int q;
+				if ( type == ADT_UDEC3 ) {
+					q = Quantize( Component( v, i ), 0.0f, 1023.0f );
+				} else {
+					q = Quantize( Component( v, i ) * 511.0f, -511.0f, 511.0f );
+				}
+				bits |= ( (unsigned int)(q) & 0x3FF ) << ( 10 * i );
+			}
+			PutInt( dest, bits );
+			break;
+		}
+		case ADT_FLOAT16_2:
+		case ADT_FLOAT16_4:
+			for ( unsigned int i = 0; i < count; ++i ) {
+				PutShort( dest + 2 * i, FloatToHalf( Component( v, i ) ) );
+			}
+			break;
+		default:
+			throw runtime_error("Cannot pack additional geometry data of an unknown type.");
+	}
+}
+
+static Vector4 DecodeValue( AdditionalDataType type, const byte * src ) {
+	unsigned int count;
+	GetAdditionalDataTypeSize( type, count );
+	Vector4 v;
+	switch ( type ) {
+		case ADT_FLOAT1:
+		case ADT_FLOAT2:
+		case ADT_FLOAT3:
+		case ADT_FLOAT4:
+			for ( unsigned int i = 0; i < count; ++i ) {
+				unsigned int bits = GetInt( src + 4 * i );
+				float f;
+				memcpy( &f, &bits, sizeof(f) );
+				SetComponent( v, i, f );
+			}
+			break;
+		case ADT_UBYTECOLOR:
+			v.x = float( src[2] ) / 255.0f;
+			v.y = float( src[1] ) / 255.0f;
+			v.z = float( src[0] ) / 255.0f;
+			v.w = float( src[3] ) / 255.0f;
+			break;
+		case ADT_UBYTE4:
+			for ( unsigned int i = 0; i < 4; ++i ) {
+				SetComponent( v, i, float( src[i] ) );
+			}
+			break;
+		case ADT_NORMUBYTE4:
+			for ( unsigned int i = 0; i < 4; ++i ) {
+				SetComponent( v, i, float( src[i] ) / 255.0f );
+			}
+			break;
+		case ADT_SHORT2:
+		case ADT_SHORT4:
+			for ( unsigned int i = 0; i < count; ++i ) {
+				SetComponent( v, i, float( short( GetShort( src + 2 * i ) ) ) );
+			}
+			break;
+		case ADT_NORMSHORT2:
+		case ADT_NORMSHORT4:
+			for ( unsigned int i = 0; i < count; ++i ) {
+				//-32768 is also -1
+				float f = float( short( GetShort( src + 2 * i ) ) ) / 32767.0f;
+				SetComponent( v, i, f < -1.0f ? -1.0f : f );
+			}
+			break;
+		case ADT_NORMUSHORT2:
+		case ADT_NORMUSHORT4:
+			for ( unsigned int i = 0; i < count; ++i ) {
+				SetComponent( v, i, float( GetShort( src + 2 * i ) ) / 65535.0f );
+			}
+			break;
+		case ADT_UDEC3:
+		case ADT_NORMDEC3: {
+			unsigned int bits = GetInt( src );
+			for ( unsigned int i = 0; i < 3; ++i ) {
+				int q = int( ( bits >> ( 10 * i ) ) & 0x3FF );
+				if ( type == ADT_UDEC3 ) {
+					SetComponent( v, i, float( q ) );
+				} else {
+					//Sign extend the 10 bit value
+					if ( q & 0x200 ) {
+						q -= 0x400;
+					}
+					float f = float( q ) / 511.0f;
+					SetComponent( v, i, f < -1.0f ? -1.0f : f );
+				}
+			}
+			break;
+		}
+		case ADT_FLOAT16_2:
+		case ADT_FLOAT16_4:
+			for ( unsigned int i = 0; i < count; ++i ) {
+				SetComponent( v, i, HalfToFloat( GetShort( src + 2 * i ) ) );
+			}
+			break;
+		default:
+			throw runtime_error("Cannot unpack additional geometry data of an unknown type.");
+	}
+	return v;
+}
+
+//The value of the unknown byte in each channel description of packed geometry
+//written by Bethesda's tools
+static const byte CHANNEL_UNKNOWN_BYTE = 2;
+
+//Interleaves the channels into one block of bytes and describes where each one went
+static void PackChannels( const vector<AdditionalChannel> & channels, vector<AdditionalDataInfo> & infos, vector<byte> & bytes, unsigned int & stride, unsigned short & num_vertices, vector<float> * errors ) {
+	size_t nv = channels.empty() ? 0 : channels[0].values.size();
+	if ( nv > 0xFFFF ) {
+		throw runtime_error("Additional geometry data can only hold 65535 vertices.");
+	}
+	num_vertices = (unsigned short)(nv);
+
+	vector<unsigned int> sizes( channels.size() );
+	vector<unsigned int> counts( channels.size() );
+	stride = 0;
+	for ( unsigned int c = 0; c < channels.size(); ++c ) {
+		if ( channels[c].values.size() != nv ) {
+			throw runtime_error("All channels of additional geometry data must have the same number of values.");
+		}
+		sizes[c] = GetAdditionalDataTypeSize( channels[c].type, counts[c] );
+		if ( sizes[c] == 0 ) {
+			throw runtime_error("Cannot pack additional geometry data of an unknown type.");
+		}
+		stride += sizes[c];
+	}
+
+	infos.resize( channels.size() );
+	unsigned int offset = 0;
+	for ( unsigned int c = 0; c < channels.size(); ++c ) {
+		AdditionalDataInfo & info = infos[c];
+		info.dataType = channels[c].type;
+		info.numChannelBytesPerElement = sizes[c];
+		info.numChannelBytes = int( sizes[c] * nv );
+		info.numTotalBytesPerElement = stride;
+		info.blockIndex = 0;
+		info.channelOffset = offset;
+		info.unknownByte1 = CHANNEL_UNKNOWN_BYTE;
+		offset += sizes[c];
+	}
+
+	bytes.assign( stride * nv, 0 );
+	if ( errors != NULL ) {
+		errors->assign( channels.size(), 0.0f );
+	}
+	for ( unsigned int c = 0; c < channels.size(); ++c ) {
+		AdditionalDataType type = channels[c].type;
+		const vector<Vector4> & values = channels[c].values;
+		byte * dest = nv > 0 ? &bytes[ infos[c].channelOffset ] : NULL;
+		float worst = 0.0f;
+		for ( size_t i = 0; i < nv; ++i, dest += stride ) {
+			EncodeValue( type, values[i], dest );
+			if ( errors != NULL ) {
+				Vector4 stored = DecodeValue( type, dest );
+				for ( unsigned int k = 0; k < counts[c]; ++k ) {
+					float e = std::fabs( Component( stored, k ) - Component( values[i], k ) );
+					if ( e > worst ) {
+						worst = e;
+					}
+				}
+			}
+		}
+		if ( errors != NULL ) {
+			(*errors)[c] = worst;
+		}
+	}
+}
+
+unsigned int GetAdditionalDataTypeSize( AdditionalDataType type, unsigned int & components ) {
+	switch ( type ) {
+		case ADT_FLOAT1: components = 1; return 4;
+		case ADT_FLOAT2: components = 2; return 8;
+		case ADT_FLOAT3: components = 3; return 12;
+		case ADT_FLOAT4: components = 4; return 16;
+		case ADT_UBYTECOLOR:
+		case ADT_UBYTE4:
+		case ADT_NORMUBYTE4: components = 4; return 4;
+		case ADT_SHORT2:
+		case ADT_NORMSHORT2:
+		case ADT_NORMUSHORT2: components = 2; return 4;
+		case ADT_SHORT4:
+		case ADT_NORMSHORT4:
+		case ADT_NORMUSHORT4: components = 4; return 8;
+		case ADT_UDEC3:
+		case ADT_NORMDEC3: components = 3; return 4;
+		case ADT_FLOAT16_2: components = 2; return 4;
+		case ADT_FLOAT16_4: components = 4; return 8;
+		default: components = 0; return 0;
+	}
+}
+
+Ref<BSPackedAdditionalGeometryData> PackAdditionalGeometry( const vector<AdditionalChannel> & channels, vector<float> * errors ) {
+	vector<AdditionalDataInfo> infos;
+	BSPackedAdditionalDataBlock block;
+	unsigned int stride;
+	unsigned short nv;
+	PackChannels( channels, infos, block.data, stride, nv, errors );
+
+	block.hasData = true;
+	block.numTotalBytes = int( block.data.size() );
+	block.blockOffsets.assign( 1, 0 );
+	for ( unsigned int c = 0; c < infos.size(); ++c ) {
+		block.atomSizes.push_back( infos[c].numChannelBytesPerElement );
+	}
+	block.unknownInt1 = 0;
+	block.numTotalBytesPerElement = stride;
+
+	Ref<BSPackedAdditionalGeometryData> result = new BSPackedAdditionalGeometryData;
+	result->SetVertexCount( nv );
+	result->SetBlockInfos( infos );
+	result->SetBlocks( vector<BSPackedAdditionalDataBlock>( 1, block ) );
+	return result;
+}
+
+Ref<NiAdditionalGeometryData> BuildAdditionalGeometry( const vector<AdditionalChannel> & channels, vector<float> * errors ) {
+	vector<AdditionalDataInfo> infos;
+	AdditionalDataBlock block;
+	block.data.resize( 1 );
+	unsigned int stride;
+	unsigned short nv;
+	PackChannels( channels, infos, block.data[0], stride, nv, errors );
+
+	block.hasData = true;
+	block.blockSize = int( block.data[0].size() );
+	block.blockOffsets.assign( 1, 0 );
+	block.dataSizes.assign( 1, block.blockSize );
+
+	Ref<NiAdditionalGeometryData> result = new NiAdditionalGeometryData;
+	result->SetVertexCount( nv );
+	result->SetBlockInfos( infos );
+	result->SetBlocks( vector<AdditionalDataBlock>( 1, block ) );
+	return result;
+}
+
+vector<AdditionalChannel> UnpackAdditionalGeometry( AbstractAdditionalGeometryData * data ) {
+	vector<AdditionalDataInfo> infos;
+	vector< const vector<byte> * > blocks;
+	unsigned int nv = 0;
+
+	BSPackedAdditionalGeometryData * packed = DynamicCast<BSPackedAdditionalGeometryData>( data );
+	NiAdditionalGeometryData * additional = DynamicCast<NiAdditionalGeometryData>( data );
+	if ( packed != NULL ) {
+		nv = packed->GetVertexCount();
+		infos = packed->GetBlockInfos();
+		const vector<BSPackedAdditionalDataBlock> & b = packed->GetBlocks();
+		for ( unsigned int i = 0; i < b.size(); ++i ) {
+			blocks.push_back( &b[i].data );
+		}
+	} else if ( additional != NULL ) {
+		nv = additional->GetVertexCount();
+		infos = additional->GetBlockInfos();
+		const vector<AdditionalDataBlock> & b = additional->GetBlocks();
+		for ( unsigned int i = 0; i < b.size(); ++i ) {
+			blocks.push_back( b[i].data.empty() ? NULL : &b[i].data[0] );
+		}
+	} else {
+		throw runtime_error("Only BSPackedAdditionalGeometryData and NiAdditionalGeometryData can be unpacked.");
+	}
+
+	vector<AdditionalChannel> channels( infos.size() );
+	for ( unsigned int c = 0; c < infos.size(); ++c ) {
+		const AdditionalDataInfo & info = infos[c];
+		AdditionalChannel & channel = channels[c];
+		channel.type = AdditionalDataType( info.dataType );
+		unsigned int count;
+		unsigned int size = GetAdditionalDataTypeSize( channel.type, count );
+		if ( size == 0 ) {
+			throw runtime_error("Cannot unpack additional geometry data of an unknown type.");
+		}
+		if ( info.blockIndex < 0 || (unsigned int)(info.blockIndex) >= blocks.size() || blocks[info.blockIndex] == NULL ) {
+			throw runtime_error("A channel of additional geometry data refers to a block that does not exist.");
+		}
+		const vector<byte> & bytes = *blocks[info.blockIndex];
+		if ( nv > 0 && size_t( info.channelOffset ) + size_t( info.numTotalBytesPerElement ) * ( nv - 1 ) + size > bytes.size() ) {
+			throw runtime_error("A channel of additional geometry data extends past the end of its block.");
+		}
+		channel.values.resize( nv );
+		for ( unsigned int i = 0; i < nv; ++i ) {
+			channel.values[i] = DecodeValue( channel.type, &bytes[ info.channelOffset + info.numTotalBytesPerElement * i ] );
+		}
+	}
+	return channels;
+}
+
+Ref<BSPackedAdditionalGeometryData> PackGeometryData( NiGeometryData * data, vector<float> * errors, bool clear_original ) {
+	if ( data == NULL ) {
+		throw runtime_error("Attempted to pack null geometry data.");
+	}
+	const vector<Vector3> & verts = data->GetVertices();
+	vector<AdditionalChannel> channels;
+
+	AdditionalChannel channel;
+	channel.type = ADT_FLOAT16_4;
+	channel.values.resize( verts.size() );
+	for ( unsigned int i = 0; i < verts.size(); ++i ) {
+		channel.values[i] = Vector4( verts[i].x, verts[i].y, verts[i].z, 1.0f );
+	}
+	channels.push_back( channel );
+
+	//Directions are stored in half their range, so their errors are doubled
+	//to give them in the units of the original vectors
+	vector<bool> is_direction( 1, false );
+	vector<Vector3> directions[3];
+	directions[0] = data->GetNormals();
+	directions[1] = data->GetTangents();
+	directions[2] = data->GetBitangents();
+	channel.type = ADT_NORMUBYTE4;
+	for ( unsigned int d = 0; d < 3; ++d ) {
+		if ( directions[d].size() != verts.size() ) {
+			continue;
+		}
+		for ( unsigned int i = 0; i < verts.size(); ++i ) {
+			const Vector3 & n = directions[d][i];
+			channel.values[i] = Vector4( n.x * 0.5f + 0.5f, n.y * 0.5f + 0.5f, n.z * 0.5f + 0.5f, 1.0f );
+		}
+		channels.push_back( channel );
+		is_direction.push_back( true );
+	}
+
+	channel.type = ADT_FLOAT16_2;
+	for ( short s = 0; s < data->GetUVSetCount(); ++s ) {
+		const vector<TexCoord> & uvs = data->GetUVSet( s );
+		if ( uvs.size() != verts.size() ) {
+			continue;
+		}
+		for ( unsigned int i = 0; i < verts.size(); ++i ) {
+			channel.values[i] = Vector4( uvs[i].u, uvs[i].v, 0.0f, 0.0f );
+		}
+		channels.push_back( channel );
+	}
+
+	Ref<BSPackedAdditionalGeometryData> result = PackAdditionalGeometry( channels, errors );
+	if ( errors != NULL ) {
+		for ( unsigned int c = 0; c < is_direction.size(); ++c ) {
+			if ( is_direction[c] ) {
+				(*errors)[c] *= 2.0f;
+			}
+		}
+	}
+	data->SetAdditionalData( result );
+	if ( clear_original ) {
+		data->ClearPackedChannels();
+	}
+	return result;
+}
+
+} //End namespace Niflib
@@ -0,0 +1,112 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#include "../include/ParticleSimulation.h"
+#include <stdexcept>
+
+using namespace Niflib;
+
+unsigned int ParticleState::Size() const {
+	return (unsigned int)(px.size());
+}
+
+unsigned int ParticleState::Add( unsigned int count ) {
+	unsigned int first = Size();
+	unsigned int n = first + count;
+	px.resize( n, 0.0f ); py.resize( n, 0.0f ); pz.resize( n, 0.0f );
+	vx.resize( n, 0.0f ); vy.resize( n, 0.0f ); vz.resize( n, 0.0f );
+	age.resize( n, 0.0f );
+	lifeSpan.resize( n, 0.0f );
+	radius.resize( n, 0.0f );
+	size.resize( n, 1.0f );
+	rotAngle.resize( n, 0.0f );
+	rotSpeed.resize( n, 0.0f );
+	r.resize( n, 1.0f ); g.resize( n, 1.0f ); b.resize( n, 1.0f ); a.resize( n, 1.0f );
+	generation.resize( n, 0 );
+	return first;
+}
+
+template <class T>
+static void RemoveSwap( vector<T> & v, unsigned int index ) {
+	v[index] = v.back();
+	v.pop_back();
+}
+
+void ParticleState::Remove( unsigned int index ) {
+	if ( index >= Size() ) {
+		throw runtime_error( "Attempted to remove a particle that does not exist." );
+	}
+	RemoveSwap( px, index ); RemoveSwap( py, index ); RemoveSwap( pz, index );
+	RemoveSwap( vx, index ); RemoveSwap( vy, index ); RemoveSwap( vz, index );
+	RemoveSwap( age, index );
+	RemoveSwap( lifeSpan, index );
+	RemoveSwap( radius, index );
+	RemoveSwap( size, index );
+	RemoveSwap( rotAngle, index );
+	RemoveSwap( rotSpeed, index );
+	RemoveSwap( r, index ); RemoveSwap( g, index ); RemoveSwap( b, index ); RemoveSwap( a, index );
+	RemoveSwap( generation, index );
+}
+
+void ParticleState::Clear() {
+	px.clear(); py.clear(); pz.clear();
+	vx.clear(); vy.clear(); vz.clear();
+	age.clear();
+	lifeSpan.clear();
+	radius.clear();
+	size.clear();
+	rotAngle.clear();
+	rotSpeed.clear();
+	r.clear(); g.clear(); b.clear(); a.clear();
+	generation.clear();
+}
+
+ParticleRandom::ParticleRandom( unsigned int seed ) : state(seed) {
+	//xorshift gets stuck at zero
+	if ( state == 0 ) {
+		state = 0x9E3779B9u;
+	}
+}
+
+float ParticleRandom::Uniform() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	//Use the top 24 bits, which a float holds exactly
+	return float( state >> 8 ) * ( 1.0f / 16777216.0f );
+}
+
+float ParticleRandom::Symmetric() {
+	return 2.0f * Uniform() - 1.0f;
+}
+
+ParticleBounds::ParticleBounds() : min(0.0f, 0.0f, 0.0f), max(0.0f, 0.0f, 0.0f), empty(true) {}
+
+void ParticleBounds::Add( const ParticleState & particles ) {
+	unsigned int n = particles.Size();
+	for ( unsigned int i = 0; i < n; ++i ) {
+		float rad = particles.radius[i] * particles.size[i];
+		if ( rad < 0.0f ) rad = -rad;
+		if ( empty ) {
+			min = max = Vector3( particles.px[i], particles.py[i], particles.pz[i] );
+			min -= rad;
+			max += rad;
+			empty = false;
+			continue;
+		}
+		if ( particles.px[i] - rad < min.x ) min.x = particles.px[i] - rad;
+		if ( particles.py[i] - rad < min.y ) min.y = particles.py[i] - rad;
+		if ( particles.pz[i] - rad < min.z ) min.z = particles.pz[i] - rad;
+		if ( particles.px[i] + rad > max.x ) max.x = particles.px[i] + rad;
+		if ( particles.py[i] + rad > max.y ) max.y = particles.py[i] + rad;
+		if ( particles.pz[i] + rad > max.z ) max.z = particles.pz[i] + rad;
+	}
+}
+
+Vector3 ParticleBounds::GetCenter() const {
+	return ( min + max ) * 0.5f;
+}
+
+Vector3 ParticleBounds::GetHalfExtents() const {
+	return ( max - min ) * 0.5f;
+}
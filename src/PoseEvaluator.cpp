@@ -0,0 +1,381 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#include "../include/PoseEvaluator.h"
+#include "../include/obj/NiNode.h"
+#include "../include/obj/NiDefaultAVObjectPalette.h"
+#include "../include/obj/NiStringPalette.h"
+#include "../include/obj/NiTransformData.h"
+#include "../include/obj/NiTransformInterpolator.h"
+#include "../include/obj/NiBSplineTransformInterpolator.h"
+#include "../include/obj/NiKeyframeController.h"
+#include "../include/gen/ControllerLink.h"
+
+#include <algorithm>
+#include <cmath>
+#ifdef NIFLIB_CXX11
+#include <thread>
+#endif
+
+using namespace Niflib;
+
+//Interpolator poses use a huge negative value for parts that are not set, and
+//new interpolators have a zero rotation and scale
+static bool IsValidPose( const Vector3 & value ) {
+	return value.x > -1.0e30f && value.x < 1.0e30f;
+}
+
+static bool IsValidPose( const Quaternion & value ) {
+	float norm = value.Dot( value );
+	return norm > 0.5f && norm < 2.0f;
+}
+
+static bool IsValidPose( float value ) {
+	return value > 0.0f && value < 1.0e30f;
+}
+
+//Converts the time since a sequence started into the time of its keys
+static float SequenceKeyTime( NiControllerSequence * seq, float time ) {
+	float start = seq->GetStartTime();
+	float stop = seq->GetStopTime();
+	float t = time * seq->GetFrequency();
+	float length = stop - start;
+	if ( length <= 0.0f ) {
+		return start;
+	}
+	switch ( seq->GetCycleType() ) {
+		case CYCLE_LOOP:
+			t = fmod( t, length );
+			if ( t < 0.0f ) t += length;
+			break;
+		case CYCLE_REVERSE:
+			t = fmod( t, 2.0f * length );
+			if ( t < 0.0f ) t += 2.0f * length;
+			if ( t > length ) t = 2.0f * length - t;
+			break;
+		default:
+			if ( t < 0.0f ) t = 0.0f;
+			if ( t > length ) t = length;
+			break;
+	}
+	return start + t;
+}
+
+//Adds every named object in the scene graph below obj to the bones, unless it is there already
+static void CollectBones( NiAVObject * obj, vector<NiAVObjectRef> & bones, map<string,unsigned int> & index ) {
+	string name = obj->GetName();
+	if ( !name.empty() && index.find( name ) == index.end() ) {
+		index[name] = (unsigned int)(bones.size());
+		bones.push_back( obj );
+	}
+	NiNodeRef node = DynamicCast<NiNode>( obj );
+	if ( node != NULL ) {
+		vector<NiAVObjectRef> children = node->GetChildren();
+		for ( vector<NiAVObjectRef>::iterator it = children.begin(); it != children.end(); ++it ) {
+			if ( *it != NULL ) {
+				CollectBones( *it, bones, index );
+			}
+		}
+	}
+}
+
+//One sampled transform of a bone, waiting to be blended
+struct PoseEvaluator::BoneSample {
+	unsigned int bone;
+	int priority;
+	float weight;
+	float time;
+	const Channel * channel;
+	QTransform value;
+
+	//Sorts samples by bone, and by decreasing priority within a bone
+	bool operator<( const BoneSample & b ) const {
+		if ( bone != b.bone ) return bone < b.bone;
+		return priority > b.priority;
+	}
+};
+
+#ifdef NIFLIB_CXX11
+//The fewest samples worth a thread of their own
+static const unsigned int MIN_THREAD_SAMPLES = 1024;
+#endif
+
+PoseEvaluator::PoseEvaluator( NiControllerManager * manager ) : manager(manager) {
+	if ( manager == NULL ) {
+		throw runtime_error( "Attempted to create a PoseEvaluator for a null controller manager." );
+	}
+	Update();
+}
+
+PoseEvaluator::~PoseEvaluator() {}
+
+void PoseEvaluator::Update() {
+	bones.clear();
+	boneIndex.clear();
+	restPose.clear();
+	channels.clear();
+	sequences = manager->GetControllerSequences();
+
+	//The bones are the palette objects, or the named objects of the target
+	NiDefaultAVObjectPaletteRef palette = manager->GetObjectPalette();
+	if ( palette != NULL ) {
+		vector<NiAVObjectRef> objs = palette->GetObjs();
+		for ( vector<NiAVObjectRef>::iterator it = objs.begin(); it != objs.end(); ++it ) {
+			if ( *it != NULL && boneIndex.find( (*it)->GetName() ) == boneIndex.end() ) {
+				boneIndex[(*it)->GetName()] = (unsigned int)(bones.size());
+				bones.push_back( *it );
+			}
+		}
+	} else {
+		NiAVObjectRef target = DynamicCast<NiAVObject>( manager->GetTarget() );
+		if ( target != NULL ) {
+			CollectBones( target, bones, boneIndex );
+		}
+	}
+
+	restPose.resize( bones.size() );
+	for ( unsigned int i = 0; i < bones.size(); ++i ) {
+		restPose[i].translation = bones[i]->GetLocalTranslation();
+		restPose[i].rotation = bones[i]->GetLocalRotation().AsQuaternion();
+		restPose[i].scale = bones[i]->GetLocalScale();
+	}
+
+	//Match the controlled blocks of each sequence to bones
+	channels.resize( sequences.size() );
+	for ( unsigned int s = 0; s < sequences.size(); ++s ) {
+		vector<ControllerLink> links = sequences[s]->GetControllerData();
+		for ( unsigned int i = 0; i < links.size(); ++i ) {
+			const ControllerLink & cl = links[i];
+			string node_name;
+			if ( cl.stringPalette != NULL ) {
+				node_name = cl.stringPalette->GetSubStr( cl.nodeNameOffset );
+			} else {
+				node_name = cl.nodeName;
+			}
+			map<string,unsigned int>::const_iterator bone = boneIndex.find( node_name );
+			if ( bone == boneIndex.end() ) {
+				continue;
+			}
+
+			Channel ch;
+			ch.bone = bone->second;
+			ch.priority = cl.priority;
+			ch.has_keys[0] = ch.has_keys[1] = ch.has_keys[2] = true;
+			NiKeyframeDataRef data;
+			if ( cl.interpolator != NULL && cl.interpolator->IsDerivedType( NiTransformInterpolator::TYPE ) ) {
+				NiTransformInterpolatorRef interp = StaticCast<NiTransformInterpolator>( cl.interpolator );
+				ch.source = TRANSFORM_INTERPOLATOR;
+				ch.object = interp;
+				data = StaticCast<NiKeyframeData>( interp->GetData() );
+			} else if ( cl.interpolator != NULL && cl.interpolator->IsDerivedType( NiBSplineTransformInterpolator::TYPE ) ) {
+				ch.source = BSPLINE_INTERPOLATOR;
+				ch.object = cl.interpolator;
+			} else if ( cl.controller != NULL && cl.controller->IsDerivedType( NiKeyframeController::TYPE ) ) {
+				data = StaticCast<NiKeyframeController>( cl.controller )->GetData();
+				if ( data == NULL ) {
+					continue;
+				}
+				ch.source = KEYFRAME_DATA;
+				ch.object = data;
+			} else {
+				continue;
+			}
+
+			//Find out once which tracks have keys, since the getters copy them
+			if ( data != NULL ) {
+				ch.has_keys[0] = !data->GetTranslateKeys().empty();
+				ch.has_keys[1] = !data->GetQuatRotateKeys().empty() || !data->GetXRotateKeys().empty()
+					|| !data->GetYRotateKeys().empty() || !data->GetZRotateKeys().empty();
+				ch.has_keys[2] = !data->GetScaleKeys().empty();
+			} else if ( ch.source == TRANSFORM_INTERPOLATOR ) {
+				ch.has_keys[0] = ch.has_keys[1] = ch.has_keys[2] = false;
+			}
+			ch.data = data;
+			channels[s].push_back( ch );
+		}
+	}
+}
+
+vector<NiAVObjectRef> PoseEvaluator::GetBones() const {
+	return bones;
+}
+
+int PoseEvaluator::GetBoneIndex( const string & name ) const {
+	map<string,unsigned int>::const_iterator it = boneIndex.find( name );
+	if ( it == boneIndex.end() ) {
+		return -1;
+	}
+	return int(it->second);
+}
+
+int PoseEvaluator::GetSequenceIndex( const string & name ) const {
+	for ( unsigned int i = 0; i < sequences.size(); ++i ) {
+		if ( sequences[i]->GetName() == name ) {
+			return int(i);
+		}
+	}
+	return -1;
+}
+
+vector<QTransform> PoseEvaluator::GetRestPose() const {
+	return restPose;
+}
+
+void PoseEvaluator::EvaluatePose( const vector<SequenceState> & active, vector<QTransform> & pose ) const {
+	pose = restPose;
+
+	//Collect every channel of the active sequences
+	vector<BoneSample> samples;
+	for ( unsigned int a = 0; a < active.size(); ++a ) {
+		if ( active[a].sequence >= sequences.size() ) {
+			throw runtime_error( "PoseEvaluator::EvaluatePose was given a sequence index that is out of range." );
+		}
+		NiControllerSequence * seq = sequences[active[a].sequence];
+		float weight = active[a].weight * seq->GetWeight();
+		if ( weight <= 0.0f ) {
+			continue;
+		}
+		float time = SequenceKeyTime( seq, active[a].time );
+		const vector<Channel> & chans = channels[active[a].sequence];
+		for ( unsigned int c = 0; c < chans.size(); ++c ) {
+			BoneSample sample;
+			sample.bone = chans[c].bone;
+			sample.priority = chans[c].priority;
+			sample.weight = weight;
+			sample.time = time;
+			sample.channel = &chans[c];
+			sample.value = restPose[sample.bone];
+			samples.push_back( sample );
+		}
+	}
+
+	//Group the samples by bone, highest priority first
+	stable_sort( samples.begin(), samples.end() );
+	vector<unsigned int> starts;
+	for ( unsigned int i = 0; i < samples.size(); ++i ) {
+		if ( i == 0 || samples[i].bone != samples[i - 1].bone ) {
+			starts.push_back( i );
+		}
+	}
+	unsigned int bone_count = (unsigned int)( starts.size() );
+	starts.push_back( (unsigned int)( samples.size() ) );
+
+#ifdef NIFLIB_CXX11
+	//Each bone is sampled and blended on its own, so large poses are split
+	//into runs of bones, one per thread
+	unsigned int thread_count = std::thread::hardware_concurrency();
+	if ( thread_count > samples.size() / MIN_THREAD_SAMPLES ) thread_count = (unsigned int)( samples.size() / MIN_THREAD_SAMPLES );
+	if ( thread_count > bone_count ) thread_count = bone_count;
+	if ( thread_count > 1 ) {
+		vector<std::thread> threads;
+		unsigned int first = 0;
+		for ( unsigned int i = 1; i <= thread_count; ++i ) {
+			unsigned int end = (unsigned int)( (unsigned long long)( bone_count ) * i / thread_count );
+			if ( i < thread_count ) {
+				threads.push_back( std::thread( BlendBones, &samples, &starts, first, end, &pose ) );
+			} else {
+				BlendBones( &samples, &starts, first, end, &pose );
+			}
+			first = end;
+		}
+		for ( unsigned int i = 0; i < threads.size(); ++i ) {
+			threads[i].join();
+		}
+		return;
+	}
+#endif
+	BlendBones( &samples, &starts, 0, bone_count, &pose );
+}
+
+void PoseEvaluator::BlendBones( vector<BoneSample> * samples_ptr, const vector<unsigned int> * starts, unsigned int first_bone, unsigned int end_bone, vector<QTransform> * pose ) {
+	vector<BoneSample> & samples = *samples_ptr;
+	for ( unsigned int b = first_bone; b < end_bone; ++b ) {
+		unsigned int first = (*starts)[b];
+		unsigned int end = (*starts)[b + 1];
+		unsigned int bone = samples[first].bone;
+
+		//Sample the channels of the bone.  Only the keys are read, so that
+		//several bones may be sampled at once.
+		for ( unsigned int i = first; i < end; ++i ) {
+			const Channel & ch = *samples[i].channel;
+			float time = samples[i].time;
+			QTransform & v = samples[i].value;
+			if ( ch.source == BSPLINE_INTERPOLATOR ) {
+				NiBSplineTransformInterpolator * interp = (NiBSplineTransformInterpolator *)ch.object;
+				Vector3 t = interp->EvaluateTranslation( time );
+				Quaternion r = interp->EvaluateRotation( time );
+				float s = interp->EvaluateScale( time );
+				if ( IsValidPose( t ) ) v.translation = t;
+				if ( IsValidPose( r ) ) v.rotation = r;
+				if ( IsValidPose( s ) ) v.scale = s;
+			} else {
+				if ( ch.source == TRANSFORM_INTERPOLATOR ) {
+					NiTransformInterpolator * interp = (NiTransformInterpolator *)ch.object;
+					Vector3 t = interp->GetTranslation();
+					Quaternion r = interp->GetRotation();
+					float s = interp->GetScale();
+					if ( !ch.has_keys[0] && IsValidPose( t ) ) v.translation = t;
+					if ( !ch.has_keys[1] && IsValidPose( r ) ) v.rotation = r;
+					if ( !ch.has_keys[2] && IsValidPose( s ) ) v.scale = s;
+				}
+				if ( ch.data != NULL ) {
+					if ( ch.has_keys[0] ) v.translation = ch.data->EvaluateTranslation( time );
+					if ( ch.has_keys[1] ) v.rotation = ch.data->EvaluateRotation( time );
+					if ( ch.has_keys[2] ) v.scale = ch.data->EvaluateScale( time );
+				}
+			}
+		}
+
+		//Give each priority group the weight that the higher ones left over
+		float remaining = 1.0f;
+		for ( unsigned int g = first; g < end; ) {
+			unsigned int g_end = g;
+			float group_weight = 0.0f;
+			while ( g_end < end && samples[g_end].priority == samples[g].priority ) {
+				group_weight += samples[g_end].weight;
+				++g_end;
+			}
+			float take = min( group_weight, max( remaining, 0.0f ) );
+			for ( unsigned int i = g; i < g_end; ++i ) {
+				samples[i].weight *= take / group_weight;
+			}
+			remaining -= take;
+			g = g_end;
+		}
+
+		//Normalized weighted sums, with the rotations in one hemisphere
+		float total = 0.0f;
+		Vector3 translation( 0.0f, 0.0f, 0.0f );
+		Quaternion rotation( 0.0f, 0.0f, 0.0f, 0.0f );
+		float scale = 0.0f;
+		const Quaternion & reference = samples[first].value.rotation;
+		for ( unsigned int i = first; i < end; ++i ) {
+			float w = samples[i].weight;
+			if ( w <= 0.0f ) {
+				continue;
+			}
+			const QTransform & v = samples[i].value;
+			total += w;
+			translation += v.translation * w;
+			rotation = rotation + v.rotation * ( reference.Dot( v.rotation ) < 0.0f ? -w : w );
+			scale += v.scale * w;
+		}
+		if ( total > 0.0f ) {
+			(*pose)[bone].translation = translation / total;
+			(*pose)[bone].rotation = rotation.Normalized();
+			(*pose)[bone].scale = scale / total;
+		}
+	}
+}
+
+void PoseEvaluator::ApplyPose( const vector<QTransform> & pose ) const {
+	if ( pose.size() != bones.size() ) {
+		throw runtime_error( "PoseEvaluator::ApplyPose requires one transform per bone." );
+	}
+	for ( unsigned int i = 0; i < bones.size(); ++i ) {
+		Quaternion rotation = pose[i].rotation;
+		bones[i]->SetLocalTranslation( pose[i].translation );
+		bones[i]->SetLocalRotation( rotation.AsMatrix() );
+		bones[i]->SetLocalScale( pose[i].scale );
+	}
+}
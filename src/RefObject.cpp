@@ -2,6 +2,7 @@
 All rights reserved.  Please see niflib.h for license. */
 
 #include "../include/RefObject.h"
+#include "../include/ObjectArena.h"
 using namespace Niflib;
 
 //Definition of TYPE constant
@@ -26,7 +27,11 @@ const Type & RefObject::GetType() const {
 }
 
 
+#ifdef NIFLIB_CXX11
+std::atomic<unsigned int> RefObject::objectsInMemory( 0 );
+#else
 unsigned int RefObject::objectsInMemory = 0;
+#endif
 
 bool RefObject::IsSameType( const Type & compare_to) const {
 	return GetType().IsSameType( compare_to );
@@ -55,6 +60,18 @@ void RefObject::SubtractRef() const {
 	}
 }
 
+unsigned int RefObject::GetNumRefs() {
+	return _ref_count;
+}
+
+void * RefObject::operator new( size_t size ) {
+	return ObjectArena::AllocateObject( size );
+}
+
+void RefObject::operator delete( void * p ) {
+	ObjectArena::FreeObject( p );
+}
+
 unsigned int RefObject::NumObjectsInMemory() {
 	return objectsInMemory;
 }
@@ -0,0 +1,371 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#include "../include/SceneBounds.h"
+#include "../include/obj/NiNode.h"
+#include "../include/obj/NiGeometry.h"
+#include "../include/obj/NiGeometryData.h"
+#include "../include/obj/NiSkinInstance.h"
+#include "../include/obj/NiSkinData.h"
+#include "../include/obj/BSBound.h"
+#include "../include/obj/BSMultiBoundNode.h"
+#include "../include/obj/BSMultiBound.h"
+#include "../include/obj/BSMultiBoundAABB.h"
+#include "../include/obj/BSMultiBoundOBB.h"
+#include "../include/gen/SkinWeight.h"
+#include <cmath>
+#include <set>
+
+using namespace Niflib;
+
+//Grows a sphere just enough to contain a point
+static void GrowSphere( Vector3 & center, float & radius, const Vector3 & p ) {
+	Vector3 d = p - center;
+	float dist2 = d.x * d.x + d.y * d.y + d.z * d.z;
+	if ( dist2 <= radius * radius ) {
+		return;
+	}
+	float dist = sqrt( dist2 );
+	float grown = ( radius + dist ) * 0.5f;
+	center += d * ( ( grown - radius ) / dist );
+	radius = grown;
+}
+
+static float MaxDistance( const vector<Vector3> & points, const Vector3 & center ) {
+	float max2 = 0.0f;
+	for ( unsigned int i = 0; i < points.size(); ++i ) {
+		Vector3 d = points[i] - center;
+		float dist2 = d.x * d.x + d.y * d.y + d.z * d.z;
+		if ( dist2 > max2 ) {
+			max2 = dist2;
+		}
+	}
+	return sqrt( max2 );
+}
+
+//Finds the eigenvectors of a symmetric matrix with Jacobi rotations, one per column of v
+static void SymmetricEigenvectors( double a[3][3], double v[3][3] ) {
+	for ( int i = 0; i < 3; ++i ) {
+		for ( int j = 0; j < 3; ++j ) {
+			v[i][j] = ( i == j ) ? 1.0 : 0.0;
+		}
+	}
+	for ( int sweep = 0; sweep < 50; ++sweep ) {
+		double off = fabs( a[0][1] ) + fabs( a[0][2] ) + fabs( a[1][2] );
+		if ( off < 1e-12 ) {
+			break;
+		}
+		for ( int p = 0; p < 2; ++p ) {
+			for ( int q = p + 1; q < 3; ++q ) {
+				if ( fabs( a[p][q] ) < 1e-15 ) {
+					continue;
+				}
+				double theta = ( a[q][q] - a[p][p] ) / ( 2.0 * a[p][q] );
+				double t = ( theta >= 0.0 ? 1.0 : -1.0 ) / ( fabs( theta ) + sqrt( theta * theta + 1.0 ) );
+				double c = 1.0 / sqrt( t * t + 1.0 );
+				double s = t * c;
+				for ( int k = 0; k < 3; ++k ) {
+					double akp = a[k][p], akq = a[k][q];
+					a[k][p] = c * akp - s * akq;
+					a[k][q] = s * akp + c * akq;
+				}
+				for ( int k = 0; k < 3; ++k ) {
+					double apk = a[p][k], aqk = a[q][k];
+					a[p][k] = c * apk - s * aqk;
+					a[q][k] = s * apk + c * aqk;
+				}
+				for ( int k = 0; k < 3; ++k ) {
+					double vkp = v[k][p], vkq = v[k][q];
+					v[k][p] = c * vkp - s * vkq;
+					v[k][q] = s * vkp + c * vkq;
+				}
+			}
+		}
+	}
+}
+
+namespace Niflib {
+
+void CalcBoundingBox( const vector<Vector3> & points, Vector3 & lows, Vector3 & highs ) {
+	if ( points.empty() ) {
+		lows = highs = Vector3();
+		return;
+	}
+	//Separate loops without branches between the axes, so that the compiler can vectorize them
+	float lx = points[0].x, ly = points[0].y, lz = points[0].z;
+	float hx = lx, hy = ly, hz = lz;
+	const unsigned int n = (unsigned int)(points.size());
+	for ( unsigned int i = 1; i < n; ++i ) {
+		const Vector3 & p = points[i];
+		lx = p.x < lx ? p.x : lx;
+		ly = p.y < ly ? p.y : ly;
+		lz = p.z < lz ? p.z : lz;
+		hx = p.x > hx ? p.x : hx;
+		hy = p.y > hy ? p.y : hy;
+		hz = p.z > hz ? p.z : hz;
+	}
+	lows = Vector3( lx, ly, lz );
+	highs = Vector3( hx, hy, hz );
+}
+
+SphereBV CalcBoundingSphere( const vector<Vector3> & points ) {
+	SphereBV result;
+	result.radius = 0.0f;
+	if ( points.empty() ) {
+		return result;
+	}
+
+	//Start from the most separated pair of the extreme points along each axis
+	unsigned int lo[3] = { 0, 0, 0 }, hi[3] = { 0, 0, 0 };
+	for ( unsigned int i = 1; i < points.size(); ++i ) {
+		for ( int k = 0; k < 3; ++k ) {
+			if ( points[i][k] < points[lo[k]][k] ) lo[k] = i;
+			if ( points[i][k] > points[hi[k]][k] ) hi[k] = i;
+		}
+	}
+	int axis = 0;
+	float best = -1.0f;
+	for ( int k = 0; k < 3; ++k ) {
+		Vector3 d = points[hi[k]] - points[lo[k]];
+		float dist2 = d.x * d.x + d.y * d.y + d.z * d.z;
+		if ( dist2 > best ) {
+			best = dist2;
+			axis = k;
+		}
+	}
+	Vector3 center = ( points[lo[axis]] + points[hi[axis]] ) * 0.5f;
+	float radius = sqrt( best ) * 0.5f;
+
+	//Grow the sphere to contain every point
+	for ( unsigned int i = 0; i < points.size(); ++i ) {
+		GrowSphere( center, radius, points[i] );
+	}
+	result.center = center;
+	result.radius = radius;
+
+	//Fall back to the sphere around the box if that happens to be smaller
+	Vector3 lows, highs;
+	CalcBoundingBox( points, lows, highs );
+	Vector3 box_center = ( lows + highs ) * 0.5f;
+	float box_radius = MaxDistance( points, box_center );
+	if ( box_radius < radius ) {
+		result.center = box_center;
+		result.radius = box_radius;
+	}
+	return result;
+}
+
+void CalcOrientedBox( const vector<Vector3> & points, Vector3 & center, Vector3 & half_size, Matrix33 & axes ) {
+	Vector3 lows, highs;
+	CalcBoundingBox( points, lows, highs );
+	center = ( lows + highs ) * 0.5f;
+	half_size = ( highs - lows ) * 0.5f;
+	axes = Matrix33::IDENTITY;
+	if ( points.size() < 3 ) {
+		return;
+	}
+
+	//The principal axes are the eigenvectors of the covariance of the points
+	double mean[3] = { 0.0, 0.0, 0.0 };
+	for ( unsigned int i = 0; i < points.size(); ++i ) {
+		for ( int k = 0; k < 3; ++k ) {
+			mean[k] += points[i][k];
+		}
+	}
+	for ( int k = 0; k < 3; ++k ) {
+		mean[k] /= double( points.size() );
+	}
+	double cov[3][3] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+	for ( unsigned int i = 0; i < points.size(); ++i ) {
+		double d[3] = { points[i].x - mean[0], points[i].y - mean[1], points[i].z - mean[2] };
+		for ( int r = 0; r < 3; ++r ) {
+			for ( int c = r; c < 3; ++c ) {
+				cov[r][c] += d[r] * d[c];
+			}
+		}
+	}
+	cov[1][0] = cov[0][1];
+	cov[2][0] = cov[0][2];
+	cov[2][1] = cov[1][2];
+	double v[3][3];
+	SymmetricEigenvectors( cov, v );
+
+	//Make the axes a right handed rotation
+	Vector3 a0( (float)(v[0][0]), (float)(v[1][0]), (float)(v[2][0]) );
+	Vector3 a1( (float)(v[0][1]), (float)(v[1][1]), (float)(v[2][1]) );
+	a0 = a0.Normalized();
+	a1 = ( a1 - a0 * a0.DotProduct( a1 ) ).Normalized();
+	Vector3 a2 = a0.CrossProduct( a1 );
+
+	//Project the points on the axes
+	float lo[3], hi[3];
+	const Vector3 * ax[3] = { &a0, &a1, &a2 };
+	for ( int k = 0; k < 3; ++k ) {
+		lo[k] = hi[k] = points[0].DotProduct( *ax[k] );
+	}
+	for ( unsigned int i = 1; i < points.size(); ++i ) {
+		for ( int k = 0; k < 3; ++k ) {
+			float d = points[i].DotProduct( *ax[k] );
+			lo[k] = d < lo[k] ? d : lo[k];
+			hi[k] = d > hi[k] ? d : hi[k];
+		}
+	}
+	float obb_volume = ( hi[0] - lo[0] ) * ( hi[1] - lo[1] ) * ( hi[2] - lo[2] );
+	float aabb_volume = ( highs.x - lows.x ) * ( highs.y - lows.y ) * ( highs.z - lows.z );
+	if ( obb_volume >= aabb_volume ) {
+		return;
+	}
+	center = a0 * ( ( lo[0] + hi[0] ) * 0.5f ) + a1 * ( ( lo[1] + hi[1] ) * 0.5f ) + a2 * ( ( lo[2] + hi[2] ) * 0.5f );
+	half_size = Vector3( hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2] ) * 0.5f;
+	axes = Matrix33( a0.x, a0.y, a0.z, a1.x, a1.y, a1.z, a2.x, a2.y, a2.z );
+}
+
+} //End namespace Niflib
+
+//Adds the vertices of every shape below an object, transformed by the object's transform to the target space
+static void CollectPoints( NiAVObject * obj, const Matrix44 & to_space, vector<Vector3> & points ) {
+	NiGeometryRef geom = DynamicCast<NiGeometry>( obj );
+	if ( geom != NULL && geom->GetData() != NULL ) {
+		const vector<Vector3> & verts = geom->GetData()->GetVertices();
+		points.reserve( points.size() + verts.size() );
+		for ( unsigned int i = 0; i < verts.size(); ++i ) {
+			points.push_back( to_space * verts[i] );
+		}
+	}
+	NiNodeRef node = DynamicCast<NiNode>( obj );
+	if ( node != NULL ) {
+		const vector<NiAVObjectRef> & children = node->GetChildren();
+		for ( unsigned int i = 0; i < children.size(); ++i ) {
+			if ( children[i] != NULL ) {
+				CollectPoints( children[i], children[i]->GetLocalTransform() * to_space, points );
+			}
+		}
+	}
+}
+
+static unsigned int UpdateGeometryBounds( NiGeometry * geom, unsigned int flags, set<NiObject *> & done ) {
+	unsigned int count = 0;
+	NiGeometryDataRef data = geom->GetData();
+	if ( data == NULL ) {
+		return 0;
+	}
+	if ( ( flags & BOUNDS_GEOMETRY ) != 0 && done.insert( data ).second ) {
+		SphereBV sphere = CalcBoundingSphere( data->GetVertices() );
+		data->SetBound( sphere.center, sphere.radius );
+		++count;
+	}
+
+	NiSkinInstanceRef skin = geom->GetSkinInstance();
+	NiSkinDataRef skin_data = skin != NULL ? skin->GetSkinData() : NiSkinDataRef();
+	if ( ( flags & BOUNDS_SKIN ) == 0 || skin_data == NULL || !done.insert( skin_data ).second ) {
+		return count;
+	}
+	//Bound the vertices of each bone separately
+	const vector<Vector3> & verts = data->GetVertices();
+	vector<Vector3> subset;
+	for ( unsigned int b = 0; b < skin_data->GetBoneCount(); ++b ) {
+		const vector<SkinWeight> & weights = skin_data->GetBoneWeights( b );
+		subset.clear();
+		for ( unsigned int i = 0; i < weights.size(); ++i ) {
+			if ( weights[i].index < verts.size() ) {
+				subset.push_back( verts[weights[i].index] );
+			}
+		}
+		if ( subset.empty() ) {
+			continue;
+		}
+		SphereBV sphere = CalcBoundingSphere( subset );
+		skin_data->SetBoneWeights( b, weights, skin_data->GetBoneTransform( b ) * sphere.center, sphere.radius );
+		++count;
+	}
+	return count;
+}
+
+static unsigned int UpdateObjectBounds( NiAVObject * obj, const Matrix44 & to_root, unsigned int flags, set<NiObject *> & done ) {
+	unsigned int count = 0;
+	NiGeometryRef geom = DynamicCast<NiGeometry>( obj );
+	if ( geom != NULL ) {
+		count += UpdateGeometryBounds( geom, flags, done );
+	}
+
+	//Bounds in the local coordinates of this object
+	vector<Vector3> points;
+	bool collected = false;
+	if ( ( flags & BOUNDS_BOUNDING_BOX ) != 0 && obj->HasBoundingBox() ) {
+		CollectPoints( obj, Matrix44::IDENTITY, points );
+		collected = true;
+		Vector3 lows, highs;
+		CalcBoundingBox( points, lows, highs );
+		BoundingBox box = obj->GetBoundingBox();
+		box.translation = ( lows + highs ) * 0.5f;
+		box.rotation = Matrix33::IDENTITY;
+		box.radius = ( highs - lows ) * 0.5f;
+		obj->SetBoundingBox( box );
+		++count;
+	}
+	if ( ( flags & BOUNDS_EXTRA_DATA ) != 0 ) {
+		list<NiExtraDataRef> extras = obj->GetExtraData();
+		for ( list<NiExtraDataRef>::iterator it = extras.begin(); it != extras.end(); ++it ) {
+			BSBoundRef bound = DynamicCast<BSBound>( *it );
+			if ( bound == NULL ) {
+				continue;
+			}
+			if ( !collected ) {
+				CollectPoints( obj, Matrix44::IDENTITY, points );
+				collected = true;
+			}
+			Vector3 lows, highs;
+			CalcBoundingBox( points, lows, highs );
+			bound->SetCenter( ( lows + highs ) * 0.5f );
+			bound->SetDimensions( ( highs - lows ) * 0.5f );
+			++count;
+		}
+	}
+
+	//Multi bounds in the local coordinates of the root
+	BSMultiBoundNodeRef multi_node = DynamicCast<BSMultiBoundNode>( obj );
+	BSMultiBoundRef multi = multi_node != NULL ? multi_node->GetMultiBound() : BSMultiBoundRef();
+	BSMultiBoundDataRef multi_data = multi != NULL ? multi->GetData() : BSMultiBoundDataRef();
+	if ( ( flags & BOUNDS_MULTI_BOUND ) != 0 && multi_data != NULL ) {
+		vector<Vector3> root_points;
+		CollectPoints( obj, to_root, root_points );
+		if ( BSMultiBoundAABBRef aabb = DynamicCast<BSMultiBoundAABB>( multi_data ) ) {
+			Vector3 lows, highs;
+			CalcBoundingBox( root_points, lows, highs );
+			aabb->SetPosition( ( lows + highs ) * 0.5f );
+			aabb->SetExtent( ( highs - lows ) * 0.5f );
+			++count;
+		} else if ( BSMultiBoundOBBRef obb = DynamicCast<BSMultiBoundOBB>( multi_data ) ) {
+			Vector3 center, half_size;
+			Matrix33 axes;
+			CalcOrientedBox( root_points, center, half_size, axes );
+			obb->SetCenter( center );
+			obb->SetSize( half_size );
+			obb->SetRotation( axes );
+			++count;
+		}
+	}
+
+	NiNodeRef node = DynamicCast<NiNode>( obj );
+	if ( node != NULL ) {
+		const vector<NiAVObjectRef> & children = node->GetChildren();
+		for ( unsigned int i = 0; i < children.size(); ++i ) {
+			if ( children[i] != NULL ) {
+				count += UpdateObjectBounds( children[i], children[i]->GetLocalTransform() * to_root, flags, done );
+			}
+		}
+	}
+	return count;
+}
+
+namespace Niflib {
+
+unsigned int UpdateSceneBounds( NiAVObject * root, unsigned int flags ) {
+	if ( root == NULL ) {
+		return 0;
+	}
+	set<NiObject *> done;
+	return UpdateObjectBounds( root, Matrix44::IDENTITY, flags, done );
+}
+
+} //End namespace Niflib
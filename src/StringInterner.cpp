@@ -0,0 +1,197 @@
+/* Copyright (c) 2006, NIF File Format Library and Tools
+All rights reserved.  Please see niflib.h for license. */
+
+#include "../include/StringInterner.h"
+#include <stdexcept>
+#ifdef NIFLIB_CXX11
+#include <mutex>
+#endif
+
+using namespace Niflib;
+
+//The string of every default handle
+static const string empty_string;
+
+//FNV-1a
+static unsigned int HashString( const string & value ) {
+	unsigned int h = 2166136261u;
+	for ( unsigned int i = 0; i < value.size(); ++i ) {
+		h ^= (unsigned char)(value[i]);
+		h *= 16777619u;
+	}
+	return h;
+}
+
+InternedString::InternedString() : value(&empty_string), index(0xFFFFFFFF) {}
+
+InternedString::InternedString( const string * value, unsigned int index ) : value(value), index(index) {}
+
+const string & InternedString::str() const {
+	return *value;
+}
+
+const char * InternedString::c_str() const {
+	return value->c_str();
+}
+
+bool InternedString::empty() const {
+	return index == 0xFFFFFFFF;
+}
+
+unsigned int InternedString::GetIndex() const {
+	return index;
+}
+
+unsigned int InternedString::Hash() const {
+	//The index is already unique, so only spread its bits
+	return index * 2654435761u;
+}
+
+InternedString::operator const string &() const {
+	return *value;
+}
+
+bool InternedString::operator==( const InternedString & rh ) const {
+	return index == rh.index;
+}
+
+bool InternedString::operator!=( const InternedString & rh ) const {
+	return index != rh.index;
+}
+
+bool InternedString::operator<( const InternedString & rh ) const {
+	//The empty string comes first
+	return index + 1 < rh.index + 1;
+}
+
+#ifdef NIFLIB_CXX11
+struct StringInterner::Lock {
+	std::mutex mutex;
+};
+
+//Holds the lock of an interner for the rest of a call
+class StringInterner::LockGuard {
+public:
+	LockGuard( Lock * lock ) : guard( lock->mutex ) {}
+private:
+	std::lock_guard<std::mutex> guard;
+};
+#else
+struct StringInterner::Lock {};
+
+class StringInterner::LockGuard {
+public:
+	LockGuard( Lock * ) {}
+};
+#endif
+
+StringInterner::StringInterner() : lock( new Lock ) {}
+
+StringInterner::~StringInterner() {
+	delete lock;
+}
+
+unsigned int StringInterner::FindSlot( const string & value, unsigned int hash ) const {
+	const unsigned int mask = (unsigned int)(slots.size()) - 1;
+	unsigned int slot = hash & mask;
+	while ( slots[slot] != 0 ) {
+		unsigned int i = slots[slot] - 1;
+		if ( hashes[i] == hash && strings[i] == value ) {
+			break;
+		}
+		slot = ( slot + 1 ) & mask;
+	}
+	return slot;
+}
+
+void StringInterner::Grow() {
+	//Keep the table at most half full, so that probe chains stay short
+	unsigned int size = slots.empty() ? 64 : (unsigned int)(slots.size()) * 2;
+	slots.assign( size, 0 );
+	const unsigned int mask = size - 1;
+	for ( unsigned int i = 0; i < hashes.size(); ++i ) {
+		unsigned int slot = hashes[i] & mask;
+		while ( slots[slot] != 0 ) {
+			slot = ( slot + 1 ) & mask;
+		}
+		slots[slot] = i + 1;
+	}
+}
+
+InternedString StringInterner::Intern( const string & value ) {
+	LockGuard guard( lock );
+	return InternUnlocked( value );
+}
+
+InternedString StringInterner::InternUnlocked( const string & value ) {
+	if ( value.empty() ) {
+		return InternedString();
+	}
+	if ( 2 * ( strings.size() + 1 ) > slots.size() ) {
+		Grow();
+	}
+	unsigned int hash = HashString( value );
+	unsigned int slot = FindSlot( value, hash );
+	if ( slots[slot] == 0 ) {
+		strings.push_back( value );
+		hashes.push_back( hash );
+		slots[slot] = (unsigned int)(strings.size());
+	}
+	unsigned int i = slots[slot] - 1;
+	return InternedString( &strings[i], i );
+}
+
+vector<InternedString> StringInterner::Intern( const vector<string> & values ) {
+	LockGuard guard( lock );
+	//Grow once for the worst case of all strings being new
+	while ( 2 * ( strings.size() + values.size() ) > slots.size() ) {
+		Grow();
+	}
+	vector<InternedString> result;
+	result.reserve( values.size() );
+	for ( unsigned int i = 0; i < values.size(); ++i ) {
+		result.push_back( InternUnlocked( values[i] ) );
+	}
+	return result;
+}
+
+bool StringInterner::Find( const string & value, InternedString & result ) const {
+	LockGuard guard( lock );
+	if ( value.empty() ) {
+		result = InternedString();
+		return true;
+	}
+	if ( slots.empty() ) {
+		return false;
+	}
+	unsigned int slot = FindSlot( value, HashString( value ) );
+	if ( slots[slot] == 0 ) {
+		return false;
+	}
+	unsigned int i = slots[slot] - 1;
+	result = InternedString( &strings[i], i );
+	return true;
+}
+
+InternedString StringInterner::GetString( unsigned int index ) const {
+	LockGuard guard( lock );
+	if ( index == 0xFFFFFFFF ) {
+		return InternedString();
+	}
+	if ( index >= strings.size() ) {
+		throw runtime_error( "Attempted to retrieve an interned string that does not exist." );
+	}
+	return InternedString( &strings[index], index );
+}
+
+unsigned int StringInterner::Size() const {
+	LockGuard guard( lock );
+	return (unsigned int)(strings.size());
+}
+
+void StringInterner::Clear() {
+	LockGuard guard( lock );
+	strings.clear();
+	hashes.clear();
+	slots.clear();
+}
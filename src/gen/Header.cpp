@@ -325,4 +325,26 @@ vector<unsigned short> Niflib::Header::getBlockTypeIndex() {
 	return blockTypeIndex;
 }
 
+unsigned int Header::AddString( const string & value ) {
+	map<string, unsigned int>::iterator it = stringIndex.find( value );
+	if ( it != stringIndex.end() && ( it->second >= strings.size() || strings[it->second] != value ) ) {
+		//The string table was replaced since it was indexed
+		stringIndex.clear();
+		it = stringIndex.end();
+	}
+	if ( it == stringIndex.end() ) {
+		//Index any strings added to the table directly, keeping the first of duplicates
+		for ( unsigned int i = (unsigned int)(stringIndex.size()); i < strings.size(); ++i ) {
+			stringIndex.insert( pair<string, unsigned int>( strings[i], i ) );
+		}
+		it = stringIndex.find( value );
+	}
+	if ( it != stringIndex.end() ) {
+		return it->second;
+	}
+	strings.push_back( value );
+	stringIndex[value] = (unsigned int)(strings.size()) - 1;
+	return (unsigned int)(strings.size()) - 1;
+}
+
 //--END CUSTOM CODE--//
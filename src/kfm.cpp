@@ -4,9 +4,89 @@
 #include "../include/niflib.h"
 #include "../include/NIF_IO.h"
 #include "../include/obj/NiObject.h"
+#include "../include/obj/NiNode.h"
+#include "../include/obj/NiControllerManager.h"
+#include "../include/obj/NiControllerSequence.h"
+#include "../include/obj/NiDefaultAVObjectPalette.h"
+#include "../include/ObjectArena.h"
+#include <fstream>
+#include <set>
+#ifdef NIFLIB_CXX11
+#include <exception>
+#include <thread>
+#endif
 
 namespace Niflib {
 
+//Object Registration, in niflib.cpp
+extern bool g_objects_registered;
+void RegisterObjects();
+
+//Joins a directory and a file name with a forward slash, which every supported
+//platform accepts.  Back slashes in the file name, as written by the Windows
+//tools, are turned into forward slashes too.
+static string JoinPath( const string & path, const string & file_name ) {
+	string file = file_name;
+	for ( unsigned int i = 0; i < file.size(); ++i ) {
+		if ( file[i] == '\\' ) file[i] = '/';
+	}
+	if ( path.empty() ) {
+		return file;
+	}
+	char last = path[path.size() - 1];
+	if ( last == '/' || last == '\\' ) {
+		return path + file;
+	}
+	return path + '/' + file;
+}
+
+//Adds every named object in the scene graph below obj to objs, unless it is in seen
+static void CollectNamedObjects( NiAVObject * obj, vector<NiAVObjectRef> & objs, set<NiAVObject *> & seen ) {
+	if ( !obj->GetName().empty() && seen.insert( obj ).second ) {
+		objs.push_back( obj );
+	}
+	NiNodeRef node = DynamicCast<NiNode>( obj );
+	if ( node != NULL ) {
+		vector<NiAVObjectRef> children = node->GetChildren();
+		for ( vector<NiAVObjectRef>::iterator it = children.begin(); it != children.end(); ++it ) {
+			if ( *it != NULL ) {
+				CollectNamedObjects( *it, objs, seen );
+			}
+		}
+	}
+}
+
+//Reads the controller sequences of a KF file.  A file that cannot be opened is skipped.
+static void ReadActionFile( const string & file_name, vector<NiControllerSequenceRef> & sequences ) {
+	// Probably we should check some other field in the Kfm file to determine whether the file exists...
+	ifstream in( file_name.c_str(), ifstream::binary );
+	if ( !in.is_open() ) {
+		return;
+	}
+	// Sequences of files older than 10.1.0.106 are rooted by a NiSequenceStreamHelper and are not merged
+	vector<NiObjectRef> objects = ReadNifList( in );
+	for ( vector<NiObjectRef>::iterator obj = objects.begin(); obj != objects.end(); ++obj ) {
+		NiControllerSequenceRef seq = DynamicCast<NiControllerSequence>( *obj );
+		if ( seq != NULL ) {
+			sequences.push_back( seq );
+		}
+	}
+}
+
+#ifdef NIFLIB_CXX11
+//Reads every step-th KF file, starting with the first-th, on a thread of its own.
+//Each file gets its own list of sequences, and the first error is kept for the caller.
+static void ReadActionFiles( const vector<string> * file_names, unsigned int first, unsigned int step, vector< vector<NiControllerSequenceRef> > * sequences, std::exception_ptr * error ) {
+	try {
+		for ( unsigned int i = first; i < file_names->size(); i += step ) {
+			ReadActionFile( (*file_names)[i], (*sequences)[i] );
+		}
+	} catch ( ... ) {
+		*error = std::current_exception();
+	}
+}
+#endif
+
 void KfmEventString::Read( istream & in, unsigned int version ) {
 	unk_int = ReadUInt(in);
 	event = ReadString(in);
@@ -121,24 +201,94 @@ void Kfm::Write( ostream & out, unsigned int version ) {
 
 Ref<NiObject> Kfm::MergeActions( string const & path ) {
 	// Read NIF file
-	NiObjectRef nif = ReadNifTree( path + '\\' + nif_filename);
-	
-	// Read Kf files
-	vector<NiObjectRef> kf;
+	NiObjectRef nif = ReadNifTree( JoinPath( path, nif_filename ) );
+	NiAVObjectRef root = DynamicCast<NiAVObject>( nif );
+	if ( root == NULL ) {
+		throw runtime_error( "The NIF file of this KFM has no scene graph to merge the actions into." );
+	}
+
+	// Read Kf files, opening each one only once
+	vector<string> file_names;
 	for ( vector<KfmAction>::iterator it = actions.begin(); it != actions.end(); it++ ) {
-		string action_filename = path + '\\' + it->action_filename;
-		// Check if the file exists.
-		// Probably we should check some other field in the Kfm file to determine this...
-		bool exists = false;
-		fstream fin;
-		fin.open(action_filename.c_str(), ios::in);
-		if( fin.is_open() ) exists = true;
-		fin.close();
-		// Import it, if it exists.
-		if (exists) kf.push_back( ReadNifTree(action_filename) );
+		file_names.push_back( JoinPath( path, it->action_filename ) );
 	};
-	
-	// TODO: merge everything into the nif file
+	vector<NiControllerSequenceRef> sequences;
+	bool read = false;
+#ifdef NIFLIB_CXX11
+	// The files are independent, so they are read on several threads.  Objects
+	// that go into an ObjectArena must be made on its thread, so the files are
+	// read one after another then.
+	unsigned int thread_count = std::thread::hardware_concurrency();
+	if ( thread_count > file_names.size() ) thread_count = (unsigned int)( file_names.size() );
+	if ( thread_count > 1 && ObjectArena::GetCurrent() == NULL ) {
+		// Register the object types before the threads need them
+		if ( g_objects_registered == false ) {
+			g_objects_registered = true;
+			RegisterObjects();
+		}
+		vector< vector<NiControllerSequenceRef> > file_sequences( file_names.size() );
+		vector<std::exception_ptr> errors( thread_count );
+		vector<std::thread> threads;
+		for ( unsigned int i = 0; i < thread_count; ++i ) {
+			threads.push_back( std::thread( ReadActionFiles, &file_names, i, thread_count, &file_sequences, &errors[i] ) );
+		}
+		for ( unsigned int i = 0; i < thread_count; ++i ) {
+			threads[i].join();
+		}
+		for ( unsigned int i = 0; i < thread_count; ++i ) {
+			if ( errors[i] ) {
+				std::rethrow_exception( errors[i] );
+			}
+		}
+		// Keep the sequences in the order of the actions
+		for ( unsigned int i = 0; i < file_sequences.size(); ++i ) {
+			sequences.insert( sequences.end(), file_sequences[i].begin(), file_sequences[i].end() );
+		}
+		read = true;
+	}
+#endif
+	if ( !read ) {
+		for ( unsigned int i = 0; i < file_names.size(); ++i ) {
+			ReadActionFile( file_names[i], sequences );
+		}
+	}
+	if ( sequences.empty() ) {
+		return nif;
+	}
+
+	// Find the controller manager of the actor, or make one
+	NiControllerManagerRef manager;
+	list<NiTimeControllerRef> controllers = root->GetControllers();
+	for ( list<NiTimeControllerRef>::iterator it = controllers.begin(); it != controllers.end() && manager == NULL; ++it ) {
+		manager = DynamicCast<NiControllerManager>( *it );
+	}
+	if ( manager == NULL ) {
+		manager = new NiControllerManager;
+		manager->SetFrequency( 1.0f );
+		root->AddController( manager );
+	}
+
+	// All sequences share one object palette that names every object in the scene graph
+	NiDefaultAVObjectPaletteRef palette = manager->GetObjectPalette();
+	if ( palette == NULL ) {
+		palette = new NiDefaultAVObjectPalette;
+		manager->SetObjectPalette( palette );
+	}
+	vector<NiAVObjectRef> objs = palette->GetObjs();
+	set<NiAVObject *> seen( objs.begin(), objs.end() );
+	CollectNamedObjects( root, objs, seen );
+	palette->SetObjs( objs );
+
+	// Hand the sequences to the manager, and let it run as long as the longest one
+	float start = manager->GetStartTime(), stop = manager->GetStopTime();
+	for ( vector<NiControllerSequenceRef>::iterator it = sequences.begin(); it != sequences.end(); ++it ) {
+		manager->AddSequence( *it );
+		if ( (*it)->GetStartTime() < start ) start = (*it)->GetStartTime();
+		if ( (*it)->GetStopTime() > stop ) stop = (*it)->GetStopTime();
+	}
+	manager->SetStartTime( start );
+	manager->SetStopTime( stop );
+
 	return nif;
 }
 
@@ -695,6 +695,64 @@ Quaternion Quaternion::Inverse() const {
 	return Quaternion(w, -x, -y, -z);
 }
 
+Quaternion Quaternion::operator*( const Quaternion & rhs ) const {
+	return Quaternion(
+		w * rhs.w - x * rhs.x - y * rhs.y - z * rhs.z,
+		w * rhs.x + x * rhs.w + y * rhs.z - z * rhs.y,
+		w * rhs.y - x * rhs.z + y * rhs.w + z * rhs.x,
+		w * rhs.z + x * rhs.y - y * rhs.x + z * rhs.w
+	);
+}
+
+Quaternion Quaternion::Normalized() const {
+	float len = sqrt( Dot(*this) );
+	if ( len == 0.0f ) {
+		return Quaternion( 1.0f, 0.0f, 0.0f, 0.0f );
+	}
+	return *this * ( 1.0f / len );
+}
+
+Quaternion Quaternion::Log() const {
+	float s = sqrt( x*x + y*y + z*z );
+	if ( s < 1e-6f ) {
+		return Quaternion( 0.0f, x, y, z );
+	}
+	float f = atan2( s, w ) / s;
+	return Quaternion( 0.0f, x * f, y * f, z * f );
+}
+
+Quaternion Quaternion::Exp() const {
+	float a = sqrt( x*x + y*y + z*z );
+	if ( a < 1e-6f ) {
+		return Quaternion( cos(a), x, y, z );
+	}
+	float f = sin(a) / a;
+	return Quaternion( cos(a), x * f, y * f, z * f );
+}
+
+Quaternion Quaternion::Slerp( float t, const Quaternion & p, const Quaternion & q ) {
+	//Take the shortest path
+	float cos_angle = p.Dot(q);
+	Quaternion target = q;
+	if ( cos_angle < 0.0f ) {
+		cos_angle = -cos_angle;
+		target = q * -1.0f;
+	}
+
+	float a, b;
+	if ( cos_angle > 0.9999f ) {
+		//Nearly the same rotation, interpolate linearly
+		a = 1.0f - t;
+		b = t;
+	} else {
+		float angle = acos( cos_angle );
+		float inv_sin = 1.0f / sin( angle );
+		a = sin( (1.0f - t) * angle ) * inv_sin;
+		b = sin( t * angle ) * inv_sin;
+	}
+	return ( p * a + target * b ).Normalized();
+}
+
 
 /*
 * InertiaMatrix Methods
@@ -846,6 +904,71 @@ float InertiaMatrix::Determinant() const {
 		- t[0][3] * Submatrix(0, 3).Determinant();
 }
 
+//Half floats
+
+float Niflib::HalfToFloat( unsigned short h ) {
+	unsigned int sign = (unsigned int)( h & 0x8000 ) << 16;
+	unsigned int exp = ( h >> 10 ) & 0x1F;
+	unsigned int mant = h & 0x3FF;
+	unsigned int bits;
+	if ( exp == 0x1F ) {
+		//Infinity or NaN
+		bits = sign | 0x7F800000 | ( mant << 13 );
+	} else if ( exp != 0 ) {
+		bits = sign | ( ( exp + 112 ) << 23 ) | ( mant << 13 );
+	} else if ( mant == 0 ) {
+		bits = sign;
+	} else {
+		//Denormal half, which is a normal float
+		exp = 113;
+		while ( ( mant & 0x400 ) == 0 ) {
+			mant <<= 1;
+			--exp;
+		}
+		bits = sign | ( exp << 23 ) | ( ( mant & 0x3FF ) << 13 );
+	}
+	float f;
+	memcpy( &f, &bits, sizeof(f) );
+	return f;
+}
+
+unsigned short Niflib::FloatToHalf( float f ) {
+	unsigned int bits;
+	memcpy( &bits, &f, sizeof(bits) );
+	unsigned short sign = (unsigned short)( ( bits >> 16 ) & 0x8000 );
+	int exp = int( ( bits >> 23 ) & 0xFF );
+	unsigned int mant = bits & 0x7FFFFF;
+	if ( exp == 0xFF ) {
+		return sign | 0x7C00 | ( mant != 0 ? 0x200 : 0 );
+	}
+	exp -= 112;
+	if ( exp >= 0x1F ) {
+		return sign | 0x7C00;
+	}
+	if ( exp <= 0 ) {
+		if ( exp < -10 ) {
+			return sign;
+		}
+		//Denormal half; round to nearest, ties to even
+		mant |= 0x800000;
+		unsigned int shift = (unsigned int)( 14 - exp );
+		unsigned int h = mant >> shift;
+		unsigned int rest = mant & ( ( 1u << shift ) - 1 );
+		unsigned int half = 1u << ( shift - 1 );
+		if ( rest > half || ( rest == half && ( h & 1 ) ) ) {
+			++h;
+		}
+		return sign | (unsigned short)(h);
+	}
+	unsigned int h = ( (unsigned int)(exp) << 10 ) | ( mant >> 13 );
+	unsigned int rest = mant & 0x1FFF;
+	//A carry out of the mantissa correctly bumps the exponent, up to infinity
+	if ( rest > 0x1000 || ( rest == 0x1000 && ( h & 1 ) ) ) {
+		++h;
+	}
+	return sign | (unsigned short)(h);
+}
+
 /*
  * ostream functions for printing with cout
  */
@@ -11,6 +11,12 @@ All rights reserved.  Please see niflib.h for license. */
 #include "../include/NIF_IO.h"
 #include "../include/ObjectRegistry.h"
 #include "../include/kfm.h"
+#include "../include/StringInterner.h"
+#include "../include/ObjectArena.h"
+#include <set>
+#ifdef NIFLIB_CXX11
+#include <unordered_map>
+#endif
 #include "../include/obj/NiObject.h"
 #include "../include/obj/NiNode.h"
 #include "../include/obj/NiAVObject.h"
@@ -28,6 +34,13 @@ All rights reserved.  Please see niflib.h for license. */
 #include "../include/obj/NiTransformInterpolator.h"
 #include "../include/obj/NiTransformController.h"
 #include "../include/obj/NiTransformData.h"
+#include "../include/obj/NiFloatData.h"
+#include "../include/obj/NiPosData.h"
+#include "../include/obj/NiBoolData.h"
+#include "../include/obj/NiMorphData.h"
+#include "../include/obj/NiBSplineTransformInterpolator.h"
+#include "../include/obj/NiFloatInterpolator.h"
+#include "../include/obj/NiPoint3Interpolator.h"
 #include "../include/obj/NiMultiTargetTransformController.h"
 #include "../include/obj/NiStringExtraData.h"
 #include "../include/obj/NiExtraData.h"
@@ -179,7 +192,19 @@ vector<NiObjectRef> ReadNifList( istream & in, list<NiObjectRef> & missing_link_
 	}
 
 	//Read header.
+	StringInterner * strings = info->strings;
+	ObjectArena * arena = info->arena;
 	*info = header.Read( in );
+	info->strings = strings;
+	info->arena = arena;
+
+	//Place the objects of the file in the arena, if one is given
+	ObjectArena::Scope arena_scope( arena != NULL ? arena : ObjectArena::GetCurrent() );
+
+	//Intern the string table once, instead of each string that refers to it
+	if ( strings != NULL ) {
+		strings->Intern( header.strings );
+	}
 
 	//If NifInfo structure is provided, fill it with info from header
 	info->version = header.version;
@@ -423,33 +448,42 @@ vector<NiObjectRef> ReadNifList( istream & in, list<NiObjectRef> & missing_link_
 	return obj_list;
 }
 
-NiObjectRef _ResolveMissingLinkStackHelper(NiObject *root, NiObject *obj) {
-	// search by name
+//Indexes the NiNodes below root by name, depth first, keeping the first node of each name
+static void _IndexNodeNames(NiObject *root, StringInterner & names, vector<NiNodeRef> & nodes, set<NiObject *> & visited) {
 	NiNodeRef rootnode = DynamicCast<NiNode>(root);
-	NiNodeRef objnode = DynamicCast<NiNode>(obj);
-	if (rootnode != NULL && objnode != NULL) {
-		if (!(rootnode->GetName().empty()) && rootnode->GetName() == objnode->GetName()) {
-			return StaticCast<NiObject>(rootnode);
-		}
-		list<NiObjectRef> children = root->GetRefs();
-		for (list<NiObjectRef>::iterator child = children.begin(); child != children.end(); ++child) {
-			NiObjectRef result = _ResolveMissingLinkStackHelper(*child, obj);
-			if (result != NULL) {
-				return result;
-			}
-		}
+	if (rootnode == NULL || !visited.insert(root).second) {
+		return;
+	}
+	InternedString name = names.Intern(rootnode->GetName());
+	if (!name.empty() && name.GetIndex() == nodes.size()) {
+		nodes.push_back(rootnode);
+	}
+	list<NiObjectRef> children = root->GetRefs();
+	for (list<NiObjectRef>::iterator child = children.begin(); child != children.end(); ++child) {
+		_IndexNodeNames(*child, names, nodes, visited);
 	}
-	// nothing found
-	return NiObjectRef();
 }
 
 list<NiObjectRef> ResolveMissingLinkStack(
 	NiObject *root,
 	const list<NiObject *> & missing_link_stack)
 {
+	// search by name, indexing the tree once for all missing links
+	StringInterner names;
+	vector<NiNodeRef> nodes;
+	set<NiObject *> visited;
+	_IndexNodeNames(root, names, nodes, visited);
+
 	list<NiObjectRef> result;
 	for (list<NiObject *>::const_iterator obj = missing_link_stack.begin(); obj != missing_link_stack.end(); ++obj) {
-		result.push_back(_ResolveMissingLinkStackHelper(root, *obj));
+		NiNodeRef objnode = DynamicCast<NiNode>(*obj);
+		InternedString name;
+		if (objnode != NULL && names.Find(objnode->GetName(), name) && !name.empty()) {
+			result.push_back(StaticCast<NiObject>(nodes[name.GetIndex()]));
+		} else {
+			// nothing found
+			result.push_back(NiObjectRef());
+		}
 	}
 	return result;
 }
@@ -985,9 +1019,40 @@ void WriteFileGroup( string const & file_name, NiObject * root_object, const Nif
 		throw runtime_error("Not yet implemented.");
 };
 
-void MapNodeNames( map<string,NiNodeRef> & name_map, NiNode * par ) {
+//Finds the nodes of the tree that is merged into by name.  The names are
+//interned, so a lookup hashes the name once, and a node replaces an earlier
+//node with the same name.
+class NodeNameIndex {
+public:
+	void Add( NiNode * node ) {
+		InternedString name = names.Intern( node->GetName() );
+		if ( name.empty() ) {
+			unnamed = node;
+			return;
+		}
+		if ( name.GetIndex() >= nodes.size() ) {
+			nodes.resize( name.GetIndex() + 1 );
+		}
+		nodes[ name.GetIndex() ] = node;
+	}
+
+	NiNodeRef Find( const string & name ) const {
+		InternedString handle;
+		if ( !names.Find( name, handle ) ) {
+			return NULL;
+		}
+		return handle.empty() ? unnamed : nodes[ handle.GetIndex() ];
+	}
+
+private:
+	StringInterner names;
+	vector<NiNodeRef> nodes;
+	NiNodeRef unnamed;
+};
+
+void MapNodeNames( NodeNameIndex & name_map, NiNode * par ) {
 	//Add the par node to the map, and then call this function for each of its children
-	name_map[par->GetName()] = par;
+	name_map.Add( par );
 
 	
 	vector<NiAVObjectRef> links = par->GetChildren();
@@ -1002,11 +1067,9 @@ void MapNodeNames( map<string,NiNodeRef> & name_map, NiNode * par ) {
 //This function will merge two scene graphs by attatching new objects to the correct position
 //on the existing scene graph.  In other words, it deals only with adding new nodes, not altering
 //existing nodes by changing their data or attatched properties
-void MergeSceneGraph( map<string,NiNodeRef> & name_map, NiNode * root, NiAVObject * par ) {
+void MergeSceneGraph( NodeNameIndex & name_map, NiNode * root, NiAVObject * par ) {
 	//Check if this object's name exists in the object map
-	string name = par->GetName();
-
-	if ( name_map.find(name) != name_map.end() ) {
+	if ( name_map.Find( par->GetName() ) != NULL ) {
 		//This object already exists in the original file, so continue on to its children, if it is a NiNode
 		
 		NiNodeRef par_node = DynamicCast<NiNode>(par);
@@ -1053,7 +1116,7 @@ void MergeSceneGraph( map<string,NiNodeRef> & name_map, NiNode * root, NiAVObjec
 		//par_par->GetAttr("Children")->RemoveLinks( par );
 
 		//Get the object to attatch to
-		NiObjectRef attatch = DynamicCast<NiObject>(name_map[par_par->GetName()]);
+		NiObjectRef attatch = DynamicCast<NiObject>(name_map.Find( par_par->GetName() ));
 
 		//TODO:  Implement children
 		////Add this object as new child
@@ -1071,7 +1134,7 @@ void MergeNifTrees( NiNode * target, NiAVObject * right, unsigned version, unsig
 	NiAVObjectRef new_tree = right;// ReadNifTree( tmp ); TODO: Figure out why this doesn't work
 
 	//Create a list of names in the target
-	map<string,NiNodeRef> name_map;
+	NodeNameIndex name_map;
 	MapNodeNames( name_map, target );
 
 	////Reassign any cross references in the new tree to point to objects in the
@@ -1082,12 +1145,162 @@ void MergeNifTrees( NiNode * target, NiAVObject * right, unsigned version, unsig
 	MergeSceneGraph( name_map, target, new_tree );
 }
 
-//Version for merging KF Trees rooted by a NiControllerSequence
-void MergeNifTrees( NiNode * target, NiControllerSequence * right, unsigned version, unsigned user_version ) {
-	//Map the node names
-	map<string,NiNodeRef> name_map;
-	MapNodeNames( name_map, target );
+//Removes unneeded keys from the data of merged controllers and interpolators.
+//Constant transform tracks only move into the interpolator pose when no other
+//merged interpolator shares the data, and shared data is reduced once.
+static void ReduceMergedKeys( const vector<NiObjectRef> & merged, float translate_tolerance, float rotate_tolerance, float scale_tolerance ) {
+	map<NiObject *,unsigned int> users;
+	for ( unsigned int i = 0; i < merged.size(); ++i ) {
+		if ( NiTransformInterpolatorRef ti = DynamicCast<NiTransformInterpolator>(merged[i]) ) {
+			NiTransformDataRef td = ti->GetData();
+			if ( td != NULL ) {
+				++users[td];
+			}
+		}
+	}
+
+	set<NiObject *> reduced;
+	for ( unsigned int i = 0; i < merged.size(); ++i ) {
+		if ( NiTransformInterpolatorRef ti = DynamicCast<NiTransformInterpolator>(merged[i]) ) {
+			NiTransformDataRef td = ti->GetData();
+			if ( td != NULL && users[td] == 1 ) {
+				ti->ReduceKeys( translate_tolerance, rotate_tolerance, scale_tolerance );
+			} else if ( td != NULL && reduced.insert( td ).second ) {
+				td->ReduceKeys( translate_tolerance, rotate_tolerance, scale_tolerance );
+			}
+		} else if ( NiFloatInterpolatorRef fi = DynamicCast<NiFloatInterpolator>(merged[i]) ) {
+			NiFloatDataRef fd = fi->GetData();
+			if ( fd != NULL && reduced.insert( fd ).second ) {
+				fd->ReduceKeys( scale_tolerance );
+			}
+		} else if ( NiPoint3InterpolatorRef pi = DynamicCast<NiPoint3Interpolator>(merged[i]) ) {
+			NiPosDataRef pd = pi->GetData();
+			if ( pd != NULL && reduced.insert( pd ).second ) {
+				pd->ReduceKeys( translate_tolerance );
+			}
+		} else if ( NiKeyframeControllerRef kc = DynamicCast<NiKeyframeController>(merged[i]) ) {
+			NiKeyframeDataRef kd = kc->GetData();
+			if ( kd != NULL && reduced.insert( kd ).second ) {
+				kd->ReduceKeys( translate_tolerance, rotate_tolerance, scale_tolerance );
+			}
+		}
+	}
+}
+
+//Clones objects together with the objects they link to.  This uses the same
+//serialization as NiObject::Clone: each object is written to a stream and read
+//back into a new object, and the links between copies are restored with
+//FixLinks.  What it saves over writing and reading a nif tree is the header
+//and the file, and objects that were cloned before are reused, so objects
+//shared between clones stay shared.  Key data objects are deduplicated by
+//their serialized bytes, so those with the same content are cloned only once.
+class ObjectCloner {
+public:
+	ObjectCloner( unsigned version, unsigned user_version ) : info( version, user_version ) {}
+
+	NiObjectRef Clone( NiObject * root ) {
+		if ( root == NULL ) {
+			return NULL;
+		}
+
+		//Find the objects in this subgraph that were not cloned before
+		vector<NiObjectRef> pending;
+		list<NiObjectRef> stack( 1, NiObjectRef(root) );
+		while ( !stack.empty() ) {
+			NiObjectRef obj = stack.front();
+			stack.pop_front();
+			if ( obj == NULL || link_map.find( obj ) != link_map.end() ) {
+				continue;
+			}
+			link_map[obj] = (unsigned int)(clones.size());
+			clones[(unsigned int)(clones.size())] = NULL;
+			pending.push_back( obj );
+			list<NiObjectRef> refs = obj->GetRefs();
+			stack.insert( stack.end(), refs.begin(), refs.end() );
+		}
+
+		//Copy the data of each object
+		vector< list<unsigned int> > link_stacks( pending.size() );
+		vector<bool> read( pending.size(), false );
+		for ( unsigned int i = 0; i < pending.size(); ++i ) {
+			Header header;
+			stringstream tmp;
+			tmp << hdrInfo(&header);
+			list<NiObject *> missing_link_stack;
+			pending[i]->Write( tmp, link_map, missing_link_stack, info );
+
+			NiObjectRef & clone = clones[ link_map[ pending[i] ] ];
+			string content;
+			if ( pending[i]->IsDerivedType( NiKeyframeData::TYPE ) ) {
+				content = pending[i]->GetType().GetTypeName() + '\0' + tmp.str();
+				SharedData::iterator it = shared_data.find( content );
+				if ( it != shared_data.end() ) {
+					clone = it->second;
+					continue;
+				}
+			}
+			clone = ObjectRegistry::CreateObject( pending[i]->GetType().GetTypeName() );
+			clone->Read( tmp, link_stacks[i], info );
+			read[i] = true;
+			if ( !content.empty() ) {
+				shared_data[content] = clone;
+			}
+		}
+
+		//Point the links at the clones; links to objects outside the subgraph are cleared
+		for ( unsigned int i = 0; i < pending.size(); ++i ) {
+			if ( read[i] ) {
+				list<NiObjectRef> missing_link_stack;
+				clones[ link_map[ pending[i] ] ]->FixLinks( clones, link_stacks[i], missing_link_stack, info );
+			}
+		}
+		return clones[ link_map[root] ];
+	}
+
+private:
+	NifInfo info;
+	map<NiObjectRef,unsigned int> link_map;
+	map<unsigned int,NiObjectRef> clones;
+#ifdef NIFLIB_CXX11
+	typedef std::unordered_map<string,NiObjectRef> SharedData;
+#else
+	typedef map<string,NiObjectRef> SharedData;
+#endif
+	SharedData shared_data;
+};
 
+//Finds the single interpolator controllers of each node by type, scanning the
+//controllers of a node only the first time it is looked up.  Every controller
+//attached during the merge must be added, so that the index finds the same
+//controller as a scan of the node, which is the one attached last.
+class ControllerIndex {
+public:
+	NiSingleInterpControllerRef Find( NiNode * node, const string & type ) {
+		if ( scanned.insert( node ).second ) {
+			list<NiTimeControllerRef> ctlrs = node->GetControllers();
+			for ( list<NiTimeControllerRef>::iterator it = ctlrs.begin(); it != ctlrs.end(); ++it ) {
+				NiSingleInterpControllerRef ctlr = DynamicCast<NiSingleInterpController>(*it);
+				if ( ctlr != NULL ) {
+					index.insert( make_pair( make_pair( node, ctlr->GetType().GetTypeName() ), ctlr ) );
+				}
+			}
+		}
+		map< pair<NiNode *,string>, NiSingleInterpControllerRef >::iterator it = index.find( make_pair( node, type ) );
+		return ( it != index.end() ) ? it->second : NULL;
+	}
+
+	void Add( NiNode * node, NiSingleInterpController * ctlr ) {
+		index[ make_pair( node, ctlr->GetType().GetTypeName() ) ] = ctlr;
+	}
+
+private:
+	set<NiNode *> scanned;
+	map< pair<NiNode *,string>, NiSingleInterpControllerRef > index;
+};
+
+//Merges one KF sequence using name, controller, and clone indices that can be
+//shared by many sequences merged into the same tree
+static void MergeSequence( NiNode * target, NiControllerSequence * right, NodeNameIndex & name_map, ControllerIndex & ctlr_index, ObjectCloner & cloner, unsigned version, vector<NiObjectRef> & merged ) {
 	//TODO:  Allow this to merge a KF sequence into a file that already has
 	//sequences in it by appending all the keyframe data to the end of
 	//existing controllers
@@ -1095,15 +1308,12 @@ void MergeNifTrees( NiNode * target, NiControllerSequence * right, unsigned vers
 	//Get the NiTextKeyExtraData, clone it, and attach it to the target node
 	NiTextKeyExtraDataRef txt_key = right->GetTextKeyExtraData();
 	if ( txt_key != NULL ) {
-		NiObjectRef tx_clone = txt_key->Clone( version, user_version );
-		NiExtraDataRef ext_dat = DynamicCast<NiExtraData>(tx_clone);
+		NiExtraDataRef ext_dat = DynamicCast<NiExtraData>( cloner.Clone( txt_key ) );
 		if ( ext_dat != NULL ) {
 			target->AddExtraData( ext_dat, version );
 		}
 	}
 
-	//Atach it to
-
 	//Get the controller data
 	vector<ControllerLink> data = right->GetControllerData();
 
@@ -1121,78 +1331,107 @@ void MergeNifTrees( NiNode * target, NiControllerSequence * right, unsigned vers
 			ctlr_type = str_pal->GetSubStr( data[i].controllerTypeOffset );
 		}
 		//Make sure there is a node with this name in the target tree
-		if ( name_map.find( node_name ) != name_map.end() ) {
-			//See if we're dealing with an interpolator or a controller
-			if ( data[i].controller != NULL ) {
-				//Clone the controller and attached data and
-				//add it to the named node
-				NiObjectRef clone = CloneNifTree( StaticCast<NiObject>(data[i].controller), version, user_version );
-				NiTimeControllerRef ctlr = DynamicCast<NiTimeController>(clone);
-				if ( ctlr != NULL ) {
-					name_map[node_name]->AddController( ctlr );
-				}
-			} else if ( data[i].interpolator != NULL ) {
-				//Clone the interpolator and attached data and
-				//attach it to the specific type of controller that's
-				//connected to the named node
-				NiNodeRef node = name_map[node_name];
-				list<NiTimeControllerRef> ctlrs = node->GetControllers();
-				NiSingleInterpControllerRef ctlr;
-				for ( list<NiTimeControllerRef>::iterator it = ctlrs.begin(); it != ctlrs.end(); ++it ) {
-					if ( *it != NULL && (*it)->GetType().GetTypeName() == ctlr_type ) {
-						ctlr = DynamicCast<NiSingleInterpController>(*it);
-						if ( ctlr != NULL ) {
-							break;
-						}
-					}
-				}
+		NiNodeRef node = name_map.Find( node_name );
+		if ( node == NULL ) {
+			continue;
+		}
 
-				//If the controller wasn't found, create one of the right type and attach it
+		//See if we're dealing with an interpolator or a controller
+		if ( data[i].controller != NULL ) {
+			//Clone the controller and attached data and
+			//add it to the named node
+			NiTimeControllerRef ctlr = DynamicCast<NiTimeController>( cloner.Clone( data[i].controller ) );
+			if ( ctlr != NULL ) {
+				node->AddController( ctlr );
+				merged.push_back( StaticCast<NiObject>(ctlr) );
+				NiSingleInterpControllerRef single = DynamicCast<NiSingleInterpController>( ctlr );
+				if ( single != NULL ) {
+					ctlr_index.Add( node, single );
+				}
+			}
+		} else if ( data[i].interpolator != NULL ) {
+			//Find the specific type of controller that's connected to the named node
+			NiSingleInterpControllerRef ctlr = ctlr_index.Find( node, ctlr_type );
+
+			//If the controller wasn't found, create one of the right type and attach it
+			if ( ctlr == NULL ) {
+				NiObjectRef new_ctlr = ObjectRegistry::CreateObject( ctlr_type );
+				ctlr = DynamicCast<NiSingleInterpController>( new_ctlr );
 				if ( ctlr == NULL ) {
-					NiObjectRef new_ctlr = ObjectRegistry::CreateObject( ctlr_type );
-					ctlr = DynamicCast<NiSingleInterpController>( new_ctlr );
-					if ( ctlr == NULL ) {
-						throw runtime_error ("Non-NiSingleInterpController controller found in KF file.");
-					}
-					node->AddController( StaticCast<NiTimeController>(ctlr) );
+					throw runtime_error ("Non-NiSingleInterpController controller found in KF file.");
 				}
+				node->AddController( StaticCast<NiTimeController>(ctlr) );
+				ctlr_index.Add( node, ctlr );
+			}
 
-				//Clone the interpolator and attached data and
-				//add it to controller of matching type that was
-				//found
-				NiObjectRef clone = CloneNifTree( StaticCast<NiObject>(data[i].interpolator), version, user_version );
-				NiInterpolatorRef interp = DynamicCast<NiInterpolator>(clone);
-				if ( interp != NULL ) {
-					ctlr->SetInterpolator( interp );
-
-					//Set the start/stop time and frequency of this controller
-					ctlr->SetStartTime( right->GetStartTime() );
-					ctlr->SetStopTime( right->GetStopTime() );
-					ctlr->SetFrequency( right->GetFrequency() );
-					ctlr->SetPhase( 0.0f ); //TODO:  Is phase somewhere in NiControllerSequence?
-
-					//Set cycle type as well
-					switch ( right->GetCycleType() ) {
-						case CYCLE_LOOP:
-							ctlr->SetFlags( 8 ); //Active
-							break;
-						case CYCLE_CLAMP:
-							ctlr->SetFlags( 12 ); //Active+Clamp
-							break;
-						case CYCLE_REVERSE:
-							ctlr->SetFlags( 10 ); //Active+Reverse
-							break;
-					}
+			//Clone the interpolator and attached data and
+			//add it to controller of matching type that was
+			//found
+			NiInterpolatorRef interp = DynamicCast<NiInterpolator>( cloner.Clone( data[i].interpolator ) );
+			if ( interp != NULL ) {
+				ctlr->SetInterpolator( interp );
+				merged.push_back( StaticCast<NiObject>(interp) );
+
+				//Set the start/stop time and frequency of this controller
+				ctlr->SetStartTime( right->GetStartTime() );
+				ctlr->SetStopTime( right->GetStopTime() );
+				ctlr->SetFrequency( right->GetFrequency() );
+				ctlr->SetPhase( 0.0f ); //TODO:  Is phase somewhere in NiControllerSequence?
+
+				//Set cycle type as well
+				switch ( right->GetCycleType() ) {
+					case CYCLE_LOOP:
+						ctlr->SetFlags( 8 ); //Active
+						break;
+					case CYCLE_CLAMP:
+						ctlr->SetFlags( 12 ); //Active+Clamp
+						break;
+					case CYCLE_REVERSE:
+						ctlr->SetFlags( 10 ); //Active+Reverse
+						break;
 				}
 			}
 		}
 	}
 }
 
+//Version for merging KF Trees rooted by a NiControllerSequence
+void MergeNifTrees( NiNode * target, NiControllerSequence * right, unsigned version, unsigned user_version, bool reduce, float translate_tolerance, float rotate_tolerance, float scale_tolerance ) {
+	vector<NiControllerSequenceRef> sequences( 1, NiControllerSequenceRef(right) );
+	MergeNifTrees( target, sequences, version, user_version, reduce, translate_tolerance, rotate_tolerance, scale_tolerance );
+}
+
+//Version for merging many KF Trees rooted by a NiControllerSequence at once
+void MergeNifTrees( NiNode * target, const vector<NiControllerSequenceRef> & sequences, unsigned version, unsigned user_version, bool reduce, float translate_tolerance, float rotate_tolerance, float scale_tolerance ) {
+	//Ensure that objects are registered, since nothing is read from a file here
+	if ( g_objects_registered == false ) {
+		g_objects_registered = true;
+		RegisterObjects();
+	}
+
+	//Map the node names once for all sequences
+	NodeNameIndex name_map;
+	MapNodeNames( name_map, target );
+
+	ControllerIndex ctlr_index;
+	ObjectCloner cloner( version, user_version );
+	vector<NiObjectRef> merged;
+	for ( unsigned int i = 0; i < sequences.size(); ++i ) {
+		if ( sequences[i] == NULL ) {
+			throw runtime_error( "Attempted to merge a null controller sequence." );
+		}
+		MergeSequence( target, sequences[i], name_map, ctlr_index, cloner, version, merged );
+	}
+
+	if ( reduce ) {
+		ReduceMergedKeys( merged, translate_tolerance, rotate_tolerance, scale_tolerance );
+	}
+}
+
 //Version for merging KF Trees rooted by a NiSequenceStreamHelper
 void MergeNifTrees( NiNode * target, NiSequenceStreamHelper * right, unsigned version, unsigned user_version ) {
 	//Map the node names
-	map<string,NiNodeRef> name_map;
+	NodeNameIndex name_map;
 	MapNodeNames( name_map, target );
 
 	//TODO: Implement this
@@ -1327,6 +1566,94 @@ Ref<NiObject> CloneNifTree( NiObject *root, unsigned version, unsigned user_vers
 	return ReadNifTree( tmp, resolved_link_stack );
 }
 
+void SampleKeyTracks( const vector<NiObjectRef> & tracks, const vector<float> & times, vector<unsigned int> & first_channels, vector<float> & samples ) {
+	//Count the channels of each track
+	first_channels.resize( tracks.size() );
+	unsigned int num_channels = 0;
+	for ( unsigned int i = 0; i < tracks.size(); ++i ) {
+		first_channels[i] = num_channels;
+		NiObject * track = tracks[i];
+		if ( track == NULL ) {
+			throw runtime_error("Cannot sample a NULL animation track.");
+		} else if ( track->IsDerivedType( NiKeyframeData::TYPE ) || track->IsDerivedType( NiBSplineTransformInterpolator::TYPE ) ) {
+			num_channels += 8;
+		} else if ( track->IsDerivedType( NiFloatData::TYPE ) || track->IsDerivedType( NiBoolData::TYPE ) ) {
+			num_channels += 1;
+		} else if ( track->IsDerivedType( NiPosData::TYPE ) ) {
+			num_channels += 3;
+		} else if ( track->IsDerivedType( NiMorphData::TYPE ) ) {
+			num_channels += DynamicCast<NiMorphData>(track)->GetMorphCount();
+		} else {
+			throw runtime_error("Cannot sample animation data of type " + track->GetType().GetTypeName() + ".");
+		}
+	}
+
+	const unsigned int count = (unsigned int)(times.size());
+	samples.resize( num_channels * count );
+	if ( count == 0 ) {
+		return;
+	}
+
+	//Sample all B-spline interpolators in one batch so they share basis weights
+	vector<NiBSplineTransformInterpolatorRef> splines;
+	for ( unsigned int i = 0; i < tracks.size(); ++i ) {
+		if ( NiBSplineTransformInterpolatorRef bs = DynamicCast<NiBSplineTransformInterpolator>(tracks[i]) ) {
+			splines.push_back( bs );
+		}
+	}
+	vector<float> spline_samples;
+	NiBSplineTransformInterpolator::SampleTransforms( splines, times, spline_samples );
+	unsigned int spline_index = 0;
+
+	for ( unsigned int i = 0; i < tracks.size(); ++i ) {
+		float * out = &samples[ first_channels[i] * count ];
+		if ( tracks[i]->IsDerivedType( NiBSplineTransformInterpolator::TYPE ) ) {
+			const float * in = &spline_samples[ spline_index * 8 * count ];
+			copy( in, in + 8 * count, out );
+			++spline_index;
+		} else if ( NiKeyframeDataRef kd = DynamicCast<NiKeyframeData>(tracks[i]) ) {
+			unsigned int hints[5] = { 0, 0, 0, 0, 0 };
+			for ( unsigned int m = 0; m < count; ++m ) {
+				Vector3 t = kd->EvaluateTranslation( times[m], &hints[3] );
+				Quaternion q = kd->EvaluateRotation( times[m], hints );
+				out[m] = t.x;
+				out[count + m] = t.y;
+				out[2 * count + m] = t.z;
+				out[3 * count + m] = q.w;
+				out[4 * count + m] = q.x;
+				out[5 * count + m] = q.y;
+				out[6 * count + m] = q.z;
+				out[7 * count + m] = kd->EvaluateScale( times[m], &hints[4] );
+			}
+		} else if ( NiFloatDataRef fd = DynamicCast<NiFloatData>(tracks[i]) ) {
+			unsigned int hint = 0;
+			for ( unsigned int m = 0; m < count; ++m ) {
+				out[m] = fd->Evaluate( times[m], &hint );
+			}
+		} else if ( NiBoolDataRef bd = DynamicCast<NiBoolData>(tracks[i]) ) {
+			unsigned int hint = 0;
+			for ( unsigned int m = 0; m < count; ++m ) {
+				out[m] = bd->Evaluate( times[m], &hint ) ? 1.0f : 0.0f;
+			}
+		} else if ( NiPosDataRef pd = DynamicCast<NiPosData>(tracks[i]) ) {
+			unsigned int hint = 0;
+			for ( unsigned int m = 0; m < count; ++m ) {
+				Vector3 p = pd->Evaluate( times[m], &hint );
+				out[m] = p.x;
+				out[count + m] = p.y;
+				out[2 * count + m] = p.z;
+			}
+		} else if ( NiMorphDataRef md = DynamicCast<NiMorphData>(tracks[i]) ) {
+			for ( int n = 0; n < md->GetMorphCount(); ++n ) {
+				unsigned int hint = 0;
+				for ( unsigned int m = 0; m < count; ++m ) {
+					out[n * count + m] = md->EvaluateMorphWeight( n, times[m], &hint );
+				}
+			}
+		}
+	}
+}
+
 void SendNifTreeToBindPos( NiNode * root ) {
 	//If this node is a skeleton root, send its children to the bind
 	//position
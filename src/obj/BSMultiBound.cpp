@@ -129,4 +129,12 @@ std::list<NiObject *> BSMultiBound::GetPtrs() const {
 
 //--BEGIN MISC CUSTOM CODE--//
 
+Ref<BSMultiBoundData> BSMultiBound::GetData() const {
+	return data;
+}
+
+void BSMultiBound::SetData( BSMultiBoundData * value ) {
+	data = value;
+}
+
 //--END CUSTOM CODE--//
@@ -110,4 +110,20 @@ std::list<NiObject *> BSMultiBoundAABB::GetPtrs() const {
 
 //--BEGIN MISC CUSTOM CODE--//
 
+Vector3 BSMultiBoundAABB::GetPosition() const {
+	return position;
+}
+
+void BSMultiBoundAABB::SetPosition( const Vector3 & value ) {
+	position = value;
+}
+
+Vector3 BSMultiBoundAABB::GetExtent() const {
+	return extent;
+}
+
+void BSMultiBoundAABB::SetExtent( const Vector3 & value ) {
+	extent = value;
+}
+
 //--END CUSTOM CODE--//
@@ -136,4 +136,12 @@ std::list<NiObject *> BSMultiBoundNode::GetPtrs() const {
 
 //--BEGIN MISC CUSTOM CODE--//
 
+Ref<BSMultiBound> BSMultiBoundNode::GetMultiBound() const {
+	return multiBound;
+}
+
+void BSMultiBoundNode::SetMultiBound( BSMultiBound * value ) {
+	multiBound = value;
+}
+
 //--END CUSTOM CODE--//
@@ -113,4 +113,28 @@ std::list<NiObject *> BSMultiBoundOBB::GetPtrs() const {
 
 //--BEGIN MISC CUSTOM CODE--//
 
+Vector3 BSMultiBoundOBB::GetCenter() const {
+	return center;
+}
+
+void BSMultiBoundOBB::SetCenter( const Vector3 & value ) {
+	center = value;
+}
+
+Vector3 BSMultiBoundOBB::GetSize() const {
+	return size;
+}
+
+void BSMultiBoundOBB::SetSize( const Vector3 & value ) {
+	size = value;
+}
+
+Matrix33 BSMultiBoundOBB::GetRotation() const {
+	return rotation;
+}
+
+void BSMultiBoundOBB::SetRotation( const Matrix33 & value ) {
+	rotation = value;
+}
+
 //--END CUSTOM CODE--//
@@ -252,4 +252,28 @@ std::list<NiObject *> BSPackedAdditionalGeometryData::GetPtrs() const {
 
 //--BEGIN MISC CUSTOM CODE--//
 
+unsigned short BSPackedAdditionalGeometryData::GetVertexCount() const {
+	return numVertices;
+}
+
+void BSPackedAdditionalGeometryData::SetVertexCount( unsigned short value ) {
+	numVertices = value;
+}
+
+const vector<AdditionalDataInfo> & BSPackedAdditionalGeometryData::GetBlockInfos() const {
+	return blockInfos;
+}
+
+void BSPackedAdditionalGeometryData::SetBlockInfos( const vector<AdditionalDataInfo> & value ) {
+	blockInfos = value;
+}
+
+const vector<BSPackedAdditionalDataBlock> & BSPackedAdditionalGeometryData::GetBlocks() const {
+	return blocks;
+}
+
+void BSPackedAdditionalGeometryData::SetBlocks( const vector<BSPackedAdditionalDataBlock> & value ) {
+	blocks = value;
+}
+
 //--END CUSTOM CODE--//
@@ -324,7 +324,7 @@ void NiAVObject::ClearProperties() {
 	properties.clear();
 }
 
-vector< Ref<NiProperty> > NiAVObject::GetProperties() const {
+const vector< Ref<NiProperty> > & NiAVObject::GetProperties() const {
 	return properties;
 }
 
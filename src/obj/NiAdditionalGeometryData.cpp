@@ -253,4 +253,28 @@ std::list<NiObject *> NiAdditionalGeometryData::GetPtrs() const {
 
 //--BEGIN MISC CUSTOM CODE--//
 
+unsigned short NiAdditionalGeometryData::GetVertexCount() const {
+	return numVertices;
+}
+
+void NiAdditionalGeometryData::SetVertexCount( unsigned short value ) {
+	numVertices = value;
+}
+
+const vector<AdditionalDataInfo> & NiAdditionalGeometryData::GetBlockInfos() const {
+	return blockInfos;
+}
+
+void NiAdditionalGeometryData::SetBlockInfos( const vector<AdditionalDataInfo> & value ) {
+	blockInfos = value;
+}
+
+const vector<AdditionalDataBlock> & NiAdditionalGeometryData::GetBlocks() const {
+	return blocks;
+}
+
+void NiAdditionalGeometryData::SetBlocks( const vector<AdditionalDataBlock> & value ) {
+	blocks = value;
+}
+
 //--END CUSTOM CODE--//
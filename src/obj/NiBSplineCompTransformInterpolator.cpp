@@ -15,6 +15,117 @@ static const int SizeofQuat = 4;
 static const int SizeofTrans = 3;
 static const int SizeofScale = 1;
 
+#include "../../include/obj/NiTransformData.h"
+#include "../../include/obj/NiTransformInterpolator.h"
+#include <algorithm>
+#include <math.h>
+
+// Solves the least squares fit of nctrl control points of dim floats to the sample
+// values, given the first control point and basis weights of each sample.  Each
+// sample touches at most 4 neighbouring control points, so the normal equations are
+// banded and are solved with a banded Cholesky factorization.  A slight second
+// difference penalty keeps control points that no sample reaches well defined.
+static void FitControlPoints( int nctrl, const vector<int> & first, const vector<float> & weights, const vector<float> & values, int dim, vector<float> & control )
+{
+	const int nw = (nctrl < 4) ? nctrl : 4;
+	const int nsamples = int(first.size());
+
+	// lower band of the normal matrix, a[i * 4 + k] = A(i, i - k), and the right hand side
+	vector<double> a(nctrl * 4, 0.0), b(nctrl * dim, 0.0);
+	for (int s = 0; s < nsamples; ++s) {
+		const float * w = &weights[4 * s];
+		for (int j = 0; j < nw; ++j) {
+			int r = first[s] + j;
+			for (int k = 0; k <= j; ++k)
+				a[r * 4 + (j - k)] += double(w[j]) * w[k];
+			for (int c = 0; c < dim; ++c)
+				b[r * dim + c] += double(w[j]) * values[s * dim + c];
+		}
+	}
+	const double lambda = 1e-6 * nsamples / nctrl;
+	const double diff[3] = { 1.0, -2.0, 1.0 };
+	for (int i = 0; i + 2 < nctrl; ++i) {
+		for (int p = 0; p < 3; ++p)
+			for (int q = 0; q <= p; ++q)
+				a[(i + p) * 4 + (p - q)] += lambda * diff[p] * diff[q];
+	}
+
+	// factor A = L L^T in place
+	for (int i = 0; i < nctrl; ++i) {
+		for (int k = (i < 3) ? i : 3; k >= 0; --k) {
+			int j = i - k;
+			double sum = a[i * 4 + k];
+			for (int l = (i < 3) ? 0 : i - 3; l < j; ++l)
+				sum -= a[i * 4 + (i - l)] * a[j * 4 + (j - l)];
+			if (k == 0)
+				a[i * 4] = sqrt((sum > 1e-20) ? sum : 1e-20);
+			else
+				a[i * 4 + k] = sum / a[j * 4];
+		}
+	}
+
+	// forward and back substitution
+	control.resize(nctrl * dim);
+	vector<double> y(nctrl);
+	for (int c = 0; c < dim; ++c) {
+		for (int i = 0; i < nctrl; ++i) {
+			double sum = b[i * dim + c];
+			for (int l = (i < 3) ? 0 : i - 3; l < i; ++l)
+				sum -= a[i * 4 + (i - l)] * y[l];
+			y[i] = sum / a[i * 4];
+		}
+		for (int i = nctrl - 1; i >= 0; --i) {
+			double sum = y[i];
+			for (int l = i + 1; l < nctrl && l <= i + 3; ++l)
+				sum -= a[l * 4 + (l - i)] * y[l];
+			y[i] = sum / a[i * 4];
+			control[i * dim + c] = float(y[i]);
+		}
+	}
+}
+
+// Quantizes control points to shorts, with a bias and multiplier that map the full
+// short range onto the range of the values, and decodes them again the same way
+// readControlPoints does.
+static void QuantizeControlPoints( vector<float> & control, vector<short> & points, float & bias, float & mult )
+{
+	float lo = *std::min_element(control.begin(), control.end());
+	float hi = *std::max_element(control.begin(), control.end());
+	bias = 0.5f * (lo + hi);
+	mult = 0.5f * (hi - lo);
+	float scale = mult / 32767.0f;
+	for (unsigned int i = 0; i < control.size(); ++i) {
+		float v = (mult > 0.0f) ? floor((control[i] - bias) / mult * 32767.0f + 0.5f) : 0.0f;
+		v = (v > 32767.0f) ? 32767.0f : ((v < -32767.0f) ? -32767.0f : v);
+		points.push_back(short(v));
+		control[i] = v * scale + bias;
+	}
+}
+
+// evaluates a curve with dim floats per control point at every sample
+static void EvaluateCurve( const vector<float> & control, int dim, int nctrl, const vector<int> & first, const vector<float> & weights, vector<float> & values )
+{
+	const int nw = (nctrl < 4) ? nctrl : 4;
+	values.assign(first.size() * dim, 0.0f);
+	for (unsigned int s = 0; s < first.size(); ++s) {
+		for (int k = 0; k < nw; ++k) {
+			float w = weights[4 * s + k];
+			for (int c = 0; c < dim; ++c)
+				values[s * dim + c] += w * control[(first[s] + k) * dim + c];
+		}
+	}
+}
+
+// time range covered by a key vector
+template <class T>
+static void ExtendKeyRange( const vector< Niflib::Key<T> > & keys, float & start, float & stop )
+{
+	if (!keys.empty()) {
+		start = std::min(start, keys.front().time);
+		stop = std::max(stop, keys.back().time);
+	}
+}
+
 //--END CUSTOM CODE--//
 
 #include "../../include/FixLink.h"
@@ -336,4 +447,231 @@ int NiBSplineCompTransformInterpolator::GetNumControlPoints() const
    return 0;
 }
 
+bool NiBSplineCompTransformInterpolator::readControlPoints( SplineCurve curve, int first, int count, float * out ) const
+{
+   unsigned int offset;
+   int size;
+   float mult, bias;
+   if (curve == TRANSLATE_CURVE) {
+      offset = translationOffset;
+      size = SizeofTrans;
+      mult = translationMultiplier;
+      bias = translationBias;
+   } else if (curve == ROTATE_CURVE) {
+      offset = rotationOffset;
+      size = SizeofQuat;
+      mult = rotationMultiplier;
+      bias = rotationBias;
+   } else {
+      offset = scaleOffset;
+      size = SizeofScale;
+      mult = scaleMultiplier;
+      bias = scaleBias;
+   }
+   if (offset == USHRT_MAX || !splineData)
+      return false;
+   vector<short> points = splineData->GetShortControlPointRange(offset + first * size, count * size);
+   mult /= 32767.0f;
+   for (unsigned int i = 0; i < points.size(); ++i)
+      out[i] = float(points[i]) * mult + bias;
+   return true;
+}
+
+void NiBSplineCompTransformInterpolator::FitTransforms( const vector<float> & times, const vector<Vector3> & translations, const vector<Quaternion> & rotations, const vector<float> & scales, float translate_tolerance, float rotate_tolerance, float scale_tolerance )
+{
+   const unsigned int count = (unsigned int)(times.size());
+   if (count == 0)
+      throw runtime_error("Cannot fit a B-spline to no samples.");
+   if ((!translations.empty() && translations.size() != count) || (!rotations.empty() && rotations.size() != count) || (!scales.empty() && scales.size() != count))
+      throw runtime_error("Each transform channel needs one value per sample time.");
+   for (unsigned int i = 1; i < count; ++i) {
+      if (times[i] < times[i-1])
+         throw runtime_error("B-spline sample times must be in increasing order.");
+   }
+
+   // flatten the channels that change; constant ones become the base transform
+   vector<float> tvalues, rvalues, svalues;
+   if (!translations.empty()) {
+      translation = translations[0];
+      for (unsigned int i = 1; i < count && tvalues.empty(); ++i) {
+         if ((translations[i] - translations[0]).Magnitude() > translate_tolerance) {
+            for (unsigned int j = 0; j < count; ++j) {
+               tvalues.push_back(translations[j].x);
+               tvalues.push_back(translations[j].y);
+               tvalues.push_back(translations[j].z);
+            }
+         }
+      }
+   }
+   if (!rotations.empty()) {
+      rotation = rotations[0];
+      for (unsigned int i = 1; i < count && rvalues.empty(); ++i) {
+         float d = fabs(rotations[i].Normalized().Dot(rotations[0].Normalized()));
+         if (2.0f * acos((d < 1.0f) ? d : 1.0f) > rotate_tolerance) {
+            // keep neighbouring quaternions in the same hemisphere so the components vary smoothly
+            Quaternion prev = rotations[0];
+            for (unsigned int j = 0; j < count; ++j) {
+               Quaternion q = rotations[j];
+               if (q.Dot(prev) < 0.0f)
+                  q = q * -1.0f;
+               rvalues.push_back(q.w);
+               rvalues.push_back(q.x);
+               rvalues.push_back(q.y);
+               rvalues.push_back(q.z);
+               prev = q;
+            }
+         }
+      }
+   }
+   if (!scales.empty()) {
+      scale = scales[0];
+      for (unsigned int i = 1; i < count && svalues.empty(); ++i) {
+         if (fabs(scales[i] - scales[0]) > scale_tolerance)
+            svalues = scales;
+      }
+   }
+
+   startTime = times.front();
+   stopTime = times.back();
+   splineData = new NiBSplineData;
+   basisData = new NiBSplineBasisData;
+   translationOffset = rotationOffset = scaleOffset = USHRT_MAX;
+   if (tvalues.empty() && rvalues.empty() && svalues.empty())
+      return;
+
+   // the curve offsets are stored as unsigned shorts, with USHRT_MAX meaning no curve, so the
+   // control points of the curves before the last one limit the control point count
+   const int min_ctrl = (count < 4) ? int(count) : 4;
+   int max_ctrl = int(count);
+   bool offset_limited = false;
+   int stride = 0, last = 0;
+   if (!tvalues.empty()) { stride += last; last = SizeofTrans; }
+   if (!rvalues.empty()) { stride += last; last = SizeofQuat; }
+   if (!svalues.empty()) { stride += last; last = SizeofScale; }
+   if (stride > 0 && max_ctrl > (USHRT_MAX - 1) / stride) {
+      max_ctrl = (USHRT_MAX - 1) / stride;
+      offset_limited = true;
+   }
+
+   // grow the control point count until the tolerances are met, then narrow it down
+   int failed = min_ctrl - 1, good = min_ctrl, fitted = good;
+   while (!fitCurves(good, times, tvalues, rvalues, svalues, translate_tolerance, rotate_tolerance, scale_tolerance)) {
+      failed = good;
+      if (good == max_ctrl) {
+         if (offset_limited)
+            throw runtime_error("The B-spline curves need more control points than their 16 bit offsets can address.");
+         return; // tolerances cannot be met, keep the densest fit
+      }
+      good = std::min(max_ctrl, 2 * good);
+      fitted = good;
+   }
+   while (good - failed > 1) {
+      int mid = (good + failed) / 2;
+      fitted = mid;
+      if (fitCurves(mid, times, tvalues, rvalues, svalues, translate_tolerance, rotate_tolerance, scale_tolerance))
+         good = mid;
+      else
+         failed = mid;
+   }
+   if (fitted != good)
+      fitCurves(good, times, tvalues, rvalues, svalues, translate_tolerance, rotate_tolerance, scale_tolerance);
+}
+
+void NiBSplineCompTransformInterpolator::FitTransforms( NiTransformInterpolator * interpolator, float sample_rate, float translate_tolerance, float rotate_tolerance, float scale_tolerance )
+{
+   if (interpolator == NULL)
+      throw runtime_error("Cannot fit a B-spline to a NULL interpolator.");
+   if (!(sample_rate > 0.0f))
+      throw runtime_error("The B-spline sample rate must be positive.");
+
+   NiTransformDataRef data = interpolator->GetData();
+   vector< Key<Vector3> > tkeys;
+   vector< Key<Quaternion> > qkeys;
+   vector< Key<float> > xkeys, ykeys, zkeys, skeys;
+   if (data) {
+      tkeys = data->GetTranslateKeys();
+      qkeys = data->GetQuatRotateKeys();
+      xkeys = data->GetXRotateKeys();
+      ykeys = data->GetYRotateKeys();
+      zkeys = data->GetZRotateKeys();
+      skeys = data->GetScaleKeys();
+   }
+   bool has_rotation = !qkeys.empty() || !xkeys.empty() || !ykeys.empty() || !zkeys.empty();
+
+   float start = 3.402823466e+38f, stop = -3.402823466e+38f;
+   ExtendKeyRange(tkeys, start, stop);
+   ExtendKeyRange(qkeys, start, stop);
+   ExtendKeyRange(xkeys, start, stop);
+   ExtendKeyRange(ykeys, start, stop);
+   ExtendKeyRange(zkeys, start, stop);
+   ExtendKeyRange(skeys, start, stop);
+   if (start > stop)
+      start = stop = 0.0f;
+
+   unsigned int count = 1;
+   if (stop > start)
+      count = (unsigned int)(ceil((stop - start) * sample_rate)) + 1;
+   vector<float> times(count);
+   vector<Vector3> translations(count, interpolator->GetTranslation());
+   vector<Quaternion> rotations(count, interpolator->GetRotation());
+   vector<float> scales(count, interpolator->GetScale());
+   unsigned int hints[5] = { 0, 0, 0, 0, 0 };
+   for (unsigned int i = 0; i < count; ++i) {
+      times[i] = (count > 1) ? start + (stop - start) * float(i) / float(count - 1) : start;
+      if (!tkeys.empty())
+         translations[i] = data->EvaluateTranslation(times[i], &hints[3]);
+      if (has_rotation)
+         rotations[i] = data->EvaluateRotation(times[i], hints);
+      if (!skeys.empty())
+         scales[i] = data->EvaluateScale(times[i], &hints[4]);
+   }
+   FitTransforms(times, translations, rotations, scales, translate_tolerance, rotate_tolerance, scale_tolerance);
+}
+
+bool NiBSplineCompTransformInterpolator::fitCurves( int nctrl, const vector<float> & times, const vector<float> & tvalues, const vector<float> & rvalues, const vector<float> & svalues, float translate_tolerance, float rotate_tolerance, float scale_tolerance )
+{
+   const unsigned int count = (unsigned int)(times.size());
+   basisData->SetNumControlPoints(nctrl);
+   vector<int> first(count);
+   vector<float> weights(4 * count);
+   for (unsigned int s = 0; s < count; ++s)
+      first[s] = bsplineWeights(times[s], nctrl, &weights[4 * s]);
+
+   bool ok = true;
+   vector<short> points;
+   vector<float> control, values;
+   if (!tvalues.empty()) {
+      FitControlPoints(nctrl, first, weights, tvalues, SizeofTrans, control);
+      translationOffset = (unsigned int)(points.size());
+      QuantizeControlPoints(control, points, translationBias, translationMultiplier);
+      EvaluateCurve(control, SizeofTrans, nctrl, first, weights, values);
+      for (unsigned int s = 0; s < count && ok; ++s) {
+         Vector3 d(values[3*s] - tvalues[3*s], values[3*s+1] - tvalues[3*s+1], values[3*s+2] - tvalues[3*s+2]);
+         ok = d.Magnitude() <= translate_tolerance;
+      }
+   }
+   if (!rvalues.empty()) {
+      FitControlPoints(nctrl, first, weights, rvalues, SizeofQuat, control);
+      rotationOffset = (unsigned int)(points.size());
+      QuantizeControlPoints(control, points, rotationBias, rotationMultiplier);
+      EvaluateCurve(control, SizeofQuat, nctrl, first, weights, values);
+      for (unsigned int s = 0; s < count && ok; ++s) {
+         Quaternion q(values[4*s], values[4*s+1], values[4*s+2], values[4*s+3]);
+         Quaternion r(rvalues[4*s], rvalues[4*s+1], rvalues[4*s+2], rvalues[4*s+3]);
+         float d = fabs(q.Normalized().Dot(r.Normalized()));
+         ok = 2.0f * acos((d < 1.0f) ? d : 1.0f) <= rotate_tolerance;
+      }
+   }
+   if (!svalues.empty()) {
+      FitControlPoints(nctrl, first, weights, svalues, SizeofScale, control);
+      scaleOffset = (unsigned int)(points.size());
+      QuantizeControlPoints(control, points, scaleBias, scaleMultiplier);
+      EvaluateCurve(control, SizeofScale, nctrl, first, weights, values);
+      for (unsigned int s = 0; s < count && ok; ++s)
+         ok = fabs(values[s] - svalues[s]) <= scale_tolerance;
+   }
+   splineData->SetShortControlPoints(points);
+   return ok;
+}
+
 //--END CUSTOM CODE--//
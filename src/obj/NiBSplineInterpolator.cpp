@@ -279,4 +279,62 @@ void NiBSplineInterpolator::bspline(int n, int t, int l, float *control, float *
    delete [] calc;
 }
 
+int NiBSplineInterpolator::bsplineWeights(float time, int nctrl, float *weights) const
+{
+   int p = (nctrl < 4) ? nctrl - 1 : 3; // degree
+   if (p <= 0) {
+      weights[0] = 1.0f;
+      return 0;
+   }
+
+   // map the time onto the knot range [0, nctrl - p] of the clamped knot vector
+   // 0 (p+1 times), 1, 2, ..., nctrl - p - 1, nctrl - p (p+1 times), which is
+   // the one compute_intervals produces for bspline()
+   float range = float(nctrl - p);
+   float u = 0.0f;
+   if (stopTime > startTime)
+      u = (time - startTime) / (stopTime - startTime) * range;
+   if (!(u > 0.0f)) // also catches NaN
+      u = 0.0f;
+   else if (u > range)
+      u = range;
+
+   // knot span containing u; the end of the range belongs to the last span
+   int span = int(u) + p;
+   if (span > nctrl - 1)
+      span = nctrl - 1;
+
+   if (p == 3 && span >= 5 && span + 3 <= nctrl) {
+      // all knots around the span are evenly spaced: uniform cubic basis
+      float t = u - float(span - 3);
+      float t2 = t * t, t3 = t2 * t, s = 1.0f - t;
+      weights[0] = s * s * s / 6.0f;
+      weights[1] = (3.0f * t3 - 6.0f * t2 + 4.0f) / 6.0f;
+      weights[2] = (-3.0f * t3 + 3.0f * t2 + 3.0f * t + 1.0f) / 6.0f;
+      weights[3] = t3 / 6.0f;
+      return span - 3;
+   }
+
+   // near the clamped ends use the Cox-de Boor recurrence on the nonzero basis functions
+   float knot[8], left[4], right[4];
+   for (int j = 0; j < 2 * p; ++j) {
+      int k = span - p + 1 + j; // knot index
+      knot[j] = float((k <= p) ? 0 : ((k >= nctrl) ? nctrl - p : k - p));
+   }
+   weights[0] = 1.0f;
+   for (int j = 1; j <= p; ++j) {
+      left[j] = u - knot[p - j];
+      right[j] = knot[p - 1 + j] - u;
+      float saved = 0.0f;
+      for (int r = 0; r < j; ++r) {
+         float denom = right[r + 1] + left[j - r];
+         float temp = (denom != 0.0f) ? weights[r] / denom : 0.0f;
+         weights[r] = saved + right[r + 1] * temp;
+         saved = left[j - r] * temp;
+      }
+      weights[j] = saved;
+   }
+   return span - p;
+}
+
 //--END CUSTOM CODE--//
@@ -10,10 +10,36 @@ All rights reserved.  Please see niflib.h for license. */
 //--BEGIN FILE HEAD CUSTOM CODE--//
 #include "../../include/obj/NiBSplineBasisData.h"
 #include "../../include/obj/NiBSplineData.h"
+#include <algorithm>
 
 static const int SizeofQuat = 4;
 static const int SizeofTrans = 3;
 static const int SizeofScale = 1;
+
+// basis weights of a set of times for one control point count and time range
+struct BSplineWeightTable {
+	int nctrl;
+	float startTime, stopTime;
+	vector<int> first;
+	vector<float> weights;
+};
+
+// evaluates a curve with size floats per control point at every time of a weight
+// table, writing each float to its own channel of count samples
+static void SampleCurve( const vector<float> & control, int size, const BSplineWeightTable & table, float * out, unsigned int count )
+{
+	int nw = (table.nctrl < 4) ? table.nctrl : 4;
+	for (unsigned int m = 0; m < count; ++m) {
+		const float * w = &table.weights[4 * m];
+		const float * p = &control[table.first[m] * size];
+		for (int c = 0; c < size; ++c) {
+			float value = 0.0f;
+			for (int k = 0; k < nw; ++k)
+				value += w[k] * p[k * size + c];
+			out[c * count + m] = value;
+		}
+	}
+}
 //--END CUSTOM CODE--//
 
 #include "../../include/FixLink.h"
@@ -334,4 +360,158 @@ int NiBSplineTransformInterpolator::GetNumControlPoints() const
 	return 0;
 }
 
+bool NiBSplineTransformInterpolator::readControlPoints( SplineCurve curve, int first, int count, float * out ) const
+{
+	unsigned int offset;
+	int size;
+	if (curve == TRANSLATE_CURVE) {
+		offset = translationOffset;
+		size = SizeofTrans;
+	} else if (curve == ROTATE_CURVE) {
+		offset = rotationOffset;
+		size = SizeofQuat;
+	} else {
+		offset = scaleOffset;
+		size = SizeofScale;
+	}
+	if (offset == USHRT_MAX || !splineData)
+		return false;
+	vector<float> points = splineData->GetFloatControlPointRange(offset + first * size, count * size);
+	std::copy(points.begin(), points.end(), out);
+	return true;
+}
+
+Vector3 NiBSplineTransformInterpolator::EvaluateTranslation( float time ) const
+{
+	int nctrl = GetNumControlPoints();
+	if (nctrl > 0) {
+		float w[4], p[4 * SizeofTrans];
+		int first = bsplineWeights(time, nctrl, w);
+		int nw = (nctrl < 4) ? nctrl : 4;
+		if (readControlPoints(TRANSLATE_CURVE, first, nw, p)) {
+			Vector3 value(0.0f, 0.0f, 0.0f);
+			for (int k = 0; k < nw; ++k) {
+				value.x += w[k] * p[k * SizeofTrans];
+				value.y += w[k] * p[k * SizeofTrans + 1];
+				value.z += w[k] * p[k * SizeofTrans + 2];
+			}
+			return value;
+		}
+	}
+	return translation;
+}
+
+Quaternion NiBSplineTransformInterpolator::EvaluateRotation( float time ) const
+{
+	int nctrl = GetNumControlPoints();
+	if (nctrl > 0) {
+		float w[4], p[4 * SizeofQuat];
+		int first = bsplineWeights(time, nctrl, w);
+		int nw = (nctrl < 4) ? nctrl : 4;
+		if (readControlPoints(ROTATE_CURVE, first, nw, p)) {
+			Quaternion value(0.0f, 0.0f, 0.0f, 0.0f);
+			for (int k = 0; k < nw; ++k) {
+				value.w += w[k] * p[k * SizeofQuat];
+				value.x += w[k] * p[k * SizeofQuat + 1];
+				value.y += w[k] * p[k * SizeofQuat + 2];
+				value.z += w[k] * p[k * SizeofQuat + 3];
+			}
+			return value.Normalized();
+		}
+	}
+	return rotation;
+}
+
+float NiBSplineTransformInterpolator::EvaluateScale( float time ) const
+{
+	int nctrl = GetNumControlPoints();
+	if (nctrl > 0) {
+		float w[4], p[4];
+		int first = bsplineWeights(time, nctrl, w);
+		int nw = (nctrl < 4) ? nctrl : 4;
+		if (readControlPoints(SCALE_CURVE, first, nw, p)) {
+			float value = 0.0f;
+			for (int k = 0; k < nw; ++k)
+				value += w[k] * p[k];
+			return value;
+		}
+	}
+	return scale;
+}
+
+void NiBSplineTransformInterpolator::SampleTransforms( const vector<NiBSplineTransformInterpolatorRef> & interpolators, const vector<float> & times, vector<float> & samples )
+{
+	const unsigned int count = (unsigned int)(times.size());
+	samples.resize(interpolators.size() * 8 * count);
+	if (count == 0)
+		return;
+
+	vector<BSplineWeightTable> tables;
+	vector<float> control;
+	for (unsigned int i = 0; i < interpolators.size(); ++i) {
+		const NiBSplineTransformInterpolator * interp = interpolators[i];
+		if (interp == NULL)
+			throw runtime_error("Cannot sample a NULL B-spline interpolator.");
+		float * out = &samples[i * 8 * count];
+		int nctrl = interp->GetNumControlPoints();
+
+		// find or fill the basis weights for this control point count and time range
+		const BSplineWeightTable * table = NULL;
+		if (nctrl > 0) {
+			for (unsigned int j = 0; j < tables.size() && table == NULL; ++j) {
+				if (tables[j].nctrl == nctrl && tables[j].startTime == interp->startTime && tables[j].stopTime == interp->stopTime)
+					table = &tables[j];
+			}
+			if (table == NULL) {
+				tables.push_back(BSplineWeightTable());
+				BSplineWeightTable & t = tables.back();
+				t.nctrl = nctrl;
+				t.startTime = interp->startTime;
+				t.stopTime = interp->stopTime;
+				t.first.resize(count);
+				t.weights.resize(4 * count);
+				for (unsigned int m = 0; m < count; ++m)
+					t.first[m] = interp->bsplineWeights(times[m], nctrl, &t.weights[4 * m]);
+				table = &t;
+			}
+			control.resize(nctrl * SizeofQuat);
+		}
+
+		// translation
+		if (table && interp->readControlPoints(TRANSLATE_CURVE, 0, nctrl, &control[0])) {
+			SampleCurve(control, SizeofTrans, *table, out, count);
+		} else {
+			std::fill(out, out + count, interp->translation.x);
+			std::fill(out + count, out + 2 * count, interp->translation.y);
+			std::fill(out + 2 * count, out + 3 * count, interp->translation.z);
+		}
+
+		// rotation
+		float * rot = out + 3 * count;
+		if (table && interp->readControlPoints(ROTATE_CURVE, 0, nctrl, &control[0])) {
+			SampleCurve(control, SizeofQuat, *table, rot, count);
+			for (unsigned int m = 0; m < count; ++m) {
+				Quaternion q(rot[m], rot[count + m], rot[2 * count + m], rot[3 * count + m]);
+				q = q.Normalized();
+				rot[m] = q.w;
+				rot[count + m] = q.x;
+				rot[2 * count + m] = q.y;
+				rot[3 * count + m] = q.z;
+			}
+		} else {
+			std::fill(rot, rot + count, interp->rotation.w);
+			std::fill(rot + count, rot + 2 * count, interp->rotation.x);
+			std::fill(rot + 2 * count, rot + 3 * count, interp->rotation.y);
+			std::fill(rot + 3 * count, rot + 4 * count, interp->rotation.z);
+		}
+
+		// scale
+		if (table && interp->readControlPoints(SCALE_CURVE, 0, nctrl, &control[0])) {
+			SampleCurve(control, SizeofScale, *table, out + 7 * count, count);
+		} else {
+			std::fill(out + 7 * count, out + 8 * count, interp->scale);
+		}
+	}
+}
+
 //--END CUSTOM CODE--//
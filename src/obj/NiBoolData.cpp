@@ -148,4 +148,11 @@ void NiBoolData::NormalizeKeys( float phase, float frequency ) {
 	NormalizeKeyVector( this->data.keys, phase, frequency );
 }
 
+bool NiBoolData::Evaluate( float time, unsigned int * hint ) const {
+	if ( data.keys.empty() ) {
+		return false;
+	}
+	return data.keys[ FindKeyIndex( data.keys, time, hint ) ].data != 0;
+}
+
 //--END CUSTOM CODE--//
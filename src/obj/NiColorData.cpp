@@ -144,4 +144,11 @@ void NiColorData::SetKeys( vector< Key<Color4> > const & keys ) {
 	data.keys = keys;
 }
 
+Color4 NiColorData::Evaluate( float time, unsigned int * hint ) const {
+	if ( data.keys.empty() ) {
+		return Color4( 1.0f, 1.0f, 1.0f, 1.0f );
+	}
+	return InterpolateKeys( data.keys, data.interpolation, time, hint );
+}
+
 //--END CUSTOM CODE--//
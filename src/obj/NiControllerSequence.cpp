@@ -592,4 +592,63 @@ Ref<NiStringPalette > Niflib::NiControllerSequence::GetStringPalette() const {
 void Niflib::NiControllerSequence::SetStringPalette( const Ref<NiStringPalette >& value ) {
 	stringPalette = value;
 }
+
+void NiControllerSequence::BuildStringPalette() {
+	if ( stringPalette == NULL ) {
+		stringPalette = new NiStringPalette;
+	}
+
+	//Gather the five strings of each block, from its own palette if it has one
+	const unsigned int count = 5;
+	vector<string> strings( controlledBlocks.size() * count );
+	for ( unsigned int i = 0; i < controlledBlocks.size(); ++i ) {
+		ControllerLink & cl = controlledBlocks[i];
+		string * str = &strings[i * count];
+		if ( cl.stringPalette != NULL ) {
+			str[0] = cl.stringPalette->GetSubStr( cl.nodeNameOffset );
+			str[1] = cl.stringPalette->GetSubStr( cl.propertyTypeOffset );
+			str[2] = cl.stringPalette->GetSubStr( cl.controllerTypeOffset );
+			str[3] = cl.stringPalette->GetSubStr( cl.variable1Offset );
+			str[4] = cl.stringPalette->GetSubStr( cl.variable2Offset );
+		} else {
+			str[0] = cl.nodeName;
+			str[1] = cl.propertyType;
+			str[2] = cl.controllerType;
+			str[3] = cl.variable1;
+			str[4] = cl.variable2;
+		}
+	}
+
+	//Add the non-empty ones to the palette at once; empty strings get the null offset
+	vector<string> named;
+	vector<unsigned int> slots;
+	for ( unsigned int i = 0; i < strings.size(); ++i ) {
+		if ( !strings[i].empty() ) {
+			named.push_back( strings[i] );
+			slots.push_back( i );
+		}
+	}
+	vector<unsigned int> named_offsets = stringPalette->AddSubStrs( named );
+	vector<unsigned int> offsets( strings.size(), 0xFFFFFFFF );
+	for ( unsigned int i = 0; i < slots.size(); ++i ) {
+		offsets[slots[i]] = named_offsets[i];
+	}
+
+	for ( unsigned int i = 0; i < controlledBlocks.size(); ++i ) {
+		ControllerLink & cl = controlledBlocks[i];
+		const string * str = &strings[i * count];
+		const unsigned int * off = &offsets[i * count];
+		cl.stringPalette = stringPalette;
+		cl.nodeName = str[0];
+		cl.nodeNameOffset = off[0];
+		cl.propertyType = str[1];
+		cl.propertyTypeOffset = off[1];
+		cl.controllerType = str[2];
+		cl.controllerTypeOffset = off[2];
+		cl.variable1 = str[3];
+		cl.variable1Offset = off[3];
+		cl.variable2 = str[4];
+		cl.variable2Offset = off[4];
+	}
+}
 //--END CUSTOM CODE--//
@@ -189,4 +189,105 @@ std::list<NiObject *> NiDataStream::GetPtrs() const {
 
 //--BEGIN MISC CUSTOM CODE--//
 
+DataStreamUsage NiDataStream::GetUsage() const {
+	return usage;
+}
+
+void NiDataStream::SetUsage( DataStreamUsage value ) {
+	usage = value;
+}
+
+DataStreamAccess NiDataStream::GetAccess() const {
+	return access;
+}
+
+void NiDataStream::SetAccess( DataStreamAccess value ) {
+	access = value;
+}
+
+vector<ComponentFormat> NiDataStream::GetComponentFormats() const {
+	return componentFormats;
+}
+
+vector<Region> NiDataStream::GetRegions() const {
+	return regions;
+}
+
+void NiDataStream::SetRegions( const vector<Region> & value ) {
+	unsigned int count = GetElementCount();
+	for ( unsigned int i = 0; i < value.size(); ++i ) {
+		if ( value[i].startIndex + value[i].numIndices > count ) {
+			throw runtime_error( "A data stream region cannot extend past the last element." );
+		}
+	}
+	regions = value;
+}
+
+unsigned int NiDataStream::GetStride() const {
+	unsigned int stride = 0;
+	for ( unsigned int i = 0; i < componentFormats.size(); ++i ) {
+		stride += GetComponentFormatSize( componentFormats[i] );
+	}
+	return stride;
+}
+
+unsigned int NiDataStream::GetElementCount() const {
+	unsigned int stride = GetStride();
+	if ( stride == 0 ) {
+		return 0;
+	}
+	return (unsigned int)(data.size()) / stride;
+}
+
+unsigned int NiDataStream::GetComponentOffset( unsigned int component ) const {
+	if ( component >= componentFormats.size() ) {
+		throw runtime_error( "The data stream component index is out of range." );
+	}
+	unsigned int offset = 0;
+	for ( unsigned int i = 0; i < component; ++i ) {
+		offset += GetComponentFormatSize( componentFormats[i] );
+	}
+	return offset;
+}
+
+DataStreamView NiDataStream::GetComponentView( unsigned int component ) const {
+	unsigned int offset = GetComponentOffset( component );
+	unsigned int count = GetElementCount();
+	if ( count == 0 ) {
+		return DataStreamView( NULL, GetStride(), 0, componentFormats[component] );
+	}
+	return DataStreamView( &data[offset], GetStride(), count, componentFormats[component] );
+}
+
+DataStreamView NiDataStream::GetComponentView( unsigned int component, unsigned int region ) const {
+	if ( region >= regions.size() ) {
+		throw runtime_error( "The data stream region index is out of range." );
+	}
+	unsigned int offset = GetComponentOffset( component );
+	const Region & r = regions[region];
+	if ( r.startIndex + r.numIndices > GetElementCount() ) {
+		throw runtime_error( "The data stream region extends past the last element." );
+	}
+	if ( r.numIndices == 0 ) {
+		return DataStreamView( NULL, GetStride(), 0, componentFormats[component] );
+	}
+	unsigned int stride = GetStride();
+	return DataStreamView( &data[r.startIndex * stride + offset], stride, r.numIndices, componentFormats[component] );
+}
+
+void NiDataStream::SetData( const vector<ComponentFormat> & formats, const vector<byte> & bytes ) {
+	unsigned int stride = 0;
+	for ( unsigned int i = 0; i < formats.size(); ++i ) {
+		stride += GetComponentFormatSize( formats[i] );
+	}
+	if ( stride == 0 || bytes.size() % stride != 0 ) {
+		throw runtime_error( "The data stream bytes must hold a whole number of elements." );
+	}
+	componentFormats = formats;
+	data = bytes;
+	regions.resize( 1 );
+	regions[0].startIndex = 0;
+	regions[0].numIndices = GetElementCount();
+}
+
 //--END CUSTOM CODE--//
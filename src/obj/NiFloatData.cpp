@@ -148,5 +148,20 @@ void NiFloatData::NormalizeKeys( float phase, float frequency ) {
 	NormalizeKeyVector( this->data.keys, phase, frequency );
 }
 
+float NiFloatData::Evaluate( float time, unsigned int * hint ) const {
+	if ( data.keys.empty() ) {
+		return 0.0f;
+	}
+	return InterpolateKeys( data.keys, data.interpolation, time, hint );
+}
+
+static float FloatKeyDistance( const float & a, const float & b ) {
+	return fabs( a - b );
+}
+
+void NiFloatData::ReduceKeys( float tolerance ) {
+	data.keys = Niflib::ReduceKeys( data.keys, data.interpolation, tolerance, &FloatKeyDistance );
+}
+
 
 //--END CUSTOM CODE--//
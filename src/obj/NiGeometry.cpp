@@ -311,6 +311,7 @@ void NiGeometry::SetShader( const string & n ) {
 		hasShader = false;
 		shaderName.clear();
 	} else {
+		hasShader = true;
 		shaderName = n;
 	}
 }
@@ -475,8 +476,8 @@ void NiGeometry::GetSkinDeformation( vector<Vector3> & vertices, vector<Vector3>
 	}
 
 	//Get the vertices & bone nodes
-	vector<Vector3> in_verts = geom_data->GetVertices();
-	vector<Vector3> in_norms = geom_data->GetNormals();
+	const vector<Vector3> & in_verts = geom_data->GetVertices();
+	const vector<Vector3> & in_norms = geom_data->GetNormals();
 
 	vector<NiNodeRef> bone_nodes = skin_inst->GetBones();
 
@@ -490,7 +491,7 @@ void NiGeometry::GetSkinDeformation( vector<Vector3> & vertices, vector<Vector3>
 	for ( unsigned int i = 0; i < skin_data->GetBoneCount(); ++i ) {
 		Matrix44 bone_world = bone_nodes[i]->GetWorldTransform();
 		Matrix44 bone_offset = skin_data->GetBoneTransform(i);
-		vector<SkinWeight> weights = skin_data->GetBoneWeights(i);
+		const vector<SkinWeight> & weights = skin_data->GetBoneWeights(i);
 		Matrix44 vert_trans =  bone_offset * bone_world;
 		Matrix44 norm_trans = Matrix44( vert_trans.GetRotation() );
 		for ( unsigned int j = 0; j < weights.size(); ++j ) {
@@ -613,7 +614,7 @@ void NiGeometry::SetBoneWeights( unsigned int bone_index, const vector<SkinWeigh
 	}
 
 	//Get vertex array
-	vector<Vector3> vertices = geomData->GetVertices();
+	const vector<Vector3> & vertices = geomData->GetVertices();
 
    Vector3 center; float radius;
    //CalcCenteredSphere(n, vertices, center, radius);
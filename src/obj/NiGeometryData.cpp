@@ -159,7 +159,7 @@ void NiGeometryData::Write( ostream& out, const map<NiObjectRef,unsigned int> &
 	NiObject::Write( out, link_map, missing_link_stack, info );
 	bsNumUvSets = bsNumUvSetsCalc(info);
 	numUvSets = numUvSetsCalc(info);
-	numVertices = (unsigned short)(vertices.size());
+	numVertices = numVerticesCalc(info);
 	if ( info.version >= 0x0A020000 ) {
 		NifStream( unknownInt, out, info );
 	};
@@ -297,7 +297,7 @@ std::string NiGeometryData::asString( bool verbose ) const {
 	stringstream out;
 	unsigned int array_output_count = 0;
 	out << NiObject::asString();
-	numVertices = (unsigned short)(vertices.size());
+	numVertices = numVerticesCalc(NifInfo());
 	out << "  Unknown Int:  " << unknownInt << endl;
 	if ( (!IsDerivedType(NiPSysData::TYPE)) ) {
 		out << "    Num Vertices:  " << numVertices << endl;
@@ -523,23 +523,25 @@ int NiGeometryData::GetVertexIndexCount() const {
 	return int(vertexIndices.size());
 }
 
-vector<Vector3> NiGeometryData::GetVertices() const {
+const vector<Vector3> & NiGeometryData::GetVertices() const {
 	return vertices;
 }
 
-vector<Vector3> NiGeometryData::GetNormals() const {
+const vector<Vector3> & NiGeometryData::GetNormals() const {
 	return normals;
 }
 
-vector<Color4> NiGeometryData::GetColors() const {
+const vector<Color4> & NiGeometryData::GetColors() const {
 	return vertexColors;
 }
 
-vector<TexCoord> NiGeometryData::GetUVSet( int index ) const {
+const vector<TexCoord> & NiGeometryData::GetUVSet( int index ) const {
+	if ( index < 0 || index >= int(uvSets.size()) )
+		throw runtime_error("Invalid UV Set: call SetUVSetCount first.");
 	return uvSets[index];
 }
 
-vector<int> NiGeometryData::GetVertexIndices() const {
+const vector<int> & NiGeometryData::GetVertexIndices() const {
 	return vertexIndices;
 }
 
@@ -560,9 +562,12 @@ void NiGeometryData::SetUVSetCount(int n) {
 }
 
 //--Setters--//
+static void CalcBound( const vector<Vector3> & vertices, Vector3 & center, float & radius );
+
 void NiGeometryData::SetVertices( const vector<Vector3> & in ) {
 	vertices = in;
 	hasVertices = ( vertices.size() != 0 );
+	numVertices = (unsigned short)(vertices.size());
 
 	//Clear out all other data as it is now based on old vertex information
 	normals.clear();
@@ -574,6 +579,11 @@ void NiGeometryData::SetVertices( const vector<Vector3> & in ) {
 	}
 
 	//If any vertices were given, calculate the new center and radius
+	CalcBound( vertices, center, radius );
+}
+
+//Calculates the center and radius of a bounding sphere of the vertices
+static void CalcBound( const vector<Vector3> & vertices, Vector3 & center, float & radius ) {
 	//Check if there are no vertices
 	if ( vertices.size() == 0 ) {
 		center.Set(0.0f, 0.0f, 0.0f);
@@ -637,6 +647,41 @@ void NiGeometryData::SetUVSet( int index, const vector<TexCoord> & in ) {
 	uvSets[index] = in;
 }
 
+void NiGeometryData::SwapVertices( vector<Vector3> & in ) {
+	//Clear the other data the way SetVertices does, without copying the old vertices
+	vector<Vector3> old;
+	old.swap( vertices );
+	const vector<Vector3> none;
+	SetVertices( none );
+	vertices.swap( in );
+	in.swap( old );
+	hasVertices = ( vertices.size() != 0 );
+	numVertices = (unsigned short)(vertices.size());
+	CalcBound( vertices, center, radius );
+}
+
+void NiGeometryData::SwapNormals( vector<Vector3> & in ) {
+	if (in.size() != vertices.size() && in.size() != 0 )
+		throw runtime_error("Vector size must equal Vertex Count or zero.");
+	normals.swap( in );
+	hasNormals = ( normals.size() != 0 );
+}
+
+void NiGeometryData::SwapVertexColors( vector<Color4> & in ) {
+	if (in.size() != vertices.size() && in.size() != 0 )
+		throw runtime_error("Vector size must equal Vertex Count or zero.");
+	vertexColors.swap( in );
+	hasVertexColors = ( vertexColors.size() != 0 );
+}
+
+void NiGeometryData::SwapUVSet( int index, vector<TexCoord> & in ) {
+	if (in.size() != vertices.size())
+		throw runtime_error("Vector size must equal Vertex Count.");
+	if ( index < 0 || index >= int(uvSets.size()) )
+		throw runtime_error("Invalid UV Set: call SetUVSetCount first.");
+	uvSets[index].swap( in );
+}
+
 void NiGeometryData::SetVertexIndices( const vector<int> & in ) {
 	if (in.size() != vertices.size() && in.size() != 0 )
 		throw runtime_error("Vector size must equal Vertex Count or zero.");
@@ -717,6 +762,31 @@ void NiGeometryData::SetTangents( const vector<Vector3 >& value ) {
    tangents = value;
 }
 
+void NiGeometryData::SwapTangents( vector<Vector3> & value ) {
+	tangents.swap( value );
+}
+
+void NiGeometryData::SwapBitangents( vector<Vector3> & value ) {
+	bitangents.swap( value );
+}
+
+void NiGeometryData::ClearPackedChannels() {
+	numVertices = (unsigned short)(vertices.size());
+	vector<Vector3>().swap( vertices );
+	hasVertices = false;
+	vector<Vector3>().swap( normals );
+	hasNormals = false;
+	vector<Vector3>().swap( tangents );
+	vector<Vector3>().swap( bitangents );
+	vector< vector<TexCoord> >().swap( uvSets );
+	hasUv = false;
+}
+
+//Data without vertices keeps the count it was read or packed with
+unsigned short NiGeometryData::numVerticesCalc(const NifInfo & info) const {
+	return hasVertices ? (unsigned short)(vertices.size()) : numVertices;
+}
+
 unsigned short NiGeometryData::numUvSetsCalc(const NifInfo & info) const {
   return (numUvSets & (~63))  | (unsigned short)(uvSets.size() & 63);
 }
@@ -728,4 +798,12 @@ unsigned short NiGeometryData::bsNumUvSetsCalc(const NifInfo & info) const {
 SkyrimHavokMaterial NiGeometryData::GetSkyrimMaterial() const {
 	return skyrimMaterial;
 }
+
+Ref<AbstractAdditionalGeometryData> NiGeometryData::GetAdditionalData() const {
+	return additionalData;
+}
+
+void NiGeometryData::SetAdditionalData( AbstractAdditionalGeometryData * value ) {
+	additionalData = value;
+}
 //--END CUSTOM CODE--//
@@ -377,4 +377,140 @@ void NiKeyframeData::SetScaleKeys( vector< Key<float> > const & keys ) {
 	scales.keys = keys;
 }
 
+/*!
+ * Calculates the inner control point of a quaternion key for squad interpolation,
+ * on the incoming or outgoing side.  Tension, bias, and continuity are applied to
+ * the tangents in logarithm space, which gives plain squad when they are zero.
+ */
+static Quaternion SquadControlPoint( const vector< Key<Quaternion> > & keys, unsigned int i, bool tbc, bool outgoing ) {
+	const unsigned int last = (unsigned int)(keys.size()) - 1;
+	const Quaternion & q = keys[i].data;
+	const Quaternion inv = q.Inverse();
+
+	//Neighbours on the same hemisphere as the key
+	Quaternion g_prev, g_next;
+	if ( i < last ) {
+		Quaternion next = keys[i + 1].data;
+		if ( q.Dot(next) < 0.0f ) {
+			next = next * -1.0f;
+		}
+		g_next = ( inv * next ).Log();
+	}
+	if ( i > 0 ) {
+		Quaternion prev = keys[i - 1].data;
+		if ( q.Dot(prev) < 0.0f ) {
+			prev = prev * -1.0f;
+		}
+		g_prev = ( inv * prev ).Log();
+	}
+	if ( i == 0 ) {
+		g_prev = g_next * -1.0f;
+	}
+	if ( i == last ) {
+		g_next = g_prev * -1.0f;
+	}
+
+	float t = 0.0f, c = 0.0f, b = 0.0f;
+	if ( tbc ) {
+		t = keys[i].tension;
+		c = keys[i].continuity;
+		b = keys[i].bias;
+	}
+	Quaternion tangent;
+	if ( outgoing ) {
+		tangent = g_prev * ( -0.5f * ( 1.0f - t ) * ( 1.0f + c ) * ( 1.0f + b ) ) + g_next * ( 0.5f * ( 1.0f - t ) * ( 1.0f - c ) * ( 1.0f - b ) );
+		return q * ( ( tangent + g_next * -1.0f ) * 0.5f ).Exp();
+	} else {
+		tangent = g_prev * ( -0.5f * ( 1.0f - t ) * ( 1.0f - c ) * ( 1.0f + b ) ) + g_next * ( 0.5f * ( 1.0f - t ) * ( 1.0f + c ) * ( 1.0f - b ) );
+		return q * ( ( tangent + g_prev ) * -0.5f ).Exp();
+	}
+}
+
+/*!
+ * Evaluates quaternion keys with slerp, or squad for quadratic and TBC keys.  Has
+ * the same signature as InterpolateKeys so it can be used by ReduceKeys.
+ */
+static Quaternion InterpolateQuatKeys( const vector< Key<Quaternion> > & keys, KeyType type, float time, unsigned int * hint ) {
+	const unsigned int i = FindKeyIndex( keys, time, hint );
+	const Key<Quaternion> & k0 = keys[i];
+	if ( time <= k0.time || i + 1 == keys.size() || type == CONST_KEY ) {
+		return k0.data;
+	}
+	const Key<Quaternion> & k1 = keys[i + 1];
+	const float u = ( time - k0.time ) / ( k1.time - k0.time );
+
+	if ( type == QUADRATIC_KEY || type == TBC_KEY ) {
+		bool tbc = ( type == TBC_KEY );
+		Quaternion a = SquadControlPoint( keys, i, tbc, true );
+		Quaternion b = SquadControlPoint( keys, i + 1, tbc, false );
+		return Quaternion::Slerp( 2.0f * u * ( 1.0f - u ), Quaternion::Slerp( u, k0.data, k1.data ), Quaternion::Slerp( u, a, b ) );
+	}
+	return Quaternion::Slerp( u, k0.data, k1.data );
+}
+
+Quaternion NiKeyframeData::EvaluateRotation( float time, unsigned int * hints ) const {
+	if ( rotationType == XYZ_ROTATION_KEY ) {
+		//Combine the three axis rotations in X, Y, Z order
+		Quaternion q( 1.0f, 0.0f, 0.0f, 0.0f );
+		for ( int axis = 0; axis < 3; ++axis ) {
+			const KeyGroup<float> & group = xyzRotations[axis];
+			if ( group.keys.empty() ) {
+				continue;
+			}
+			float half = 0.5f * InterpolateKeys( group.keys, group.interpolation, time, hints ? &hints[axis] : NULL );
+			Quaternion r( cos(half), 0.0f, 0.0f, 0.0f );
+			( axis == 0 ? r.x : axis == 1 ? r.y : r.z ) = sin(half);
+			q = q * r;
+		}
+		return q;
+	}
+
+	if ( quaternionKeys.empty() ) {
+		return Quaternion( 1.0f, 0.0f, 0.0f, 0.0f );
+	}
+	return InterpolateQuatKeys( quaternionKeys, rotationType, time, hints );
+}
+
+Vector3 NiKeyframeData::EvaluateTranslation( float time, unsigned int * hint ) const {
+	if ( translations.keys.empty() ) {
+		return Vector3( 0.0f, 0.0f, 0.0f );
+	}
+	return InterpolateKeys( translations.keys, translations.interpolation, time, hint );
+}
+
+float NiKeyframeData::EvaluateScale( float time, unsigned int * hint ) const {
+	if ( scales.keys.empty() ) {
+		return 1.0f;
+	}
+	return InterpolateKeys( scales.keys, scales.interpolation, time, hint );
+}
+
+//Distances between key values for ReduceKeys
+static float FloatKeyDistance( const float & a, const float & b ) {
+	return fabs( a - b );
+}
+
+static float Vector3KeyDistance( const Vector3 & a, const Vector3 & b ) {
+	return ( a - b ).Magnitude();
+}
+
+static float QuatKeyDistance( const Quaternion & a, const Quaternion & b ) {
+	float d = fabs( a.Normalized().Dot( b.Normalized() ) );
+	return 2.0f * acos( d < 1.0f ? d : 1.0f );
+}
+
+void NiKeyframeData::ReduceKeys( float translate_tolerance, float rotate_tolerance, float scale_tolerance ) {
+	translations.keys = Niflib::ReduceKeys( translations.keys, translations.interpolation, translate_tolerance, &Vector3KeyDistance );
+	scales.keys = Niflib::ReduceKeys( scales.keys, scales.interpolation, scale_tolerance, &FloatKeyDistance );
+	if ( rotationType == XYZ_ROTATION_KEY ) {
+		for ( int axis = 0; axis < 3; ++axis ) {
+			KeyGroup<float> & group = xyzRotations[axis];
+			group.keys = Niflib::ReduceKeys( group.keys, group.interpolation, rotate_tolerance / 3.0f, &FloatKeyDistance );
+		}
+	} else {
+		quaternionKeys = Niflib::ReduceKeys( quaternionKeys, rotationType, rotate_tolerance, &QuatKeyDistance, &InterpolateQuatKeys );
+		UpdateRotationKeyCount();
+	}
+}
+
 //--END CUSTOM CODE--//
@@ -463,4 +463,85 @@ std::list<NiObject *> NiMesh::GetPtrs() const {
 
 //--BEGIN MISC CUSTOM CODE--//
 
+MeshPrimitiveType NiMesh::GetPrimitiveType() const {
+	return primitiveType;
+}
+
+void NiMesh::SetPrimitiveType( MeshPrimitiveType value ) {
+	primitiveType = value;
+}
+
+unsigned short NiMesh::GetSubmeshCount() const {
+	return numSubmeshes;
+}
+
+void NiMesh::SetSubmeshCount( unsigned short value ) {
+	numSubmeshes = value;
+}
+
+vector<MeshData> NiMesh::GetMeshData() const {
+	return datas;
+}
+
+void NiMesh::SetMeshData( const vector<MeshData> & value ) {
+	datas = value;
+}
+
+SphereBV NiMesh::GetBound() const {
+	return bound;
+}
+
+void NiMesh::SetBound( const SphereBV & value ) {
+	bound = value;
+}
+
+vector< Ref<NiMeshModifier> > NiMesh::GetModifiers() const {
+	return modifiers;
+}
+
+void NiMesh::AddModifier( NiMeshModifier * value ) {
+	modifiers.push_back( value );
+}
+
+//Finds the mesh data entry and the component that hold a semantic
+static const MeshData * FindSemantic( const vector<MeshData> & datas, const string & semantic, unsigned int index, unsigned int & component ) {
+	for ( unsigned int d = 0; d < datas.size(); ++d ) {
+		const vector<SemanticData> & sems = datas[d].componentSemantics;
+		for ( unsigned int c = 0; c < sems.size(); ++c ) {
+			if ( sems[c].index == index && string(sems[c].name) == semantic ) {
+				component = c;
+				return &datas[d];
+			}
+		}
+	}
+	return NULL;
+}
+
+bool NiMesh::HasSemantic( const string & semantic, unsigned int index ) const {
+	unsigned int component;
+	const MeshData * md = FindSemantic( datas, semantic, index, component );
+	return md != NULL && md->stream != NULL;
+}
+
+DataStreamView NiMesh::GetSemanticView( const string & semantic, unsigned int index ) const {
+	unsigned int component;
+	const MeshData * md = FindSemantic( datas, semantic, index, component );
+	if ( md == NULL || md->stream == NULL ) {
+		throw runtime_error( "The mesh has no data stream with the semantic " + semantic + "." );
+	}
+	return md->stream->GetComponentView( component );
+}
+
+DataStreamView NiMesh::GetSemanticView( const string & semantic, unsigned int index, unsigned int submesh ) const {
+	unsigned int component;
+	const MeshData * md = FindSemantic( datas, semantic, index, component );
+	if ( md == NULL || md->stream == NULL ) {
+		throw runtime_error( "The mesh has no data stream with the semantic " + semantic + "." );
+	}
+	if ( submesh >= md->submeshToRegionMap.size() ) {
+		throw runtime_error( "The submesh index is out of range for the data stream." );
+	}
+	return md->stream->GetComponentView( component, md->submeshToRegionMap[submesh] );
+}
+
 //--END CUSTOM CODE--//
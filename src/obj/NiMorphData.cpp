@@ -258,4 +258,74 @@ void NiMorphData::SetFrameName( int n, string const & key ) {
 	morphs[n].frameName = key;
 }
 
+float NiMorphData::EvaluateMorphWeight( int n, float time, unsigned int * hint ) const {
+	const Morph & m = morphs[n];
+	if ( m.keys.empty() ) {
+		return 0.0f;
+	}
+	return InterpolateKeys( m.keys, m.interpolation, time, hint );
+}
+
+bool NiMorphData::GetRelativeTargets() const {
+	return relativeTargets != 0;
+}
+
+void NiMorphData::SetRelativeTargets( bool value ) {
+	relativeTargets = value ? 1 : 0;
+}
+
+vector<Vector3> NiMorphData::GetMorphDeltas( int n ) const {
+	if ( n == 0 ) {
+		return vector<Vector3>( morphs[0].vectors.size(), Vector3( 0.0f, 0.0f, 0.0f ) );
+	}
+	vector<Vector3> deltas = morphs[n].vectors;
+	if ( relativeTargets == 0 ) {
+		const vector<Vector3> & base = morphs[0].vectors;
+		for ( unsigned int i = 0; i < deltas.size() && i < base.size(); ++i ) {
+			deltas[i] -= base[i];
+		}
+	}
+	return deltas;
+}
+
+vector<unsigned int> NiMorphData::GetMorphedVertices( float tolerance ) const {
+	float tol2 = tolerance * tolerance;
+	vector<bool> moved( numVertices, false );
+	for ( unsigned int n = 1; n < morphs.size(); ++n ) {
+		vector<Vector3> deltas = GetMorphDeltas( n );
+		for ( unsigned int i = 0; i < deltas.size() && i < moved.size(); ++i ) {
+			if ( deltas[i].DotProduct( deltas[i] ) > tol2 ) {
+				moved[i] = true;
+			}
+		}
+	}
+	vector<unsigned int> out;
+	for ( unsigned int i = 0; i < moved.size(); ++i ) {
+		if ( moved[i] ) {
+			out.push_back( i );
+		}
+	}
+	return out;
+}
+
+unsigned int NiMorphData::ClearSmallDeltas( float tolerance ) {
+	float tol2 = tolerance * tolerance;
+	unsigned int cleared = 0;
+	for ( unsigned int n = 1; n < morphs.size(); ++n ) {
+		vector<Vector3> & verts = morphs[n].vectors;
+		for ( unsigned int i = 0; i < verts.size(); ++i ) {
+			Vector3 delta = verts[i];
+			if ( relativeTargets == 0 && i < morphs[0].vectors.size() ) {
+				delta -= morphs[0].vectors[i];
+			}
+			bool zero = delta.x == 0.0f && delta.y == 0.0f && delta.z == 0.0f;
+			if ( !zero && delta.DotProduct( delta ) <= tol2 ) {
+				verts[i] = ( relativeTargets == 0 && i < morphs[0].vectors.size() ) ? morphs[0].vectors[i] : Vector3( 0.0f, 0.0f, 0.0f );
+				++cleared;
+			}
+		}
+	}
+	return cleared;
+}
+
 //--END CUSTOM CODE--//
@@ -11,6 +11,7 @@ All rights reserved.  Please see niflib.h for license. */
 #include "../../include/obj/NiSkinInstance.h"
 #include "../../include/obj/NiTriBasedGeom.h"
 #include "../../include/obj/NiSkinData.h"
+#include <algorithm>
 //--END CUSTOM CODE--//
 
 #include "../../include/FixLink.h"
@@ -262,6 +263,19 @@ void NiNode::RemoveChild( Ref<NiAVObject> obj ) {
 	}
 }
 
+void NiNode::ReplaceChild( Ref<NiAVObject> old_child, Ref<NiAVObject> new_child ) {
+	if ( new_child->GetParent() != NULL ) {
+		throw runtime_error( "You have attempted to add a child to a NiNode which already is the child of another NiNode." );
+	}
+	vector< NiAVObjectRef >::iterator it = find( children.begin(), children.end(), old_child );
+	if ( it == children.end() ) {
+		throw runtime_error( "The object to replace is not a child of this NiNode." );
+	}
+	old_child->SetParent( NULL );
+	new_child->SetParent( this );
+	*it = new_child;
+}
+
 void NiNode::ClearChildren() {
 	for ( vector< NiAVObjectRef >::iterator it = children.begin(); it != children.end(); ++it) {
 		if ( *it != NULL ) {
@@ -271,7 +285,7 @@ void NiNode::ClearChildren() {
 	children.clear();
 }
 
-vector< Ref<NiAVObject> > NiNode::GetChildren() const {
+const vector< Ref<NiAVObject> > & NiNode::GetChildren() const {
 	return children;
 }
 
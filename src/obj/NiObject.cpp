@@ -96,7 +96,19 @@ std::list<NiObject *> NiObject::GetPtrs() const {
 
 //--BEGIN MISC CUSTOM CODE--//
 
+namespace Niflib {
+	//Object Registration, in niflib.cpp
+	extern bool g_objects_registered;
+	void RegisterObjects();
+}
+
 NiObjectRef NiObject::Clone( unsigned int version, unsigned int user_version ) {
+	//Ensure that objects are registered, since nothing may have been read from a file yet
+	if ( g_objects_registered == false ) {
+		g_objects_registered = true;
+		RegisterObjects();
+	}
+
 	//Create a string stream to temporarily hold the state-save of this object
 	stringstream tmp;
 
@@ -120,4 +120,14 @@ std::list<NiObject *> NiPSysAgeDeathModifier::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+void NiPSysAgeDeathModifier::UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const {
+	//Walk backwards so that the particle swapped into a removed slot has already been checked
+	for ( unsigned int i = particles.Size(); i > 0; --i ) {
+		if ( particles.age[i - 1] >= particles.lifeSpan[i - 1] ) {
+			particles.Remove( i - 1 );
+		}
+	}
+}
+
 //--END CUSTOM CODE--//
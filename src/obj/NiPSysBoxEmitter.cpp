@@ -101,4 +101,36 @@ std::list<NiObject *> NiPSysBoxEmitter::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+float NiPSysBoxEmitter::GetWidth() const {
+	return width;
+}
+
+void NiPSysBoxEmitter::SetWidth( float value ) {
+	width = value;
+}
+
+float NiPSysBoxEmitter::GetHeight() const {
+	return height;
+}
+
+void NiPSysBoxEmitter::SetHeight( float value ) {
+	height = value;
+}
+
+float NiPSysBoxEmitter::GetDepth() const {
+	return depth;
+}
+
+void NiPSysBoxEmitter::SetDepth( float value ) {
+	depth = value;
+}
+
+Vector3 NiPSysBoxEmitter::emitPosition( ParticleRandom & random ) const {
+	float x = 0.5f * width * random.Symmetric();
+	float y = 0.5f * height * random.Symmetric();
+	float z = 0.5f * depth * random.Symmetric();
+	return emitterOrigin() + Vector3( x, y, z );
+}
+
 //--END CUSTOM CODE--//
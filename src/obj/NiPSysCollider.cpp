@@ -197,4 +197,44 @@ std::list<NiObject *> NiPSysCollider::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+float NiPSysCollider::GetBounce() const {
+	return bounce;
+}
+
+void NiPSysCollider::SetBounce( float value ) {
+	bounce = value;
+}
+
+bool NiPSysCollider::GetDieOnCollide() const {
+	return dieOnCollide;
+}
+
+void NiPSysCollider::SetDieOnCollide( bool value ) {
+	dieOnCollide = value;
+}
+
+Ref<NiPSysCollider> NiPSysCollider::GetNextCollider() const {
+	return DynamicCast<NiPSysCollider>( nextCollider );
+}
+
+bool NiPSysCollider::CollideParticle( ParticleState & particles, unsigned int i, const Vector3 & previous ) const {
+	return false;
+}
+
+Vector3 NiPSysCollider::colliderOrigin() const {
+	if ( colliderObject == NULL ) {
+		return Vector3();
+	}
+	return colliderObject->GetLocalTranslation();
+}
+
+void NiPSysCollider::bounceParticle( ParticleState & particles, unsigned int i, const Vector3 & normal ) const {
+	float vn = particles.vx[i] * normal.x + particles.vy[i] * normal.y + particles.vz[i] * normal.z;
+	float k = ( 1.0f + bounce ) * vn;
+	particles.vx[i] -= normal.x * k;
+	particles.vy[i] -= normal.y * k;
+	particles.vz[i] -= normal.z * k;
+}
+
 //--END CUSTOM CODE--//
@@ -117,4 +117,22 @@ std::list<NiObject *> NiPSysColliderManager::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+void NiPSysColliderManager::UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const {
+	if ( collider == NULL ) {
+		return;
+	}
+	for ( unsigned int i = particles.Size(); i > 0; --i ) {
+		unsigned int p = i - 1;
+		//Where the particle was at the start of the step
+		Vector3 previous( particles.px[p] - particles.vx[p] * delta, particles.py[p] - particles.vy[p] * delta, particles.pz[p] - particles.vz[p] * delta );
+		for ( NiPSysColliderRef c = collider; c != NULL; c = c->GetNextCollider() ) {
+			if ( c->CollideParticle( particles, p, previous ) ) {
+				particles.Remove( p );
+				break;
+			}
+		}
+	}
+}
+
 //--END CUSTOM CODE--//
@@ -117,4 +117,24 @@ std::list<NiObject *> NiPSysColorModifier::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+void NiPSysColorModifier::UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const {
+	if ( data == NULL || data->GetKeys().empty() ) {
+		return;
+	}
+	unsigned int n = particles.Size();
+	unsigned int hint = 0;
+	for ( unsigned int i = 0; i < n; ++i ) {
+		float t = 0.0f;
+		if ( particles.lifeSpan[i] > 0.0f ) {
+			t = particles.age[i] / particles.lifeSpan[i];
+		}
+		Color4 c = data->Evaluate( t, &hint );
+		particles.r[i] = c.r;
+		particles.g[i] = c.g;
+		particles.b[i] = c.b;
+		particles.a[i] = c.a;
+	}
+}
+
 //--END CUSTOM CODE--//
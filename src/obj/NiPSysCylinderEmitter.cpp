@@ -98,4 +98,13 @@ std::list<NiObject *> NiPSysCylinderEmitter::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+Vector3 NiPSysCylinderEmitter::emitPosition( ParticleRandom & random ) const {
+	//The square root spreads the points evenly over the disc
+	float a = 2.0f * PI * random.Uniform();
+	float r = radius * sqrt( random.Uniform() );
+	float z = 0.5f * height * random.Symmetric();
+	return emitterOrigin() + Vector3( r * cos( a ), r * sin( a ), z );
+}
+
 //--END CUSTOM CODE--//
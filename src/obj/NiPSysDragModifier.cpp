@@ -129,4 +129,22 @@ std::list<NiObject *> NiPSysDragModifier::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+void NiPSysDragModifier::UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const {
+	float k = percentage * delta;
+	if ( k <= 0.0f ) {
+		return;
+	}
+	if ( k > 1.0f ) {
+		k = 1.0f;
+	}
+	float keep = 1.0f - k;
+	unsigned int n = particles.Size();
+	for ( unsigned int i = 0; i < n; ++i ) {
+		particles.vx[i] *= keep;
+		particles.vy[i] *= keep;
+		particles.vz[i] *= keep;
+	}
+}
+
 //--END CUSTOM CODE--//
@@ -129,4 +129,73 @@ std::list<NiObject *> NiPSysEmitter::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+float NiPSysEmitter::GetSpeed() const {
+	return speed;
+}
+
+void NiPSysEmitter::SetSpeed( float value ) {
+	speed = value;
+}
+
+float NiPSysEmitter::GetLifeSpan() const {
+	return lifeSpan;
+}
+
+void NiPSysEmitter::SetLifeSpan( float value ) {
+	lifeSpan = value;
+}
+
+float NiPSysEmitter::GetInitialRadius() const {
+	return initialRadius;
+}
+
+void NiPSysEmitter::SetInitialRadius( float value ) {
+	initialRadius = value;
+}
+
+float NiPSysEmitter::GetDeclination() const {
+	return declination;
+}
+
+void NiPSysEmitter::SetDeclination( float value ) {
+	declination = value;
+}
+
+float NiPSysEmitter::GetPlanarAngle() const {
+	return planarAngle;
+}
+
+void NiPSysEmitter::SetPlanarAngle( float value ) {
+	planarAngle = value;
+}
+
+void NiPSysEmitter::EmitParticles( ParticleState & particles, unsigned int count, ParticleRandom & random ) const {
+	unsigned int first = particles.Add( count );
+	unsigned int n = particles.Size();
+	for ( unsigned int i = first; i < n; ++i ) {
+		Vector3 p = emitPosition( random );
+		float dec = declination + declinationVariation * random.Symmetric();
+		float pa = planarAngle + planarAngleVariation * random.Symmetric();
+		float s = speed + speedVariation * random.Symmetric();
+		float sd = sin( dec );
+		particles.px[i] = p.x;
+		particles.py[i] = p.y;
+		particles.pz[i] = p.z;
+		particles.vx[i] = s * sd * cos( pa );
+		particles.vy[i] = s * sd * sin( pa );
+		particles.vz[i] = s * cos( dec );
+		particles.radius[i] = initialRadius + radiusVariation * random.Symmetric();
+		particles.lifeSpan[i] = lifeSpan + lifeSpanVariation * random.Symmetric();
+		particles.r[i] = initialColor.r;
+		particles.g[i] = initialColor.g;
+		particles.b[i] = initialColor.b;
+		particles.a[i] = initialColor.a;
+	}
+}
+
+Vector3 NiPSysEmitter::emitPosition( ParticleRandom & random ) const {
+	return Vector3();
+}
+
 //--END CUSTOM CODE--//
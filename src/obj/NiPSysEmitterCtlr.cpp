@@ -8,6 +8,10 @@ All rights reserved.  Please see niflib.h for license. */
 //-----------------------------------NOTICE----------------------------------//
 
 //--BEGIN FILE HEAD CUSTOM CODE--//
+#include "../../include/obj/NiFloatInterpolator.h"
+#include "../../include/obj/NiFloatData.h"
+#include "../../include/obj/NiBoolInterpolator.h"
+#include "../../include/obj/NiBoolData.h"
 //--END CUSTOM CODE--//
 
 #include "../../include/FixLink.h"
@@ -170,4 +174,31 @@ void NiPSysEmitterCtlr::SetVisibilityInterpolator( NiInterpolator * value ) {
 	visibilityInterpolator = value;
 }
 
+float NiPSysEmitterCtlr::EvaluateBirthRate( float time ) const {
+	NiFloatInterpolatorRef interp = DynamicCast<NiFloatInterpolator>( GetInterpolator() );
+	if ( interp == NULL ) {
+		return 0.0f;
+	}
+	NiFloatDataRef fdata = interp->GetData();
+	if ( fdata != NULL && !fdata->GetKeys().empty() ) {
+		return fdata->Evaluate( time );
+	}
+	return interp->GetFloatValue();
+}
+
+bool NiPSysEmitterCtlr::IsEmitterActive( float time ) const {
+	NiBoolInterpolatorRef interp = DynamicCast<NiBoolInterpolator>( visibilityInterpolator );
+	if ( interp == NULL ) {
+		return true;
+	}
+	NiBoolDataRef bdata = interp->GetData();
+	if ( bdata != NULL ) {
+		vector< Key<unsigned char> > keys = bdata->GetKeys();
+		if ( !keys.empty() ) {
+			return keys[FindKeyIndex( keys, time )].data != 0;
+		}
+	}
+	return interp->GetBoolValue();
+}
+
 //--END CUSTOM CODE--//
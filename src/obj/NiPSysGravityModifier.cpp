@@ -142,4 +142,72 @@ std::list<NiObject *> NiPSysGravityModifier::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+Vector3 NiPSysGravityModifier::GetGravityAxis() const {
+	return gravityAxis;
+}
+
+void NiPSysGravityModifier::SetGravityAxis( const Vector3 & value ) {
+	gravityAxis = value;
+}
+
+float NiPSysGravityModifier::GetStrength() const {
+	return strength;
+}
+
+void NiPSysGravityModifier::SetStrength( float value ) {
+	strength = value;
+}
+
+ForceType NiPSysGravityModifier::GetForceType() const {
+	return forceType;
+}
+
+void NiPSysGravityModifier::SetForceType( ForceType value ) {
+	forceType = value;
+}
+
+void NiPSysGravityModifier::UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const {
+	unsigned int n = particles.Size();
+	float step = strength * delta;
+	if ( forceType == FORCE_SPHERICAL ) {
+		//Pull toward the gravity object, weaker with distance
+		Vector3 center;
+		if ( gravityObject != NULL ) {
+			center = gravityObject->GetLocalTranslation();
+		}
+		for ( unsigned int i = 0; i < n; ++i ) {
+			float dx = center.x - particles.px[i];
+			float dy = center.y - particles.py[i];
+			float dz = center.z - particles.pz[i];
+			float dist = sqrt( dx * dx + dy * dy + dz * dz );
+			if ( dist > 0.0f ) {
+				float f = step * exp( -decay * dist ) / dist;
+				particles.vx[i] += dx * f;
+				particles.vy[i] += dy * f;
+				particles.vz[i] += dz * f;
+			}
+		}
+	} else {
+		float len = gravityAxis.Magnitude();
+		if ( len > 0.0f ) {
+			Vector3 dv = gravityAxis * ( step / len );
+			for ( unsigned int i = 0; i < n; ++i ) {
+				particles.vx[i] += dv.x;
+				particles.vy[i] += dv.y;
+				particles.vz[i] += dv.z;
+			}
+		}
+	}
+
+	if ( turbulence != 0.0f ) {
+		float t = turbulence * delta;
+		for ( unsigned int i = 0; i < n; ++i ) {
+			particles.vx[i] += t * random.Symmetric();
+			particles.vy[i] += t * random.Symmetric();
+			particles.vz[i] += t * random.Symmetric();
+		}
+	}
+}
+
 //--END CUSTOM CODE--//
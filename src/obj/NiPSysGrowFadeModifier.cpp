@@ -111,4 +111,24 @@ std::list<NiObject *> NiPSysGrowFadeModifier::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+void NiPSysGrowFadeModifier::UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const {
+	unsigned int n = particles.Size();
+	for ( unsigned int i = 0; i < n; ++i ) {
+		float s = 1.0f;
+		float age = particles.age[i];
+		if ( growTime > 0.0f && age < growTime && particles.generation[i] == growGeneration ) {
+			s = age / growTime;
+		}
+		float left = particles.lifeSpan[i] - age;
+		if ( fadeTime > 0.0f && left < fadeTime && particles.generation[i] == fadeGeneration ) {
+			float f = left / fadeTime;
+			if ( f < s ) {
+				s = f;
+			}
+		}
+		particles.size[i] = s < 0.0f ? 0.0f : s;
+	}
+}
+
 //--END CUSTOM CODE--//
@@ -126,4 +126,33 @@ std::list<NiObject *> NiPSysModifier::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+string NiPSysModifier::GetName() const {
+	return name;
+}
+
+void NiPSysModifier::SetName( const string & value ) {
+	name = value;
+}
+
+unsigned int NiPSysModifier::GetOrder() const {
+	return order;
+}
+
+void NiPSysModifier::SetOrder( unsigned int value ) {
+	order = value;
+}
+
+bool NiPSysModifier::GetActive() const {
+	return active;
+}
+
+void NiPSysModifier::SetActive( bool value ) {
+	active = value;
+}
+
+void NiPSysModifier::InitializeParticles( ParticleState & particles, unsigned int first, ParticleRandom & random ) const {}
+
+void NiPSysModifier::UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const {}
+
 //--END CUSTOM CODE--//
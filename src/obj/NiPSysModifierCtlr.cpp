@@ -95,4 +95,13 @@ std::list<NiObject *> NiPSysModifierCtlr::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+string NiPSysModifierCtlr::GetModifierName() const {
+	return modifierName;
+}
+
+void NiPSysModifierCtlr::SetModifierName( const string & value ) {
+	modifierName = value;
+}
+
 //--END CUSTOM CODE--//
@@ -104,4 +104,37 @@ std::list<NiObject *> NiPSysPlanarCollider::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+bool NiPSysPlanarCollider::CollideParticle( ParticleState & particles, unsigned int i, const Vector3 & previous ) const {
+	Vector3 normal = xAxis ^ yAxis;
+	if ( normal.Magnitude() == 0.0f ) {
+		return false;
+	}
+	normal = normal.Normalized();
+	Vector3 origin = colliderOrigin();
+	Vector3 p( particles.px[i], particles.py[i], particles.pz[i] );
+	float d0 = ( previous - origin ) * normal;
+	float d1 = ( p - origin ) * normal;
+	if ( ( d0 < 0.0f ) == ( d1 < 0.0f ) ) {
+		return false;
+	}
+
+	//Only the rectangle around the collider object collides
+	Vector3 hit = previous + ( p - previous ) * ( d0 / ( d0 - d1 ) ) - origin;
+	if ( fabs( hit * xAxis.Normalized() ) > width * 0.5f || fabs( hit * yAxis.Normalized() ) > height * 0.5f ) {
+		return false;
+	}
+	if ( dieOnCollide ) {
+		return true;
+	}
+
+	//Mirror the part of the step that went through the plane
+	float back = ( 1.0f + bounce ) * d1;
+	particles.px[i] -= normal.x * back;
+	particles.py[i] -= normal.y * back;
+	particles.pz[i] -= normal.z * back;
+	bounceParticle( particles, i, normal );
+	return false;
+}
+
 //--END CUSTOM CODE--//
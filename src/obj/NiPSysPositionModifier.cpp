@@ -92,4 +92,14 @@ std::list<NiObject *> NiPSysPositionModifier::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+void NiPSysPositionModifier::UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const {
+	unsigned int n = particles.Size();
+	for ( unsigned int i = 0; i < n; ++i ) {
+		particles.px[i] += particles.vx[i] * delta;
+		particles.py[i] += particles.vy[i] * delta;
+		particles.pz[i] += particles.vz[i] * delta;
+	}
+}
+
 //--END CUSTOM CODE--//
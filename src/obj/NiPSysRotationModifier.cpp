@@ -117,4 +117,24 @@ std::list<NiObject *> NiPSysRotationModifier::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+void NiPSysRotationModifier::InitializeParticles( ParticleState & particles, unsigned int first, ParticleRandom & random ) const {
+	unsigned int n = particles.Size();
+	for ( unsigned int i = first; i < n; ++i ) {
+		float s = initialRotationSpeed + initialRotationSpeedVariation * random.Symmetric();
+		if ( randomRotSpeedSign && random.Uniform() < 0.5f ) {
+			s = -s;
+		}
+		particles.rotSpeed[i] = s;
+		particles.rotAngle[i] = initialRotationAngle + initialRotationAngleVariation * random.Symmetric();
+	}
+}
+
+void NiPSysRotationModifier::UpdateParticles( ParticleState & particles, float delta, ParticleRandom & random ) const {
+	unsigned int n = particles.Size();
+	for ( unsigned int i = 0; i < n; ++i ) {
+		particles.rotAngle[i] += particles.rotSpeed[i] * delta;
+	}
+}
+
 //--END CUSTOM CODE--//
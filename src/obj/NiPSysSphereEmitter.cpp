@@ -95,4 +95,14 @@ std::list<NiObject *> NiPSysSphereEmitter::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+Vector3 NiPSysSphereEmitter::emitPosition( ParticleRandom & random ) const {
+	//Draw from the enclosing cube until the point falls in the sphere
+	Vector3 p;
+	do {
+		p.Set( random.Symmetric(), random.Symmetric(), random.Symmetric() );
+	} while ( p * p > 1.0f );
+	return emitterOrigin() + p * radius;
+}
+
 //--END CUSTOM CODE--//
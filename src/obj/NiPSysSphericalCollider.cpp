@@ -95,4 +95,32 @@ std::list<NiObject *> NiPSysSphericalCollider::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+bool NiPSysSphericalCollider::CollideParticle( ParticleState & particles, unsigned int i, const Vector3 & previous ) const {
+	Vector3 center = colliderOrigin();
+	Vector3 offset = Vector3( particles.px[i], particles.py[i], particles.pz[i] ) - center;
+	float dist = offset.Magnitude();
+	if ( dist >= radius || ( previous - center ).Magnitude() < radius ) {
+		return false;
+	}
+	if ( dieOnCollide ) {
+		return true;
+	}
+	if ( dist == 0.0f ) {
+		offset = previous - center;
+		dist = offset.Magnitude();
+	}
+	Vector3 normal = offset / dist;
+
+	//Put the particle back on the surface
+	Vector3 p = center + normal * radius;
+	particles.px[i] = p.x;
+	particles.py[i] = p.y;
+	particles.pz[i] = p.z;
+	if ( particles.vx[i] * normal.x + particles.vy[i] * normal.y + particles.vz[i] * normal.z < 0.0f ) {
+		bounceParticle( particles, i, normal );
+	}
+	return false;
+}
+
 //--END CUSTOM CODE--//
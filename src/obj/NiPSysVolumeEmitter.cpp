@@ -123,4 +123,12 @@ std::list<NiObject *> NiPSysVolumeEmitter::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+Vector3 NiPSysVolumeEmitter::emitterOrigin() const {
+	if ( emitterObject == NULL ) {
+		return Vector3();
+	}
+	return emitterObject->GetLocalTranslation();
+}
+
 //--END CUSTOM CODE--//
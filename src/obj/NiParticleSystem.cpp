@@ -8,6 +8,9 @@ All rights reserved.  Please see niflib.h for license. */
 //-----------------------------------NOTICE----------------------------------//
 
 //--BEGIN FILE HEAD CUSTOM CODE--//
+#include "../../include/obj/NiPSysEmitter.h"
+#include "../../include/obj/NiPSysEmitterCtlr.h"
+#include <algorithm>
 //--END CUSTOM CODE--//
 
 #include "../../include/FixLink.h"
@@ -167,4 +170,101 @@ std::list<NiObject *> NiParticleSystem::GetPtrs() const {
 }
 
 //--BEGIN MISC CUSTOM CODE--//
+
+vector< Ref<NiPSysModifier> > NiParticleSystem::GetModifiers() const {
+	return modifiers;
+}
+
+void NiParticleSystem::SetModifiers( const vector< Ref<NiPSysModifier> > & value ) {
+	modifiers = value;
+}
+
+void NiParticleSystem::AddModifier( NiPSysModifier * value ) {
+	modifiers.push_back( value );
+}
+
+static bool ModifierOrderLess( const NiPSysModifier * a, const NiPSysModifier * b ) {
+	return a->GetOrder() < b->GetOrder();
+}
+
+ParticleBounds NiParticleSystem::Simulate( float start, float stop, float step, unsigned int seed, ParticleState & particles ) const {
+	if ( step <= 0.0f ) {
+		throw runtime_error( "The particle simulation step must be larger than zero." );
+	}
+	ParticleRandom random( seed );
+	ParticleBounds bounds;
+	particles.Clear();
+
+	//Equal order numbers keep their file order
+	vector<NiPSysModifier *> chain;
+	for ( unsigned int i = 0; i < modifiers.size(); ++i ) {
+		if ( modifiers[i] != NULL && modifiers[i]->GetActive() ) {
+			chain.push_back( modifiers[i] );
+		}
+	}
+	stable_sort( chain.begin(), chain.end(), ModifierOrderLess );
+
+	//Each emitter controller drives the emitter modifier with its modifier name
+	vector<NiPSysEmitterCtlr *> ctlrs;
+	vector<NiPSysEmitter *> emitters;
+	list<NiTimeControllerRef> controllers = GetControllers();
+	for ( list<NiTimeControllerRef>::iterator it = controllers.begin(); it != controllers.end(); ++it ) {
+		NiPSysEmitterCtlrRef ctlr = DynamicCast<NiPSysEmitterCtlr>( *it );
+		if ( ctlr == NULL ) {
+			continue;
+		}
+		for ( unsigned int i = 0; i < chain.size(); ++i ) {
+			NiPSysEmitterRef emitter = DynamicCast<NiPSysEmitter>( chain[i] );
+			if ( emitter != NULL && emitter->GetName() == ctlr->GetModifierName() ) {
+				ctlrs.push_back( ctlr );
+				emitters.push_back( emitter );
+				break;
+			}
+		}
+	}
+	//The fraction of a particle that each emitter has built up
+	vector<float> pending( emitters.size(), 0.0f );
+
+	unsigned int steps = 0;
+	if ( stop > start ) {
+		steps = (unsigned int)( ceil( ( stop - start ) / step ) );
+	}
+	for ( unsigned int s = 0; s < steps; ++s ) {
+		float time = start + float(s) * step;
+		float delta = step;
+		if ( time + delta > stop ) {
+			delta = stop - time;
+		}
+
+		unsigned int n = particles.Size();
+		for ( unsigned int i = 0; i < n; ++i ) {
+			particles.age[i] += delta;
+		}
+
+		for ( unsigned int e = 0; e < emitters.size(); ++e ) {
+			float t = time * ctlrs[e]->GetFrequency() + ctlrs[e]->GetPhase();
+			if ( !ctlrs[e]->IsEmitterActive( t ) ) {
+				continue;
+			}
+			pending[e] += ctlrs[e]->EvaluateBirthRate( t ) * delta;
+			if ( pending[e] < 1.0f ) {
+				continue;
+			}
+			unsigned int count = (unsigned int)( pending[e] );
+			pending[e] -= float(count);
+			unsigned int first = particles.Size();
+			emitters[e]->EmitParticles( particles, count, random );
+			for ( unsigned int m = 0; m < chain.size(); ++m ) {
+				chain[m]->InitializeParticles( particles, first, random );
+			}
+		}
+
+		for ( unsigned int m = 0; m < chain.size(); ++m ) {
+			chain[m]->UpdateParticles( particles, delta, random );
+		}
+		bounds.Add( particles );
+	}
+	return bounds;
+}
+
 //--END CUSTOM CODE--//
@@ -8,6 +8,9 @@ All rights reserved.  Please see niflib.h for license. */
 //-----------------------------------NOTICE----------------------------------//
 
 //--BEGIN FILE HEAD CUSTOM CODE--//
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
 //--END CUSTOM CODE--//
 
 #include "../../include/FixLink.h"
@@ -152,6 +155,327 @@ std::list<NiObject *> NiPixelData::GetPtrs() const {
 
 //--BEGIN MISC CUSTOM CODE--//
 
+////////////////////////////////////////////////
+// Block compression helpers
+
+namespace Niflib {
+
+/*! Number of bytes used by a single image of the given size in the given format. */
+static unsigned int PixelDataSize( PixelFormat px_fmt, unsigned int width, unsigned int height ) {
+	switch ( px_fmt ) {
+		case PX_FMT_RGB8:
+			return width * height * 3;
+		case PX_FMT_RGBA8:
+			return width * height * 4;
+		case PX_FMT_PAL8:
+			return width * height;
+		case PX_FMT_DXT1:
+			return ( (width + 3) / 4 ) * ( (height + 3) / 4 ) * 8;
+		case PX_FMT_DXT5:
+		case PX_FMT_DXT5_ALT:
+			return ( (width + 3) / 4 ) * ( (height + 3) / 4 ) * 16;
+		default:
+			throw runtime_error("The pixel type you have requested is not currently supported.");
+	}
+}
+
+static unsigned short PackRGB565( int r, int g, int b ) {
+	return (unsigned short)( ( ( (r * 31 + 127) / 255 ) << 11 ) | ( ( (g * 63 + 127) / 255 ) << 5 ) | ( (b * 31 + 127) / 255 ) );
+}
+
+static void UnpackRGB565( unsigned short c, int * rgb ) {
+	int r = (c >> 11) & 31;
+	int g = (c >> 5) & 63;
+	int b = c & 31;
+	rgb[0] = (r << 3) | (r >> 2);
+	rgb[1] = (g << 2) | (g >> 4);
+	rgb[2] = (b << 3) | (b >> 2);
+}
+
+/*! Builds the four color palette of a color block.  Entry 3 of a three color block is transparent black. */
+static void ColorBlockPalette( unsigned short c0, unsigned short c1, bool three_color, int palette[4][4] ) {
+	UnpackRGB565( c0, palette[0] );
+	UnpackRGB565( c1, palette[1] );
+	palette[0][3] = palette[1][3] = 255;
+	for ( int k = 0; k < 3; ++k ) {
+		if ( three_color ) {
+			palette[2][k] = ( palette[0][k] + palette[1][k] ) / 2;
+			palette[3][k] = 0;
+		} else {
+			palette[2][k] = ( 2 * palette[0][k] + palette[1][k] ) / 3;
+			palette[3][k] = ( palette[0][k] + 2 * palette[1][k] ) / 3;
+		}
+	}
+	palette[2][3] = 255;
+	palette[3][3] = three_color ? 0 : 255;
+}
+
+/*! Decodes an 8 byte color block into 16 RGBA8 texels.  Only DXT1 blocks may use the three color mode. */
+static void DecodeColorBlock( const byte * block, bool dxt1, byte * rgba ) {
+	unsigned short c0 = (unsigned short)( block[0] | (block[1] << 8) );
+	unsigned short c1 = (unsigned short)( block[2] | (block[3] << 8) );
+	int palette[4][4];
+	ColorBlockPalette( c0, c1, dxt1 && c0 <= c1, palette );
+	unsigned int bits = block[4] | (block[5] << 8) | (block[6] << 16) | ((unsigned int)block[7] << 24);
+	for ( int i = 0; i < 16; ++i, bits >>= 2 ) {
+		const int * p = palette[bits & 3];
+		rgba[i * 4 + 0] = byte(p[0]);
+		rgba[i * 4 + 1] = byte(p[1]);
+		rgba[i * 4 + 2] = byte(p[2]);
+		rgba[i * 4 + 3] = byte(p[3]);
+	}
+}
+
+/*! Decodes an 8 byte interpolated alpha block into the alpha channel of 16 RGBA8 texels. */
+static void DecodeAlphaBlock( const byte * block, byte * rgba ) {
+	int a[8];
+	a[0] = block[0];
+	a[1] = block[1];
+	if ( a[0] > a[1] ) {
+		for ( int i = 1; i < 7; ++i ) {
+			a[i + 1] = ( (7 - i) * a[0] + i * a[1] ) / 7;
+		}
+	} else {
+		for ( int i = 1; i < 5; ++i ) {
+			a[i + 1] = ( (5 - i) * a[0] + i * a[1] ) / 5;
+		}
+		a[6] = 0;
+		a[7] = 255;
+	}
+	for ( int i = 0; i < 16; ++i ) {
+		int bit = 16 + i * 3;
+		int index = ( ( block[bit / 8] | (block[bit / 8 + 1] << 8) ) >> (bit % 8) ) & 7;
+		rgba[i * 4 + 3] = byte(a[index]);
+	}
+}
+
+/*! Encodes 16 RGBA8 texels into an 8 byte color block.  DXT1 blocks with texels below half alpha use the three color mode. */
+static void EncodeColorBlock( const byte * rgba, bool dxt1, byte * block ) {
+	bool transparent[16];
+	bool three_color = false;
+	int count = 0;
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	for ( int i = 0; i < 16; ++i ) {
+		transparent[i] = dxt1 && rgba[i * 4 + 3] < 128;
+		if ( transparent[i] ) {
+			three_color = true;
+			continue;
+		}
+		for ( int k = 0; k < 3; ++k ) {
+			mean[k] += rgba[i * 4 + k];
+		}
+		++count;
+	}
+
+	unsigned short c0 = 0, c1 = 0;
+	if ( count > 0 ) {
+		//Find the principal axis of the colors by power iteration on their covariance
+		float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+		for ( int k = 0; k < 3; ++k ) {
+			mean[k] /= float(count);
+		}
+		for ( int i = 0; i < 16; ++i ) {
+			if ( transparent[i] ) {
+				continue;
+			}
+			float r = rgba[i * 4 + 0] - mean[0];
+			float g = rgba[i * 4 + 1] - mean[1];
+			float b = rgba[i * 4 + 2] - mean[2];
+			cov[0] += r * r;
+			cov[1] += r * g;
+			cov[2] += r * b;
+			cov[3] += g * g;
+			cov[4] += g * b;
+			cov[5] += b * b;
+		}
+		float axis[3] = { 1.0f, 1.0f, 1.0f };
+		for ( int it = 0; it < 8; ++it ) {
+			float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+			float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+			float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+			float len = max( fabs(x), max( fabs(y), fabs(z) ) );
+			if ( len < 1e-6f ) {
+				break;
+			}
+			axis[0] = x / len;
+			axis[1] = y / len;
+			axis[2] = z / len;
+		}
+
+		//Use the extreme colors along the axis as end points
+		float lo = 1e30f, hi = -1e30f;
+		int lo_i = 0, hi_i = 0;
+		for ( int i = 0; i < 16; ++i ) {
+			if ( transparent[i] ) {
+				continue;
+			}
+			float d = rgba[i * 4 + 0] * axis[0] + rgba[i * 4 + 1] * axis[1] + rgba[i * 4 + 2] * axis[2];
+			if ( d < lo ) { lo = d; lo_i = i; }
+			if ( d > hi ) { hi = d; hi_i = i; }
+		}
+		c0 = PackRGB565( rgba[hi_i * 4], rgba[hi_i * 4 + 1], rgba[hi_i * 4 + 2] );
+		c1 = PackRGB565( rgba[lo_i * 4], rgba[lo_i * 4 + 1], rgba[lo_i * 4 + 2] );
+	}
+
+	//Order the end points to select the block mode
+	if ( three_color ? ( c0 > c1 ) : ( c0 < c1 ) ) {
+		std::swap( c0, c1 );
+	}
+
+	int palette[4][4];
+	ColorBlockPalette( c0, c1, three_color, palette );
+	unsigned int bits = 0;
+	if ( three_color || c0 != c1 ) {
+		for ( int i = 15; i >= 0; --i ) {
+			unsigned int best = 3;
+			if ( transparent[i] == false ) {
+				int best_dist = 0x7FFFFFFF;
+				for ( unsigned int j = 0; j < ( three_color ? 3u : 4u ); ++j ) {
+					int dr = palette[j][0] - rgba[i * 4 + 0];
+					int dg = palette[j][1] - rgba[i * 4 + 1];
+					int db = palette[j][2] - rgba[i * 4 + 2];
+					int dist = dr * dr + dg * dg + db * db;
+					if ( dist < best_dist ) {
+						best_dist = dist;
+						best = j;
+					}
+				}
+			}
+			bits = (bits << 2) | best;
+		}
+	}
+
+	block[0] = byte(c0 & 0xFF);
+	block[1] = byte(c0 >> 8);
+	block[2] = byte(c1 & 0xFF);
+	block[3] = byte(c1 >> 8);
+	block[4] = byte(bits & 0xFF);
+	block[5] = byte((bits >> 8) & 0xFF);
+	block[6] = byte((bits >> 16) & 0xFF);
+	block[7] = byte(bits >> 24);
+}
+
+/*! Encodes the alpha channel of 16 RGBA8 texels into an 8 byte interpolated alpha block. */
+static void EncodeAlphaBlock( const byte * rgba, byte * block ) {
+	int a0 = 0, a1 = 255;
+	for ( int i = 0; i < 16; ++i ) {
+		a0 = max( a0, int(rgba[i * 4 + 3]) );
+		a1 = min( a1, int(rgba[i * 4 + 3]) );
+	}
+	block[0] = byte(a0);
+	block[1] = byte(a1);
+	for ( int i = 2; i < 8; ++i ) {
+		block[i] = 0;
+	}
+	if ( a0 == a1 ) {
+		return;
+	}
+
+	//Eight interpolated values, a0 > a1
+	int a[8];
+	a[0] = a0;
+	a[1] = a1;
+	for ( int i = 1; i < 7; ++i ) {
+		a[i + 1] = ( (7 - i) * a0 + i * a1 ) / 7;
+	}
+	for ( int i = 0; i < 16; ++i ) {
+		int value = rgba[i * 4 + 3];
+		int best = 0;
+		for ( int j = 1; j < 8; ++j ) {
+			if ( abs( a[j] - value ) < abs( a[best] - value ) ) {
+				best = j;
+			}
+		}
+		int bit = 16 + i * 3;
+		block[bit / 8] |= byte( (best << (bit % 8)) & 0xFF );
+		if ( bit % 8 > 5 ) {
+			block[bit / 8 + 1] |= byte( best >> (8 - bit % 8) );
+		}
+	}
+}
+
+} //End namespace Niflib
+
+void NiPixelData::DecompressBlocks( PixelFormat px_fmt, const byte * blocks, unsigned int width, unsigned int height, byte * rgba ) {
+	unsigned int block_size;
+	switch ( px_fmt ) {
+		case PX_FMT_DXT1:
+			block_size = 8;
+			break;
+		case PX_FMT_DXT5:
+		case PX_FMT_DXT5_ALT:
+			block_size = 16;
+			break;
+		default:
+			throw runtime_error("DecompressBlocks only supports the PX_FMT_DXT1, PX_FMT_DXT5, and PX_FMT_DXT5_ALT pixel formats.");
+	}
+
+	byte texels[64];
+	for ( unsigned int by = 0; by < height; by += 4 ) {
+		for ( unsigned int bx = 0; bx < width; bx += 4, blocks += block_size ) {
+			if ( block_size == 8 ) {
+				DecodeColorBlock( blocks, true, texels );
+			} else {
+				DecodeColorBlock( blocks + 8, false, texels );
+				DecodeAlphaBlock( blocks, texels );
+			}
+
+			//Copy the part of the block that lies inside the image
+			for ( unsigned int y = 0; y < 4 && by + y < height; ++y ) {
+				for ( unsigned int x = 0; x < 4 && bx + x < width; ++x ) {
+					byte * px = &rgba[ ( (by + y) * width + bx + x ) * 4 ];
+					const byte * tx = &texels[ (y * 4 + x) * 4 ];
+					px[0] = tx[0];
+					px[1] = tx[1];
+					px[2] = tx[2];
+					px[3] = tx[3];
+				}
+			}
+		}
+	}
+}
+
+void NiPixelData::CompressBlocks( PixelFormat px_fmt, const byte * rgba, unsigned int width, unsigned int height, byte * blocks ) {
+	unsigned int block_size;
+	switch ( px_fmt ) {
+		case PX_FMT_DXT1:
+			block_size = 8;
+			break;
+		case PX_FMT_DXT5:
+		case PX_FMT_DXT5_ALT:
+			block_size = 16;
+			break;
+		default:
+			throw runtime_error("CompressBlocks only supports the PX_FMT_DXT1, PX_FMT_DXT5, and PX_FMT_DXT5_ALT pixel formats.");
+	}
+
+	byte texels[64];
+	for ( unsigned int by = 0; by < height; by += 4 ) {
+		for ( unsigned int bx = 0; bx < width; bx += 4, blocks += block_size ) {
+			//Gather the block, repeating edge texels where it extends past the image
+			for ( unsigned int y = 0; y < 4; ++y ) {
+				for ( unsigned int x = 0; x < 4; ++x ) {
+					unsigned int sy = min( by + y, height - 1 );
+					unsigned int sx = min( bx + x, width - 1 );
+					const byte * px = &rgba[ (sy * width + sx) * 4 ];
+					byte * tx = &texels[ (y * 4 + x) * 4 ];
+					tx[0] = px[0];
+					tx[1] = px[1];
+					tx[2] = px[2];
+					tx[3] = px[3];
+				}
+			}
+
+			if ( block_size == 8 ) {
+				EncodeColorBlock( texels, true, blocks );
+			} else {
+				EncodeAlphaBlock( texels, blocks );
+				EncodeColorBlock( texels, false, blocks + 8 );
+			}
+		}
+	}
+}
+
 int NiPixelData::GetHeight() const {
 	if ( mipmaps.size() == 0 ) {
 		return 0;
@@ -194,6 +518,10 @@ void NiPixelData::Reset( int new_width, int new_height, PixelFormat px_fmt ) {
 	mipmaps[0].offset = 0;
 
 	//Set up pixel format fields
+	SetFormatFields( px_fmt );
+}
+
+void NiPixelData::SetFormatFields( PixelFormat px_fmt ) {
 	pixelFormat = px_fmt;
 	switch(pixelFormat) {
 		case PX_FMT_RGB8:
@@ -241,7 +569,19 @@ void NiPixelData::Reset( int new_width, int new_height, PixelFormat px_fmt ) {
 			unknown8Bytes[6] = 12;
 			unknown8Bytes[7] = 0;
 			break;	
-		//[4,0,0,0,0,0,0,0] if 0 (?) bits per pixel
+		case PX_FMT_DXT1 :
+		case PX_FMT_DXT5 :
+		case PX_FMT_DXT5_ALT :
+			redMask   = 0x00000000;
+			blueMask  = 0x00000000;
+			greenMask = 0x00000000;
+			alphaMask = 0x00000000;
+			bitsPerPixel = ( pixelFormat == PX_FMT_DXT1 ) ? 4 : 8;
+			unknown8Bytes[0] = 4;
+			for ( int i = 1; i < 8; ++i ) {
+				unknown8Bytes[i] = 0;
+			}
+			break;
 		default:
 			throw runtime_error("The pixel type you have requested is not currently supported.");
 	}
@@ -275,8 +615,22 @@ vector<Color4> NiPixelData::GetColors() const {
 				pixels[i].a = float(pixelData[0][i * 4 + 3]) / 255.0f;
 			}
 			break;
+		case PX_FMT_DXT1:
+		case PX_FMT_DXT5:
+		case PX_FMT_DXT5_ALT:
+			{
+				vector<byte> rgba( pixels.size() * 4 );
+				DecompressBlocks( pixelFormat, &pixelData[0][0], mipmaps[0].width, mipmaps[0].height, &rgba[0] );
+				for ( unsigned int i = 0; i < pixels.size(); ++i ) {
+					pixels[i].r = float(rgba[i * 4]) / 255.0f;
+					pixels[i].g = float(rgba[i * 4 + 1]) / 255.0f;
+					pixels[i].b = float(rgba[i * 4 + 2]) / 255.0f;
+					pixels[i].a = float(rgba[i * 4 + 3]) / 255.0f;
+				}
+			}
+			break;
 		default:
-			throw runtime_error("The GetColors function only supports the PX_FMT_RGB8 and PX_FMT_RGBA8 pixel formats.");
+			throw runtime_error("The GetColors function only supports the PX_FMT_RGB8, PX_FMT_RGBA8, and DXT pixel formats.");
 	}
 
 #ifdef IM_DEBUG
@@ -292,8 +646,8 @@ vector<Color4> NiPixelData::GetColors() const {
 
 void NiPixelData::SetColors( const vector<Color4> & new_pixels, bool generate_mipmaps ) {
 	//Ensure that compatible pixel format is being used
-	if ( pixelFormat != PX_FMT_RGB8 && pixelFormat != PX_FMT_RGBA8 ) {
-		throw runtime_error("The SetColors function only supports the PX_FMT_RGB8 and PX_FMT_RGBA8 pixel formats.");
+	if ( pixelFormat == PX_FMT_PAL8 ) {
+		throw runtime_error("The SetColors function only supports the PX_FMT_RGB8, PX_FMT_RGBA8, and DXT pixel formats.");
 	}
 
 	//Ensure that there is size information in the mipmaps
@@ -306,143 +660,513 @@ void NiPixelData::SetColors( const vector<Color4> & new_pixels, bool generate_mi
 		throw runtime_error("You must pass one color for every pixel in the image.  There should be height * width colors.");
 	}
 
-	unsigned int size = 0;
+	//Store the first image only, mipmaps are filtered down from it afterwards
 	mipmaps.resize(1);
-	size = (mipmaps[0].height * mipmaps[0].width * bitsPerPixel) / 8;
+	mipmaps[0].offset = 0;
+	pixelData.resize(1);
+	pixelData[0].resize( PixelDataSize( pixelFormat, mipmaps[0].width, mipmaps[0].height ) );
+
+	//Pack pixel data
+	byte * map = &pixelData[0][0];
+	switch(pixelFormat) {
+	case PX_FMT_RGB8:
+		for ( unsigned int j = 0; j < new_pixels.size(); ++j ) {
+			map[j * 3] = int( new_pixels[j].r * 255.0f );
+			map[j * 3 + 1] = int( new_pixels[j].g * 255.0f );
+			map[j * 3 + 2] = int( new_pixels[j].b * 255.0f );
+		}
+		break;
+	case PX_FMT_RGBA8:
+		for ( unsigned int j = 0; j < new_pixels.size(); ++j ) {
+			map[j * 4] = int( new_pixels[j].r * 255.0f );
+			map[j * 4 + 1] = int( new_pixels[j].g * 255.0f );
+			map[j * 4 + 2] = int( new_pixels[j].b * 255.0f );
+			map[j * 4 + 3] = int( new_pixels[j].a * 255.0f );
+		}
+		break;
+	case PX_FMT_DXT1:
+	case PX_FMT_DXT5:
+	case PX_FMT_DXT5_ALT:
+		{
+			vector<byte> rgba( new_pixels.size() * 4 );
+			for ( unsigned int j = 0; j < new_pixels.size(); ++j ) {
+				rgba[j * 4] = int( new_pixels[j].r * 255.0f );
+				rgba[j * 4 + 1] = int( new_pixels[j].g * 255.0f );
+				rgba[j * 4 + 2] = int( new_pixels[j].b * 255.0f );
+				rgba[j * 4 + 3] = int( new_pixels[j].a * 255.0f );
+			}
+			CompressBlocks( pixelFormat, &rgba[0], mipmaps[0].width, mipmaps[0].height, map );
+		}
+		break;
+	default:
+		throw runtime_error("The SetColors function only supports the PX_FMT_RGB8, PX_FMT_RGBA8, and DXT pixel formats.");
+	}
 
 	//Deal with multiple mipmaps
 	if ( generate_mipmaps == true ) {
-		MipMap m;
-		m.height = mipmaps[0].height;
-		m.width = mipmaps[0].width;
+		GenerateMipMaps();
+	}
+}
+
+////////////////////////////////////////////////
+// Mipmap generation
 
-		size = (mipmaps[0].height * mipmaps[0].width * bitsPerPixel) / 8;
+namespace Niflib {
 
-		while ( m.width != 1 && m.height != 1 ) {
-			m.width /= 2;
-			m.height /= 2;
-			m.offset = size;
+/*! The source pixels and weights that make up one destination pixel along one axis. */
+struct MipTaps {
+	unsigned int first;
+	vector<float> weights;
+};
 
-			size += (m.height * m.width * bitsPerPixel) / 8;
+static float MipSinc( float x ) {
+	if ( fabs(x) < 1e-5f ) {
+		return 1.0f;
+	}
+	x *= 3.14159265f;
+	return sin(x) / x;
+}
+
+/*! Zeroth order modified Bessel function of the first kind, used by the Kaiser window. */
+static float MipBessel0( float x ) {
+	float sum = 1.0f;
+	float term = 1.0f;
+	for ( int k = 1; k < 20; ++k ) {
+		float f = x / ( 2.0f * float(k) );
+		term *= f * f;
+		sum += term;
+	}
+	return sum;
+}
 
-			mipmaps.push_back(m);
+/*! Computes the filter taps for resampling src pixels to dst pixels along one axis.  Edge pixels are repeated. */
+static vector<MipTaps> MipFilterTaps( unsigned int src, unsigned int dst, NiPixelData::MipMapFilter filter ) {
+	vector<MipTaps> taps( dst );
+	const float ratio = float(src) / float(dst);
+	const float radius = ( filter == NiPixelData::MIP_FILTER_BOX ) ? 0.5f : 3.0f;
+	for ( unsigned int d = 0; d < dst; ++d ) {
+		const float lo = float(d) * ratio;
+		const float hi = float(d + 1) * ratio;
+		const float center = 0.5f * ( lo + hi );
+		int s0 = int( floor( center - radius * ratio ) );
+		int s1 = int( ceil( center + radius * ratio ) );
+		int first = max( s0, 0 );
+		int last = min( s1, int(src) - 1 );
+		MipTaps & t = taps[d];
+		t.first = first;
+		t.weights.assign( last - first + 1, 0.0f );
+
+		float sum = 0.0f;
+		for ( int s = s0; s <= s1; ++s ) {
+			float w;
+			float x = ( float(s) + 0.5f - center ) / ratio;
+			switch ( filter ) {
+				case NiPixelData::MIP_FILTER_KAISER:
+					{
+						//Kaiser windowed sinc, three lobes, alpha = 4
+						float r = x / radius;
+						w = ( r * r < 1.0f ) ? MipSinc( x ) * MipBessel0( 4.0f * sqrt( 1.0f - r * r ) ) / MipBessel0( 4.0f ) : 0.0f;
+					}
+					break;
+				case NiPixelData::MIP_FILTER_LANCZOS:
+					w = ( fabs(x) < radius ) ? MipSinc( x ) * MipSinc( x / radius ) : 0.0f;
+					break;
+				default:
+					//Area covered by the source pixel
+					w = max( 0.0f, min( float(s + 1), hi ) - max( float(s), lo ) );
+					break;
+			}
+			t.weights[ min( max( s, first ), last ) - first ] += w;
+			sum += w;
+		}
+		for ( unsigned int i = 0; i < t.weights.size(); ++i ) {
+			t.weights[i] /= sum;
 		}
 	}
+	return taps;
+}
 
-	pixelData.resize(1);
-	pixelData[0].resize( size * bitsPerPixel / 8 );
+/*!
+ * Resamples an 8-bit image with the given filter taps.  Color channels are
+ * filtered in linear space through the to_linear and from_linear tables, the
+ * fourth channel is always filtered as is.
+ */
+static void MipResample( const byte * src, unsigned int src_width, unsigned int src_height, byte * dst, unsigned int dst_width, unsigned int dst_height, unsigned int channels, const vector<MipTaps> & x_taps, const vector<MipTaps> & y_taps, const float * to_linear, const byte * from_linear ) {
+	const unsigned int row = dst_width * channels;
+
+	//Horizontal pass, one float row per source row
+	vector<float> tmp( src_height * row );
+	for ( unsigned int y = 0; y < src_height; ++y ) {
+		const byte * in = &src[ y * src_width * channels ];
+		float * out = &tmp[ y * row ];
+		for ( unsigned int x = 0; x < dst_width; ++x ) {
+			const MipTaps & t = x_taps[x];
+			float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for ( unsigned int i = 0; i < t.weights.size(); ++i ) {
+				const byte * px = &in[ ( t.first + i ) * channels ];
+				const float w = t.weights[i];
+				acc[0] += w * to_linear[ px[0] ];
+				acc[1] += w * to_linear[ px[1] ];
+				acc[2] += w * to_linear[ px[2] ];
+				if ( channels == 4 ) {
+					acc[3] += w * float( px[3] ) * ( 1.0f / 255.0f );
+				}
+			}
+			for ( unsigned int c = 0; c < channels; ++c ) {
+				out[ x * channels + c ] = acc[c];
+			}
+		}
+	}
+
+	//Vertical pass straight into the destination
+	vector<float> acc( row );
+	for ( unsigned int y = 0; y < dst_height; ++y ) {
+		const MipTaps & t = y_taps[y];
+		fill( acc.begin(), acc.end(), 0.0f );
+		for ( unsigned int i = 0; i < t.weights.size(); ++i ) {
+			const float * in = &tmp[ ( t.first + i ) * row ];
+			const float w = t.weights[i];
+			for ( unsigned int j = 0; j < row; ++j ) {
+				acc[j] += w * in[j];
+			}
+		}
+		byte * out = &dst[ y * row ];
+		for ( unsigned int j = 0; j < row; ++j ) {
+			float v = min( max( acc[j], 0.0f ), 1.0f );
+			if ( j % channels == 3 ) {
+				out[j] = byte( v * 255.0f + 0.5f );
+			} else {
+				out[j] = from_linear[ int( v * 4095.0f + 0.5f ) ];
+			}
+		}
+	}
+}
 
-	//Copy pixels to Color4 C array
-	Color4 * tmp_image = new Color4[new_pixels.size()];
+} //End namespace Niflib
 
-	for (unsigned int i = 0; i < new_pixels.size(); ++i ) {
-		tmp_image[i] = new_pixels[i];
+void NiPixelData::GenerateMipMaps( MipMapFilter filter, bool srgb ) {
+	if ( mipmaps.size() == 0 ) {
+		throw runtime_error("The size informatoin has not been set.  Call the IPixelData::Reset() function first.");
 	}
 
-	//Pack pixel data
-	for (unsigned int i = 0; i < mipmaps.size(); ++i ) {
-		if ( i > 0 ) {
-			//Allocate space to store re-sized image.
-			Color4 * resized = new Color4[ mipmaps[i].width * mipmaps[i].height ];
-
-			//Visit every other pixel in each row and column of the previous image
-			for ( unsigned int w = 0; w < mipmaps[i-1].width; w+=2 ) {
-				for ( unsigned int h = 0; h < mipmaps[i-1].height; h+=2 ) {
-					Color4 & av = resized[(h/2) * mipmaps[i].width + (w/2)];
-
-					//Start with the value of the current pixel
-					av = tmp_image[h * mipmaps[i-1].width + w];
-					float num_colors = 1.0f;
-
-					//Only process the pixel above if height is > 1
-					if ( h > 1 ) {
-						Color4 & px = tmp_image[(h+1) * mipmaps[i-1].width + w];
-						av.r += px.r;
-						av.g += px.g;
-						av.b += px.b;
-						av.a += px.a;
-						num_colors += 1.0f;
-					}
+	unsigned int channels;
+	bool compressed = false;
+	switch ( pixelFormat ) {
+		case PX_FMT_RGB8:
+			channels = 3;
+			break;
+		case PX_FMT_RGBA8:
+			channels = 4;
+			break;
+		case PX_FMT_DXT1:
+		case PX_FMT_DXT5:
+		case PX_FMT_DXT5_ALT:
+			channels = 4;
+			compressed = true;
+			break;
+		default:
+			throw runtime_error("The GenerateMipMaps function only supports the PX_FMT_RGB8, PX_FMT_RGBA8, and DXT pixel formats.");
+	}
 
-					//Only process the pixel to the right if width > 1
-					if (w > 1 ) {
-						Color4 & px = tmp_image[h * mipmaps[i-1].width + (w+1)];
-						av.r += px.r;
-						av.g += px.g;
-						av.b += px.b;
-						av.a += px.a;
-						num_colors += 1.0f;
-					}
+	unsigned int first_size = PixelDataSize( pixelFormat, mipmaps[0].width, mipmaps[0].height );
+	unsigned int size = LayoutMipMaps( 0 );
 
-					//Only process the pixel to the upper right if both width and height are > 1
-					if ( w > 1 && h >> 1 ) {
-						Color4 & px = tmp_image[(h+1) * mipmaps[i-1].width + (w+1)];
-						av.r += px.r;
-						av.g += px.g;
-						av.b += px.b;
-						av.a += px.a;
-						num_colors += 1.0f;
-					}
+	//Conversion tables between the stored values and linear intensity
+	float to_linear[256];
+	byte from_linear[4096];
+	for ( int i = 0; i < 256; ++i ) {
+		float c = float(i) / 255.0f;
+		if ( srgb ) {
+			c = ( c <= 0.04045f ) ? c / 12.92f : pow( ( c + 0.055f ) / 1.055f, 2.4f );
+		}
+		to_linear[i] = c;
+	}
+	for ( int i = 0; i < 4096; ++i ) {
+		float c = float(i) / 4095.0f;
+		if ( srgb ) {
+			c = ( c <= 0.0031308f ) ? c * 12.92f : 1.055f * pow( c, 1.0f / 2.4f ) - 0.055f;
+		}
+		from_linear[i] = byte( c * 255.0f + 0.5f );
+	}
 
-					//Calculate average
-					av.r /= num_colors;
-					av.g /= num_colors;
-					av.b /= num_colors;
-					av.a /= num_colors;
-				}
+	//Filter every face of a cube map separately
+	for ( unsigned int f = 0; f < pixelData.size(); ++f ) {
+		if ( pixelData[f].size() < first_size ) {
+			throw runtime_error("The pixel data is too small for the size of the first mipmap.");
+		}
+		pixelData[f].resize( size );
+
+		vector<byte> prev, next;
+		if ( compressed ) {
+			prev.resize( mipmaps[0].width * mipmaps[0].height * 4 );
+			DecompressBlocks( pixelFormat, &pixelData[f][0], mipmaps[0].width, mipmaps[0].height, &prev[0] );
+		} else {
+			prev.assign( pixelData[f].begin(), pixelData[f].begin() + first_size );
+		}
+
+		for ( unsigned int i = 1; i < mipmaps.size(); ++i ) {
+			const MipMap & src = mipmaps[i - 1];
+			const MipMap & dst = mipmaps[i];
+			next.resize( dst.width * dst.height * channels );
+			MipResample( &prev[0], src.width, src.height, &next[0], dst.width, dst.height, channels,
+				MipFilterTaps( src.width, dst.width, filter ), MipFilterTaps( src.height, dst.height, filter ),
+				to_linear, from_linear );
+			if ( compressed ) {
+				CompressBlocks( pixelFormat, &next[0], dst.width, dst.height, &pixelData[f][dst.offset] );
+			} else {
+				copy( next.begin(), next.end(), pixelData[f].begin() + dst.offset );
 			}
-			//Resize is complete, set result to tmp_image
+			prev.swap( next );
+		}
+	}
+}
+
+unsigned int NiPixelData::LayoutMipMaps( unsigned int num_mipmaps ) {
+	//Each mipmap halves the size of the previous one, down to 1 x 1
+	mipmaps.resize(1);
+	mipmaps[0].offset = 0;
+	unsigned int size = PixelDataSize( pixelFormat, mipmaps[0].width, mipmaps[0].height );
+	MipMap m = mipmaps[0];
+	while ( ( m.width > 1 || m.height > 1 ) && ( num_mipmaps == 0 || mipmaps.size() < num_mipmaps ) ) {
+		m.width = max( m.width / 2, 1u );
+		m.height = max( m.height / 2, 1u );
+		m.offset = size;
+		size += PixelDataSize( pixelFormat, m.width, m.height );
+		mipmaps.push_back(m);
+	}
+	return size;
+}
 
-			//delete old tmp_image data
-			delete [] tmp_image;
+////////////////////////////////////////////////
+// Direct pixel access
 
-			//Adjust pointer values
-			tmp_image = resized;
-			resized = NULL;
-		}
+unsigned int NiPixelData::GetNumMipMaps() const {
+	return (unsigned int)(mipmaps.size());
+}
+
+unsigned int NiPixelData::GetNumFaces() const {
+	return (unsigned int)(pixelData.size());
+}
 
-		//Data is ready to be packed into the byes of this mipmap
+void NiPixelData::AllocatePixelData( unsigned int num_mipmaps, unsigned int num_faces ) {
+	if ( mipmaps.size() == 0 ) {
+		throw runtime_error("The size informatoin has not been set.  Call the IPixelData::Reset() function first.");
+	}
+	if ( num_faces == 0 ) {
+		throw runtime_error("A texture must have at least one face.");
+	}
+	unsigned int size = LayoutMipMaps( num_mipmaps );
+	pixelData.resize( num_faces );
+	for ( unsigned int f = 0; f < pixelData.size(); ++f ) {
+		pixelData[f].resize( size );
+	}
+}
 
-		#ifdef IM_DEBUG
-			cout << "Showing mipmap size " << mipmaps[i].width << " x " << mipmaps[i].height << "." << endl;
-			imdebug("rgba b=32f w=%d h=%d %p", mipmaps[i].width, mipmaps[i].height, &tmp_image[0] );
-			cin.get();
-		#endif
+NiPixelData::MipMapView NiPixelData::GetMipMapView( unsigned int level, unsigned int face ) {
+	ConstMipMapView c = static_cast<const NiPixelData *>(this)->GetMipMapView( level, face );
+	MipMapView v;
+	v.data = const_cast<byte *>(c.data);
+	v.size = c.size;
+	v.width = c.width;
+	v.height = c.height;
+	v.rowPitch = c.rowPitch;
+	return v;
+}
 
-		//Start at offset
-		byte * map = &pixelData[0][mipmaps[i].offset];
+NiPixelData::ConstMipMapView NiPixelData::GetMipMapView( unsigned int level, unsigned int face ) const {
+	if ( level >= mipmaps.size() ) {
+		throw runtime_error("The mipmap level is out of range.");
+	}
+	if ( face >= pixelData.size() ) {
+		throw runtime_error("The face index is out of range.");
+	}
+	const MipMap & m = mipmaps[level];
+	ConstMipMapView v;
+	v.size = PixelDataSize( pixelFormat, m.width, m.height );
+	if ( m.offset + v.size > pixelData[face].size() ) {
+		throw runtime_error("The pixel data is too small for the mipmap layout.");
+	}
+	v.data = v.size ? &pixelData[face][m.offset] : NULL;
+	v.width = m.width;
+	v.height = m.height;
+	v.rowPitch = v.size / max( ( pixelFormat >= PX_FMT_DXT1 ) ? ( m.height + 3 ) / 4 : m.height, 1u );
+	return v;
+}
 
-		switch(pixelFormat) {
-		case PX_FMT_RGB8:
-			for ( unsigned int j = 0; j < mipmaps[i].width * mipmaps[i].height; ++j ) {
-				map[j * 3] = int( tmp_image[j].r * 255.0f );
-				map[j * 3 + 1] = int( tmp_image[j].g * 255.0f );
-				map[j * 3 + 2] = int( tmp_image[j].b * 255.0f );
+void NiPixelData::ReadMipMap( istream & in, unsigned int level, unsigned int face ) {
+	MipMapView v = GetMipMapView( level, face );
+	in.read( (char *)v.data, v.size );
+	if ( (unsigned int)(in.gcount()) != v.size ) {
+		throw runtime_error("Unexpected end of stream while reading mipmap data.");
+	}
+}
+
+void NiPixelData::WriteMipMap( ostream & out, unsigned int level, unsigned int face ) const {
+	ConstMipMapView v = GetMipMapView( level, face );
+	out.write( (const char *)v.data, v.size );
+}
+
+void NiPixelData::ConvertFormat( PixelFormat px_fmt ) {
+	if ( px_fmt == pixelFormat ) {
+		return;
+	}
+	if ( pixelFormat == PX_FMT_PAL8 || px_fmt == PX_FMT_PAL8 ) {
+		throw runtime_error("The ConvertFormat function does not support palettized textures.");
+	}
+	//Make sure the target format is known and the data is complete before anything is changed
+	PixelDataSize( px_fmt, 1, 1 );
+	for ( unsigned int i = 0; i < mipmaps.size(); ++i ) {
+		for ( unsigned int f = 0; f < pixelData.size(); ++f ) {
+			if ( mipmaps[i].offset + PixelDataSize( pixelFormat, mipmaps[i].width, mipmaps[i].height ) > pixelData[f].size() ) {
+				throw runtime_error("The pixel data is too small for the mipmap layout.");
 			}
+		}
+	}
 
-			//#ifdef IM_DEBUG
-			//	cout << "Showing mipmap after being packed  - size " << mipmaps[i].width << " x " << mipmaps[i].height << "." << endl;
-			//	imdebug("rgb w=%d h=%d %p", mipmaps[i].width, mipmaps[i].height, &map[0] );
-			//	cin.get();
-			//#endif
-			break;
-		case PX_FMT_RGBA8:
-			for ( unsigned int j = 0; j < mipmaps[i].width * mipmaps[i].height; ++j ) {
-				map[j * 4] = int( tmp_image[j].r * 255.0f );
-				map[j * 4 + 1] = int( tmp_image[j].g * 255.0f );
-				map[j * 4 + 2] = int( tmp_image[j].b * 255.0f );
-				map[j * 4 + 3] = int( tmp_image[j].a * 255.0f );
+	const PixelFormat old_fmt = pixelFormat;
+	const vector<MipMap> old_mipmaps = mipmaps;
+	const unsigned int old_channels = ( old_fmt == PX_FMT_RGB8 ) ? 3 : 4;
+	const unsigned int new_channels = ( px_fmt == PX_FMT_RGB8 ) ? 3 : 4;
+	SetFormatFields( px_fmt );
+	const unsigned int size = LayoutMipMaps( (unsigned int)(old_mipmaps.size()) );
+
+	//Between RGB8 and RGBA8, mipmaps that are packed one after another are
+	//converted in place.  Growing pixels only move to later positions, so the
+	//levels are converted last to first and each one back to front.  Shrinking
+	//pixels only move to earlier positions, so the order is reversed.
+	bool in_place = ( old_fmt < PX_FMT_DXT1 && px_fmt < PX_FMT_DXT1 );
+	unsigned int packed_offset = 0;
+	for ( unsigned int i = 0; in_place && i < old_mipmaps.size(); ++i ) {
+		in_place = ( old_mipmaps[i].offset == packed_offset );
+		packed_offset += old_mipmaps[i].width * old_mipmaps[i].height * old_channels;
+	}
+	if ( in_place ) {
+		const bool grow = ( new_channels > old_channels );
+		const unsigned int levels = (unsigned int)(mipmaps.size());
+		for ( unsigned int f = 0; f < pixelData.size(); ++f ) {
+			if ( grow ) {
+				pixelData[f].resize( size );
+			}
+			byte * data = pixelData[f].empty() ? NULL : &pixelData[f][0];
+			for ( unsigned int n = 0; n < levels; ++n ) {
+				const unsigned int i = grow ? levels - 1 - n : n;
+				const unsigned int count = mipmaps[i].width * mipmaps[i].height;
+				const byte * in = data + old_mipmaps[i].offset;
+				byte * out = data + mipmaps[i].offset;
+				for ( unsigned int k = 0; k < count; ++k ) {
+					const unsigned int j = grow ? count - 1 - k : k;
+					//Read the whole pixel before writing, since the two can overlap
+					const byte r = in[j * old_channels];
+					const byte g = in[j * old_channels + 1];
+					const byte b = in[j * old_channels + 2];
+					out[j * new_channels] = r;
+					out[j * new_channels + 1] = g;
+					out[j * new_channels + 2] = b;
+					if ( new_channels == 4 ) {
+						out[j * 4 + 3] = 255;
+					}
+				}
 			}
+			pixelData[f].resize( size );
+		}
+		return;
+	}
+
+	vector<byte> src;
+	for ( unsigned int f = 0; f < pixelData.size(); ++f ) {
+		//Convert into a new buffer, since block formats change the size of each
+		//level unevenly and the new layout can overlap old mipmaps that are not
+		//converted yet
+		vector<byte> converted( size );
+		for ( unsigned int i = 0; i < mipmaps.size(); ++i ) {
+			const MipMap & om = old_mipmaps[i];
+			const unsigned int count = om.width * om.height;
+			const byte * in = &pixelData[f][om.offset];
+			byte * out = &converted[mipmaps[i].offset];
+
+			if ( old_fmt >= PX_FMT_DXT1 || px_fmt >= PX_FMT_DXT1 ) {
+				//Block formats go through an RGBA copy of the mipmap
+				src.resize( count * 4 );
+				if ( old_fmt >= PX_FMT_DXT1 ) {
+					DecompressBlocks( old_fmt, in, om.width, om.height, &src[0] );
+				} else {
+					for ( unsigned int j = 0; j < count; ++j ) {
+						src[j * 4] = in[j * old_channels];
+						src[j * 4 + 1] = in[j * old_channels + 1];
+						src[j * 4 + 2] = in[j * old_channels + 2];
+						src[j * 4 + 3] = ( old_channels == 4 ) ? in[j * 4 + 3] : 255;
+					}
+				}
+				if ( px_fmt >= PX_FMT_DXT1 ) {
+					CompressBlocks( px_fmt, &src[0], om.width, om.height, out );
+				} else {
+					for ( unsigned int j = 0; j < count; ++j ) {
+						for ( unsigned int c = 0; c < new_channels; ++c ) {
+							out[j * new_channels + c] = src[j * 4 + c];
+						}
+					}
+				}
+			} else {
+				//Between RGB8 and RGBA8 in a layout with gaps, with an opaque alpha when one is added
+				for ( unsigned int j = 0; j < count; ++j ) {
+					out[j * new_channels] = in[j * old_channels];
+					out[j * new_channels + 1] = in[j * old_channels + 1];
+					out[j * new_channels + 2] = in[j * old_channels + 2];
+					if ( new_channels == 4 ) {
+						out[j * 4 + 3] = 255;
+					}
+				}
+			}
+		}
+		pixelData[f].swap( converted );
+	}
+}
 
-			//#ifdef IM_DEBUG
-			//	cout << "Showing mipmap after being packed  - size " << mipmaps[i].width << " x " << mipmaps[i].height << "." << endl;
-			//	imdebug("rgba w=%d h=%d %p", mipmaps[i].width, mipmaps[i].height, &map[0] );
-			//	cin.get();
-			//#endif
+void NiPixelData::SwizzleChannels( unsigned int r, unsigned int g, unsigned int b, unsigned int a ) {
+	unsigned int channels;
+	switch ( pixelFormat ) {
+		case PX_FMT_RGB8:
+			channels = 3;
 			break;
-		case PX_FMT_PAL8:
-			throw runtime_error("The SetColors function only supports the PX_FMT_RGB8 and PX_FMT_RGBA8 pixel formats.");
+		case PX_FMT_RGBA8:
+			channels = 4;
 			break;
+		default:
+			throw runtime_error("The SwizzleChannels function only supports the PX_FMT_RGB8 and PX_FMT_RGBA8 pixel formats.");
+	}
+	const unsigned int order[4] = { r, g, b, a };
+	for ( unsigned int c = 0; c < channels; ++c ) {
+		if ( order[c] >= channels ) {
+			throw runtime_error("The swizzle refers to a channel that the pixel format does not have.");
+		}
+	}
+
+	for ( unsigned int f = 0; f < pixelData.size(); ++f ) {
+		byte * px = pixelData[f].empty() ? NULL : &pixelData[f][0];
+		const unsigned int count = (unsigned int)(pixelData[f].size()) / channels;
+		for ( unsigned int j = 0; j < count; ++j, px += channels ) {
+			byte tmp[4] = { px[0], px[1], px[2], ( channels == 4 ) ? px[3] : (byte)0 };
+			for ( unsigned int c = 0; c < channels; ++c ) {
+				px[c] = tmp[ order[c] ];
+			}
+		}
+	}
+}
+
+void NiPixelData::PremultiplyAlpha() {
+	if ( pixelFormat != PX_FMT_RGBA8 ) {
+		throw runtime_error("The PremultiplyAlpha function only supports the PX_FMT_RGBA8 pixel format.");
+	}
+	for ( unsigned int f = 0; f < pixelData.size(); ++f ) {
+		byte * px = pixelData[f].empty() ? NULL : &pixelData[f][0];
+		const unsigned int count = (unsigned int)(pixelData[f].size()) / 4;
+		for ( unsigned int j = 0; j < count; ++j, px += 4 ) {
+			const unsigned int a = px[3];
+			//Rounded division by 255
+			for ( unsigned int c = 0; c < 3; ++c ) {
+				unsigned int v = px[c] * a + 128;
+				px[c] = byte( ( v + (v >> 8) ) >> 8 );
+			}
 		}
 	}
 }
@@ -148,4 +148,19 @@ void NiPosData::NormalizeKeys( float phase, float frequency ) {
 	NormalizeKeyVector( this->data.keys, phase, frequency );
 }
 
+Vector3 NiPosData::Evaluate( float time, unsigned int * hint ) const {
+	if ( data.keys.empty() ) {
+		return Vector3( 0.0f, 0.0f, 0.0f );
+	}
+	return InterpolateKeys( data.keys, data.interpolation, time, hint );
+}
+
+static float Vector3KeyDistance( const Vector3 & a, const Vector3 & b ) {
+	return ( a - b ).Magnitude();
+}
+
+void NiPosData::ReduceKeys( float tolerance ) {
+	data.keys = Niflib::ReduceKeys( data.keys, data.interpolation, tolerance, &Vector3KeyDistance );
+}
+
 //--END CUSTOM CODE--//
@@ -135,4 +135,20 @@ std::list<NiObject *> NiRenderObject::GetPtrs() const {
 
 //--BEGIN MISC CUSTOM CODE--//
 
+vector<MaterialData> NiRenderObject::GetMaterials() const {
+	return materialData;
+}
+
+void NiRenderObject::SetMaterials( const vector<MaterialData> & value ) {
+	materialData = value;
+}
+
+int NiRenderObject::GetActiveMaterial() const {
+	return activeMaterial;
+}
+
+void NiRenderObject::SetActiveMaterial( int value ) {
+	activeMaterial = value;
+}
+
 //--END CUSTOM CODE--//
@@ -259,8 +259,8 @@ Matrix44 NiSkinData::GetBoneTransform( unsigned int bone_index ) const {
 	return Matrix44( boneList[bone_index].skinTransform.translation, boneList[bone_index].skinTransform.rotation, boneList[bone_index].skinTransform.scale );
 }
 
-vector<SkinWeight> NiSkinData::GetBoneWeights( unsigned int bone_index ) const {
-	if ( bone_index > boneList.size() ) {
+const vector<SkinWeight> & NiSkinData::GetBoneWeights( unsigned int bone_index ) const {
+	if ( bone_index >= boneList.size() ) {
 		throw runtime_error( "The specified bone index was larger than the number of bones in this NiSkinData." );
 	}
 
@@ -287,6 +287,15 @@ void NiSkinData::SetBoneWeights( unsigned int bone_index, const vector<SkinWeigh
 	boneList[bone_index].vertexWeights = weights;
 }
 
+void NiSkinData::SwapBoneWeights( unsigned int bone_index, vector<SkinWeight> & weights ) {
+	if ( bone_index >= boneList.size() ) {
+		throw runtime_error( "The specified bone index was larger than the number of bones in this NiSkinData." );
+	}
+
+	hasVertexWeights = true;
+	boneList[bone_index].vertexWeights.swap( weights );
+}
+
 Matrix44 NiSkinData::GetOverallTransform() const {
 	return Matrix44( skinTransform.translation, skinTransform.rotation, skinTransform.scale );
 }
@@ -743,7 +743,7 @@ NiSkinPartition::NiSkinPartition(Ref<NiTriBasedGeom> shape) {
    for (int i=0; i<totalBones; ++i) {
       boneMap[i] = i;
 
-      vector<SkinWeight> skinWeights = skinData->GetBoneWeights(i);
+      const vector<SkinWeight> & skinWeights = skinData->GetBoneWeights(i);
       for (vector<SkinWeight>::const_iterator skinWeight = skinWeights.begin(); skinWeight != skinWeights.end(); ++skinWeight) {
          WeightList& vertexWeight = vertexWeights[skinWeight->index];
          BoneList& boneIndex = boneIndexList[skinWeight->index];
@@ -911,7 +911,7 @@ NiSkinPartition::NiSkinPartition(Ref<NiTriBasedGeom> shape, int maxBonesPerParti
    }
 
       // read in the weights from NiSkinData
-   vector<Vector3> verts = geomData->GetVertices();
+   const vector<Vector3> & verts = geomData->GetVertices();
    vector< BoneWeightList > weights;
    if (verts.empty()){
       throw runtime_error( "Attempted to generate a skin partition on a mesh with no vertices." );
@@ -927,7 +927,7 @@ NiSkinPartition::NiSkinPartition(Ref<NiTriBasedGeom> shape, int maxBonesPerParti
    int numBones = skinData->GetBoneCount();
    for ( int bone = 0; bone < numBones; bone++ )
    {
-      vector<SkinWeight> vertexWeights = skinData->GetBoneWeights(bone);
+      const vector<SkinWeight> & vertexWeights = skinData->GetBoneWeights(bone);
       for (int r = 0; r < int(vertexWeights.size()); ++r ){
          int vertex = vertexWeights[r].index;
          float weight = vertexWeights[r].weight;
@@ -240,4 +240,53 @@ std::list<NiObject *> NiSkinningMeshModifier::GetPtrs() const {
 
 //--BEGIN MISC CUSTOM CODE--//
 
+unsigned short NiSkinningMeshModifier::GetFlags() const {
+	return flags;
+}
+
+void NiSkinningMeshModifier::SetFlags( unsigned short value ) {
+	flags = value;
+}
+
+Ref<NiAVObject> NiSkinningMeshModifier::GetSkeletonRoot() const {
+	return skeletonRoot;
+}
+
+void NiSkinningMeshModifier::SetSkeletonRoot( NiAVObject * value ) {
+	skeletonRoot = value;
+}
+
+SkinTransform NiSkinningMeshModifier::GetSkeletonTransform() const {
+	return skeletonTransform;
+}
+
+void NiSkinningMeshModifier::SetSkeletonTransform( const SkinTransform & value ) {
+	skeletonTransform = value;
+}
+
+vector< Ref<NiAVObject> > NiSkinningMeshModifier::GetBones() const {
+	vector< Ref<NiAVObject> > result( bones.size() );
+	for ( unsigned int i = 0; i < bones.size(); ++i ) {
+		result[i] = bones[i];
+	}
+	return result;
+}
+
+vector<SkinTransform> NiSkinningMeshModifier::GetBoneTransforms() const {
+	return boneTransforms;
+}
+
+void NiSkinningMeshModifier::SetBones( const vector< Ref<NiAVObject> > & value, const vector<SkinTransform> & transforms ) {
+	if ( value.size() != transforms.size() ) {
+		throw runtime_error( "Each bone of a skinning mesh modifier needs a bone transform." );
+	}
+	bones.resize( value.size() );
+	for ( unsigned int i = 0; i < value.size(); ++i ) {
+		bones[i] = value[i];
+	}
+	boneTransforms = transforms;
+	boneBounds.clear();
+	flags &= ~0x0002;
+}
+
 //--END CUSTOM CODE--//
@@ -15,6 +15,9 @@ All rights reserved.  Please see niflib.h for license. */
 #include "../../include/NIF_IO.h"
 #include "../../include/obj/NiStringPalette.h"
 #include "../../include/gen/StringPalette.h"
+#ifdef NIFLIB_CXX11
+#include <unordered_map>
+#endif
 using namespace Niflib;
 
 //Definition of TYPE constant
@@ -47,6 +50,7 @@ void NiStringPalette::Read( istream& in, list<unsigned int> & link_stack, const
 	NifStream( palette.length, in, info );
 
 	//--BEGIN POST-READ CUSTOM CODE--//
+	subStrIndex.clear();
 	//--END CUSTOM CODE--//
 }
 
@@ -100,12 +104,30 @@ std::list<NiObject *> NiStringPalette::GetPtrs() const {
 
 //--BEGIN MISC CUSTOM CODE--//
 
+struct NiStringPalette::SubStrIndex::Impl {
+#ifdef NIFLIB_CXX11
+	typedef std::unordered_map<string,unsigned int> Map;
+#else
+	typedef map<string,unsigned int> Map;
+#endif
+	Map offsets;
+	/*! The number of palette characters covered by the index. */
+	unsigned int indexedSize;
+	Impl() : indexedSize(0) {}
+};
+
+void NiStringPalette::SubStrIndex::clear() {
+	delete impl;
+	impl = NULL;
+}
+
 string NiStringPalette::GetPaletteString() const {
 	return palette.palette;
 }
 	
 void NiStringPalette::SetPaletteString( const string & n ) {
 	palette.palette = n;
+	subStrIndex.clear();
 }
 
 string NiStringPalette::GetSubStr( short offset ) const {
@@ -127,18 +149,69 @@ string NiStringPalette::GetSubStr( short offset ) const {
 }
 
 unsigned int NiStringPalette::AddSubStr( const string & n ) {
-	//Search for the string
-   //  When searching for strings also search for ending null.
-	unsigned int offset = (unsigned int)palette.palette.find( n.c_str(), 0, n.size()+1 );
-	
-	//If string was not found, append it
-	if ( offset == 0xFFFFFFFF ) {
-		offset = (unsigned int)palette.palette.size();
-		palette.palette.append( n + '\0' );
+	//A string with a null in it is never a whole string of the palette, so
+	//  search for it, ending null included.
+	if ( n.find( '\0' ) != string::npos ) {
+		unsigned int offset = (unsigned int)palette.palette.find( n.c_str(), 0, n.size()+1 );
+		if ( offset == 0xFFFFFFFF ) {
+			offset = (unsigned int)palette.palette.size();
+			palette.palette.append( n + '\0' );
+		}
+		return offset;
 	}
 
-	//Return the offset where the string was found or appended
+	//The index holds every whole string in the palette, so a string that is
+	//  not in it is appended
+	updateIndex();
+	SubStrIndex::Impl & index = *subStrIndex.impl;
+	SubStrIndex::Impl::Map::iterator it = index.offsets.find( n );
+	if ( it != index.offsets.end() ) {
+		return it->second;
+	}
+	unsigned int offset = (unsigned int)palette.palette.size();
+	palette.palette.append( n + '\0' );
+	index.offsets.insert( pair<const string,unsigned int>( n, offset ) );
+	index.indexedSize = (unsigned int)palette.palette.size();
 	return offset;
 }
 
+vector<unsigned int> NiStringPalette::AddSubStrs( const vector<string> & strings ) {
+	//Reserve room for the worst case, where every string is new
+	size_t total = palette.palette.size();
+	for ( unsigned int i = 0; i < strings.size(); ++i ) {
+		total += strings[i].size() + 1;
+	}
+	palette.palette.reserve( total );
+
+	vector<unsigned int> offsets( strings.size() );
+	for ( unsigned int i = 0; i < strings.size(); ++i ) {
+		offsets[i] = AddSubStr( strings[i] );
+	}
+	return offsets;
+}
+
+void NiStringPalette::updateIndex() {
+	//The palette was replaced or shortened behind the index's back
+	if ( subStrIndex.impl != NULL && subStrIndex.impl->indexedSize > palette.palette.size() ) {
+		subStrIndex.clear();
+	}
+	if ( subStrIndex.impl == NULL ) {
+		subStrIndex.impl = new SubStrIndex::Impl;
+	}
+
+	//Index each complete string that was added since the last update.  A
+	//trailing string without its null is left for later.
+	SubStrIndex::Impl & index = *subStrIndex.impl;
+	const string & pal = palette.palette;
+	while ( index.indexedSize < pal.size() ) {
+		size_t end = pal.find( '\0', index.indexedSize );
+		if ( end == string::npos ) {
+			break;
+		}
+		//insert keeps the first offset of a string that is in the palette twice
+		index.offsets.insert( pair<const string,unsigned int>( pal.substr( index.indexedSize, end - index.indexedSize ), index.indexedSize ) );
+		index.indexedSize = (unsigned int)(end + 1);
+	}
+}
+
 //--END CUSTOM CODE--//
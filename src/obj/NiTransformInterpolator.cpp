@@ -188,4 +188,43 @@ void NiTransformInterpolator::NormalizeKeys( float phase, float frequency ) {
 	}
 }
 
+void NiTransformInterpolator::ReduceKeys( float translate_tolerance, float rotate_tolerance, float scale_tolerance ) {
+	if ( data == NULL ) {
+		return;
+	}
+	data->ReduceKeys( translate_tolerance, rotate_tolerance, scale_tolerance );
+
+	//Move constant tracks into the pose
+	vector< Key<Vector3> > trans_keys = data->GetTranslateKeys();
+	if ( trans_keys.size() == 1 ) {
+		translation = trans_keys[0].data;
+		data->SetTranslateKeys( vector< Key<Vector3> >() );
+	}
+	vector< Key<float> > scale_keys = data->GetScaleKeys();
+	if ( scale_keys.size() == 1 ) {
+		scale = scale_keys[0].data;
+		data->SetScaleKeys( vector< Key<float> >() );
+	}
+	if ( data->GetRotateType() == XYZ_ROTATION_KEY ) {
+		vector< Key<float> > x_keys = data->GetXRotateKeys(), y_keys = data->GetYRotateKeys(), z_keys = data->GetZRotateKeys();
+		if ( x_keys.size() + y_keys.size() + z_keys.size() > 0 && x_keys.size() <= 1 && y_keys.size() <= 1 && z_keys.size() <= 1 ) {
+			rotation = data->EvaluateRotation( 0.0f );
+			data->SetXRotateKeys( vector< Key<float> >() );
+			data->SetYRotateKeys( vector< Key<float> >() );
+			data->SetZRotateKeys( vector< Key<float> >() );
+		}
+	} else {
+		vector< Key<Quaternion> > rot_keys = data->GetQuatRotateKeys();
+		if ( rot_keys.size() == 1 ) {
+			rotation = rot_keys[0].data;
+			data->SetQuatRotateKeys( vector< Key<Quaternion> >() );
+		}
+	}
+
+	if ( data->GetTranslateKeys().empty() && data->GetScaleKeys().empty() && data->GetQuatRotateKeys().empty()
+		&& data->GetXRotateKeys().empty() && data->GetYRotateKeys().empty() && data->GetZRotateKeys().empty() ) {
+		data = NULL;
+	}
+}
+
 //--END CUSTOM CODE--//
@@ -152,10 +152,10 @@ void NiTriBasedGeom::UpdateTangentSpace(int method) {
 	}
 
 	//Get mesh data from data object
-	vector<Vector3> verts = niTriGeomData->GetVertices();
-	vector<Vector3> norms = niTriGeomData->GetNormals();
+	const vector<Vector3> & verts = niTriGeomData->GetVertices();
+	const vector<Vector3> & norms = niTriGeomData->GetNormals();
 	vector<Triangle> tris = niTriGeomData->GetTriangles();
-	vector<TexCoord> uvs = niTriGeomData->GetUVSet(0);
+	const vector<TexCoord> & uvs = niTriGeomData->GetUVSet(0);
 
 	/* check for data validity */
 	if(
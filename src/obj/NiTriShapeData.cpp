@@ -284,4 +284,15 @@ void NiTriShapeData::SetTriangles( const vector<Triangle> & in ) {
 	numTrianglePoints = numTriangles * 3;
 }
 
+void NiTriShapeData::SwapTriangles( vector<Triangle> & in ) {
+	if ( in.size() > 65535 ) {
+		throw runtime_error("Invalid Triangle Count: must be between 0 and 65535.");
+	}
+
+	triangles.swap( in );
+	hasTriangles = ( triangles.size() != 0 );
+	numTriangles = (unsigned int)(triangles.size());
+	numTrianglePoints = numTriangles * 3;
+}
+
 //--END CUSTOM CODE--//
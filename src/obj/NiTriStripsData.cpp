@@ -213,7 +213,7 @@ void NiTriStripsData::SetStripCount(int n) {
 }
 
 //Getters
-vector<unsigned short> NiTriStripsData::GetStrip( int index ) const {
+const vector<unsigned short> & NiTriStripsData::GetStrip( int index ) const {
 	return points[index];
 }
 
@@ -268,6 +268,13 @@ void NiTriStripsData::SetStrip( int index, const vector<unsigned short> & in ) {
 	numTriangles = CalcTriangleCount();
 }
 
+void NiTriStripsData::SwapStrip( int index, vector<unsigned short> & in ) {
+	points[index].swap( in );
+
+	//Recalculate Triangle Count
+	numTriangles = CalcTriangleCount();
+}
+
 unsigned short NiTriStripsData::CalcTriangleCount() const {
 
 	//Calculate number of triangles
@@ -8,7 +8,10 @@ All rights reserved.  Please see niflib.h for license. */
 //-----------------------------------NOTICE----------------------------------//
 
 //--BEGIN FILE HEAD CUSTOM CODE--//
-
+#include "../../NvTriStrip/NvTriStrip.h"
+#include <algorithm>
+#include <math.h>
+using namespace NvTriStrip;
 //--END CUSTOM CODE--//
 
 #include "../../include/FixLink.h"
@@ -537,4 +540,322 @@ unsigned int bhkCompressedMeshShapeData::SetChunks(vector<bhkCMSDChunk>& theChun
 	return numChunks;
 }
 
+////////////////////////////////////////////////
+// Triangle mesh compression
+
+/*! Maximum number of triangles stored in a single chunk. */
+static const unsigned int CMS_MAX_CHUNK_TRIANGLES = 255;
+
+/*! Orders triangle indices by their centroid along one axis. */
+struct CmsCenterLess {
+	const vector<Vector3> & centers;
+	int axis;
+	CmsCenterLess( const vector<Vector3> & c, int a ) : centers(c), axis(a) {}
+	bool operator()( unsigned int a, unsigned int b ) const {
+		return centers[a][axis] < centers[b][axis];
+	}
+};
+
+static Vector3 CmsRotate( const QuaternionXYZW & q, const Vector3 & v ) {
+	// v + 2w(q x v) + 2 q x (q x v)
+	Vector3 u( q.x, q.y, q.z );
+	Vector3 t = u.CrossProduct( v ) * 2.0f;
+	return v + t * q.w + u.CrossProduct( t );
+}
+
+static void CmsBounds( const vector<Vector3> & vertices, const vector<Triangle> & triangles, const vector<unsigned int> & tris, Vector3 & lo, Vector3 & hi ) {
+	lo = hi = vertices[triangles[tris[0]].v1];
+	for ( unsigned int i = 0; i < tris.size(); ++i ) {
+		for ( int k = 0; k < 3; ++k ) {
+			const Vector3 & v = vertices[triangles[tris[i]][k]];
+			for ( int a = 0; a < 3; ++a ) {
+				lo[a] = min( lo[a], v[a] );
+				hi[a] = max( hi[a], v[a] );
+			}
+		}
+	}
+}
+
+void bhkCompressedMeshShapeData::GetTriangleMesh( vector<Vector3> & out_vertices, vector<Triangle> & out_triangles, vector<unsigned int> * out_materials ) const {
+	out_vertices.clear();
+	out_triangles.clear();
+	if ( out_materials != NULL ) {
+		out_materials->clear();
+	}
+
+	//Count the vertices first so the output is allocated once
+	size_t total = bigVerts.size();
+	for ( size_t c = 0; c < chunks.size(); ++c ) {
+		total += chunks[c].vertices.size() / 3;
+	}
+	if ( total > 65535 ) {
+		throw runtime_error("Compressed mesh has more than 65535 vertices and cannot be expressed as a triangle list.");
+	}
+	out_vertices.resize( total );
+
+	size_t base = 0;
+	for ( size_t c = 0; c < chunks.size(); ++c ) {
+		const bhkCMSDChunk & chunk = chunks[c];
+		const size_t count = chunk.vertices.size() / 3;
+		const unsigned short * q = count ? &chunk.vertices[0] : NULL;
+		const float tx = chunk.translation.x, ty = chunk.translation.y, tz = chunk.translation.z;
+		const float step = error;
+		Vector3 * v = count ? &out_vertices[base] : NULL;
+
+		//Dequantize in one flat pass over the shorts
+		for ( size_t i = 0; i < count; ++i ) {
+			v[i].x = tx + float(q[3 * i + 0]) * step;
+			v[i].y = ty + float(q[3 * i + 1]) * step;
+			v[i].z = tz + float(q[3 * i + 2]) * step;
+		}
+
+		//Move the chunk by its transform, if it has one
+		if ( chunk.transformIndex < chunkTransforms.size() ) {
+			const bhkCMSDTransform & xf = chunkTransforms[chunk.transformIndex];
+			Vector3 t( xf.translation.x, xf.translation.y, xf.translation.z );
+			for ( size_t i = 0; i < count; ++i ) {
+				v[i] = CmsRotate( xf.rotation, v[i] ) + t;
+			}
+		}
+
+		//Strips come first in the index list, the remaining indices are a triangle list
+		size_t pos = 0;
+		for ( size_t s = 0; s < chunk.strips.size(); ++s ) {
+			size_t len = chunk.strips[s];
+			if ( pos + len > chunk.indices.size() ) {
+				throw runtime_error("Compressed mesh chunk has strips that run past its indices.");
+			}
+			for ( size_t i = 2; i < len; ++i ) {
+				Triangle t;
+				if ( i % 2 == 0 ) {
+					t.Set( chunk.indices[pos + i - 2], chunk.indices[pos + i - 1], chunk.indices[pos + i] );
+				} else {
+					t.Set( chunk.indices[pos + i], chunk.indices[pos + i - 1], chunk.indices[pos + i - 2] );
+				}
+				if ( t.v1 != t.v2 && t.v2 != t.v3 && t.v1 != t.v3 ) {
+					out_triangles.push_back( Triangle( (unsigned short)(base + t.v1), (unsigned short)(base + t.v2), (unsigned short)(base + t.v3) ) );
+					if ( out_materials != NULL ) {
+						out_materials->push_back( chunk.materialIndex );
+					}
+				}
+			}
+			pos += len;
+		}
+		for ( ; pos + 2 < chunk.indices.size(); pos += 3 ) {
+			out_triangles.push_back( Triangle( (unsigned short)(base + chunk.indices[pos]), (unsigned short)(base + chunk.indices[pos + 1]), (unsigned short)(base + chunk.indices[pos + 2]) ) );
+			if ( out_materials != NULL ) {
+				out_materials->push_back( chunk.materialIndex );
+			}
+		}
+		base += count;
+	}
+
+	//Big triangles index the uncompressed big vertices
+	for ( size_t i = 0; i < bigVerts.size(); ++i ) {
+		out_vertices[base + i] = Vector3( bigVerts[i].x, bigVerts[i].y, bigVerts[i].z );
+	}
+	for ( size_t i = 0; i < bigTris.size(); ++i ) {
+		const bhkCMSDBigTris & t = bigTris[i];
+		out_triangles.push_back( Triangle( (unsigned short)(base + t.triangle1), (unsigned short)(base + t.triangle2), (unsigned short)(base + t.triangle3) ) );
+		if ( out_materials != NULL ) {
+			out_materials->push_back( t.unknownInt1 );
+		}
+	}
+
+	for ( size_t i = 0; i < out_triangles.size(); ++i ) {
+		const Triangle & t = out_triangles[i];
+		if ( t.v1 >= total || t.v2 >= total || t.v3 >= total ) {
+			throw runtime_error("Compressed mesh triangle references a vertex that does not exist.");
+		}
+	}
+}
+
+void bhkCompressedMeshShapeData::SetTriangleMesh( const vector<Vector3> & vertices, const vector<Triangle> & triangles, const vector<unsigned int> & materials, float error ) {
+	if ( error <= 0.0f ) {
+		throw runtime_error("Compressed mesh error must be positive.");
+	}
+	if ( materials.empty() == false && materials.size() != triangles.size() ) {
+		throw runtime_error("There must be one material index per triangle.");
+	}
+	if ( chunkMaterials.empty() ) {
+		bhkCMSDMaterial mat;
+		mat.skyrimMaterial = SKY_HAV_MAT_STONE;
+		mat.skyrimLayer = 1;
+		chunkMaterials.push_back( mat );
+		numMaterials = 1;
+	}
+	for ( size_t i = 0; i < materials.size(); ++i ) {
+		if ( materials[i] >= chunkMaterials.size() ) {
+			throw runtime_error("Material index is out of range of the chunk materials.");
+		}
+	}
+	for ( size_t i = 0; i < triangles.size(); ++i ) {
+		const Triangle & t = triangles[i];
+		if ( t.v1 >= vertices.size() || t.v2 >= vertices.size() || t.v3 >= vertices.size() ) {
+			throw runtime_error("Triangle references a vertex that does not exist.");
+		}
+	}
+
+	this->error = error;
+	if ( bitsPerIndex == 0 && bitsPerWIndex == 0 ) {
+		//Values used by Skyrim
+		bitsPerIndex = 17;
+		bitsPerWIndex = 18;
+		maskIndex = ( 1 << bitsPerIndex ) - 1;
+		maskWIndex = ( 1 << bitsPerWIndex ) - 1;
+	}
+	chunks.clear();
+	bigVerts.clear();
+	bigTris.clear();
+
+	//All chunks share a single identity transform
+	chunkTransforms.resize( 1 );
+	chunkTransforms[0].translation = Vector4();
+	chunkTransforms[0].rotation.x = chunkTransforms[0].rotation.y = chunkTransforms[0].rotation.z = 0.0f;
+	chunkTransforms[0].rotation.w = 1.0f;
+
+	boundsMin = boundsMax = Vector4();
+	if ( triangles.empty() ) {
+		numChunks = numBigVerts = numBigTris = 0;
+		numTransforms = 1;
+		return;
+	}
+
+	//Sort the triangles into a bucket per material; triangles too large to be
+	//quantized in a chunk become big triangles
+	const float range = 65535.0f * error;
+	map< unsigned int, vector<unsigned int> > buckets;
+	vector<unsigned int> big;
+	vector<Vector3> centers( triangles.size() );
+	vector<unsigned int> all( triangles.size() );
+	for ( unsigned int i = 0; i < triangles.size(); ++i ) {
+		const Triangle & t = triangles[i];
+		centers[i] = ( vertices[t.v1] + vertices[t.v2] + vertices[t.v3] ) / 3.0f;
+		all[i] = i;
+		Vector3 lo, hi;
+		vector<unsigned int> one( 1, i );
+		CmsBounds( vertices, triangles, one, lo, hi );
+		if ( hi.x - lo.x > range || hi.y - lo.y > range || hi.z - lo.z > range ) {
+			big.push_back( i );
+		} else {
+			buckets[ materials.empty() ? 0 : materials[i] ].push_back( i );
+		}
+	}
+
+	Vector3 lo, hi;
+	CmsBounds( vertices, triangles, all, lo, hi );
+	boundsMin = Vector4( lo.x, lo.y, lo.z, 0.0f );
+	boundsMax = Vector4( hi.x, hi.y, hi.z, 0.0f );
+
+	//Split each bucket at the centroid median until every piece fits in a chunk
+	vector< pair< unsigned int, vector<unsigned int> > > pending;
+	for ( map< unsigned int, vector<unsigned int> >::iterator it = buckets.begin(); it != buckets.end(); ++it ) {
+		pending.push_back( make_pair( it->first, it->second ) );
+	}
+	while ( pending.empty() == false ) {
+		unsigned int material = pending.back().first;
+		vector<unsigned int> tris;
+		tris.swap( pending.back().second );
+		pending.pop_back();
+
+		CmsBounds( vertices, triangles, tris, lo, hi );
+		Vector3 size = hi - lo;
+		if ( tris.size() > CMS_MAX_CHUNK_TRIANGLES || size.x > range || size.y > range || size.z > range ) {
+			int axis = 0;
+			if ( size.y > size[axis] ) axis = 1;
+			if ( size.z > size[axis] ) axis = 2;
+			size_t mid = tris.size() / 2;
+			nth_element( tris.begin(), tris.begin() + mid, tris.end(), CmsCenterLess( centers, axis ) );
+			pending.push_back( make_pair( material, vector<unsigned int>( tris.begin(), tris.begin() + mid ) ) );
+			pending.push_back( make_pair( material, vector<unsigned int>( tris.begin() + mid, tris.end() ) ) );
+			continue;
+		}
+
+		bhkCMSDChunk chunk;
+		chunk.translation = Vector4( lo.x, lo.y, lo.z, 0.0f );
+		chunk.materialIndex = material;
+		chunk.unknownShort1 = 65535;
+		chunk.transformIndex = 0;
+
+		//Remap to chunk local vertices and quantize them
+		map<unsigned short, unsigned short> local;
+		vector<unsigned short> list( tris.size() * 3 );
+		for ( size_t i = 0; i < tris.size(); ++i ) {
+			for ( int k = 0; k < 3; ++k ) {
+				unsigned short vi = triangles[tris[i]][k];
+				map<unsigned short, unsigned short>::iterator found = local.find( vi );
+				if ( found == local.end() ) {
+					unsigned short li = (unsigned short)local.size();
+					local[vi] = li;
+					for ( int a = 0; a < 3; ++a ) {
+						float q = floor( ( vertices[vi][a] - lo[a] ) / error + 0.5f );
+						chunk.vertices.push_back( (unsigned short)( min( 65535.0f, max( 0.0f, q ) ) ) );
+					}
+					list[i * 3 + k] = li;
+				} else {
+					list[i * 3 + k] = found->second;
+				}
+			}
+		}
+
+		//Strip the chunk; triangles the stripper leaves in lists follow the strips
+		PrimitiveGroup * groups = 0;
+		unsigned short num_groups = 0;
+		SetCacheSize( CACHESIZE_GEFORCE3 );
+		SetStitchStrips( false );
+		GenerateStrips( &list[0], (unsigned int)list.size(), &groups, &num_groups );
+		vector<unsigned short> loose;
+		for ( unsigned short g = 0; g < num_groups; ++g ) {
+			if ( groups[g].type == PT_STRIP ) {
+				chunk.strips.push_back( (unsigned short)groups[g].numIndices );
+				chunk.indices.insert( chunk.indices.end(), groups[g].indices, groups[g].indices + groups[g].numIndices );
+			} else if ( groups[g].type == PT_LIST ) {
+				loose.insert( loose.end(), groups[g].indices, groups[g].indices + groups[g].numIndices );
+			}
+		}
+		delete [] groups;
+		if ( num_groups == 0 ) {
+			loose = list;
+		}
+		chunk.indices.insert( chunk.indices.end(), loose.begin(), loose.end() );
+		chunk.indices2.assign( tris.size(), 0 );
+
+		chunk.numVertices = (unsigned int)chunk.vertices.size();
+		chunk.numIndices = (unsigned int)chunk.indices.size();
+		chunk.numStrips = (unsigned int)chunk.strips.size();
+		chunk.numIndices2 = (unsigned int)chunk.indices2.size();
+		chunks.push_back( chunk );
+	}
+
+	//Big triangles keep their vertices uncompressed
+	map<unsigned short, unsigned short> big_index;
+	for ( size_t i = 0; i < big.size(); ++i ) {
+		const Triangle & t = triangles[big[i]];
+		unsigned short idx[3];
+		for ( int k = 0; k < 3; ++k ) {
+			map<unsigned short, unsigned short>::iterator found = big_index.find( t[k] );
+			if ( found == big_index.end() ) {
+				idx[k] = (unsigned short)bigVerts.size();
+				big_index[t[k]] = idx[k];
+				const Vector3 & v = vertices[t[k]];
+				bigVerts.push_back( Vector4( v.x, v.y, v.z, 0.0f ) );
+			} else {
+				idx[k] = found->second;
+			}
+		}
+		bhkCMSDBigTris bt;
+		bt.triangle1 = idx[0];
+		bt.triangle2 = idx[1];
+		bt.triangle3 = idx[2];
+		bt.unknownInt1 = materials.empty() ? 0 : materials[big[i]];
+		bt.unknownShort1 = 0;
+		bigTris.push_back( bt );
+	}
+
+	numTransforms = (unsigned int)chunkTransforms.size();
+	numBigVerts = (unsigned int)bigVerts.size();
+	numBigTris = (unsigned int)bigTris.size();
+	numChunks = (unsigned int)chunks.size();
+}
+
 //--END CUSTOM CODE--//
@@ -8,6 +8,11 @@ All rights reserved.  Please see niflib.h for license. */
 //-----------------------------------NOTICE----------------------------------//
 
 //--BEGIN FILE HEAD CUSTOM CODE--//
+#include "../../include/obj/bhkPackedNiTriStripsShape.h"
+#include "../../include/obj/hkPackedNiTriStripsData.h"
+#include "../../include/gen/hkTriangle.h"
+#include <algorithm>
+#include <math.h>
 //--END CUSTOM CODE--//
 
 #include "../../include/FixLink.h"
@@ -258,6 +263,481 @@ void bhkMoppBvTreeShape::SetMoppScale( float value ) {
 	scale = value;
 }
 
+namespace Niflib {
+
+////////////////////////////////////////////////
+// Mopp code
+//
+// The mopp is a byte code program that is run against a query volume.  Every
+// coordinate test is done in 8 bit mopp coordinates, which are obtained from
+// havok coordinates as (v - origin) * scale / 65536.  Each path through the
+// program ends in an instruction that reports a shape key.
+
+enum MoppOpcode {
+	MOPP_RESCALE_FIRST = 0x01,
+	MOPP_RESCALE_LAST = 0x04,
+	MOPP_JUMP8 = 0x05,
+	MOPP_JUMP16 = 0x06,
+	MOPP_ADD_OFFSET8 = 0x09,
+	MOPP_ADD_OFFSET16 = 0x0A,
+	MOPP_SET_OFFSET32 = 0x0B,
+	MOPP_SPLIT_X = 0x10, // 0x10 - 0x12 split along x, y, z
+	MOPP_SPLIT_LAST = 0x1C, // 0x13 - 0x1C split along diagonal axes
+	MOPP_SINGLE_SPLIT_FIRST = 0x20,
+	MOPP_SINGLE_SPLIT_LAST = 0x22,
+	MOPP_SPLIT16_FIRST = 0x23,
+	MOPP_SPLIT16_LAST = 0x25,
+	MOPP_BOUND_X = 0x26, // 0x26 - 0x28 bound check along x, y, z
+	MOPP_KEY_COMPACT = 0x30, // 0x30 - 0x4F key offset encoded in the opcode
+	MOPP_KEY8 = 0x50,
+	MOPP_KEY16 = 0x51,
+	MOPP_KEY24 = 0x52,
+	MOPP_KEY32 = 0x53
+};
+
+/*! Quantized bounds and centroid of one triangle, used while building the tree. */
+struct MoppTriBounds {
+	unsigned int key;
+	int lo[3];
+	int hi[3];
+	float center[3];
+};
+
+/*! Orders triangles by their centroid along one axis. */
+struct MoppCenterLess {
+	int axis;
+	MoppCenterLess( int a ) : axis(a) {}
+	bool operator()( const MoppTriBounds & a, const MoppTriBounds & b ) const {
+		return a.center[axis] < b.center[axis];
+	}
+};
+
+/*! Selects the triangles that fall to the left of a SAH bin boundary. */
+struct MoppBinLeft {
+	int axis, split;
+	float cmin, cscale;
+	MoppBinLeft( int a, int s, float m, float sc ) : axis(a), split(s), cmin(m), cscale(sc) {}
+	bool operator()( const MoppTriBounds & t ) const {
+		return int( (t.center[axis] - cmin) * cscale ) < split;
+	}
+};
+
+static const int MOPP_SAH_BINS = 16;
+
+static int MoppQuantize( float v, float origin, float scale ) {
+	float q = floor( (v - origin) * scale / 65536.0f );
+	if ( q < 0.0f ) return 0;
+	if ( q > 255.0f ) return 255;
+	return int(q);
+}
+
+static float MoppBoxArea( const int * lo, const int * hi ) {
+	float ex = float(hi[0] - lo[0] + 1);
+	float ey = float(hi[1] - lo[1] + 1);
+	float ez = float(hi[2] - lo[2] + 1);
+	return ex * ey + ey * ez + ez * ex;
+}
+
+static void MoppPushShort( vector<byte> & code, unsigned int value ) {
+	code.push_back( byte(value >> 8) );
+	code.push_back( byte(value) );
+}
+
+static void MoppEmitKey( vector<byte> & code, unsigned int key ) {
+	if ( key > 0xFFFF ) {
+		code.push_back( MOPP_SET_OFFSET32 );
+		MoppPushShort( code, key >> 16 );
+		MoppPushShort( code, 0 );
+		key &= 0xFFFF;
+	}
+	if ( key < 0x20 ) {
+		code.push_back( byte(MOPP_KEY_COMPACT + key) );
+	} else if ( key <= 0xFF ) {
+		code.push_back( MOPP_KEY8 );
+		code.push_back( byte(key) );
+	} else {
+		code.push_back( MOPP_KEY16 );
+		MoppPushShort( code, key );
+	}
+}
+
+static void MoppEmitSplit( vector<byte> & code, int axis, int hi, int lo, const vector<byte> & left, const vector<byte> & right ) {
+	code.push_back( byte(MOPP_SPLIT_X + axis) );
+	code.push_back( byte(hi) );
+	code.push_back( byte(lo) );
+	if ( left.size() <= 0xFF ) {
+		//The else branch jumps over the then branch directly
+		code.push_back( byte(left.size()) );
+		code.insert( code.end(), left.begin(), left.end() );
+		code.insert( code.end(), right.begin(), right.end() );
+	} else if ( right.size() <= 0xFFFF ) {
+		//The then branch jumps over the else branch, which is stored first
+		code.push_back( 3 );
+		code.push_back( MOPP_JUMP16 );
+		MoppPushShort( code, (unsigned int)right.size() );
+		code.insert( code.end(), right.begin(), right.end() );
+		code.insert( code.end(), left.begin(), left.end() );
+	} else if ( left.size() <= 0xFFFF ) {
+		//Both branches start with a jump
+		code.push_back( 3 );
+		code.push_back( MOPP_JUMP16 );
+		MoppPushShort( code, 3 );
+		code.push_back( MOPP_JUMP16 );
+		MoppPushShort( code, (unsigned int)left.size() );
+		code.insert( code.end(), left.begin(), left.end() );
+		code.insert( code.end(), right.begin(), right.end() );
+	} else {
+		throw runtime_error("Mopp code is too large: both halves of a split exceed 65535 bytes.");
+	}
+}
+
+static void MoppBuildNode( vector<MoppTriBounds> & tris, size_t begin, size_t end, vector<byte> & code ) {
+	size_t count = end - begin;
+	if ( count == 1 ) {
+		MoppEmitKey( code, tris[begin].key );
+		return;
+	}
+
+	//Find the centroid and box bounds of this node
+	float cmin[3], cmax[3];
+	int blo[3], bhi[3];
+	for ( int a = 0; a < 3; ++a ) {
+		cmin[a] = cmax[a] = tris[begin].center[a];
+		blo[a] = tris[begin].lo[a];
+		bhi[a] = tris[begin].hi[a];
+	}
+	for ( size_t i = begin + 1; i < end; ++i ) {
+		for ( int a = 0; a < 3; ++a ) {
+			cmin[a] = min( cmin[a], tris[i].center[a] );
+			cmax[a] = max( cmax[a], tris[i].center[a] );
+			blo[a] = min( blo[a], tris[i].lo[a] );
+			bhi[a] = max( bhi[a], tris[i].hi[a] );
+		}
+	}
+
+	//Binned surface area heuristic over the triangle centroids
+	int best_axis = -1, best_split = 0;
+	float best_cost = 0.0f;
+	for ( int a = 0; a < 3; ++a ) {
+		if ( cmax[a] <= cmin[a] ) {
+			continue;
+		}
+		float cscale = float(MOPP_SAH_BINS) * 0.999f / ( cmax[a] - cmin[a] );
+		int bin_count[MOPP_SAH_BINS];
+		int bin_lo[MOPP_SAH_BINS][3], bin_hi[MOPP_SAH_BINS][3];
+		for ( int b = 0; b < MOPP_SAH_BINS; ++b ) {
+			bin_count[b] = 0;
+			for ( int k = 0; k < 3; ++k ) {
+				bin_lo[b][k] = 255;
+				bin_hi[b][k] = 0;
+			}
+		}
+		for ( size_t i = begin; i < end; ++i ) {
+			int b = int( (tris[i].center[a] - cmin[a]) * cscale );
+			++bin_count[b];
+			for ( int k = 0; k < 3; ++k ) {
+				bin_lo[b][k] = min( bin_lo[b][k], tris[i].lo[k] );
+				bin_hi[b][k] = max( bin_hi[b][k], tris[i].hi[k] );
+			}
+		}
+		//Sweep from the right to get the cost of every right hand side
+		float right_cost[MOPP_SAH_BINS];
+		int rlo[3] = { 255, 255, 255 }, rhi[3] = { 0, 0, 0 };
+		int rcount = 0;
+		for ( int b = MOPP_SAH_BINS - 1; b > 0; --b ) {
+			rcount += bin_count[b];
+			for ( int k = 0; k < 3; ++k ) {
+				rlo[k] = min( rlo[k], bin_lo[b][k] );
+				rhi[k] = max( rhi[k], bin_hi[b][k] );
+			}
+			right_cost[b] = rcount ? float(rcount) * MoppBoxArea( rlo, rhi ) : -1.0f;
+		}
+		//Sweep from the left and combine
+		int llo[3] = { 255, 255, 255 }, lhi[3] = { 0, 0, 0 };
+		int lcount = 0;
+		for ( int b = 1; b < MOPP_SAH_BINS; ++b ) {
+			lcount += bin_count[b - 1];
+			for ( int k = 0; k < 3; ++k ) {
+				llo[k] = min( llo[k], bin_lo[b - 1][k] );
+				lhi[k] = max( lhi[k], bin_hi[b - 1][k] );
+			}
+			if ( lcount == 0 || right_cost[b] < 0.0f ) {
+				continue;
+			}
+			float cost = float(lcount) * MoppBoxArea( llo, lhi ) + right_cost[b];
+			if ( best_axis < 0 || cost < best_cost ) {
+				best_axis = a;
+				best_split = b;
+				best_cost = cost;
+			}
+		}
+	}
+
+	size_t mid;
+	int axis;
+	if ( best_axis >= 0 ) {
+		axis = best_axis;
+		float cscale = float(MOPP_SAH_BINS) * 0.999f / ( cmax[axis] - cmin[axis] );
+		mid = partition( tris.begin() + begin, tris.begin() + end, MoppBinLeft( axis, best_split, cmin[axis], cscale ) ) - tris.begin();
+	} else {
+		//All centroids coincide, so split the node in half along its widest axis
+		axis = 0;
+		for ( int a = 1; a < 3; ++a ) {
+			if ( bhi[a] - blo[a] > bhi[axis] - blo[axis] ) {
+				axis = a;
+			}
+		}
+		mid = begin + count / 2;
+		nth_element( tris.begin() + begin, tris.begin() + mid, tris.begin() + end, MoppCenterLess(axis) );
+	}
+
+	//The then branch is taken for coordinates up to hi, the else branch from lo on
+	int hi = 0, lo = 255;
+	for ( size_t i = begin; i < mid; ++i ) {
+		hi = max( hi, tris[i].hi[axis] );
+	}
+	for ( size_t i = mid; i < end; ++i ) {
+		lo = min( lo, tris[i].lo[axis] );
+	}
+
+	vector<byte> left, right;
+	MoppBuildNode( tris, begin, mid, left );
+	MoppBuildNode( tris, mid, end, right );
+	MoppEmitSplit( code, axis, hi, lo, left, right );
+}
+
+/*! A pending path through the mopp program. */
+struct MoppTraversal {
+	size_t pos;
+	unsigned int offset;
+	bool bounded;
+};
+
+static unsigned int MoppByte( const vector<byte> & code, size_t pos ) {
+	if ( pos >= code.size() ) {
+		throw runtime_error("Malformed mopp code: instruction runs past the end of the code.");
+	}
+	return code[pos];
+}
+
+static unsigned int MoppShort( const vector<byte> & code, size_t pos ) {
+	return ( MoppByte( code, pos ) << 8 ) | MoppByte( code, pos + 1 );
+}
+
+// Runs the mopp program.  If rmin and rmax are given, only paths whose tests
+// overlap the quantized query box [rmin, rmax] are followed.
+static void MoppDecode( const vector<byte> & code, const int * rmin, const int * rmax, vector<unsigned int> & keys ) {
+	keys.clear();
+	if ( code.empty() ) {
+		return;
+	}
+
+	vector<MoppTraversal> stack;
+	MoppTraversal start;
+	start.pos = 0;
+	start.offset = 0;
+	start.bounded = ( rmin != NULL && rmax != NULL );
+	stack.push_back( start );
+
+	while ( stack.empty() == false ) {
+		MoppTraversal t = stack.back();
+		stack.pop_back();
+
+		bool done = false;
+		while ( done == false ) {
+			unsigned int op = MoppByte( code, t.pos );
+			if ( op >= MOPP_RESCALE_FIRST && op <= MOPP_RESCALE_LAST ) {
+				//Tests below this point use a rescaled frame, so stop pruning
+				t.bounded = false;
+				t.pos += 4;
+			} else if ( op == MOPP_JUMP8 ) {
+				t.pos += 2 + MoppByte( code, t.pos + 1 );
+			} else if ( op == MOPP_JUMP16 ) {
+				t.pos += 3 + MoppShort( code, t.pos + 1 );
+			} else if ( op == MOPP_ADD_OFFSET8 ) {
+				t.offset += MoppByte( code, t.pos + 1 );
+				t.pos += 2;
+			} else if ( op == MOPP_ADD_OFFSET16 ) {
+				t.offset += MoppShort( code, t.pos + 1 );
+				t.pos += 3;
+			} else if ( op == MOPP_SET_OFFSET32 ) {
+				t.offset = ( MoppShort( code, t.pos + 1 ) << 16 ) | MoppShort( code, t.pos + 3 );
+				t.pos += 5;
+			} else if ( op >= MOPP_SPLIT_X && op <= MOPP_SPLIT_LAST ) {
+				int hi = int(MoppByte( code, t.pos + 1 ));
+				int lo = int(MoppByte( code, t.pos + 2 ));
+				unsigned int jump = MoppByte( code, t.pos + 3 );
+				bool then_branch = true, else_branch = true;
+				//Diagonal splits are not pruned
+				if ( t.bounded && op < MOPP_SPLIT_X + 3 ) {
+					int axis = op - MOPP_SPLIT_X;
+					then_branch = ( rmin[axis] <= hi );
+					else_branch = ( rmax[axis] >= lo );
+				}
+				if ( else_branch ) {
+					MoppTraversal e = t;
+					e.pos = t.pos + 4 + jump;
+					stack.push_back( e );
+				}
+				if ( then_branch ) {
+					t.pos += 4;
+				} else {
+					done = true;
+				}
+			} else if ( op >= MOPP_SINGLE_SPLIT_FIRST && op <= MOPP_SINGLE_SPLIT_LAST ) {
+				//Single plane split; visit both sides
+				MoppTraversal e = t;
+				e.pos = t.pos + 3 + MoppByte( code, t.pos + 2 );
+				stack.push_back( e );
+				t.pos += 3;
+			} else if ( op >= MOPP_SPLIT16_FIRST && op <= MOPP_SPLIT16_LAST ) {
+				//Split with long jumps; visit both sides
+				MoppTraversal e = t;
+				e.pos = t.pos + 7 + MoppShort( code, t.pos + 5 );
+				stack.push_back( e );
+				t.pos += 7 + MoppShort( code, t.pos + 3 );
+			} else if ( op >= MOPP_BOUND_X && op < MOPP_BOUND_X + 3 ) {
+				int lo = int(MoppByte( code, t.pos + 1 ));
+				int hi = int(MoppByte( code, t.pos + 2 ));
+				int axis = op - MOPP_BOUND_X;
+				if ( t.bounded && ( rmax[axis] < lo || rmin[axis] > hi ) ) {
+					done = true;
+				} else {
+					t.pos += 3;
+				}
+			} else if ( op >= MOPP_KEY_COMPACT && op < MOPP_KEY8 ) {
+				keys.push_back( t.offset + op - MOPP_KEY_COMPACT );
+				done = true;
+			} else if ( op == MOPP_KEY8 ) {
+				keys.push_back( t.offset + MoppByte( code, t.pos + 1 ) );
+				done = true;
+			} else if ( op == MOPP_KEY16 ) {
+				keys.push_back( t.offset + MoppShort( code, t.pos + 1 ) );
+				done = true;
+			} else if ( op == MOPP_KEY24 ) {
+				keys.push_back( t.offset + ( ( MoppByte( code, t.pos + 1 ) << 16 ) | MoppShort( code, t.pos + 2 ) ) );
+				done = true;
+			} else if ( op == MOPP_KEY32 ) {
+				keys.push_back( t.offset + ( ( MoppShort( code, t.pos + 1 ) << 16 ) | MoppShort( code, t.pos + 3 ) ) );
+				done = true;
+			} else {
+				stringstream err;
+				err << "Malformed mopp code: unknown instruction 0x" << hex << op << " at byte " << dec << t.pos << ".";
+				throw runtime_error( err.str() );
+			}
+		}
+	}
+
+	sort( keys.begin(), keys.end() );
+	keys.erase( unique( keys.begin(), keys.end() ), keys.end() );
+}
+
+} //End namespace Niflib
+
+void bhkMoppBvTreeShape::BuildMoppCode( const vector<Vector3> & vertices, const vector<Triangle> & triangles ) {
+	//Gather the triangles that can be hit
+	vector<unsigned int> keys;
+	for ( unsigned int i = 0; i < triangles.size(); ++i ) {
+		const Triangle & t = triangles[i];
+		if ( t.v1 >= vertices.size() || t.v2 >= vertices.size() || t.v3 >= vertices.size() ) {
+			throw runtime_error("Triangle references a vertex that does not exist.");
+		}
+		if ( t.v1 != t.v2 && t.v2 != t.v3 && t.v1 != t.v3 ) {
+			keys.push_back( i );
+		}
+	}
+
+	vector<byte> code;
+	if ( keys.empty() ) {
+		origin = Vector3();
+		scale = 0.0f;
+		SetMoppCode( code );
+		return;
+	}
+
+	//Origin and scale follow the Oblivion conventions
+	Vector3 vmin = vertices[triangles[keys[0]].v1];
+	Vector3 vmax = vmin;
+	for ( unsigned int i = 0; i < keys.size(); ++i ) {
+		for ( int k = 0; k < 3; ++k ) {
+			const Vector3 & v = vertices[triangles[keys[i]][k]];
+			for ( int a = 0; a < 3; ++a ) {
+				vmin[a] = min( vmin[a], v[a] );
+				vmax[a] = max( vmax[a], v[a] );
+			}
+		}
+	}
+	float size = max( vmax.x - vmin.x, max( vmax.y - vmin.y, vmax.z - vmin.z ) );
+	origin = vmin - 0.1f;
+	scale = 256.0f * 256.0f * 254.0f / ( size + 0.2f );
+
+	//Quantize the triangle bounds
+	vector<MoppTriBounds> bounds( keys.size() );
+	for ( unsigned int i = 0; i < keys.size(); ++i ) {
+		MoppTriBounds & b = bounds[i];
+		const Triangle & t = triangles[keys[i]];
+		b.key = keys[i];
+		for ( int a = 0; a < 3; ++a ) {
+			float v1 = vertices[t.v1][a], v2 = vertices[t.v2][a], v3 = vertices[t.v3][a];
+			b.lo[a] = MoppQuantize( min( v1, min( v2, v3 ) ), origin[a], scale );
+			b.hi[a] = MoppQuantize( max( v1, max( v2, v3 ) ), origin[a], scale );
+			b.center[a] = ( v1 + v2 + v3 ) / 3.0f;
+		}
+	}
+
+	//Reject queries outside the mesh before walking the tree
+	for ( int a = 0; a < 3; ++a ) {
+		code.push_back( byte(MOPP_BOUND_X + a) );
+		code.push_back( byte(MoppQuantize( vmin[a], origin[a], scale )) );
+		code.push_back( byte(MoppQuantize( vmax[a], origin[a], scale )) );
+	}
+	MoppBuildNode( bounds, 0, bounds.size(), code );
+
+	SetMoppCode( code );
+}
+
+void bhkMoppBvTreeShape::BuildMoppCode() {
+	bhkPackedNiTriStripsShapeRef packed = DynamicCast<bhkPackedNiTriStripsShape>(shape);
+	if ( packed == NULL || packed->GetData() == NULL ) {
+		throw runtime_error("BuildMoppCode requires a bhkPackedNiTriStripsShape with data.");
+	}
+	hkPackedNiTriStripsDataRef data = packed->GetData();
+
+	//The shape keys are indices into the full triangle list, so it must not
+	//contain degenerate triangles which GetHavokTriangles leaves out.
+	vector<hkTriangle> hk_tris = data->GetHavokTriangles();
+	if ( int(hk_tris.size()) != data->GetNumFace() ) {
+		throw runtime_error("BuildMoppCode: the packed data contains degenerate triangles, remove them first.");
+	}
+	vector<Triangle> tris( hk_tris.size() );
+	for ( unsigned int i = 0; i < hk_tris.size(); ++i ) {
+		tris[i] = hk_tris[i].triangle;
+	}
+	BuildMoppCode( data->GetVertices(), tris );
+}
+
+vector<unsigned int> bhkMoppBvTreeShape::GetMoppTriangleIndices() const {
+	vector<unsigned int> keys;
+	MoppDecode( moppData, NULL, NULL, keys );
+	return keys;
+}
+
+vector<unsigned int> bhkMoppBvTreeShape::QueryMoppRay( const Vector3 & start, const Vector3 & end ) const {
+	int rmin[3], rmax[3];
+	for ( int a = 0; a < 3; ++a ) {
+		float q1 = ( start[a] - origin[a] ) * scale / 65536.0f;
+		float q2 = ( end[a] - origin[a] ) * scale / 65536.0f;
+		//Clamp so that points far outside the mopp range stay representable
+		float lo = max( -1.0f, min( 256.0f, floor( min( q1, q2 ) ) ) );
+		float hi = max( -1.0f, min( 256.0f, floor( max( q1, q2 ) ) ) );
+		rmin[a] = int(lo);
+		rmax[a] = int(hi);
+	}
+	vector<unsigned int> keys;
+	MoppDecode( moppData, rmin, rmax, keys );
+	return keys;
+}
+
 void bhkMoppBvTreeShape::CalcMassProperties( float density, bool solid, float &mass, float &volume, Vector3 &center, InertiaMatrix& inertia )
 {
 	center = Vector3(0,0,0);
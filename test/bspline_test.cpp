@@ -0,0 +1,183 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <climits> // USHRT_MAX
+
+#include "niflib.h"
+#include "obj/NiBSplineCompTransformInterpolator.h"
+#include "obj/NiBSplineData.h"
+#include "obj/NiBSplineBasisData.h"
+#include "obj/NiTransformInterpolator.h"
+#include "obj/NiTransformData.h"
+
+using namespace Niflib;
+using namespace std;
+
+// a compressed interpolator with 8 control points of translation and rotation, and no scale curve
+static NiBSplineCompTransformInterpolatorRef make_interpolator()
+{
+  const int nctrl = 8;
+  vector<short> points;
+  for (int i = 0; i < nctrl; i++) {
+    points.push_back(short(4000 * i));
+    points.push_back(short(-3000 * i));
+    points.push_back(short((i % 3) * 9000));
+  }
+  for (int i = 0; i < nctrl; i++) {
+    float angle = 0.2f * i;
+    points.push_back(short(32767 * cos(angle)));
+    points.push_back(0);
+    points.push_back(0);
+    points.push_back(short(32767 * sin(angle)));
+  }
+  NiBSplineDataRef data = new NiBSplineData;
+  data->SetShortControlPoints(points);
+  NiBSplineBasisDataRef basis = new NiBSplineBasisData;
+  basis->SetNumControlPoints(nctrl);
+
+  NiBSplineCompTransformInterpolatorRef interp = new NiBSplineCompTransformInterpolator;
+  interp->SetSplineData(data);
+  interp->SetBasisData(basis);
+  interp->SetStartTime(0.0f);
+  interp->SetStopTime(2.0f);
+  interp->SetTranslationOffset(0);
+  interp->SetTranslateMultiplier(10.0f);
+  interp->SetTranslateBias(1.0f);
+  interp->SetRotationOffset(3 * nctrl);
+  interp->SetRotationMultiplier(1.0f);
+  interp->SetRotationBias(0.0f);
+  interp->SetScaleOffset(USHRT_MAX);
+  interp->SetScale(2.0f);
+  return interp;
+}
+
+BOOST_AUTO_TEST_SUITE(bspline_test_suite)
+
+BOOST_AUTO_TEST_CASE(bspline_evaluate_test)
+{
+  NiBSplineCompTransformInterpolatorRef interp = make_interpolator();
+  // matches the generic de Boor sampling
+  vector< Key<Vector3> > keys = interp->SampleTranslateKeys(11, 3);
+  BOOST_REQUIRE_EQUAL(keys.size(), 11u);
+  for (int i = 0; i < 11; i++) {
+    Vector3 v = interp->EvaluateTranslation(0.2f * i);
+    BOOST_CHECK_SMALL(v.x - keys[i].data.x, 1e-4f);
+    BOOST_CHECK_SMALL(v.y - keys[i].data.y, 1e-4f);
+    BOOST_CHECK_SMALL(v.z - keys[i].data.z, 1e-4f);
+  }
+  // the clamped curve passes through its end points
+  vector<Vector3> control = interp->GetTranslateControlData();
+  BOOST_CHECK_SMALL(interp->EvaluateTranslation(-1.0f).y - control.front().y, 1e-4f);
+  BOOST_CHECK_SMALL(interp->EvaluateTranslation(2.0f).x - control.back().x, 1e-4f);
+  // rotations come out normalized
+  Quaternion q = interp->EvaluateRotation(0.7f);
+  BOOST_CHECK_CLOSE(q.Dot(q), 1.0f, 1e-3f);
+  BOOST_CHECK(q.z > 0.0f);
+  // no scale curve
+  BOOST_CHECK_EQUAL(interp->EvaluateScale(0.7f), 2.0f);
+}
+
+BOOST_AUTO_TEST_CASE(bspline_sample_test)
+{
+  vector<NiBSplineTransformInterpolatorRef> interps;
+  interps.push_back(StaticCast<NiBSplineTransformInterpolator>(make_interpolator()));
+  interps.push_back(StaticCast<NiBSplineTransformInterpolator>(make_interpolator()));
+  interps[1]->SetStopTime(4.0f);
+  vector<float> times;
+  for (int i = 0; i <= 30; i++)
+    times.push_back(0.1f * i);
+  vector<float> samples;
+  NiBSplineTransformInterpolator::SampleTransforms(interps, times, samples);
+  BOOST_REQUIRE_EQUAL(samples.size(), 2 * 8 * times.size());
+  const unsigned int count = times.size();
+  for (unsigned int i = 0; i < 2; i++) {
+    for (unsigned int m = 0; m < count; m++) {
+      Vector3 t = interps[i]->EvaluateTranslation(times[m]);
+      Quaternion q = interps[i]->EvaluateRotation(times[m]);
+      const float * out = &samples[i * 8 * count + m];
+      BOOST_CHECK_SMALL(out[0] - t.x, 1e-4f);
+      BOOST_CHECK_SMALL(out[2 * count] - t.z, 1e-4f);
+      BOOST_CHECK_SMALL(out[3 * count] - q.w, 1e-5f);
+      BOOST_CHECK_SMALL(out[6 * count] - q.z, 1e-5f);
+      BOOST_CHECK_EQUAL(out[7 * count], 2.0f);
+    }
+  }
+  // the same samples through the generic track sampler
+  vector<NiObjectRef> tracks(interps.begin(), interps.end());
+  vector<unsigned int> channels;
+  vector<float> track_samples;
+  SampleKeyTracks(tracks, times, channels, track_samples);
+  BOOST_CHECK_EQUAL(channels[1], 8u);
+  BOOST_CHECK(track_samples == samples);
+}
+
+BOOST_AUTO_TEST_CASE(bspline_fit_test)
+{
+  vector<float> times;
+  vector<Vector3> translations;
+  vector<Quaternion> rotations;
+  vector<float> scales;
+  for (int i = 0; i <= 60; i++) {
+    float t = i / 30.0f;
+    times.push_back(t);
+    translations.push_back(Vector3(10.0f * sin(t), t * t, 5.0f));
+    rotations.push_back(Quaternion(cos(0.4f * t), 0.0f, sin(0.4f * t), 0.0f));
+    scales.push_back(1.5f);
+  }
+  NiBSplineCompTransformInterpolatorRef interp = new NiBSplineCompTransformInterpolator;
+  interp->FitTransforms(times, translations, rotations, scales, 0.01f, 0.002f, 0.001f);
+  BOOST_CHECK_EQUAL(interp->GetStopTime(), 2.0f);
+  int nctrl = interp->GetNumControlPoints();
+  BOOST_CHECK(nctrl >= 4 && nctrl < 20);
+  // constant scale needs no curve
+  BOOST_CHECK(interp->GetScaleControlData().empty());
+  BOOST_CHECK_EQUAL(interp->GetSplineData()->GetShortControlPoints().size(), 7u * nctrl);
+  for (unsigned int i = 0; i < times.size(); i++) {
+    BOOST_CHECK((interp->EvaluateTranslation(times[i]) - translations[i]).Magnitude() <= 0.01f);
+    BOOST_CHECK(fabs(interp->EvaluateRotation(times[i]).Dot(rotations[i])) >= cos(0.001f));
+    BOOST_CHECK_EQUAL(interp->EvaluateScale(times[i]), 1.5f);
+  }
+  // tighter tolerances need more control points
+  NiBSplineCompTransformInterpolatorRef fine = new NiBSplineCompTransformInterpolator;
+  fine->FitTransforms(times, translations, rotations, scales, 0.0005f, 0.002f, 0.001f);
+  BOOST_CHECK(fine->GetNumControlPoints() > nctrl);
+
+  // fit to linear translation keys of a transform interpolator
+  NiTransformDataRef data = new NiTransformData;
+  vector< Key<Vector3> > keys(3);
+  keys[0].time = 0.0f;
+  keys[0].data = Vector3(0.0f, 0.0f, 0.0f);
+  keys[1].time = 1.0f;
+  keys[1].data = Vector3(1.0f, 2.0f, 0.0f);
+  keys[2].time = 2.0f;
+  keys[2].data = Vector3(1.0f, 3.0f, 0.0f);
+  data->SetTranslateType(LINEAR_KEY);
+  data->SetTranslateKeys(keys);
+  NiTransformInterpolatorRef source = new NiTransformInterpolator;
+  source->SetData(data);
+  source->SetRotation(Quaternion(1.0f, 0.0f, 0.0f, 0.0f));
+  source->SetScale(1.0f);
+  interp->FitTransforms(source, 30.0f, 0.02f, 0.002f, 0.001f);
+  BOOST_CHECK(interp->GetQuatRotateControlData().empty());
+  for (unsigned int i = 0; i < keys.size(); i++)
+    BOOST_CHECK((interp->EvaluateTranslation(keys[i].time) - keys[i].data).Magnitude() <= 0.02f);
+  BOOST_CHECK_EQUAL(interp->EvaluateRotation(0.5f).w, 1.0f);
+
+  // the scale curve follows 7 values per control point, which its 16 bit offset
+  // can only address for up to 9362 control points
+  times.clear();
+  translations.clear();
+  rotations.clear();
+  scales.clear();
+  for (int i = 0; i < 12000; i++) {
+    float t = i / 30.0f;
+    times.push_back(t);
+    translations.push_back(Vector3((i % 2) ? 1.0f : -1.0f, 0.0f, 0.0f));
+    rotations.push_back(Quaternion(cos(0.4f * t), 0.0f, sin(0.4f * t), 0.0f));
+    scales.push_back(1.0f + 0.001f * t);
+  }
+  BOOST_CHECK_THROW(interp->FitTransforms(times, translations, rotations, scales, 0.01f, 0.002f, 0.001f), runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
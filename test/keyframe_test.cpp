@@ -0,0 +1,586 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include "niflib.h"
+#include "obj/NiTransformData.h"
+#include "obj/NiFloatData.h"
+#include "obj/NiBoolData.h"
+#include "obj/NiTransformInterpolator.h"
+#include "obj/NiTransformController.h"
+#include "obj/NiControllerSequence.h"
+#include "obj/NiNode.h"
+#include "obj/NiStringPalette.h"
+#include "gen/ControllerLink.h"
+#include "obj/NiControllerManager.h"
+#include "obj/NiDefaultAVObjectPalette.h"
+#include "kfm.h"
+#include "PoseEvaluator.h"
+#include "MorphEvaluator.h"
+#include "obj/NiFloatInterpolator.h"
+#include "obj/NiParticleSystem.h"
+#include "obj/NiPSysBoxEmitter.h"
+#include "obj/NiPSysPositionModifier.h"
+#include "obj/NiPSysGravityModifier.h"
+#include "obj/NiPSysAgeDeathModifier.h"
+#include "obj/NiPSysEmitterCtlr.h"
+#include <cstdio>
+#include <cfloat>
+
+using namespace Niflib;
+using namespace std;
+
+template <class T>
+static Key<T> make_key(float time, T data)
+{
+  Key<T> key;
+  key.time = time;
+  key.data = key.forward_tangent = key.backward_tangent = data;
+  key.tension = key.bias = key.continuity = 0.0f;
+  return key;
+}
+
+BOOST_AUTO_TEST_SUITE(keyframe_test_suite)
+
+BOOST_AUTO_TEST_CASE(interpolate_keys_test)
+{
+  vector< Key<float> > keys;
+  for (int i = 0; i < 5; i++)
+    keys.push_back(make_key(float(i), 2.0f * i));
+  BOOST_CHECK_CLOSE(InterpolateKeys(keys, LINEAR_KEY, 1.25f), 2.5f, 1e-4f);
+  // clamped outside the keys
+  BOOST_CHECK_EQUAL(InterpolateKeys(keys, LINEAR_KEY, -1.0f), 0.0f);
+  BOOST_CHECK_EQUAL(InterpolateKeys(keys, LINEAR_KEY, 9.0f), 8.0f);
+  BOOST_CHECK_EQUAL(InterpolateKeys(keys, CONST_KEY, 1.9f), 2.0f);
+  // TBC through evenly spaced keys on a line stays on the line
+  BOOST_CHECK_CLOSE(InterpolateKeys(keys, TBC_KEY, 2.3f), 4.6f, 1e-3f);
+  // quadratic keys use the stored tangents
+  for (int i = 0; i < 5; i++)
+    keys[i].forward_tangent = keys[i].backward_tangent = 0.0f;
+  BOOST_CHECK_CLOSE(InterpolateKeys(keys, QUADRATIC_KEY, 1.5f), 3.0f, 1e-4f);
+  BOOST_CHECK_CLOSE(InterpolateKeys(keys, QUADRATIC_KEY, 1.25f), 2.3125f, 1e-4f);
+  // the hint gives the same results for increasing and jumping times
+  unsigned int hint = 0;
+  float times[] = { 0.5f, 0.7f, 1.2f, 3.9f, 0.1f, 4.0f };
+  for (int i = 0; i < 6; i++)
+    BOOST_CHECK_EQUAL(InterpolateKeys(keys, LINEAR_KEY, times[i], &hint), InterpolateKeys(keys, LINEAR_KEY, times[i]));
+  BOOST_CHECK_EQUAL(hint, 4u);
+  keys.clear();
+  BOOST_CHECK_THROW(InterpolateKeys(keys, LINEAR_KEY, 0.0f), runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(transform_data_test)
+{
+  NiTransformDataRef data = new NiTransformData;
+  BOOST_CHECK_EQUAL(data->EvaluateScale(1.0f), 1.0f);
+  BOOST_CHECK_EQUAL(data->EvaluateRotation(1.0f).w, 1.0f);
+
+  // quarter turn about z
+  const float s = sqrt(0.5f);
+  vector< Key<Quaternion> > rot;
+  rot.push_back(make_key(0.0f, Quaternion(1.0f, 0.0f, 0.0f, 0.0f)));
+  rot.push_back(make_key(1.0f, Quaternion(s, 0.0f, 0.0f, s)));
+  data->SetRotateType(LINEAR_KEY);
+  data->SetQuatRotateKeys(rot);
+  Quaternion q = data->EvaluateRotation(0.5f);
+  BOOST_CHECK_CLOSE(q.w, cos(3.14159265f / 8.0f), 1e-3f);
+  BOOST_CHECK_CLOSE(q.z, sin(3.14159265f / 8.0f), 1e-3f);
+  // squad between two keys follows the same arc
+  data->SetRotateType(QUADRATIC_KEY);
+  q = data->EvaluateRotation(0.5f);
+  BOOST_CHECK_CLOSE(q.z, sin(3.14159265f / 8.0f), 1e-2f);
+
+  // the same rotation as separate axis keys
+  vector< Key<float> > angle;
+  angle.push_back(make_key(0.0f, 0.0f));
+  angle.push_back(make_key(1.0f, 3.14159265f / 2.0f));
+  data->SetRotateType(XYZ_ROTATION_KEY);
+  data->SetZRotateType(LINEAR_KEY);
+  data->SetZRotateKeys(angle);
+  q = data->EvaluateRotation(0.5f);
+  BOOST_CHECK_CLOSE(q.z, sin(3.14159265f / 8.0f), 1e-3f);
+}
+
+BOOST_AUTO_TEST_CASE(sample_tracks_test)
+{
+  NiFloatDataRef fdata = new NiFloatData;
+  vector< Key<float> > fkeys;
+  fkeys.push_back(make_key(0.0f, 0.0f));
+  fkeys.push_back(make_key(1.0f, 1.0f));
+  fdata->SetKeyType(LINEAR_KEY);
+  fdata->SetKeys(fkeys);
+  NiBoolDataRef bdata = new NiBoolData;
+  vector< Key<unsigned char> > bkeys;
+  bkeys.push_back(make_key(0.0f, (unsigned char)0));
+  bkeys.push_back(make_key(0.5f, (unsigned char)1));
+  bdata->SetKeys(bkeys);
+  NiTransformDataRef tdata = new NiTransformData;
+
+  vector<NiObjectRef> tracks;
+  tracks.push_back(StaticCast<NiObject>(fdata));
+  tracks.push_back(StaticCast<NiObject>(tdata));
+  tracks.push_back(StaticCast<NiObject>(bdata));
+  vector<float> times;
+  for (int i = 0; i <= 4; i++)
+    times.push_back(0.25f * i);
+  vector<unsigned int> channels;
+  vector<float> samples;
+  SampleKeyTracks(tracks, times, channels, samples);
+  BOOST_REQUIRE_EQUAL(channels.size(), 3u);
+  BOOST_CHECK_EQUAL(channels[1], 1u);
+  BOOST_CHECK_EQUAL(channels[2], 9u);
+  BOOST_REQUIRE_EQUAL(samples.size(), 50u);
+  BOOST_CHECK_EQUAL(samples[3], 0.75f);
+  // rotation w and scale of the empty transform
+  BOOST_CHECK_EQUAL(samples[(1 + 3) * 5 + 2], 1.0f);
+  BOOST_CHECK_EQUAL(samples[(1 + 7) * 5 + 2], 1.0f);
+  BOOST_CHECK_EQUAL(samples[9 * 5 + 1], 0.0f);
+  BOOST_CHECK_EQUAL(samples[9 * 5 + 2], 1.0f);
+}
+
+BOOST_AUTO_TEST_CASE(reduce_keys_test)
+{
+  // a straight line with one bend keeps the ends and the bend
+  NiFloatDataRef fdata = new NiFloatData;
+  vector< Key<float> > fkeys;
+  for (int i = 0; i <= 20; i++)
+    fkeys.push_back(make_key(i / 10.0f, i <= 10 ? float(i) : 20.0f - i));
+  fdata->SetKeyType(LINEAR_KEY);
+  fdata->SetKeys(fkeys);
+  fdata->ReduceKeys(0.001f);
+  BOOST_REQUIRE_EQUAL(fdata->GetKeys().size(), 3u);
+  BOOST_CHECK_EQUAL(fdata->GetKeys()[1].data, 10.0f);
+
+  // a smooth TBC curve stays within the tolerance at every original key
+  fkeys.clear();
+  for (int i = 0; i <= 60; i++)
+    fkeys.push_back(make_key(i / 30.0f, sin(i / 30.0f)));
+  fdata->SetKeyType(TBC_KEY);
+  fdata->SetKeys(fkeys);
+  fdata->ReduceKeys(0.001f);
+  BOOST_CHECK(fdata->GetKeys().size() < 20);
+  for (unsigned int i = 0; i < fkeys.size(); i++)
+    BOOST_CHECK(fabs(fdata->Evaluate(fkeys[i].time) - fkeys[i].data) <= 0.001f);
+
+  // constant tracks move into the interpolator pose
+  NiTransformDataRef tdata = new NiTransformData;
+  vector< Key<Vector3> > tkeys;
+  vector< Key<Quaternion> > rkeys;
+  for (int i = 0; i <= 30; i++) {
+    float angle = i / 30.0f;
+    tkeys.push_back(make_key(i / 30.0f, Vector3(1.0f, 2.0f, 3.0f)));
+    rkeys.push_back(make_key(i / 30.0f, Quaternion(cos(angle), sin(angle), 0.0f, 0.0f)));
+  }
+  tdata->SetTranslateType(LINEAR_KEY);
+  tdata->SetTranslateKeys(tkeys);
+  tdata->SetRotateType(LINEAR_KEY);
+  tdata->SetQuatRotateKeys(rkeys);
+  NiTransformInterpolatorRef interp = new NiTransformInterpolator;
+  interp->SetData(tdata);
+  interp->ReduceKeys(0.001f, 0.001f, 0.001f);
+  BOOST_CHECK(tdata->GetTranslateKeys().empty());
+  BOOST_CHECK_EQUAL(interp->GetTranslation().z, 3.0f);
+  // slerp at a constant rate needs only the end keys
+  BOOST_CHECK_EQUAL(tdata->GetQuatRotateKeys().size(), 2u);
+  BOOST_CHECK(interp->GetData() != NULL);
+}
+
+// a sequence with one transform controller on a node called name, whose
+// translation keys move linearly from 0 to 1 over 31 keys
+static NiControllerSequenceRef make_sequence(const string & name)
+{
+  NiTransformDataRef tdata = new NiTransformData;
+  vector< Key<Vector3> > tkeys;
+  for (int i = 0; i <= 30; i++)
+    tkeys.push_back(make_key(i / 30.0f, Vector3(i / 30.0f, 0.0f, 0.0f)));
+  tdata->SetTranslateType(LINEAR_KEY);
+  tdata->SetTranslateKeys(tkeys);
+  NiTransformInterpolatorRef interp = new NiTransformInterpolator;
+  interp->SetData(tdata);
+  interp->SetRotation(Quaternion(1.0f, 0.0f, 0.0f, 0.0f));
+  interp->SetScale(1.0f);
+  NiNodeRef node = new NiNode;
+  node->SetName(name);
+  NiTransformControllerRef ctlr = new NiTransformController;
+  node->AddController(ctlr);
+  ctlr->SetInterpolator(interp);
+  NiControllerSequenceRef seq = new NiControllerSequence;
+  seq->AddInterpolator(ctlr, 0, false);
+  seq->SetStopTime(1.0f);
+  seq->SetFrequency(1.0f);
+  return seq;
+}
+
+BOOST_AUTO_TEST_CASE(merge_sequences_test)
+{
+  NiNodeRef root = new NiNode;
+  NiNodeRef bones[2];
+  for (int i = 0; i < 2; i++) {
+    bones[i] = new NiNode;
+    bones[i]->SetName(i == 0 ? "Bone1" : "Bone2");
+    root->AddChild(StaticCast<NiAVObject>(bones[i]));
+  }
+  vector<NiControllerSequenceRef> seqs;
+  seqs.push_back(make_sequence("Bone1"));
+  seqs.push_back(make_sequence("Bone2"));
+  seqs.push_back(make_sequence("Missing"));
+  BOOST_CHECK_NO_THROW(MergeNifTrees(root, seqs, VER_20_0_0_5, 11));
+
+  // each bone gets a clone of its interpolator, and the content-equal key data
+  // of both sequences is merged into one object
+  NiTransformDataRef data[2];
+  for (int i = 0; i < 2; i++) {
+    list<NiTimeControllerRef> ctlrs = bones[i]->GetControllers();
+    BOOST_REQUIRE_EQUAL(ctlrs.size(), 1u);
+    NiTransformControllerRef ctlr = DynamicCast<NiTransformController>(ctlrs.front());
+    BOOST_REQUIRE(ctlr != NULL);
+    NiTransformInterpolatorRef interp = DynamicCast<NiTransformInterpolator>(ctlr->GetInterpolator());
+    BOOST_REQUIRE(interp != NULL);
+    BOOST_CHECK(interp != seqs[i]->GetControllerData()[0].interpolator);
+    data[i] = interp->GetData();
+    BOOST_REQUIRE(data[i] != NULL);
+    BOOST_CHECK_EQUAL(data[i]->GetTranslateKeys().size(), 31u);
+    BOOST_CHECK_EQUAL(ctlr->GetStopTime(), 1.0f);
+  }
+  BOOST_CHECK(data[0] == data[1]);
+
+  // reducing the shared data leaves the two ends of the line
+  root = new NiNode;
+  for (int i = 0; i < 2; i++) {
+    bones[i] = new NiNode;
+    bones[i]->SetName(i == 0 ? "Bone1" : "Bone2");
+    root->AddChild(StaticCast<NiAVObject>(bones[i]));
+  }
+  MergeNifTrees(root, seqs, VER_20_0_0_5, 11, true);
+  for (int i = 0; i < 2; i++) {
+    NiTransformControllerRef ctlr = DynamicCast<NiTransformController>(bones[i]->GetControllers().front());
+    NiTransformInterpolatorRef interp = DynamicCast<NiTransformInterpolator>(ctlr->GetInterpolator());
+    BOOST_REQUIRE(interp->GetData() != NULL);
+    BOOST_CHECK_EQUAL(interp->GetData()->GetTranslateKeys().size(), 2u);
+  }
+  // the source sequences are left alone
+  NiTransformInterpolatorRef src = DynamicCast<NiTransformInterpolator>(seqs[0]->GetControllerData()[0].interpolator);
+  BOOST_CHECK_EQUAL(src->GetData()->GetTranslateKeys().size(), 31u);
+}
+
+BOOST_AUTO_TEST_CASE(merge_sequences_controller_test)
+{
+  // a sequence that attaches a whole controller to a node whose controllers
+  // were already looked up, followed by one that needs a controller there
+  NiNodeRef root = new NiNode;
+  NiNodeRef bone = new NiNode;
+  bone->SetName("Bone1");
+  root->AddChild(StaticCast<NiAVObject>(bone));
+  vector<NiControllerSequenceRef> seqs;
+  seqs.push_back(make_sequence("Bone1"));
+  NiNodeRef target = new NiNode;
+  target->SetName("Bone1");
+  NiTransformControllerRef attached = new NiTransformController;
+  target->AddController(attached);
+  NiControllerSequenceRef whole = new NiControllerSequence;
+  whole->AddController(attached);
+  seqs.push_back(whole);
+  seqs.push_back(make_sequence("Bone1"));
+  seqs.back()->SetStopTime(2.0f);
+  MergeNifTrees(root, seqs, VER_20_0_0_5, 11);
+
+  // the last sequence drives the controller attached last, as a scan of the
+  // node's controllers would find
+  list<NiTimeControllerRef> ctlrs = bone->GetControllers();
+  BOOST_REQUIRE_EQUAL(ctlrs.size(), 2u);
+  BOOST_CHECK_EQUAL(ctlrs.front()->GetStopTime(), 2.0f);
+  BOOST_CHECK_EQUAL(ctlrs.back()->GetStopTime(), 1.0f);
+}
+
+BOOST_AUTO_TEST_CASE(string_palette_test)
+{
+  NiStringPaletteRef pal = new NiStringPalette;
+  BOOST_CHECK_EQUAL(pal->AddSubStr("RootBone"), 0u);
+  BOOST_CHECK_EQUAL(pal->AddSubStr("Tail"), 9u);
+  // whole strings are shared, everything else is appended
+  BOOST_CHECK_EQUAL(pal->AddSubStr("RootBone"), 0u);
+  BOOST_CHECK_EQUAL(pal->AddSubStr("Bone"), 14u);
+  BOOST_CHECK_EQUAL(pal->AddSubStr(""), 19u);
+  BOOST_CHECK_EQUAL(pal->AddSubStr("Bone"), 14u);
+  BOOST_CHECK_EQUAL(pal->GetPaletteString().size(), 20u);
+  // a copy indexes its own palette
+  NiStringPalette copy(*pal);
+  BOOST_CHECK_EQUAL(copy.AddSubStr("Tail"), 9u);
+  // a replaced palette is indexed again
+  pal->SetPaletteString(string("Head\0", 5));
+  vector<string> strs;
+  strs.push_back("Tail");
+  strs.push_back("ad");
+  strs.push_back("Tail");
+  vector<unsigned int> offsets = pal->AddSubStrs(strs);
+  BOOST_CHECK_EQUAL(offsets[0], 5u);
+  BOOST_CHECK_EQUAL(offsets[1], 10u);
+  BOOST_CHECK_EQUAL(offsets[2], 5u);
+  BOOST_CHECK_EQUAL(pal->GetSubStr(5), "Tail");
+
+  // the sequence builder moves direct strings into the palette
+  NiControllerSequenceRef seq = make_sequence("Bone1");
+  BOOST_CHECK(seq->GetStringPalette() == NULL);
+  seq->BuildStringPalette();
+  BOOST_REQUIRE(seq->GetStringPalette() != NULL);
+  ControllerLink cl = seq->GetControllerData()[0];
+  BOOST_CHECK(cl.stringPalette == seq->GetStringPalette());
+  BOOST_CHECK_EQUAL(cl.stringPalette->GetSubStr(cl.nodeNameOffset), "Bone1");
+  BOOST_CHECK_EQUAL(cl.stringPalette->GetSubStr(cl.controllerTypeOffset), "NiTransformController");
+  BOOST_CHECK_EQUAL(cl.propertyTypeOffset, 0xFFFFFFFFu);
+}
+
+BOOST_AUTO_TEST_CASE(kfm_merge_actions_test)
+{
+  NiNodeRef root = new NiNode;
+  root->SetName("Actor");
+  NiNodeRef bone = new NiNode;
+  bone->SetName("Bone1");
+  root->AddChild(StaticCast<NiAVObject>(bone));
+  NifInfo info(VER_20_0_0_5, 11);
+  WriteNifTree("kfm_test_actor.nif", root, info);
+  NiControllerSequenceRef seq = make_sequence("Bone1");
+  seq->SetName("walk");
+  WriteNifTree("kfm_test_actor_walk.kf", seq, info);
+  seq->SetName("run");
+  WriteNifTree("kfm_test_actor_run.kf", seq, info);
+
+  Kfm kfm;
+  kfm.nif_filename = "kfm_test_actor.nif";
+  kfm.actions.resize(3);
+  kfm.actions[0].action_filename = "kfm_test_actor_walk.kf";
+  kfm.actions[1].action_filename = "kfm_test_actor_missing.kf";
+  kfm.actions[2].action_filename = "kfm_test_actor_run.kf";
+  NiNodeRef merged;
+  BOOST_CHECK_NO_THROW(merged = DynamicCast<NiNode>(kfm.MergeActions("./")));
+  remove("kfm_test_actor.nif");
+  remove("kfm_test_actor_walk.kf");
+  remove("kfm_test_actor_run.kf");
+  BOOST_REQUIRE(merged != NULL);
+
+  list<NiTimeControllerRef> ctlrs = merged->GetControllers();
+  BOOST_REQUIRE_EQUAL(ctlrs.size(), 1u);
+  NiControllerManagerRef manager = DynamicCast<NiControllerManager>(ctlrs.front());
+  BOOST_REQUIRE(manager != NULL);
+  vector<NiControllerSequenceRef> seqs = manager->GetControllerSequences();
+  // the sequences keep the order of the actions
+  BOOST_REQUIRE_EQUAL(seqs.size(), 2u);
+  BOOST_CHECK_EQUAL(seqs[0]->GetName(), "walk");
+  BOOST_CHECK_EQUAL(seqs[1]->GetName(), "run");
+  BOOST_CHECK_EQUAL(manager->GetStopTime(), 1.0f);
+  BOOST_REQUIRE(manager->GetObjectPalette() != NULL);
+  BOOST_CHECK_EQUAL(manager->GetObjectPalette()->GetObjs().size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(pose_evaluator_test)
+{
+  NiNodeRef root = new NiNode;
+  root->SetName("Actor");
+  NiNodeRef bone = new NiNode;
+  bone->SetName("Bone1");
+  bone->SetLocalTranslation(Vector3(0.0f, 5.0f, 0.0f));
+  root->AddChild(StaticCast<NiAVObject>(bone));
+  NiControllerManagerRef manager = new NiControllerManager;
+  root->AddController(manager);
+  // two sequences on the same bone: x goes from 0 to 1 in the first, and the
+  // second has the same keys at a higher priority
+  NiControllerSequenceRef walk = make_sequence("Bone1");
+  walk->SetName("walk");
+  NiControllerSequenceRef run = make_sequence("Bone1");
+  run->SetName("run");
+  vector<ControllerLink> links = run->GetControllerData();
+  links[0].priority = 10;
+  run->SetControllerData(links);
+  manager->AddSequence(walk);
+  manager->AddSequence(run);
+
+  PoseEvaluator eval(manager);
+  BOOST_REQUIRE_EQUAL(eval.GetBones().size(), 2u);
+  int b = eval.GetBoneIndex("Bone1");
+  BOOST_REQUIRE(b >= 0);
+  BOOST_CHECK_EQUAL(eval.GetSequenceIndex("run"), 1);
+  BOOST_CHECK_EQUAL(eval.GetBoneIndex("Missing"), -1);
+
+  // one sequence; bones it does not animate keep their rest pose
+  vector<SequenceState> active;
+  active.push_back(SequenceState(0, 0.5f, 1.0f));
+  vector<QTransform> pose;
+  eval.EvaluatePose(active, pose);
+  BOOST_REQUIRE_EQUAL(pose.size(), 2u);
+  BOOST_CHECK_CLOSE(pose[b].translation.x, 0.5f, 0.01f);
+  BOOST_CHECK_CLOSE(pose[b].rotation.w, 1.0f, 0.01f);
+  BOOST_CHECK_CLOSE(pose[1 - b].scale, 1.0f, 0.01f);
+  BOOST_CHECK_CLOSE(eval.GetRestPose()[b].translation.y, 5.0f, 0.01f);
+
+  // the higher priority sequence at full weight hides the lower one
+  active.push_back(SequenceState(1, 0.25f, 1.0f));
+  eval.EvaluatePose(active, pose);
+  BOOST_CHECK_CLOSE(pose[b].translation.x, 0.25f, 0.01f);
+  // at half weight it leaves half for the lower one
+  active[1].weight = 0.5f;
+  eval.EvaluatePose(active, pose);
+  BOOST_CHECK_CLOSE(pose[b].translation.x, 0.375f, 0.01f);
+
+  // the pose can be written back into the scene graph
+  eval.ApplyPose(pose);
+  BOOST_CHECK_CLOSE(bone->GetLocalTranslation().x, 0.375f, 0.01f);
+  BOOST_CHECK_THROW(eval.ApplyPose(vector<QTransform>(1)), runtime_error);
+
+  // a large skeleton may be blended on several threads, with the same result
+  NiNodeRef big = new NiNode;
+  big->SetName("Big");
+  NiControllerManagerRef big_manager = new NiControllerManager;
+  big->AddController(big_manager);
+  NiControllerSequenceRef wave = make_sequence("Big");
+  for (int i = 0; i < 4096; i++) {
+    char name[16];
+    sprintf(name, "Bone%d", i);
+    NiNodeRef node = new NiNode;
+    node->SetName(name);
+    node->SetLocalTranslation(Vector3(0.0f, float(i), 0.0f));
+    big->AddChild(StaticCast<NiAVObject>(node));
+    NiTransformInterpolatorRef interp = new NiTransformInterpolator;
+    interp->SetData(StaticCast<NiTransformInterpolator>(wave->GetControllerData()[0].interpolator)->GetData());
+    interp->SetRotation(Quaternion(1.0f, 0.0f, 0.0f, 0.0f));
+    interp->SetScale(1.0f);
+    NiTransformControllerRef ctlr = new NiTransformController;
+    node->AddController(ctlr);
+    ctlr->SetInterpolator(interp);
+    wave->AddInterpolator(ctlr, 0, false);
+  }
+  big_manager->AddSequence(wave);
+  PoseEvaluator big_eval(big_manager);
+  BOOST_REQUIRE_EQUAL(big_eval.GetBones().size(), 4097u);
+  active.clear();
+  active.push_back(SequenceState(0, 0.5f, 1.0f));
+  big_eval.EvaluatePose(active, pose);
+  BOOST_REQUIRE_EQUAL(pose.size(), 4097u);
+  unsigned int wrong = 0;
+  for (unsigned int i = 0; i < pose.size(); i++)
+    if (fabs(pose[i].translation.x - 0.5f) > 1.0e-4f || fabs(pose[i].translation.y) > 1.0e-4f)
+      wrong++;
+  BOOST_CHECK_EQUAL(wrong, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(morph_evaluator_test)
+{
+  // a base of 100 vertices and two targets that each move a few of them
+  NiMorphDataRef data = new NiMorphData;
+  data->SetMorphCount(3);
+  data->SetVertexCount(100);
+  vector<Vector3> base(100), up(100), side(100);
+  for (unsigned int i = 0; i < 100; i++)
+    base[i] = Vector3(float(i), 0.0f, 0.0f);
+  up[3] = Vector3(0.0f, 1.0f, 0.0f);
+  up[7] = Vector3(0.0f, 2.0f, 0.0f);
+  up[8] = Vector3(0.0f, 0.0f, 1.0e-6f);
+  side[7] = Vector3(1.0f, 0.0f, 0.0f);
+  data->SetMorphVerts(0, base);
+  data->SetMorphVerts(1, up);
+  data->SetMorphVerts(2, side);
+  data->SetRelativeTargets(true);
+
+  vector<unsigned int> moved = data->GetMorphedVertices(1.0e-4f);
+  BOOST_REQUIRE_EQUAL(moved.size(), 2u);
+  BOOST_CHECK_EQUAL(moved[1], 7u);
+  BOOST_CHECK_EQUAL(data->GetMorphedVertices().size(), 3u);
+
+  MorphEvaluator eval(data, 1.0e-4f);
+  BOOST_CHECK_EQUAL(eval.GetMorphCount(), 3u);
+  BOOST_CHECK_EQUAL(eval.GetMovedVertexCount(1), 2u);
+  BOOST_CHECK_EQUAL(eval.GetMovedVertexCount(2), 1u);
+  vector<float> weights(3, 0.0f);
+  weights[1] = 0.5f;
+  weights[2] = 2.0f;
+  vector<Vector3> verts;
+  eval.Evaluate(weights, verts);
+  BOOST_REQUIRE_EQUAL(verts.size(), 100u);
+  BOOST_CHECK_CLOSE(verts[3].y, 0.5f, 0.001f);
+  BOOST_CHECK_CLOSE(verts[7].x, 9.0f, 0.001f);
+  BOOST_CHECK_CLOSE(verts[7].y, 1.0f, 0.001f);
+  BOOST_CHECK_EQUAL(verts[50].x, 50.0f);
+
+  // weights at a time come from the controller's interpolators
+  NiGeomMorpherControllerRef ctlr = new NiGeomMorpherController;
+  ctlr->SetData(data);
+  vector<NiInterpolatorRef> interps;
+  for (int i = 0; i < 3; i++) {
+    NiFloatInterpolatorRef interp = new NiFloatInterpolator;
+    interp->SetFloatValue(i == 1 ? 1.0f : 0.0f);
+    interps.push_back(StaticCast<NiInterpolator>(interp));
+  }
+  ctlr->SetInterpolators(interps);
+  MorphEvaluator ctlr_eval(ctlr);
+  ctlr_eval.Evaluate(0.0f, verts);
+  BOOST_CHECK_CLOSE(verts[7].y, 2.0f, 0.001f);
+  BOOST_CHECK_EQUAL(verts[7].x, 7.0f);
+  // an interpolator without a pose leaves its target unweighted
+  DynamicCast<NiFloatInterpolator>(interps[1])->SetFloatValue(-FLT_MAX);
+  BOOST_CHECK_EQUAL(ctlr_eval.EvaluateWeights(0.0f)[1], 0.0f);
+
+  // clearing small deltas leaves only the real ones
+  BOOST_CHECK_EQUAL(data->ClearSmallDeltas(1.0e-4f), 1u);
+  BOOST_CHECK_EQUAL(data->GetMorphedVertices().size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(particle_simulation_test)
+{
+  NiParticleSystemRef psys = new NiParticleSystem;
+  NiPSysBoxEmitterRef emitter = new NiPSysBoxEmitter;
+  emitter->SetName("Emitter");
+  emitter->SetOrder(1000);
+  emitter->SetActive(true);
+  emitter->SetWidth(2.0f);
+  emitter->SetHeight(2.0f);
+  emitter->SetDepth(2.0f);
+  emitter->SetLifeSpan(0.5f);
+  NiPSysGravityModifierRef gravity = new NiPSysGravityModifier;
+  gravity->SetOrder(4000);
+  gravity->SetActive(true);
+  gravity->SetGravityAxis(Vector3(0.0f, 0.0f, -2.0f));
+  gravity->SetStrength(10.0f);
+  NiPSysPositionModifierRef position = new NiPSysPositionModifier;
+  position->SetOrder(6000);
+  position->SetActive(true);
+  NiPSysAgeDeathModifierRef death = new NiPSysAgeDeathModifier;
+  death->SetOrder(3000);
+  death->SetActive(true);
+  // the modifiers run by order, not in the order they were added
+  psys->AddModifier(position);
+  psys->AddModifier(gravity);
+  psys->AddModifier(death);
+  psys->AddModifier(emitter);
+
+  NiPSysEmitterCtlrRef ctlr = new NiPSysEmitterCtlr;
+  ctlr->SetModifierName("Emitter");
+  ctlr->SetFrequency(1.0f);
+  NiFloatInterpolatorRef rate = new NiFloatInterpolator;
+  rate->SetFloatValue(100.0f);
+  ctlr->SetInterpolator(rate);
+  psys->AddController(ctlr);
+
+  ParticleState a, b;
+  ParticleBounds bounds = psys->Simulate(0.0f, 1.0f, 1.0f / 30.0f, 42, a);
+  psys->Simulate(0.0f, 1.0f, 1.0f / 30.0f, 42, b);
+
+  // particles live half a second at 100 per second
+  BOOST_CHECK(a.Size() > 40 && a.Size() <= 50);
+  BOOST_REQUIRE_EQUAL(a.Size(), b.Size());
+  for (unsigned int i = 0; i < a.Size(); i++) {
+    BOOST_CHECK_EQUAL(a.px[i], b.px[i]);
+    BOOST_CHECK_EQUAL(a.pz[i], b.pz[i]);
+    BOOST_CHECK(a.age[i] < a.lifeSpan[i]);
+    BOOST_CHECK(a.vz[i] < 0.0f);
+  }
+  BOOST_CHECK(!bounds.empty);
+  BOOST_CHECK(bounds.min.z < -1.0f);
+  BOOST_CHECK(bounds.max.x <= 1.0f);
+
+  // another seed scatters the particles differently
+  ParticleState c;
+  psys->Simulate(0.0f, 1.0f, 1.0f / 30.0f, 7, c);
+  BOOST_REQUIRE(c.Size() > 0);
+  BOOST_CHECK(c.px[0] != a.px[0]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,373 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <sstream> // stringstream
+
+// evil hack to allow testing of private and protected data
+#define private public
+#define protected public
+
+#include "niflib.h"
+#include "obj/NiMesh.h"
+#include "obj/NiDataStream.h"
+#include "obj/NiTriShapeData.h"
+#include "obj/NiSkinInstance.h"
+#include "obj/NiSkinData.h"
+#include "obj/NiMeshModifier.h"
+#include "obj/NiTexturingProperty.h"
+#include "obj/NiStringExtraData.h"
+#include "obj/NiVisController.h"
+#include "MeshConverter.h"
+#include "PackedGeometry.h"
+
+using namespace Niflib;
+using namespace std;
+
+template <class T>
+void push_raw(vector<Niflib::byte> & bytes, T value) {
+  Niflib::byte raw[sizeof(T)];
+  memcpy(raw, &value, sizeof(T));
+  bytes.insert(bytes.end(), raw, raw + sizeof(T));
+}
+
+BOOST_AUTO_TEST_SUITE(mesh_test_suite)
+
+BOOST_AUTO_TEST_CASE(half_float_test)
+{
+  BOOST_CHECK_EQUAL(HalfToFloat(0x3C00), 1.0f);
+  BOOST_CHECK_EQUAL(HalfToFloat(0xC000), -2.0f);
+  BOOST_CHECK_EQUAL(HalfToFloat(0x0001), 5.9604645e-8f);
+  BOOST_CHECK_EQUAL(FloatToHalf(0.5f), 0x3800);
+  BOOST_CHECK_EQUAL(FloatToHalf(1.0e6f), 0x7C00);
+  for (unsigned int h = 0; h < 0x7C00; h++) {
+    BOOST_REQUIRE_EQUAL(FloatToHalf(HalfToFloat((unsigned short)h)), h);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(data_stream_view_test)
+{
+  // interleaved vertices: float position, half uv, normalized byte normal
+  vector<ComponentFormat> formats;
+  formats.push_back(F_FLOAT32_3);
+  formats.push_back(F_FLOAT16_2);
+  formats.push_back(F_NORMINT8_4);
+  vector<Niflib::byte> bytes;
+  for (int i = 0; i < 4; i++) {
+    push_raw(bytes, float(i));
+    push_raw(bytes, 2.0f * i);
+    push_raw(bytes, -1.0f);
+    push_raw(bytes, FloatToHalf(0.25f * i));
+    push_raw(bytes, FloatToHalf(1.0f));
+    push_raw(bytes, (signed char)(0));
+    push_raw(bytes, (signed char)(-128));
+    push_raw(bytes, (signed char)(127));
+    push_raw(bytes, (signed char)(0));
+  }
+  NiDataStreamRef stream = new NiDataStream;
+  stream->SetData(formats, bytes);
+  BOOST_CHECK_EQUAL(stream->GetStride(), 20u);
+  BOOST_CHECK_EQUAL(stream->GetElementCount(), 4u);
+  BOOST_CHECK_EQUAL(stream->GetComponentOffset(2), 16u);
+
+  DataStreamView pos = stream->GetComponentView(0);
+  BOOST_CHECK_EQUAL(pos.Size(), 4u);
+  BOOST_CHECK_EQUAL(pos.GetVector3(3), Vector3(3.0f, 6.0f, -1.0f));
+  DataStreamView uv = stream->GetComponentView(1);
+  BOOST_CHECK_EQUAL(uv.GetTexCoord(2).u, 0.5f);
+  BOOST_CHECK_EQUAL(uv.GetTexCoord(2).v, 1.0f);
+  DataStreamView norm = stream->GetComponentView(2);
+  BOOST_CHECK_EQUAL(norm.GetValueCount(), 4u);
+  // -128 clamps to -1 like -127
+  BOOST_CHECK_EQUAL(norm.GetVector3(0), Vector3(0.0f, -1.0f, 1.0f));
+
+  vector<Vector3> positions;
+  pos.DecodeVector3s(positions);
+  BOOST_REQUIRE_EQUAL(positions.size(), 4u);
+  BOOST_CHECK_EQUAL(positions[1], Vector3(1.0f, 2.0f, -1.0f));
+
+  // regions restrict the view to a submesh
+  vector<Region> regions(2);
+  regions[0].startIndex = 0;
+  regions[0].numIndices = 1;
+  regions[1].startIndex = 1;
+  regions[1].numIndices = 3;
+  stream->SetRegions(regions);
+  DataStreamView part = stream->GetComponentView(0, 1);
+  BOOST_CHECK_EQUAL(part.Size(), 3u);
+  BOOST_CHECK_EQUAL(part.GetFloat(0, 0), 1.0f);
+  regions[1].numIndices = 4;
+  BOOST_CHECK_THROW(stream->SetRegions(regions), runtime_error);
+
+  // packed normals
+  vector<ComponentFormat> packed(1, F_NORMINT_10_10_10_L1);
+  vector<Niflib::byte> packed_bytes;
+  push_raw(packed_bytes, (unsigned int)(511 | (0x201 << 10) | (0 << 20)));
+  stream->SetData(packed, packed_bytes);
+  BOOST_CHECK_EQUAL(stream->GetComponentView(0).GetVector3(0), Vector3(1.0f, -1.0f, 0.0f));
+
+  // BGRA colors are stored blue first and read back in RGBA order
+  vector<ComponentFormat> bgra(1, F_NORMUINT8_4_BGRA);
+  vector<Niflib::byte> color_bytes;
+  push_raw(color_bytes, (unsigned char)(0));
+  push_raw(color_bytes, (unsigned char)(51));
+  push_raw(color_bytes, (unsigned char)(255));
+  push_raw(color_bytes, (unsigned char)(255));
+  stream->SetData(bgra, color_bytes);
+  DataStreamView colors = stream->GetComponentView(0);
+  Color4 color = colors.GetColor4(0);
+  BOOST_CHECK_EQUAL(color.r, 1.0f);
+  BOOST_CHECK_CLOSE(color.g, 0.2f, 1e-3f);
+  BOOST_CHECK_EQUAL(color.b, 0.0f);
+  BOOST_CHECK_EQUAL(color.a, 1.0f);
+  BOOST_CHECK_EQUAL(colors.GetFloat(0, 0), 0.0f);
+  BOOST_CHECK_EQUAL(colors.GetUInt(0, 2), 1u);
+  vector<float> values;
+  colors.DecodeFloats(values);
+  BOOST_CHECK_EQUAL(values.size(), 4u);
+}
+
+BOOST_AUTO_TEST_CASE(mesh_semantic_test)
+{
+  vector<ComponentFormat> formats(1, F_UINT16_1);
+  vector<Niflib::byte> bytes;
+  for (unsigned short i = 0; i < 6; i++) {
+    push_raw(bytes, (unsigned short)(5 - i));
+  }
+  NiDataStreamRef indices = new NiDataStream;
+  indices->SetData(formats, bytes);
+  vector<Region> regions(2);
+  regions[0].startIndex = 0;
+  regions[0].numIndices = 3;
+  regions[1].startIndex = 3;
+  regions[1].numIndices = 3;
+  indices->SetRegions(regions);
+
+  MeshData md;
+  md.stream = indices;
+  md.submeshToRegionMap.push_back(0);
+  md.submeshToRegionMap.push_back(1);
+  SemanticData sem;
+  sem.name = "INDEX";
+  sem.index = 0;
+  md.componentSemantics.push_back(sem);
+
+  NiMeshRef mesh = new NiMesh;
+  mesh->numSubmeshes = 2;
+  mesh->datas.push_back(md);
+  BOOST_CHECK(mesh->HasSemantic("INDEX"));
+  BOOST_CHECK(!mesh->HasSemantic("POSITION"));
+  BOOST_CHECK_THROW(mesh->GetSemanticView("POSITION"), runtime_error);
+  BOOST_CHECK_EQUAL(mesh->GetSemanticView("INDEX").Size(), 6u);
+  DataStreamView second = mesh->GetSemanticView("INDEX", 0, 1);
+  vector<unsigned int> values;
+  second.DecodeUInts(values);
+  BOOST_REQUIRE_EQUAL(values.size(), 3u);
+  BOOST_CHECK_EQUAL(values[0], 2u);
+  BOOST_CHECK_EQUAL(values[2], 0u);
+}
+
+NiTriShapeRef make_quad()
+{
+  vector<Vector3> verts;
+  verts.push_back(Vector3(0.0f, 0.0f, 0.0f));
+  verts.push_back(Vector3(1.0f, 0.0f, 0.0f));
+  verts.push_back(Vector3(1.0f, 1.0f, 0.0f));
+  verts.push_back(Vector3(0.0f, 1.0f, 0.0f));
+  vector<Triangle> tris;
+  tris.push_back(Triangle(0, 1, 2));
+  tris.push_back(Triangle(0, 2, 3));
+  NiTriShapeDataRef data = new NiTriShapeData;
+  data->SetVertices(verts);
+  data->SetNormals(vector<Vector3>(4, Vector3(0.0f, 0.0f, 1.0f)));
+  data->SetUVSetCount(1);
+  vector<TexCoord> uvs;
+  for (unsigned int i = 0; i < 4; i++) {
+    uvs.push_back(TexCoord(verts[i].x, verts[i].y));
+  }
+  data->SetUVSet(0, uvs);
+  data->SetTriangles(tris);
+  NiTriShapeRef shape = new NiTriShape;
+  shape->SetName("quad");
+  shape->SetData(data);
+  return shape;
+}
+
+BOOST_AUTO_TEST_CASE(mesh_convert_test)
+{
+  NiTriShapeRef shape = make_quad();
+  for (int layout = MESH_INTERLEAVED; layout <= MESH_SEPARATE; layout++) {
+    NiMeshRef mesh = ConvertToMesh(shape, MeshStreamLayout(layout));
+    BOOST_CHECK_EQUAL(mesh->GetName(), "quad");
+    BOOST_CHECK_EQUAL(mesh->GetSubmeshCount(), 1);
+    // interleaved: one vertex stream and the index stream
+    BOOST_CHECK_EQUAL(mesh->GetMeshData().size(), layout == MESH_INTERLEAVED ? 2u : 4u);
+    BOOST_CHECK_EQUAL(mesh->GetSemanticView("POSITION").GetVector3(2), Vector3(1.0f, 1.0f, 0.0f));
+    BOOST_CHECK_EQUAL(mesh->GetSemanticView("TEXCOORD").GetTexCoord(3).v, 1.0f);
+    BOOST_CHECK_EQUAL(mesh->GetSemanticView("INDEX").Size(), 6u);
+
+    NiTriShapeRef back = ConvertToTriShape(mesh);
+    NiTriShapeDataRef data = DynamicCast<NiTriShapeData>(back->GetData());
+    BOOST_REQUIRE(data != NULL);
+    BOOST_CHECK_EQUAL(data->GetVertexCount(), 4);
+    BOOST_CHECK_EQUAL(data->GetNormals().size(), 4u);
+    BOOST_CHECK_EQUAL(data->GetUVSetCount(), 1);
+    vector<Triangle> tris = data->GetTriangles();
+    BOOST_REQUIRE_EQUAL(tris.size(), 2u);
+    BOOST_CHECK_EQUAL(tris[1].v3, 3);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(mesh_convert_state_test)
+{
+  NiNodeRef root = new NiNode;
+  NiTriShapeRef shape = make_quad();
+  NiTexturingPropertyRef texturing = new NiTexturingProperty;
+  shape->AddProperty(texturing);
+  shape->SetShader("SkinShader");
+  NiStringExtraDataRef extra = new NiStringExtraData;
+  extra->SetData("extra");
+  shape->AddExtraData(extra);
+  NiVisControllerRef controller = new NiVisController;
+  shape->AddController(controller);
+  root->AddChild(StaticCast<NiAVObject>(shape));
+
+  BOOST_CHECK_EQUAL(ConvertSceneToMeshes(root), 1u);
+  NiMeshRef mesh = DynamicCast<NiMesh>(root->GetChildren().front());
+  BOOST_REQUIRE(mesh != NULL);
+  BOOST_REQUIRE_EQUAL(mesh->GetProperties().size(), 1u);
+  BOOST_CHECK(DynamicCast<NiTexturingProperty>(mesh->GetProperties()[0]) == texturing);
+  BOOST_REQUIRE_EQUAL(mesh->GetMaterials().size(), 1u);
+  BOOST_CHECK_EQUAL(string(mesh->GetMaterials()[0].materialName), "SkinShader");
+  BOOST_REQUIRE_EQUAL(mesh->GetExtraData().size(), 1u);
+  BOOST_CHECK(DynamicCast<NiStringExtraData>(mesh->GetExtraData().front()) == extra);
+  BOOST_REQUIRE_EQUAL(mesh->GetControllers().size(), 1u);
+  BOOST_CHECK(controller->GetTarget() == StaticCast<NiObjectNET>(mesh));
+  BOOST_CHECK(shape->GetExtraData().empty());
+  BOOST_CHECK(shape->GetControllers().empty());
+
+  BOOST_CHECK_EQUAL(ConvertSceneToTriShapes(root), 1u);
+  NiTriShapeRef back = DynamicCast<NiTriShape>(root->GetChildren().front());
+  BOOST_REQUIRE(back != NULL);
+  BOOST_REQUIRE_EQUAL(back->GetProperties().size(), 1u);
+  BOOST_CHECK(DynamicCast<NiTexturingProperty>(back->GetProperties()[0]) == texturing);
+  BOOST_CHECK(back->HasShader());
+  BOOST_CHECK_EQUAL(back->GetShader(), "SkinShader");
+  BOOST_CHECK_EQUAL(back->GetExtraData().size(), 1u);
+  BOOST_REQUIRE_EQUAL(back->GetControllers().size(), 1u);
+  BOOST_CHECK(controller->GetTarget() == StaticCast<NiObjectNET>(back));
+}
+
+BOOST_AUTO_TEST_CASE(mesh_convert_skin_test)
+{
+  NiNodeRef root = new NiNode;
+  NiNodeRef bone0 = new NiNode;
+  NiNodeRef bone1 = new NiNode;
+  bone1->SetLocalTranslation(Vector3(0.0f, 1.0f, 0.0f));
+  root->AddChild(StaticCast<NiAVObject>(bone0));
+  root->AddChild(StaticCast<NiAVObject>(bone1));
+  NiTriShapeRef shape = make_quad();
+  root->AddChild(StaticCast<NiAVObject>(shape));
+  vector<NiNodeRef> bones;
+  bones.push_back(bone0);
+  bones.push_back(bone1);
+  shape->BindSkin(bones);
+  vector<SkinWeight> weights(2);
+  weights[0].index = 0;
+  weights[0].weight = 1.0f;
+  weights[1].index = 1;
+  weights[1].weight = 1.0f;
+  shape->SetBoneWeights(0, weights);
+  weights[0].index = 2;
+  weights[1].index = 3;
+  shape->SetBoneWeights(1, weights);
+
+  size_t child_count = root->GetChildren().size();
+  BOOST_CHECK_EQUAL(ConvertSceneToMeshes(root, MESH_SEPARATE), 1u);
+  // the mesh takes the place of the shape among the children
+  BOOST_CHECK_EQUAL(root->GetChildren().size(), child_count);
+  NiMeshRef mesh = DynamicCast<NiMesh>(root->GetChildren().front());
+  BOOST_REQUIRE(mesh != NULL);
+  BOOST_CHECK(mesh->HasSemantic("BLENDWEIGHT"));
+  BOOST_CHECK_EQUAL(mesh->GetSemanticView("BLENDINDICES").GetUInt(3, 0), 1u);
+  BOOST_CHECK_EQUAL(mesh->GetModifiers().size(), 1u);
+
+  BOOST_CHECK_EQUAL(ConvertSceneToTriShapes(root), 1u);
+  BOOST_CHECK_EQUAL(root->GetChildren().size(), child_count);
+  NiTriShapeRef back = DynamicCast<NiTriShape>(root->GetChildren().front());
+  BOOST_REQUIRE(back != NULL);
+  NiSkinInstanceRef skin = back->GetSkinInstance();
+  BOOST_REQUIRE(skin != NULL);
+  BOOST_CHECK_EQUAL(skin->GetBoneCount(), 2u);
+  vector<SkinWeight> bound = skin->GetSkinData()->GetBoneWeights(1);
+  BOOST_REQUIRE_EQUAL(bound.size(), 2u);
+  BOOST_CHECK_EQUAL(bound[0].index, 2);
+}
+
+BOOST_AUTO_TEST_CASE(packed_geometry_test)
+{
+  NiTriShapeRef shape = make_quad();
+  NiTriShapeDataRef data = DynamicCast<NiTriShapeData>(shape->GetData());
+  vector<float> errors;
+  BSPackedAdditionalGeometryDataRef packed = PackGeometryData(data, &errors);
+  BOOST_CHECK(data->GetAdditionalData() == packed);
+  // positions, normals and uvs
+  BOOST_REQUIRE_EQUAL(errors.size(), 3u);
+  BOOST_CHECK_EQUAL(errors[0], 0.0f);
+  BOOST_CHECK_EQUAL(errors[2], 0.0f);
+  // a normal component of 0 is stored half a step off, in -1..1 units
+  BOOST_CHECK_CLOSE(errors[1], 1.0f / 255.0f, 1.0f);
+  BOOST_CHECK_EQUAL(packed->GetBlockInfos()[2].channelOffset, 12);
+  BOOST_CHECK_EQUAL(packed->GetBlocks()[0].data.size(), 4u * 16u);
+
+  // the packed data survives a round trip through a Fallout 3 file
+  stringstream ss;
+  NifInfo info(VER_20_2_0_7, 11, 34);
+  WriteNifTree(ss, shape, info);
+  ss.seekg(0);
+  NiTriShapeRef back = DynamicCast<NiTriShape>(ReadNifTree(ss));
+  BOOST_REQUIRE(back != NULL);
+  vector<AdditionalChannel> channels = UnpackAdditionalGeometry(back->GetData()->GetAdditionalData());
+  BOOST_REQUIRE_EQUAL(channels.size(), 3u);
+  BOOST_CHECK_EQUAL(channels[0].type, ADT_FLOAT16_4);
+  BOOST_CHECK_EQUAL(channels[0].values[2].x, 1.0f);
+  BOOST_CHECK_EQUAL(channels[0].values[2].w, 1.0f);
+  BOOST_CHECK_EQUAL(channels[1].values[0].z, 1.0f);
+  BOOST_CHECK_EQUAL(channels[2].values[3].y, 1.0f);
+
+  // the original arrays can be dropped, keeping the vertex count
+  NiTriShapeRef cleared = make_quad();
+  PackGeometryData(cleared->GetData(), NULL, true);
+  BOOST_CHECK(cleared->GetData()->GetVertices().empty());
+  BOOST_CHECK(!cleared->GetData()->GetHasNormals());
+  BOOST_CHECK_EQUAL(cleared->GetData()->GetUVSetCount(), 0);
+  stringstream cs;
+  WriteNifTree(cs, cleared, info);
+  cs.seekg(0);
+  back = DynamicCast<NiTriShape>(ReadNifTree(cs));
+  BOOST_REQUIRE(back != NULL);
+  BOOST_CHECK(back->GetData()->GetVertices().empty());
+  BOOST_CHECK_EQUAL(DynamicCast<NiTriShapeData>(back->GetData())->GetTriangles().size(), 2u);
+  channels = UnpackAdditionalGeometry(back->GetData()->GetAdditionalData());
+  BOOST_REQUIRE_EQUAL(channels.size(), 3u);
+  BOOST_CHECK_EQUAL(channels[0].values.size(), 4u);
+  BOOST_CHECK_EQUAL(channels[0].values[2].x, 1.0f);
+
+  BOOST_CHECK_THROW(PackGeometryData(NULL), runtime_error);
+
+  // values out of range are clamped, and the error says so
+  AdditionalChannel color;
+  color.type = ADT_NORMSHORT2;
+  color.values.push_back(Vector4(0.5f, -1.0f, 0.0f, 0.0f));
+  color.values.push_back(Vector4(2.0f, 0.0f, 0.0f, 0.0f));
+  vector<AdditionalChannel> input(1, color);
+  NiAdditionalGeometryDataRef built = BuildAdditionalGeometry(input, &errors);
+  BOOST_CHECK_CLOSE(errors[0], 1.0f, 0.01f);
+  channels = UnpackAdditionalGeometry(built);
+  BOOST_CHECK_CLOSE(channels[0].values[0].x, 0.5f, 0.01f);
+  BOOST_CHECK_EQUAL(channels[0].values[0].y, -1.0f);
+  BOOST_CHECK_EQUAL(channels[0].values[1].x, 1.0f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
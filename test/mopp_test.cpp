@@ -0,0 +1,192 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <sstream> // stringstream
+#include <cmath> // fabs
+#include <algorithm> // find
+
+#include "niflib.h"
+#include "obj/bhkMoppBvTreeShape.h"
+#include "obj/bhkPackedNiTriStripsShape.h"
+#include "obj/hkPackedNiTriStripsData.h"
+#include "obj/bhkCompressedMeshShapeData.h"
+#include "gen/hkTriangle.h"
+
+using namespace Niflib;
+using namespace std;
+
+// a flat grid of n x n quads in the xy plane, two triangles per quad
+static void make_grid(int n, vector<Vector3> & verts, vector<Triangle> & tris)
+{
+  for (int j = 0; j <= n; j++)
+    for (int i = 0; i <= n; i++)
+      verts.push_back(Vector3(float(i), float(j), 0.0f));
+  for (int j = 0; j < n; j++)
+    for (int i = 0; i < n; i++) {
+      unsigned short v = (unsigned short)(j * (n + 1) + i);
+      tris.push_back(Triangle(v, v + 1, v + n + 2));
+      tris.push_back(Triangle(v, v + n + 2, v + n + 1));
+    }
+}
+
+// rotates a triangle so that its smallest index comes first, keeping the winding
+static Triangle first_smallest(const Triangle & t)
+{
+  if (t.v2 < t.v1 && t.v2 < t.v3)
+    return Triangle(t.v2, t.v3, t.v1);
+  if (t.v3 < t.v1 && t.v3 < t.v2)
+    return Triangle(t.v3, t.v1, t.v2);
+  return t;
+}
+
+static bool triangle_less(const Triangle & a, const Triangle & b)
+{
+  if (a.v1 != b.v1)
+    return a.v1 < b.v1;
+  if (a.v2 != b.v2)
+    return a.v2 < b.v2;
+  return a.v3 < b.v3;
+}
+
+BOOST_AUTO_TEST_SUITE(mopp_test_suite)
+
+BOOST_AUTO_TEST_CASE(mopp_build_test)
+{
+  vector<Vector3> verts;
+  vector<Triangle> tris;
+  make_grid(20, verts, tris);
+  bhkMoppBvTreeShapeRef mopp = new bhkMoppBvTreeShape;
+  BOOST_CHECK_NO_THROW(mopp->BuildMoppCode(verts, tris));
+  BOOST_CHECK(!mopp->GetMoppCode().empty());
+  BOOST_CHECK_CLOSE(mopp->GetMoppOrigin().x, -0.1f, 0.001f);
+  // every triangle is reachable
+  vector<unsigned int> keys = mopp->GetMoppTriangleIndices();
+  BOOST_REQUIRE_EQUAL(keys.size(), tris.size());
+  for (unsigned int i = 0; i < keys.size(); i++)
+    BOOST_CHECK_EQUAL(keys[i], i);
+  // a vertical ray through the middle of quad (7, 11) hits its two triangles
+  // and only a few neighbours
+  vector<unsigned int> hits = mopp->QueryMoppRay(Vector3(7.5f, 11.5f, 5.0f), Vector3(7.5f, 11.5f, -5.0f));
+  unsigned int quad = 11 * 20 + 7;
+  BOOST_CHECK(find(hits.begin(), hits.end(), 2 * quad) != hits.end());
+  BOOST_CHECK(find(hits.begin(), hits.end(), 2 * quad + 1) != hits.end());
+  BOOST_CHECK(hits.size() < 20);
+  // a ray that misses the grid hits nothing
+  hits = mopp->QueryMoppRay(Vector3(50.0f, 50.0f, 5.0f), Vector3(50.0f, 50.0f, -5.0f));
+  BOOST_CHECK(hits.empty());
+}
+
+BOOST_AUTO_TEST_CASE(mopp_shape_test)
+{
+  vector<Vector3> verts;
+  vector<Triangle> tris;
+  make_grid(4, verts, tris);
+  hkPackedNiTriStripsDataRef data = new hkPackedNiTriStripsData;
+  vector<hkTriangle> hktris(tris.size());
+  for (unsigned int i = 0; i < tris.size(); i++)
+    hktris[i].triangle = tris[i];
+  data->SetVertices(verts);
+  data->SetHavokTriangles(hktris);
+  bhkPackedNiTriStripsShapeRef shape = new bhkPackedNiTriStripsShape;
+  shape->SetData(data);
+  bhkMoppBvTreeShapeRef mopp = new bhkMoppBvTreeShape;
+  // no shape yet
+  BOOST_CHECK_THROW(mopp->BuildMoppCode(), runtime_error);
+  mopp->SetShape(shape);
+  BOOST_CHECK_NO_THROW(mopp->BuildMoppCode());
+  BOOST_CHECK_EQUAL(mopp->GetMoppTriangleIndices().size(), tris.size());
+  // write and read back, and check that the code survives
+  stringstream ss;
+  vector<NiObjectRef> objs;
+  BOOST_CHECK_NO_THROW(WriteNifTree(ss, mopp, NifInfo(VER_20_0_0_5, 11)));
+  ss.seekg(0);
+  BOOST_CHECK_NO_THROW(objs = ReadNifList(ss));
+  bhkMoppBvTreeShapeRef mopp2;
+  for (unsigned int i = 0; i < objs.size() && mopp2 == NULL; i++)
+    mopp2 = DynamicCast<bhkMoppBvTreeShape>(objs[i]);
+  BOOST_REQUIRE(mopp2 != NULL);
+  BOOST_CHECK(mopp2->GetMoppCode() == mopp->GetMoppCode());
+  BOOST_CHECK(mopp2->QueryMoppRay(Vector3(0.5f, 0.5f, 1.0f), Vector3(0.5f, 0.5f, -1.0f))
+              == mopp->QueryMoppRay(Vector3(0.5f, 0.5f, 1.0f), Vector3(0.5f, 0.5f, -1.0f)));
+}
+
+BOOST_AUTO_TEST_CASE(compressed_mesh_test)
+{
+  // two triangles small enough for a chunk and one that must be a big triangle
+  vector<Vector3> verts;
+  verts.push_back(Vector3(1.0f, 1.0f, 0.0f));
+  verts.push_back(Vector3(2.0f, 1.0f, 0.0f));
+  verts.push_back(Vector3(2.0f, 2.0f, 0.5f));
+  verts.push_back(Vector3(1.0f, 2.0f, 0.25f));
+  verts.push_back(Vector3(0.0f, 0.0f, 0.0f));
+  verts.push_back(Vector3(100.0f, 0.0f, 0.0f));
+  verts.push_back(Vector3(0.0f, 100.0f, 0.0f));
+  vector<Triangle> tris;
+  tris.push_back(Triangle(0, 1, 2));
+  tris.push_back(Triangle(0, 2, 3));
+  tris.push_back(Triangle(4, 5, 6));
+  const float error = 0.001f;
+  bhkCompressedMeshShapeDataRef data = new bhkCompressedMeshShapeData;
+  data->SetTriangleMesh(verts, tris, vector<unsigned int>(), error);
+  BOOST_CHECK_EQUAL(data->GetChunks().size(), 1u);
+  BOOST_CHECK_EQUAL(data->GetBigTris().size(), 1u);
+
+  vector<Vector3> out_verts;
+  vector<Triangle> out_tris;
+  vector<unsigned int> materials;
+  data->GetTriangleMesh(out_verts, out_tris, &materials);
+  BOOST_REQUIRE_EQUAL(out_verts.size(), verts.size());
+  BOOST_REQUIRE_EQUAL(out_tris.size(), tris.size());
+  BOOST_CHECK_EQUAL(materials.size(), tris.size());
+  // chunk triangles come first and the big triangle keeps its exact vertices
+  BOOST_CHECK(out_verts[out_tris[2].v1] == verts[4]);
+  BOOST_CHECK(out_verts[out_tris[2].v2] == verts[5]);
+  BOOST_CHECK(out_verts[out_tris[2].v3] == verts[6]);
+
+  // match each vertex read back to the vertex it came from
+  vector<unsigned short> source(out_verts.size());
+  for (unsigned int i = 0; i < out_verts.size(); i++) {
+    unsigned int best = 0;
+    for (unsigned int j = 1; j < verts.size(); j++)
+      if ((out_verts[i] - verts[j]).Magnitude() < (out_verts[i] - verts[best]).Magnitude())
+        best = j;
+    BOOST_CHECK_SMALL(fabs(out_verts[i].x - verts[best].x), error);
+    BOOST_CHECK_SMALL(fabs(out_verts[i].y - verts[best].y), error);
+    BOOST_CHECK_SMALL(fabs(out_verts[i].z - verts[best].z), error);
+    source[i] = (unsigned short)best;
+  }
+  vector<Triangle> expected, found;
+  for (unsigned int i = 0; i < tris.size(); i++) {
+    expected.push_back(first_smallest(tris[i]));
+    found.push_back(first_smallest(Triangle(source[out_tris[i].v1], source[out_tris[i].v2], source[out_tris[i].v3])));
+  }
+  sort(expected.begin(), expected.end(), triangle_less);
+  sort(found.begin(), found.end(), triangle_less);
+  for (unsigned int i = 0; i < tris.size(); i++) {
+    BOOST_CHECK_EQUAL(found[i].v1, expected[i].v1);
+    BOOST_CHECK_EQUAL(found[i].v2, expected[i].v2);
+    BOOST_CHECK_EQUAL(found[i].v3, expected[i].v3);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(mopp_malformed_test)
+{
+  bhkMoppBvTreeShapeRef mopp = new bhkMoppBvTreeShape;
+  vector<Niflib::byte> code;
+  // split whose else branch jumps past the end
+  code.push_back(0x10);
+  code.push_back(0x80);
+  code.push_back(0x80);
+  code.push_back(0x40);
+  code.push_back(0x30);
+  mopp->SetMoppCode(code);
+  BOOST_CHECK_THROW(mopp->GetMoppTriangleIndices(), runtime_error);
+  // unknown instruction
+  code.clear();
+  code.push_back(0xFF);
+  mopp->SetMoppCode(code);
+  BOOST_CHECK_THROW(mopp->GetMoppTriangleIndices(), runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
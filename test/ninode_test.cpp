@@ -10,6 +10,12 @@
 
 #include "niflib.h"
 #include "obj/NiNode.h"
+#include "obj/NiTriShape.h"
+#include "obj/NiTriShapeData.h"
+#include "obj/BSMultiBoundNode.h"
+#include "obj/BSMultiBound.h"
+#include "obj/BSMultiBoundAABB.h"
+#include "SceneBounds.h"
 
 using namespace Niflib;
 using namespace std;
@@ -37,4 +43,43 @@ BOOST_AUTO_TEST_CASE(ninode_test)
 {
 }
 
+BOOST_AUTO_TEST_CASE(ninode_scene_bounds_test)
+{
+  vector<Vector3> verts;
+  verts.push_back(Vector3(-1.0f, -1.0f, 0.0f));
+  verts.push_back(Vector3(1.0f, -1.0f, 0.0f));
+  verts.push_back(Vector3(1.0f, 1.0f, 0.0f));
+  verts.push_back(Vector3(-1.0f, 1.0f, 0.0f));
+  verts.push_back(Vector3(0.0f, 0.0f, 0.5f));
+  NiTriShapeDataRef data = new NiTriShapeData;
+  data->SetVertices(verts);
+  // the same data twice, offset along x
+  NiTriShapeRef shape1 = new NiTriShape;
+  NiTriShapeRef shape2 = new NiTriShape;
+  shape1->SetData(data);
+  shape2->SetData(data);
+  shape2->SetLocalTranslation(Vector3(4.0f, 0.0f, 0.0f));
+  BSMultiBoundAABBRef aabb = new BSMultiBoundAABB;
+  BSMultiBoundRef multi = new BSMultiBound;
+  multi->SetData(aabb);
+  BSMultiBoundNodeRef node = new BSMultiBoundNode;
+  node->SetMultiBound(multi);
+  node->AddChild(StaticCast<NiAVObject>(shape1));
+  node->AddChild(StaticCast<NiAVObject>(shape2));
+
+  // shared data is bounded once, plus the multibound
+  BOOST_CHECK_EQUAL(UpdateSceneBounds(node), 2u);
+  BOOST_CHECK_SMALL(data->GetCenter().x, 1e-5f);
+  BOOST_CHECK_SMALL(data->GetCenter().y, 1e-5f);
+  BOOST_CHECK(data->GetRadius() <= sqrt(2.0f) + 1e-5f);
+  for (unsigned int i = 0; i < verts.size(); ++i) {
+    BOOST_CHECK((verts[i] - data->GetCenter()).Magnitude() <= data->GetRadius() + 1e-5f);
+  }
+  BOOST_CHECK_CLOSE(aabb->GetPosition().x, 2.0f, 1e-3f);
+  BOOST_CHECK_CLOSE(aabb->GetPosition().z, 0.25f, 1e-3f);
+  BOOST_CHECK_CLOSE(aabb->GetExtent().x, 3.0f, 1e-3f);
+  BOOST_CHECK_CLOSE(aabb->GetExtent().y, 1.0f, 1e-3f);
+  BOOST_CHECK_CLOSE(aabb->GetExtent().z, 0.25f, 1e-3f);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
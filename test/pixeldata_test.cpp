@@ -0,0 +1,153 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <cmath> // fabs
+#include <sstream> // stringstream
+
+#include "niflib.h"
+#include "obj/NiPixelData.h"
+
+using namespace Niflib;
+using namespace std;
+
+// diagonal color gradient, with an alpha ramp unless opaque is set
+static vector<Color4> make_image(int w, int h, bool opaque)
+{
+  vector<Color4> pixels(w * h);
+  for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++) {
+      float t = float(x + y) / float(w + h);
+      pixels[y * w + x] = Color4(t, 0.5f * t, 1.0f - t, opaque ? 1.0f : 1.0f - t);
+    }
+  return pixels;
+}
+
+static float max_error(const vector<Color4> & a, const vector<Color4> & b, bool alpha)
+{
+  float err = 0.0f;
+  for (unsigned int i = 0; i < a.size(); i++) {
+    err = max(err, fabs(a[i].r - b[i].r));
+    err = max(err, fabs(a[i].g - b[i].g));
+    err = max(err, fabs(a[i].b - b[i].b));
+    if (alpha)
+      err = max(err, fabs(a[i].a - b[i].a));
+  }
+  return err;
+}
+
+BOOST_AUTO_TEST_SUITE(pixeldata_test_suite)
+
+BOOST_AUTO_TEST_CASE(dxt_decode_test)
+{
+  // red and blue end points, four color mode, index pattern 0 1 2 3 on every row
+  Niflib::byte block[8] = { 0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4 };
+  Niflib::byte rgba[64];
+  NiPixelData::DecompressBlocks(PX_FMT_DXT1, block, 4, 4, rgba);
+  BOOST_CHECK_EQUAL(int(rgba[0]), 255);
+  BOOST_CHECK_EQUAL(int(rgba[2]), 0);
+  BOOST_CHECK_EQUAL(int(rgba[4]), 0);
+  BOOST_CHECK_EQUAL(int(rgba[6]), 255);
+  BOOST_CHECK_EQUAL(int(rgba[8]), 170);
+  BOOST_CHECK_EQUAL(int(rgba[12]), 85);
+  BOOST_CHECK_EQUAL(int(rgba[15]), 255);
+  // three color mode, index 3 is transparent
+  swap(block[0], block[2]);
+  swap(block[1], block[3]);
+  NiPixelData::DecompressBlocks(PX_FMT_DXT1, block, 4, 4, rgba);
+  BOOST_CHECK_EQUAL(int(rgba[15]), 0);
+  BOOST_CHECK_THROW(NiPixelData::DecompressBlocks(PX_FMT_RGB8, block, 4, 4, rgba), runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(dxt_roundtrip_test)
+{
+  vector<Color4> pixels = make_image(32, 16, true);
+  NiPixelDataRef data = new NiPixelData;
+  data->Reset(32, 16, PX_FMT_DXT1);
+  BOOST_CHECK_NO_THROW(data->SetColors(pixels, false));
+  BOOST_CHECK_LT(max_error(pixels, data->GetColors(), false), 0.1f);
+  pixels = make_image(32, 16, false);
+  data->Reset(32, 16, PX_FMT_DXT5);
+  BOOST_CHECK_NO_THROW(data->SetColors(pixels, true));
+  BOOST_CHECK_LT(max_error(pixels, data->GetColors(), true), 0.1f);
+  // partial blocks
+  pixels = make_image(2, 2, false);
+  data->Reset(2, 2, PX_FMT_DXT5);
+  BOOST_CHECK_NO_THROW(data->SetColors(pixels, false));
+  BOOST_CHECK_LT(max_error(pixels, data->GetColors(), true), 0.1f);
+}
+
+BOOST_AUTO_TEST_CASE(mipmap_view_test)
+{
+  NiPixelDataRef data = new NiPixelData;
+  data->Reset(8, 4, PX_FMT_RGB8);
+  data->AllocatePixelData(0, 6);
+  BOOST_CHECK_EQUAL(data->GetNumMipMaps(), 4u);
+  BOOST_CHECK_EQUAL(data->GetNumFaces(), 6u);
+  NiPixelData::MipMapView view = data->GetMipMapView(1, 5);
+  BOOST_CHECK_EQUAL(view.width, 4u);
+  BOOST_CHECK_EQUAL(view.height, 2u);
+  BOOST_CHECK_EQUAL(view.size, 24u);
+  BOOST_CHECK_EQUAL(view.rowPitch, 12u);
+  BOOST_CHECK_THROW(data->GetMipMapView(4, 0), runtime_error);
+
+  // stream a checkerboard into the first mipmap of every face
+  string raw;
+  for (int i = 0; i < 32; i++)
+    raw += string(3, char((i % 8 + i / 8) % 2 ? 255 : 0));
+  for (unsigned int f = 0; f < 6; f++) {
+    istringstream in(raw);
+    data->ReadMipMap(in, 0, f);
+  }
+  // an sRGB box filter keeps the perceived brightness of the checkerboard
+  data->GenerateMipMaps(NiPixelData::MIP_FILTER_BOX, true);
+  BOOST_CHECK_EQUAL(int(data->GetMipMapView(3, 2).data[0]), 188);
+  data->GenerateMipMaps(NiPixelData::MIP_FILTER_BOX, false);
+  BOOST_CHECK_EQUAL(int(data->GetMipMapView(3, 2).data[0]), 128);
+  ostringstream out;
+  data->WriteMipMap(out, 0, 3);
+  BOOST_CHECK(out.str() == raw);
+
+  // in place format conversion, swizzle and premultiply
+  data->ConvertFormat(PX_FMT_RGBA8);
+  BOOST_CHECK_EQUAL(data->GetMipMapView(0, 5).size, 128u);
+  BOOST_CHECK_EQUAL(int(data->GetMipMapView(3, 5).data[0]), 128);
+  BOOST_CHECK_EQUAL(int(data->GetMipMapView(3, 5).data[3]), 255);
+  data->SwizzleChannels(3, 1, 2, 0);
+  BOOST_CHECK_EQUAL(int(data->GetMipMapView(3, 0).data[0]), 255);
+  BOOST_CHECK_EQUAL(int(data->GetMipMapView(3, 0).data[3]), 128);
+  data->PremultiplyAlpha();
+  BOOST_CHECK_EQUAL(int(data->GetMipMapView(3, 0).data[0]), 128);
+  const byte * storage = data->GetMipMapView(0, 0).data;
+  data->ConvertFormat(PX_FMT_RGB8);
+  // shrinking reuses the same buffer
+  BOOST_CHECK(data->GetMipMapView(0, 0).data == storage);
+  BOOST_CHECK_EQUAL(data->GetMipMapView(0, 0).size, 96u);
+  BOOST_CHECK_EQUAL(int(data->GetMipMapView(3, 0).data[1]), 64);
+}
+
+BOOST_AUTO_TEST_CASE(convert_growing_mipmaps_test)
+{
+  // the DXT5 mipmaps of an 8x2 image take more room than the RGB8 ones,
+  // so converting must not read levels that were already overwritten
+  NiPixelDataRef data = new NiPixelData;
+  data->Reset(8, 2, PX_FMT_RGB8);
+  data->AllocatePixelData(0, 1);
+  BOOST_REQUIRE_EQUAL(data->GetNumMipMaps(), 4u);
+  const int colors[4][3] = { {255, 0, 0}, {0, 255, 0}, {0, 0, 255}, {255, 255, 255} };
+  for (unsigned int i = 0; i < 4; i++) {
+    NiPixelData::MipMapView view = data->GetMipMapView(i, 0);
+    for (unsigned int j = 0; j < view.size; j++)
+      view.data[j] = Niflib::byte(colors[i][j % 3]);
+  }
+  data->ConvertFormat(PX_FMT_DXT5);
+  BOOST_CHECK_EQUAL(data->GetMipMapView(1, 0).size, 16u);
+  data->ConvertFormat(PX_FMT_RGBA8);
+  for (unsigned int i = 0; i < 4; i++) {
+    NiPixelData::MipMapView view = data->GetMipMapView(i, 0);
+    for (unsigned int j = 0; j < view.size; j++)
+      BOOST_CHECK_EQUAL(int(view.data[j]), j % 4 == 3 ? 255 : colors[i][j % 4]);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -12,6 +12,12 @@
 #include "obj/NiNode.h"
 #include "obj/NiTriShape.h"
 #include "obj/NiTriShapeData.h"
+#include "obj/NiLODNode.h"
+#include "MeshSimplifier.h"
+#include "GeometryOptimizer.h"
+#include "obj/NiSkinInstance.h"
+#include "obj/NiSkinData.h"
+#include "obj/NiSkinPartition.h"
 
 using namespace Niflib;
 using namespace std;
@@ -71,4 +77,231 @@ BOOST_AUTO_TEST_CASE(trishape_match_test)
   BOOST_CHECK_EQUAL(data->matchGroups[1].vertexIndices[1], 6);
 }
 
+BOOST_AUTO_TEST_CASE(trishape_swap_test)
+{
+  NiTriShapeDataRef data = new NiTriShapeData;
+  vector<Vector3> verts(3, Vector3(1.0f, 0.0f, 0.0f));
+  verts[1] = Vector3(-1.0f, 0.0f, 0.0f);
+  data->SetVertices(verts);
+  vector<Vector3> norms(3, Vector3(0.0f, 0.0f, 1.0f));
+  data->SwapNormals(norms);
+  BOOST_CHECK(norms.empty());
+  // the getters return the stored vectors themselves
+  BOOST_CHECK_EQUAL(&data->GetNormals(), &data->GetNormals());
+  BOOST_CHECK_EQUAL(data->GetNormals().size(), 3u);
+
+  vector<Vector3> moved(2, Vector3(0.0f, 2.0f, 0.0f));
+  moved[1] = Vector3(0.0f, -2.0f, 0.0f);
+  data->SwapVertices(moved);
+  // like SetVertices, the other vertex data is cleared and the bound updated
+  BOOST_CHECK_EQUAL(moved.size(), 3u);
+  BOOST_CHECK_EQUAL(data->GetVertexCount(), 2);
+  BOOST_CHECK(data->GetNormals().empty());
+  BOOST_CHECK_EQUAL(data->GetRadius(), 2.0f);
+  vector<Vector3> wrong(5);
+  BOOST_CHECK_THROW(data->SwapNormals(wrong), runtime_error);
+  BOOST_CHECK_THROW(data->GetUVSet(0), runtime_error);
+
+#ifdef NIFLIB_CXX11
+  // moving vectors in goes through the same paths as swapping
+  data->DoMatchDetection();
+  vector<Vector3> fresh(3, Vector3(0.0f, 0.0f, 3.0f));
+  const Vector3 * storage = &fresh[0];
+  data->SetVertices(std::move(fresh));
+  BOOST_CHECK_EQUAL(&data->GetVertices()[0], storage);
+  BOOST_CHECK(!data->HasMatchData());
+  data->SetTriangles(vector<Triangle>(1, Triangle(0, 1, 2)));
+  BOOST_CHECK_EQUAL(data->GetTriangles().size(), 1u);
+  BOOST_CHECK_EQUAL(data->numTrianglePoints, 3u);
+#endif
+
+  NiTriShapeDataRef other;
+  unsigned int refs = data->GetNumRefs();
+  other.swap(data);
+  BOOST_CHECK(data == NULL);
+  BOOST_CHECK_EQUAL(other->GetNumRefs(), refs);
+}
+
+// a flat grid of n by n quads
+static NiTriShapeDataRef MakeGrid(unsigned int n)
+{
+  vector<Vector3> verts;
+  vector<Vector3> norms;
+  vector<TexCoord> uvs;
+  vector<Triangle> tris;
+  for (unsigned int y = 0; y <= n; ++y) {
+    for (unsigned int x = 0; x <= n; ++x) {
+      verts.push_back(Vector3(float(x), float(y), 0.0f));
+      norms.push_back(Vector3(0.0f, 0.0f, 1.0f));
+      uvs.push_back(TexCoord(float(x) / n, float(y) / n));
+    }
+  }
+  for (unsigned int y = 0; y < n; ++y) {
+    for (unsigned int x = 0; x < n; ++x) {
+      unsigned short a = y * (n + 1) + x, b = a + 1, c = a + n + 1, d = c + 1;
+      tris.push_back(Triangle(a, b, d));
+      tris.push_back(Triangle(a, d, c));
+    }
+  }
+  NiTriShapeDataRef data = new NiTriShapeData;
+  data->SetVertices(verts);
+  data->SetNormals(norms);
+  data->SetUVSetCount(1);
+  data->SetUVSet(0, uvs);
+  data->SetTriangles(tris);
+  return data;
+}
+
+BOOST_AUTO_TEST_CASE(trishape_simplify_test)
+{
+  NiTriShapeDataRef data = MakeGrid(8);
+  float error = -1.0f;
+  vector<Triangle> tris = SimplifyTriangles(data, 16, NULL, 1.0f, &error);
+  BOOST_CHECK(tris.size() <= 16);
+  BOOST_CHECK(tris.size() > 0);
+  // the grid is flat, so nothing moved off the surface
+  BOOST_CHECK_SMALL(error, 1e-3f);
+  // the border stays in place, so the area is unchanged
+  float area = 0.0f;
+  for (unsigned int i = 0; i < tris.size(); ++i) {
+    const Vector3 & a = data->GetVertices()[tris[i].v1];
+    const Vector3 & b = data->GetVertices()[tris[i].v2];
+    const Vector3 & c = data->GetVertices()[tris[i].v3];
+    Vector3 n = (b - a).CrossProduct(c - a);
+    BOOST_CHECK(n.z > 0.0f);
+    area += 0.5f * n.z;
+  }
+  BOOST_CHECK_CLOSE(area, 64.0f, 1e-3f);
+}
+
+BOOST_AUTO_TEST_CASE(trishape_generate_lods_test)
+{
+  NiNodeRef root = new NiNode;
+  NiTriShapeRef shape = new NiTriShape;
+  shape->SetData(MakeGrid(8));
+  root->AddChild(DynamicCast<NiAVObject>(shape));
+  vector<float> ratios;
+  ratios.push_back(0.5f);
+  ratios.push_back(0.125f);
+  NiLODNodeRef lod = GenerateLODs(shape, ratios);
+  // the lod node replaced the shape
+  BOOST_CHECK_EQUAL(root->GetChildren().size(), 1u);
+  BOOST_CHECK(root->GetChildren()[0] == DynamicCast<NiAVObject>(lod));
+  BOOST_CHECK_EQUAL(lod->GetChildren().size(), 3u);
+  BOOST_CHECK(lod->GetChildren()[0] == DynamicCast<NiAVObject>(shape));
+  NiTriShapeRef level2 = DynamicCast<NiTriShape>(lod->GetChildren()[2]);
+  BOOST_REQUIRE(level2 != NULL);
+  NiTriShapeDataRef data2 = DynamicCast<NiTriShapeData>(level2->GetData());
+  BOOST_CHECK(data2->GetTriangles().size() <= 16);
+  // unused vertices are dropped
+  BOOST_CHECK(data2->GetVertices().size() < 81);
+  BOOST_CHECK_EQUAL(data2->GetUVSetCount(), 1);
+  vector<LODRange> ranges = lod->GetLODLevels();
+  BOOST_REQUIRE_EQUAL(ranges.size(), 3u);
+  BOOST_CHECK_EQUAL(ranges[0].nearExtent, 0.0f);
+  for (unsigned int i = 1; i < ranges.size(); ++i) {
+    BOOST_CHECK_EQUAL(ranges[i].nearExtent, ranges[i - 1].farExtent);
+    BOOST_CHECK(ranges[i].farExtent >= ranges[i].nearExtent);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(trishape_generate_skinned_lods_test)
+{
+  NiNodeRef root = new NiNode;
+  NiNodeRef bone = new NiNode;
+  root->AddChild(StaticCast<NiAVObject>(bone));
+  NiTriShapeRef shape = new NiTriShape;
+  shape->SetData(MakeGrid(8));
+  root->AddChild(StaticCast<NiAVObject>(shape));
+  vector<NiNodeRef> bones(1, bone);
+  shape->BindSkin(bones);
+  vector<SkinWeight> weights(81);
+  for (unsigned short i = 0; i < 81; ++i) {
+    weights[i].index = i;
+    weights[i].weight = 1.0f;
+  }
+  shape->SetBoneWeights(0, weights);
+  shape->GenHardwareSkinInfo();
+  NiSkinPartitionRef partition = shape->GetSkinInstance()->GetSkinData()->GetSkinPartition();
+  BOOST_REQUIRE(partition != NULL);
+
+  vector<float> ratios(1, 0.25f);
+  NiLODNodeRef lod = GenerateLODs(shape, ratios);
+  // the levels partition their own skin data, leaving the original alone
+  BOOST_CHECK(shape->GetSkinInstance()->GetSkinData()->GetSkinPartition() == partition);
+  BOOST_CHECK(shape->GetSkinInstance()->GetSkinPartition() == partition);
+  NiTriShapeRef level1 = DynamicCast<NiTriShape>(lod->GetChildren()[1]);
+  BOOST_REQUIRE(level1 != NULL);
+  NiSkinInstanceRef skin1 = level1->GetSkinInstance();
+  BOOST_REQUIRE(skin1 != NULL);
+  BOOST_CHECK(skin1->GetSkinPartition() != NULL);
+  BOOST_CHECK(skin1->GetSkinPartition() != partition);
+  BOOST_CHECK(skin1->GetSkinData() != shape->GetSkinInstance()->GetSkinData());
+  BOOST_CHECK_EQUAL(skin1->GetSkinData()->GetBoneWeights(0).size(), 81u);
+}
+
+BOOST_AUTO_TEST_CASE(trishape_optimize_test)
+{
+  NiNodeRef root = new NiNode;
+  NiNodeRef bone = new NiNode;
+  root->AddChild(StaticCast<NiAVObject>(bone));
+  NiTriShapeRef shape = new NiTriShape;
+  NiTriShapeDataRef data = new NiTriShapeData;
+  shape->SetData(data);
+  root->AddChild(StaticCast<NiAVObject>(shape));
+  // a quad whose triangles do not share vertices, an unused vertex and a degenerate triangle
+  vector<Vector3> verts;
+  verts.push_back(Vector3(0, 0, 0));
+  verts.push_back(Vector3(1, 0, 0));
+  verts.push_back(Vector3(1, 1, 0));
+  verts.push_back(Vector3(0, 0, 0));
+  verts.push_back(Vector3(1, 1, 0));
+  verts.push_back(Vector3(0, 1, 0));
+  verts.push_back(Vector3(5, 5, 5));
+  vector<TexCoord> uvs;
+  for (unsigned int i = 0; i < verts.size(); ++i) {
+    uvs.push_back(TexCoord(verts[i].x, verts[i].y));
+  }
+  vector<Triangle> tris;
+  tris.push_back(Triangle(0, 1, 2));
+  tris.push_back(Triangle(3, 4, 5));
+  tris.push_back(Triangle(0, 3, 1));
+  data->SetVertices(verts);
+  data->SetUVSetCount(2);
+  data->SetUVSet(0, uvs);
+  data->SetUVSet(1, uvs);
+  data->SetTriangles(tris);
+  vector<NiNodeRef> bones(1, bone);
+  shape->BindSkin(bones);
+  vector<SkinWeight> weights;
+  for (unsigned short i = 0; i < 7; ++i) {
+    SkinWeight sw;
+    sw.index = i;
+    sw.weight = 1.0f;
+    weights.push_back(sw);
+  }
+  shape->SetBoneWeights(0, weights);
+  shape->GenHardwareSkinInfo(4, 4, false);
+
+  GeometryOptimizeResult result = OptimizeSceneGeometry(root);
+  BOOST_CHECK_EQUAL(result.weldedVertices, 2u);
+  BOOST_CHECK_EQUAL(result.unusedVertices, 1u);
+  BOOST_CHECK_EQUAL(result.degenerateTriangles, 1u);
+  BOOST_CHECK_EQUAL(result.duplicateUVSets, 1u);
+  BOOST_CHECK(result.bytesSaved > 0);
+  BOOST_CHECK_EQUAL(data->GetVertices().size(), 4u);
+  BOOST_CHECK_EQUAL(data->GetUVSetCount(), 1);
+  BOOST_CHECK_EQUAL(data->GetUVSet(0).size(), 4u);
+  vector<Triangle> after = data->GetTriangles();
+  BOOST_REQUIRE_EQUAL(after.size(), 2u);
+  // both triangles now share the diagonal
+  BOOST_CHECK_EQUAL(after[0].v1, after[1].v1);
+  BOOST_CHECK_EQUAL(after[0].v3, after[1].v2);
+  BOOST_CHECK_EQUAL(shape->GetSkinInstance()->GetSkinData()->GetBoneWeights(0).size(), 4u);
+  NiSkinPartitionRef partition = shape->GetSkinInstance()->GetSkinPartition();
+  BOOST_REQUIRE(partition != NULL);
+  BOOST_CHECK_EQUAL(partition->GetNumVertices(0), 4);
+  BOOST_CHECK_EQUAL(partition->GetTriangles(0).size(), 2u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,12 @@
 #include "niflib.h"
 #include "obj/NiNode.h"
 #include "obj/NiKeyframeController.h"
+#include "obj/NiTriShape.h"
+#include "obj/NiTriShapeData.h"
+#include "obj/NiMaterialProperty.h"
+#include "StringInterner.h"
+#include "ObjectArena.h"
+#include "ObjectDeduplicator.h"
 
 using namespace Niflib;
 using namespace std;
@@ -34,4 +40,132 @@ BOOST_AUTO_TEST_CASE(write_incomplete_tree_test)
   BOOST_CHECK(ctrl2->GetTarget() == NULL);
 }
 
+BOOST_AUTO_TEST_CASE(write_string_table_test)
+{
+  // nodes sharing names are stored once in the string table
+  NiNodeRef root = new NiNode;
+  root->SetName("root");
+  for (int i = 0; i < 6; i++) {
+    NiNodeRef child = new NiNode;
+    child->SetName(i % 2 ? "odd" : "even");
+    root->AddChild(StaticCast<NiAVObject>(child));
+  }
+  stringstream ss;
+  WriteNifTree(ss, root, NifInfo(VER_20_2_0_7, 11));
+
+  ss.seekg(0);
+  StringInterner strings;
+  NifInfo info;
+  info.strings = &strings;
+  NiNodeRef root2 = DynamicCast<NiNode>(ReadNifTree(ss, &info));
+  BOOST_REQUIRE(root2 != NULL);
+  BOOST_CHECK(info.strings == &strings);
+  BOOST_CHECK_EQUAL(strings.Size(), 3u);
+
+  // handles compare without looking at the characters
+  vector<NiAVObjectRef> children = root2->GetChildren();
+  BOOST_REQUIRE_EQUAL(children.size(), 6u);
+  InternedString odd = strings.Intern(children[1]->GetName());
+  BOOST_CHECK(odd == strings.Intern(children[3]->GetName()));
+  BOOST_CHECK(odd != strings.Intern(children[0]->GetName()));
+  BOOST_CHECK_EQUAL(odd.str(), "odd");
+  BOOST_CHECK_EQUAL(strings.Size(), 3u);
+  InternedString found;
+  BOOST_CHECK(strings.Find("root", found));
+  BOOST_CHECK(found == strings.GetString(found.GetIndex()));
+  BOOST_CHECK(!strings.Find("missing", found));
+  BOOST_CHECK(strings.Intern("").empty());
+}
+
+BOOST_AUTO_TEST_CASE(read_arena_test)
+{
+  NiNodeRef root = new NiNode;
+  for (int i = 0; i < 10; i++) {
+    root->AddChild(StaticCast<NiAVObject>(NiNodeRef(new NiNode)));
+  }
+  stringstream ss;
+  WriteNifTree(ss, root, NifInfo(VER_20_0_0_5));
+  root = NULL;
+  unsigned int before = RefObject::NumObjectsInMemory();
+
+  NiNodeRef root2;
+  {
+    ObjectArena arena;
+    NifInfo info;
+    info.arena = &arena;
+    ss.seekg(0);
+    root2 = DynamicCast<NiNode>(ReadNifTree(ss, &info));
+    BOOST_REQUIRE(root2 != NULL);
+    BOOST_CHECK_EQUAL(arena.GetObjectCount(), 11u);
+    BOOST_CHECK_EQUAL(arena.GetBlockCount(), 1u);
+    BOOST_CHECK(ObjectArena::GetCurrent() == NULL);
+    // objects created outside a read still come from the heap
+    NiNodeRef heap_node = new NiNode;
+    BOOST_CHECK_EQUAL(arena.GetObjectCount(), 11u);
+  }
+  // the objects outlive the arena
+  BOOST_CHECK_EQUAL(root2->GetChildren().size(), 10u);
+  root2 = NULL;
+  BOOST_CHECK_EQUAL(RefObject::NumObjectsInMemory(), before);
+}
+
+NiTriShapeRef make_triangle(const string & material)
+{
+  vector<Vector3> verts;
+  verts.push_back(Vector3(0.0f, 0.0f, 0.0f));
+  verts.push_back(Vector3(1.0f, 0.0f, 0.0f));
+  verts.push_back(Vector3(0.0f, 1.0f, 0.0f));
+  NiTriShapeDataRef data = new NiTriShapeData;
+  data->SetVertices(verts);
+  data->SetTriangles(vector<Triangle>(1, Triangle(0, 1, 2)));
+  NiMaterialPropertyRef mat = new NiMaterialProperty;
+  mat->SetName(material);
+  // the colors have no defaults
+  mat->SetAmbientColor(Color3(1.0f, 1.0f, 1.0f));
+  mat->SetDiffuseColor(Color3(1.0f, 1.0f, 1.0f));
+  mat->SetSpecularColor(Color3(0.0f, 0.0f, 0.0f));
+  mat->SetEmissiveColor(Color3(0.0f, 0.0f, 0.0f));
+  NiTriShapeRef shape = new NiTriShape;
+  shape->SetData(data);
+  shape->AddProperty(mat);
+  return shape;
+}
+
+BOOST_AUTO_TEST_CASE(write_deduplicate_test)
+{
+  NifInfo info(VER_20_2_0_7, 11, 34);
+  NiNodeRef root = new NiNode;
+  for (int i = 0; i < 3; i++) {
+    root->AddChild(StaticCast<NiAVObject>(make_triangle(i == 2 ? "other" : "stone")));
+  }
+  vector<NiAVObjectRef> children = root->GetChildren();
+  DeduplicateResult result = DeduplicateObjects(root, info);
+  // two of the data and one of the materials
+  BOOST_CHECK_EQUAL(result.removedObjects, 3u);
+  BOOST_CHECK(result.bytesSaved > 0u);
+  NiTriShapeRef first = DynamicCast<NiTriShape>(children[0]);
+  NiTriShapeRef last = DynamicCast<NiTriShape>(children[2]);
+  BOOST_CHECK(first->GetData() == last->GetData());
+  BOOST_CHECK(first->GetProperties().front() != last->GetProperties().front());
+  BOOST_CHECK_EQUAL(first->GetParent(), root);
+  BOOST_CHECK_EQUAL(DeduplicateObjects(root, info).removedObjects, 0u);
+
+  stringstream ss;
+  WriteNifTree(ss, root, info);
+  ss.seekg(0);
+  BOOST_CHECK_EQUAL(ReadNifList(ss).size(), 7u);
+
+  // the same material and data in two files
+  WriteNifTree("dedup_test_a.nif", make_triangle("stone"), info);
+  WriteNifTree("dedup_test_b.nif", make_triangle("stone"), info);
+  vector<string> files;
+  files.push_back("dedup_test_a.nif");
+  files.push_back("dedup_test_b.nif");
+  vector<SharedObject> shared;
+  BOOST_CHECK_EQUAL(DeduplicateFiles(files, &shared).removedObjects, 0u);
+  BOOST_REQUIRE_EQUAL(shared.size(), 2u);
+  BOOST_CHECK_EQUAL(shared[0].files.size(), 2u);
+  BOOST_CHECK_EQUAL(shared[0].files[1], "dedup_test_b.nif");
+}
+
 BOOST_AUTO_TEST_SUITE_END()